@@ -4,8 +4,8 @@
 
 uniform sampler2D texture;
 
-in vec2 texCoord;
-in float light;
+varying vec2 texCoord;
+varying float light;
 
 void main( void )
 {
@@ -0,0 +1,178 @@
+#include "VRBarnesHut.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace OSG;
+
+VRBarnesHut::VRBarnesHut() {}
+
+void VRBarnesHut::setSoftening(double s) { softening2 = s*s; }
+int VRBarnesHut::size() { return points.size(); }
+
+void VRBarnesHut::build(const vector<Vec3d>& pnts, const vector<float>& m) {
+    points = pnts;
+    masses = m;
+    masses.resize(points.size(), 1);
+    nodes.clear();
+    order.clear();
+    if (points.size() == 0) return;
+
+    Vec3d bb1 = points[0], bb2 = points[0];
+    for (auto& p : points) {
+        for (int k=0; k<3; k++) {
+            bb1[k] = min(bb1[k], p[k]);
+            bb2[k] = max(bb2[k], p[k]);
+        }
+    }
+
+    order.reserve(points.size());
+    for (unsigned int i=0; i<points.size(); i++) if (masses[i] != 0) order.push_back(i);
+
+    Node root;
+    root.origin = bb1;
+    root.size = max(max(bb2[0]-bb1[0], bb2[1]-bb1[1]), bb2[2]-bb1[2]) * 1.0001 + 1e-9;
+    nodes.reserve(2*points.size()/leafSize*8/7 + 1);
+    nodes.push_back(root);
+    buildNode(0, 0, order.size(), 0);
+}
+
+void VRBarnesHut::buildNode(int n, int start, int count, int depth) {
+    Vec3d c;
+    double m = 0;
+    for (int i=start; i<start+count; i++) {
+        int j = order[i];
+        c += points[j]*masses[j];
+        m += masses[j];
+    }
+    nodes[n].mass = m;
+    nodes[n].center = m != 0 ? c*(1.0/m) : nodes[n].origin;
+    nodes[n].start = start;
+    nodes[n].count = count;
+    if (count <= leafSize || depth >= maxDepth) return;
+
+    // sort the points into the octants
+    Vec3d o = nodes[n].origin;
+    double h = nodes[n].size*0.5;
+    auto octant = [&](int j) {
+        const Vec3d& p = points[j];
+        return int(p[0] >= o[0]+h) | int(p[1] >= o[1]+h)<<1 | int(p[2] >= o[2]+h)<<2;
+    };
+
+    int counts[8] = {0,0,0,0,0,0,0,0};
+    for (int i=start; i<start+count; i++) counts[octant(order[i])]++;
+    int offsets[8];
+    offsets[0] = start;
+    for (int k=1; k<8; k++) offsets[k] = offsets[k-1] + counts[k-1];
+
+    vector<int> tmp(order.begin()+start, order.begin()+start+count);
+    int pos[8];
+    copy(offsets, offsets+8, pos);
+    for (int j : tmp) order[pos[octant(j)]++] = j;
+
+    int first = nodes.size();
+    nodes[n].child = first;
+    for (int k=0; k<8; k++) {
+        Node child;
+        child.origin = o + Vec3d(k&1 ? h : 0, k&2 ? h : 0, k&4 ? h : 0);
+        child.size = h;
+        nodes.push_back(child);
+    }
+    for (int k=0; k<8; k++) buildNode(first+k, offsets[k], counts[k], depth+1);
+}
+
+bool VRBarnesHut::accept(const Node& n, const Vec3d& p, double theta2) const {
+    for (int k=0; k<3; k++) { // never approximate cells containing the query point
+        if (p[k] < n.origin[k] || p[k] > n.origin[k]+n.size) {
+            Vec3d d = n.center - p;
+            return n.size*n.size < theta2 * d.squareLength();
+        }
+    }
+    return false;
+}
+
+Vec3d VRBarnesHut::field(const Vec3d& p, int self, float theta) const {
+    Vec3d res;
+    if (nodes.size() == 0) return res;
+    double theta2 = theta*theta;
+
+    int stack[256];
+    int N = 0;
+    stack[N++] = 0;
+    while (N > 0) {
+        const Node& n = nodes[stack[--N]];
+        if (n.count == 0) continue;
+
+        if (accept(n, p, theta2)) {
+            Vec3d d = p - n.center;
+            double r2 = d.squareLength() + softening2;
+            res += d * (n.mass / (r2*sqrt(r2)));
+            continue;
+        }
+
+        if (n.child >= 0) {
+            for (int k=0; k<8; k++) stack[N++] = n.child+k;
+            continue;
+        }
+
+        for (int i=n.start; i<n.start+n.count; i++) {
+            int j = order[i];
+            if (j == self) continue;
+            Vec3d d = p - points[j];
+            double r2 = d.squareLength() + softening2;
+            res += d * (masses[j] / (r2*sqrt(r2)));
+        }
+    }
+    return res;
+}
+
+double VRBarnesHut::potential(const Vec3d& p, int self, float theta) const {
+    double res = 0;
+    if (nodes.size() == 0) return res;
+    double theta2 = theta*theta;
+
+    int stack[256];
+    int N = 0;
+    stack[N++] = 0;
+    while (N > 0) {
+        const Node& n = nodes[stack[--N]];
+        if (n.count == 0) continue;
+
+        if (accept(n, p, theta2)) {
+            res += n.mass / sqrt((p - n.center).squareLength() + softening2);
+            continue;
+        }
+
+        if (n.child >= 0) {
+            for (int k=0; k<8; k++) stack[N++] = n.child+k;
+            continue;
+        }
+
+        for (int i=n.start; i<n.start+n.count; i++) {
+            int j = order[i];
+            if (j == self) continue;
+            res += masses[j] / sqrt((p - points[j]).squareLength() + softening2);
+        }
+    }
+    return res;
+}
+
+Vec3d VRBarnesHut::fieldExact(const vector<Vec3d>& points, const vector<float>& masses, const Vec3d& p, int self, double softening2) {
+    Vec3d res;
+    for (unsigned int j=0; j<points.size(); j++) {
+        if (int(j) == self || j >= masses.size() || masses[j] == 0) continue;
+        Vec3d d = p - points[j];
+        double r2 = d.squareLength() + softening2;
+        res += d * (masses[j] / (r2*sqrt(r2)));
+    }
+    return res;
+}
+
+double VRBarnesHut::potentialExact(const vector<Vec3d>& points, const vector<float>& masses, const Vec3d& p, int self, double softening2) {
+    double res = 0;
+    for (unsigned int j=0; j<points.size(); j++) {
+        if (int(j) == self || j >= masses.size() || masses[j] == 0) continue;
+        res += masses[j] / sqrt((p - points[j]).squareLength() + softening2);
+    }
+    return res;
+}
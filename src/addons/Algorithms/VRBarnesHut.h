@@ -0,0 +1,56 @@
+#ifndef VRBARNESHUT_H_INCLUDED
+#define VRBARNESHUT_H_INCLUDED
+
+#include <OpenSG/OSGVector.h>
+#include <vector>
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Barnes-Hut octree for inverse square interactions between weighted points.
+    Each cell stores its total mass and center of mass, cells which appear small from the query point
+    (edge length < theta * distance) are treated as a single point, theta = 0 gives the exact sum.
+    Nodes are stored in a flat array, the eight children of a cell are consecutive.
+*/
+
+class VRBarnesHut {
+    private:
+        struct Node {
+            Vec3d origin; // cube corner
+            double size = 0;
+            Vec3d center; // of mass
+            double mass = 0;
+            int child = -1; // first of eight children, -1 for leafs
+            int start = 0; // leaf: range in order
+            int count = 0;
+        };
+
+        vector<Vec3d> points;
+        vector<float> masses;
+        vector<Node> nodes;
+        vector<int> order; // points sorted by leaf
+        int leafSize = 8;
+        int maxDepth = 24;
+        double softening2 = 1e-6;
+
+        void buildNode(int n, int start, int count, int depth);
+        bool accept(const Node& n, const Vec3d& p, double theta2) const;
+
+    public:
+        VRBarnesHut();
+
+        void setSoftening(double s);
+        void build(const vector<Vec3d>& points, const vector<float>& masses);
+        int size();
+
+        Vec3d field(const Vec3d& p, int self = -1, float theta = 0.8) const; // sum of m (p-pj) / r^3
+        double potential(const Vec3d& p, int self = -1, float theta = 0.8) const; // sum of m / r
+
+        static Vec3d fieldExact(const vector<Vec3d>& points, const vector<float>& masses, const Vec3d& p, int self, double softening2 = 1e-6);
+        static double potentialExact(const vector<Vec3d>& points, const vector<float>& masses, const Vec3d& p, int self, double softening2 = 1e-6);
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRBARNESHUT_H_INCLUDED
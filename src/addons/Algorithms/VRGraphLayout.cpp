@@ -1,19 +1,23 @@
 #include "VRGraphLayout.h"
+#include "VRBarnesHut.h"
 #include "core/math/Octree.h"
 
+#include <algorithm>
+
 using namespace OSG;
 
 VRGraphLayout::VRGraphLayout() {}
 
 VRGraphLayoutPtr VRGraphLayout::create() { return VRGraphLayoutPtr( new VRGraphLayout() ); }
 
-void VRGraphLayout::setGraph(GraphPtr g) { graph = g; }
+void VRGraphLayout::setGraph(GraphPtr g) { graph = g; stepLength = -1; progress = 0; lastEnergy = 1e30; }
 GraphPtr VRGraphLayout::getGraph() { return graph; }
 void VRGraphLayout::setAlgorithm(ALGORITHM a, int p) { algorithms[p] = a; }
 void VRGraphLayout::clearAlgorithms() { algorithms.clear(); }
 void VRGraphLayout::setAlgorithm(string a, int p) {
     ALGORITHM A = SPRINGS;
     if (a == "OCCUPANCYMAP") A = OCCUPANCYMAP;
+    if (a == "FORCES") A = FORCES;
     setAlgorithm(A, p);
 }
 
@@ -109,9 +113,157 @@ void VRGraphLayout::applyOccupancy(float eps, float v) {
     }
 }
 
-void VRGraphLayout::compute(int N, float eps) {
-    if (!graph) return;
-    for (int i=0; i<N; i++) { // steps
+void VRGraphLayout::readNodes(vector<Vec3d>& positions, vector<float>& radii, vector<float>& masses, vector<int>& nodeFlags) {
+    auto& nodes = graph->getNodes();
+    int N = nodes.size();
+    positions.resize(N);
+    radii.resize(N);
+    masses.resize(N);
+    nodeFlags.resize(N);
+    for (int i=0; i<N; i++) {
+        auto& n = nodes[i];
+        positions[i] = n.box.empty() ? n.p.pos() : n.box.center();
+        radii[i] = n.box.radius();
+        nodeFlags[i] = getFlag(i);
+        masses[i] = nodeFlags[i] & INACTIVE ? 0 : 1;
+    }
+}
+
+void VRGraphLayout::setNodePosition(int i, Vec3d p) {
+    auto po = graph->getPosition(i);
+    po->setPos(p);
+    graph->getNode(i).box.setCenter(p);
+    graph->setPosition(i, po);
+}
+
+void VRGraphLayout::buildCSR(vector<int>& nodeFlags) { // edges in both directions, grouped by node
+    int N = nodeFlags.size();
+    auto valid = [&](Graph::edge& e) {
+        if (e.from == e.to || e.from < 0 || e.to < 0 || e.from >= N || e.to >= N) return false;
+        return !(nodeFlags[e.from] & INACTIVE || nodeFlags[e.to] & INACTIVE);
+    };
+
+    csrOffsets.assign(N+1, 0);
+    for (auto& n : graph->getEdges()) {
+        for (auto& e : n) {
+            if (!valid(e)) continue;
+            csrOffsets[e.from+1]++;
+            csrOffsets[e.to+1]++;
+        }
+    }
+    for (int i=0; i<N; i++) csrOffsets[i+1] += csrOffsets[i];
+
+    csrNeighbors.resize(csrOffsets[N]);
+    csrSiblings.resize(csrOffsets[N]);
+    vector<int> pos(csrOffsets.begin(), csrOffsets.end()-1);
+    for (auto& n : graph->getEdges()) {
+        for (auto& e : n) {
+            if (!valid(e)) continue;
+            bool sibling = (e.connection == Graph::SIBLING);
+            csrNeighbors[pos[e.from]] = e.to;
+            csrSiblings[pos[e.from]++] = sibling;
+            csrNeighbors[pos[e.to]] = e.from;
+            csrSiblings[pos[e.to]++] = sibling;
+        }
+    }
+}
+
+float VRGraphLayout::applyForces() {
+    if (!graph) return 0;
+    vector<Vec3d> P;
+    vector<float> R, M;
+    vector<int> F;
+    readNodes(P, R, M, F);
+    buildCSR(F);
+    int N = P.size();
+
+    double K = radius > 0 ? radius : 1; // natural length scale
+    double C = repulsion*K*K*K;
+    if (stepLength <= 0) stepLength = speed*K;
+
+    VRBarnesHut bh;
+    bh.setSoftening(1e-3*K);
+    bh.build(P, M);
+
+    vector<Vec3d> forces(N);
+    double energy = 0;
+    #pragma omp parallel for schedule(dynamic, 256) reduction(+:energy)
+    for (int i=0; i<N; i++) {
+        if (F[i] & FIXED || F[i] & INACTIVE) continue;
+        Vec3d f = bh.field(P[i], i, theta)*C + gravity;
+        for (int k=csrOffsets[i]; k<csrOffsets[i+1]; k++) {
+            int j = csrNeighbors[k];
+            Vec3d d = P[j] - P[i];
+            double l = d.length();
+            double x = l - (radius + R[i] + R[j]); // displacement
+            if (csrSiblings[k] && x >= 0) continue; // siblings only push away
+            if (l > 0) f += d*(x/l);
+        }
+        forces[i] = f;
+        energy += f.squareLength();
+    }
+
+    // adaptive step length, grows after a series of improvements and shrinks otherwise
+    if (energy < lastEnergy) {
+        if (++progress >= 5) { progress = 0; stepLength /= 0.9; }
+    } else { progress = 0; stepLength *= 0.9; }
+    lastEnergy = energy;
+
+    float moved = 0;
+    for (int i=0; i<N; i++) {
+        double l = forces[i].length();
+        if (l == 0) continue;
+        double s = min(l, double(stepLength));
+        setNodePosition(i, P[i] + forces[i]*(s/l));
+        moved = max(moved, float(s));
+    }
+    return moved;
+}
+
+double VRGraphLayout::getEnergy(float t) {
+    if (!graph) return 0;
+    vector<Vec3d> P;
+    vector<float> R, M;
+    vector<int> F;
+    readNodes(P, R, M, F);
+    int N = P.size();
+    double K = radius > 0 ? radius : 1;
+    double C = repulsion*K*K*K;
+
+    double springs = 0;
+    for (auto& n : graph->getEdges()) {
+        for (auto& e : n) {
+            if (e.from == e.to || e.from < 0 || e.to < 0 || e.from >= N || e.to >= N) continue;
+            if (M[e.from] == 0 || M[e.to] == 0) continue;
+            double x = (P[e.to] - P[e.from]).length() - (radius + R[e.from] + R[e.to]);
+            if (e.connection == Graph::SIBLING && x >= 0) continue;
+            springs += 0.5*x*x;
+        }
+    }
+
+    VRBarnesHut bh;
+    bh.setSoftening(1e-3*K);
+    if (t > 0) bh.build(P, M);
+
+    double repulsions = 0;
+    double potential = 0;
+    #pragma omp parallel for reduction(+:repulsions,potential)
+    for (int i=0; i<N; i++) {
+        if (M[i] == 0) continue;
+        if (t > 0) repulsions += bh.potential(P[i], i, t);
+        else repulsions += VRBarnesHut::potentialExact(P, M, P[i], i, 1e-6*K*K);
+        potential -= gravity.dot(P[i]);
+    }
+
+    return springs + 0.5*C*repulsions + potential;
+}
+
+int VRGraphLayout::compute(int N, float eps) {
+    if (!graph) return 0;
+    int steps = 0;
+    while (steps < N) {
+        steps++;
+        float moved = -1; // only the force directed layout reports convergence
         for (auto a : algorithms) {
             switch(a.second) {
                 case SPRINGS:
@@ -120,12 +272,17 @@ void VRGraphLayout::compute(int N, float eps) {
                 case OCCUPANCYMAP:
                     applyOccupancy(eps, 0.5);
                     break;
+                case FORCES:
+                    moved = max(moved, applyForces());
+                    break;
             }
         }
+        if (moved >= 0 && moved < eps) break;
     }
 
     // update graph nodes a second time
     for (uint i=0; i<graph->getNodes().size(); i++) graph->update(i, false);
+    return steps;
 }
 
 void VRGraphLayout::setFlag(int i, FLAG f) {
@@ -152,9 +309,14 @@ void VRGraphLayout::setNodeState(int i, bool s) { if(!s) setFlag(i, INACTIVE); e
 void VRGraphLayout::setRadius(float r) { radius = r; }
 void VRGraphLayout::setSpeed(float s) { speed = s; }
 void VRGraphLayout::setGravity(Vec3d v) { gravity = v; }
+void VRGraphLayout::setTheta(float t) { theta = t; }
+void VRGraphLayout::setRepulsion(float r) { repulsion = r; }
 
 void VRGraphLayout::clear() {
     flags.clear();
+    stepLength = -1;
+    progress = 0;
+    lastEnergy = 1e30;
 }
 
 
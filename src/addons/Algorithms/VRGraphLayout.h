@@ -6,6 +6,7 @@
 
 #include <OpenSG/OSGVector.h>
 #include <map>
+#include <vector>
 
 OSG_BEGIN_NAMESPACE;
 using namespace std;
@@ -14,7 +15,8 @@ class VRGraphLayout {
     public:
         enum ALGORITHM {
             SPRINGS,
-            OCCUPANCYMAP
+            OCCUPANCYMAP,
+            FORCES // springs along the edges, Barnes-Hut repulsion between all nodes
         };
 
         enum FLAG {
@@ -30,9 +32,24 @@ class VRGraphLayout {
         Vec3d gravity;
         float radius = 1;
         float speed = 1;
+        float theta = 0.8;
+        float repulsion = 1;
+
+        // force directed layout state
+        float stepLength = -1;
+        int progress = 0;
+        double lastEnergy = 1e30;
+        vector<int> csrOffsets; // neighbors of node i are csrNeighbors[csrOffsets[i]..csrOffsets[i+1]]
+        vector<int> csrNeighbors;
+        vector<char> csrSiblings;
 
         void applySprings(float eps, float v);
         void applyOccupancy(float eps, float v);
+        float applyForces();
+
+        void buildCSR(vector<int>& nodeFlags);
+        void readNodes(vector<Vec3d>& positions, vector<float>& radii, vector<float>& masses, vector<int>& nodeFlags);
+        void setNodePosition(int i, Vec3d p);
 
         int getFlag(int i);
         void setFlag(int i, FLAG f);
@@ -50,11 +67,14 @@ class VRGraphLayout {
         void setAlgorithm(ALGORITHM a, int position = 0);
         void setAlgorithm(string a, int position = 0);
         void clearAlgorithms();
-        void compute(int N = 10, float eps = 0.1);
+        int compute(int N = 10, float eps = 0.1);
+        double getEnergy(float theta = 0);
 
         void setGravity(Vec3d v);
         void setRadius(float r);
         void setSpeed(float s);
+        void setTheta(float t);
+        void setRepulsion(float r);
         void fixNode(int i);
         void setNodeState(int i, bool state);
 };
@@ -8,10 +8,10 @@ simpleVRPyType(GraphLayout, New_ptr);
 
 PyMethodDef VRPyGraphLayout::methods[] = {
     {"setGraph", (PyCFunction)VRPyGraphLayout::setGraph, METH_VARARGS, "Set graph - setGraph(graph)" },
-    {"setAlgorithm", (PyCFunction)VRPyGraphLayout::setAlgorithm, METH_VARARGS, "Set pipeline algorithms - setAlgorithm( str algorithm, int position )\n\talgorithm: 'SPRINGS', 'OCCUPANCYMAP'" },
-    {"setParameters", (PyCFunction)VRPyGraphLayout::setParameters, METH_VARARGS, "Set parameters - setParameters( flt radius )" },
+    {"setAlgorithm", (PyCFunction)VRPyGraphLayout::setAlgorithm, METH_VARARGS, "Set pipeline algorithms - setAlgorithm( str algorithm, int position )\n\talgorithm: 'SPRINGS', 'OCCUPANCYMAP', 'FORCES'" },
+    {"setParameters", (PyCFunction)VRPyGraphLayout::setParameters, METH_VARARGS, "Set parameters - setParameters( flt radius, flt theta = 0.8, flt repulsion = 1 )\n\ttheta: Barnes-Hut accuracy of the FORCES algorithm, 0 is exact" },
     {"fixNode", (PyCFunction)VRPyGraphLayout::fixNode, METH_VARARGS, "Fix a node, making it static - fixNode( int n )" },
-    {"compute", (PyCFunction)VRPyGraphLayout::compute, METH_VARARGS, "Compute N steps - compute( int steps, float threshold )" },
+    {"compute", (PyCFunction)VRPyGraphLayout::compute, METH_VARARGS, "Compute up to N steps, returns the number of steps done - int compute( int steps, float threshold )\n\tthe FORCES algorithm stops when no node moves more than threshold" },
     {NULL}  /* Sentinel */
 };
 
@@ -35,8 +35,12 @@ PyObject* VRPyGraphLayout::setAlgorithm(VRPyGraphLayout* self, PyObject* args) {
 PyObject* VRPyGraphLayout::setParameters(VRPyGraphLayout* self, PyObject* args) {
     if (!self->valid()) return NULL;
     float r = 1;
-    if (!PyArg_ParseTuple(args, "f", &r)) return NULL;
+    float t = 0.8;
+    float c = 1;
+    if (!PyArg_ParseTuple(args, "f|ff", &r, &t, &c)) return NULL;
     self->objPtr->setRadius( r );
+    self->objPtr->setTheta( t );
+    self->objPtr->setRepulsion( c );
     Py_RETURN_TRUE;
 }
 
@@ -45,8 +49,7 @@ PyObject* VRPyGraphLayout::compute(VRPyGraphLayout* self, PyObject* args) {
     int N;
     float t = 0.1;
     if (!PyArg_ParseTuple(args, "i|f", &N, &t)) return NULL;
-    self->objPtr->compute( N, t );
-    Py_RETURN_TRUE;
+    return PyInt_FromLong( self->objPtr->compute( N, t ) );
 }
 
 PyObject* VRPyGraphLayout::fixNode(VRPyGraphLayout* self, PyObject* args) {
@@ -10,6 +10,7 @@ using namespace OSG;
 
 CarSound::CarSound() {
     sound = VRSound::create();
+    sound->setMixed(true); // the engine spectra play as a stream voice of the sound mixer
 }
 
 CarSound::~CarSound() {}
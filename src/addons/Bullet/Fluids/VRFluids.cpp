@@ -1,6 +1,7 @@
 #include "VRFluids.h"
 #include "../Particles/VRParticle.h"
 #include "../Particles/VRParticlesT.h"
+#include "VRSPHSolver.h"
 
 #include <cmath> // pow(), etc. needed for kernels
 #include <omp.h> // openMP for parallelization
@@ -44,6 +45,9 @@ void VRFluids::setFunctions(int from, int to) {
             fluidFkt = VRUpdateCb::create("sph_update", boost::bind(&VRFluids::updateSPH, this,from,to));
         } else if (this->simulation == XSPH) {
             fluidFkt = VRUpdateCb::create("xsph_update", boost::bind(&VRFluids::updateXSPH, this,from,to));
+        } else if (this->simulation == GRID_SPH) {
+            fluidFkt = VRUpdateCb::create("grid_sph_update", boost::bind(&VRFluids::updateGridSPH, this));
+            solverTimer.start();
         }
         scene->addPhysicsUpdateFunction(fluidFkt, this->afterBullet);
     }
@@ -61,6 +65,16 @@ void VRFluids::disableFunctions() {
 
 void VRFluids::updateParticles(int from, int to) {
     if (to < 0) to = N;
+    if (simulation == GRID_SPH && solver) {
+        BLock lock(mtx());
+        auto& X = solver->getX();
+        auto& Y = solver->getY();
+        auto& Z = solver->getZ();
+        int n = min(solver->size(), int(pos->size()));
+        for (int i=0; i<n; i++) pos->setValue(Pnt3f(X[i], Y[i], Z[i]), i);
+        return;
+    }
+
     {
         BLock lock(mtx());
         for (int i=from; i < to; i++) {
@@ -136,6 +150,108 @@ inline void VRFluids::updateSPH(int from, int to) {
     }
 }
 
+int VRFluids::spawnGridFluid(Vec3d min, Vec3d max, float spacing) {
+    if (!solver) solver = VRSPHSolver::create();
+    this->disableFunctions();
+
+    int n = 0;
+    {
+        BLock lock(mtx());
+        solver->clear();
+        solver->setKernelRadius(2*spacing);
+        n = solver->spawnCuboid(min, max, spacing);
+        solver->setBoundaryCallback( boost::bind(&VRFluids::collideWithBullet, this) );
+
+        // the geometry shows the solver particles, the bullet particles stay unspawned
+        GeoUInt32PropertyRecPtr Length = GeoUInt32Property::create();
+        GeoUInt32PropertyRecPtr inds = GeoUInt32Property::create();
+        Length->addValue(n);
+        pos->resize(n);
+        normals->resize(n);
+        colors->resize(n);
+        for (int i=0; i<n; i++) inds->addValue(i);
+        for (int i=0; i<n; i++) colors->setValue(Vec4d(0,0,1,1), i);
+        setLengths(Length);
+        setIndices(inds);
+    }
+
+    simulation = GRID_SPH;
+    setFunctions(0, n);
+    printf("VRFluids::spawnGridFluid(): %i particles\n", n);
+    return n;
+}
+
+VRSPHSolverPtr VRFluids::getSolver() { return solver; }
+
+void VRFluids::updateGridSPH() {
+    if (!solver) return;
+    BLock lock(mtx());
+    int ms = solverTimer.stop();
+    solverTimer.start();
+    solverImpulses.clear();
+    solver->update(ms*0.001);
+    for (auto i : solverImpulses) {
+        i.first->activate();
+        i.first->applyCentralImpulse(i.second);
+    }
+}
+
+/**
+ * Pushes solver particles out of the bounding boxes of bullet objects.
+ * Dynamic bodies receive the opposite impulse, applied once after all substeps.
+ */
+void VRFluids::collideWithBullet() {
+    if (!world || solver->size() == 0) return;
+    auto& X = solver->getX();
+    auto& Y = solver->getY();
+    auto& Z = solver->getZ();
+    Vec3d bmin(X[0],Y[0],Z[0]), bmax = bmin;
+    for (int i=1; i<solver->size(); i++) {
+        bmin = Vec3d(min(bmin[0],double(X[i])), min(bmin[1],double(Y[i])), min(bmin[2],double(Z[i])));
+        bmax = Vec3d(max(bmax[0],double(X[i])), max(bmax[1],double(Y[i])), max(bmax[2],double(Z[i])));
+    }
+
+    float m = solver->getMass();
+    auto& objs = world->getCollisionObjectArray();
+    for (int k=0; k<objs.size(); k++) {
+        btCollisionObject* o = objs[k];
+        if (o->getCollisionFlags() & btCollisionObject::CF_NO_CONTACT_RESPONSE) continue;
+        btVector3 b1, b2;
+        o->getCollisionShape()->getAabb(o->getWorldTransform(), b1, b2);
+        if (b1[0] > bmax[0] || b1[1] > bmax[1] || b1[2] > bmax[2]) continue;
+        if (b2[0] < bmin[0] || b2[1] < bmin[1] || b2[2] < bmin[2]) continue;
+
+        btRigidBody* body = btRigidBody::upcast(o);
+        bool dynamic = body && body->getInvMass() > 0;
+        btVector3 bv = dynamic ? body->getLinearVelocity() : btVector3(0,0,0);
+        btVector3 impulse(0,0,0);
+
+        for (int i : solver->getParticles(toVec3d(b1), toVec3d(b2))) {
+            Vec3d p = solver->getPosition(i);
+            Vec3d v = solver->getVelocity(i);
+            int axis = 0; // leave the box through the nearest face
+            float d = 1e9, side = 0;
+            for (int a=0; a<3; a++) {
+                if (p[a]-b1[a] < d) { d = p[a]-b1[a]; axis = a; side = -1; }
+                if (b2[a]-p[a] < d) { d = b2[a]-p[a]; axis = a; side = 1; }
+            }
+            p[axis] = side < 0 ? b1[axis] : b2[axis];
+            float vn = (v[axis]-bv[axis])*side;
+            if (vn < 0) {
+                v[axis] -= vn*side;
+                impulse[axis] += m*vn*side;
+            }
+            solver->setPosition(i, p);
+            solver->setVelocity(i, v);
+        }
+
+        if (dynamic && !impulse.isZero()) {
+            if (!solverImpulses.count(body)) solverImpulses[body] = btVector3(0,0,0);
+            solverImpulses[body] += impulse;
+        }
+    }
+}
+
 const float XSPH_CHAINING = 0.3; // binding strength between particles (XSPH)
 inline void VRFluids::updateXSPH(int from, int to) {
     SphParticle* p;
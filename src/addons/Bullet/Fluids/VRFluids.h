@@ -2,13 +2,15 @@
 #define VRFLUIDS_H_INCLUDED
 
 #include "../Particles/VRParticles.h"
+#include "../VRPhysicsFwd.h"
+#include "core/utils/VRTimer.h"
 
 OSG_BEGIN_NAMESPACE;
 
 class VRFluids : public VRParticles {
 
     public:
-        enum SimulationType { SPH, XSPH };
+        enum SimulationType { SPH, XSPH, GRID_SPH };
 
         VRFluids(string name, bool spawnParticles = true);
         ~VRFluids();
@@ -17,6 +19,10 @@ class VRFluids : public VRParticles {
         void updateParticles(int from, int to) override;
         void updateSPH(int from, int to);
         void updateXSPH(int from, int to);
+        void updateGridSPH();
+
+        int spawnGridFluid(Vec3d min, Vec3d max, float spacing);
+        VRSPHSolverPtr getSolver();
 
         void setSimulation(SimulationType t, bool forceChange=false);
         void setSphRadius(float newRadius);
@@ -30,6 +36,12 @@ class VRFluids : public VRParticles {
         VRUpdateCbPtr fluidFkt;
         SimulationType simulation = SPH;
 
+        /* GRID_SPH, particles live in the solver and only the boundaries are coupled to bullet */
+        VRSPHSolverPtr solver;
+        VRTimer solverTimer;
+        map<btRigidBody*, btVector3> solverImpulses;
+        void collideWithBullet();
+
         /* Calculate after bullets physics cycle? */
         const bool afterBullet = false;
         /*
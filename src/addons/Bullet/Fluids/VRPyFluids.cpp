@@ -2,6 +2,7 @@
 #include "core/scripting/VRPyGeometry.h"
 #include "core/scripting/VRPyMaterial.h"
 #include "core/scripting/VRPyBaseT.h"
+#include "VRSPHSolver.h"
 
 using namespace OSG;
 
@@ -10,7 +11,9 @@ simpleVRPyType(MetaBalls, New_VRObjects_ptr);
 
 PyMethodDef VRPyFluids::methods[] = {
     {"setRadius", (PyCFunction)VRPyFluids::setRadius, METH_VARARGS, "setRadius(float radius, float variation) \n\tsetRadius(0.05, 0.02)"},
-    {"setSimType", (PyCFunction)VRPyFluids::setSimType, METH_VARARGS, "setSimType(string type, bool forceUpdate=False) \n\tsetSimType('SPH', True) #or XSPH"},
+    {"setSimType", (PyCFunction)VRPyFluids::setSimType, METH_VARARGS, "setSimType(string type, bool forceUpdate=False) \n\tsetSimType('SPH', True) #or XSPH, GRID_SPH"},
+    {"spawnGridFluid", (PyCFunction)VRPyFluids::spawnGridFluid, METH_VARARGS, "spawnGridFluid(min, max, float spacing) - fill a box with particles of the grid SPH solver, returns the particle count \n\tspawnGridFluid([0,0,0], [0.4,0.6,0.3], 0.02)"},
+    {"setSolverDomain", (PyCFunction)VRPyFluids::setSolverDomain, METH_VARARGS, "setSolverDomain(min, max) - walls of the grid SPH solver"},
     {"setSphRadius", (PyCFunction)VRPyFluids::setSphRadius, METH_VARARGS, "setSphRadius(float radius)"},
     {"setMass", (PyCFunction)VRPyFluids::setMass, METH_VARARGS, "setMass(float mass, float variation)"},
     {"setMassByRadius", (PyCFunction)VRPyFluids::setMassByRadius, METH_VARARGS, "setMassByRadius(float massOfOneMeterRadius) \n\tsetMass(1000.0*100)"},
@@ -65,11 +68,30 @@ PyObject* VRPyFluids::setSimType(VRPyFluids* self, PyObject* args) {
 
     if (! PyArg_ParseTuple(args, "s#|b", &sim, &length, &update)) { Py_RETURN_FALSE; }
     if (strncmp(sim, "SPH", length)==0) simType = OSG::VRFluids::SPH;
+    if (strncmp(sim, "GRID_SPH", length)==0) simType = OSG::VRFluids::GRID_SPH;
     if (update > 0) force = true;
     self->objPtr->setSimulation(simType, force);
     Py_RETURN_TRUE;
 }
 
+PyObject* VRPyFluids::spawnGridFluid(VRPyFluids* self, PyObject* args) {
+    checkObj(self);
+    PyObject *v1, *v2; float spacing = 0.02;
+    if (! PyArg_ParseTuple(args, "OO|f", &v1, &v2, &spacing)) return NULL;
+    int n = self->objPtr->spawnGridFluid( parseVec3dList(v1), parseVec3dList(v2), spacing );
+    return PyInt_FromLong((long) n);
+}
+
+PyObject* VRPyFluids::setSolverDomain(VRPyFluids* self, PyObject* args) {
+    checkObj(self);
+    PyObject *v1, *v2;
+    if (! PyArg_ParseTuple(args, "OO", &v1, &v2)) return NULL;
+    auto solver = self->objPtr->getSolver();
+    if (!solver) { setErr("No grid fluid spawned, call spawnGridFluid first"); return NULL; }
+    solver->setDomain( parseVec3dList(v1), parseVec3dList(v2) );
+    Py_RETURN_TRUE;
+}
+
 PyObject* VRPyFluids::setSphRadius(VRPyFluids* self, PyObject* args) {
     checkObj(self);
     float radius;
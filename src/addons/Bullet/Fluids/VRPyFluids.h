@@ -18,6 +18,8 @@ struct VRPyFluids : VRPyBaseT<OSG::VRFluids> {
     static PyObject* setAmount(VRPyFluids* self, PyObject* args);
     static PyObject* setRadius(VRPyFluids* self, PyObject* args);
     static PyObject* setSimType(VRPyFluids* self, PyObject* args);
+    static PyObject* spawnGridFluid(VRPyFluids* self, PyObject* args);
+    static PyObject* setSolverDomain(VRPyFluids* self, PyObject* args);
     static PyObject* setSphRadius(VRPyFluids* self, PyObject* args);
     static PyObject* setMass(VRPyFluids* self, PyObject* args);
     static PyObject* setMassByRadius(VRPyFluids* self, PyObject* args);
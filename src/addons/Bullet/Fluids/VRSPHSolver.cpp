@@ -0,0 +1,369 @@
+#include "VRSPHSolver.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace OSG;
+
+VRSPHSolver::VRSPHSolver() { updateKernels(); }
+VRSPHSolver::~VRSPHSolver() {}
+
+VRSPHSolverPtr VRSPHSolver::create() { return VRSPHSolverPtr( new VRSPHSolver() ); }
+
+void VRSPHSolver::setKernelRadius(float r) { h = r; updateKernels(); }
+void VRSPHSolver::setMass(float m) { mass = m; }
+void VRSPHSolver::setRestDensity(float rho) { restDensity = rho; }
+void VRSPHSolver::setStiffness(float k) { stiffness = k; }
+void VRSPHSolver::setViscosity(float a) { viscosity = a; }
+void VRSPHSolver::setXSPH(float eps) { xsph = eps; }
+void VRSPHSolver::setRestitution(float r) { restitution = r; }
+void VRSPHSolver::setGravity(Vec3d g) { gravity = g; }
+void VRSPHSolver::setTimeStep(float t, int n) { dt = t; maxSubsteps = n; }
+void VRSPHSolver::setDomain(Vec3d min, Vec3d max) { domainMin = min; domainMax = max; useDomain = true; }
+void VRSPHSolver::setBoundaryCallback(function<void()> cb) { boundaryCb = cb; }
+
+float VRSPHSolver::getKernelRadius() { return h; }
+float VRSPHSolver::getMass() { return mass; }
+float VRSPHSolver::getRestDensity() { return restDensity; }
+float VRSPHSolver::getTimeStep() { return dt; }
+float VRSPHSolver::getParticleRadius() { return particleRadius; }
+
+int VRSPHSolver::size() { return px.size(); }
+long long VRSPHSolver::getSteps() { return steps; }
+int VRSPHSolver::getID(int i) { return ids[i]; }
+Vec3d VRSPHSolver::getPosition(int i) { return Vec3d(px[i], py[i], pz[i]); }
+Vec3d VRSPHSolver::getVelocity(int i) { return Vec3d(vx[i], vy[i], vz[i]); }
+void VRSPHSolver::setPosition(int i, Vec3d p) { px[i] = p[0]; py[i] = p[1]; pz[i] = p[2]; }
+void VRSPHSolver::setVelocity(int i, Vec3d v) { vx[i] = v[0]; vy[i] = v[1]; vz[i] = v[2]; }
+float VRSPHSolver::getDensity(int i) { return density[i]; }
+float VRSPHSolver::getPressure(int i) { return pressure[i]; }
+const vector<float>& VRSPHSolver::getX() { return px; }
+const vector<float>& VRSPHSolver::getY() { return py; }
+const vector<float>& VRSPHSolver::getZ() { return pz; }
+
+void VRSPHSolver::updateKernels() { // Müller et al. 2003
+    poly6 = 315.0 / (64.0*M_PI*pow(h,9));
+    spikyGrad = -45.0 / (M_PI*pow(h,6));
+}
+
+void VRSPHSolver::wallContribution(int i, float& rho, float* grad) {
+    // domain walls act like the particle lattice continued behind them,
+    // virtual particles lie on the lattice through particle i and on the mirrored layers behind the walls
+    float sp = particleRadius*2;
+    int K = ceil(h/sp);
+    float p[3] = { px[i], py[i], pz[i] };
+    float c[3][16];
+    bool outside[3][16];
+    int n[3] = {0,0,0};
+    bool nearWall = false;
+    for (int k=0; k<3; k++) {
+        float b1 = domainMin[k], b2 = domainMax[k];
+        for (int a=-K; a<=K && n[k] < 16; a++) { // lattice inside the domain
+            float y = p[k] + a*sp;
+            if (y < b1 || y > b2) continue;
+            c[k][n[k]] = y; outside[k][n[k]++] = false;
+        }
+        for (float y = b1-sp*0.5; y > p[k]-h && n[k] < 16; y -= sp) { c[k][n[k]] = y; outside[k][n[k]++] = true; nearWall = true; }
+        for (float y = b2+sp*0.5; y < p[k]+h && n[k] < 16; y += sp) { c[k][n[k]] = y; outside[k][n[k]++] = true; nearWall = true; }
+    }
+    if (!nearWall) return;
+
+    float h2 = h*h;
+    float r0 = 0;
+    float g[3] = {0,0,0};
+    for (int a=0; a<n[0]; a++) {
+        for (int b=0; b<n[1]; b++) {
+            for (int d=0; d<n[2]; d++) {
+                if (!outside[0][a] && !outside[1][b] && !outside[2][d]) continue;
+                float dx = p[0]-c[0][a], dy = p[1]-c[1][b], dz = p[2]-c[2][d];
+                float r2 = dx*dx+dy*dy+dz*dz;
+                if (r2 >= h2 || r2 == 0) continue;
+                float e = h2-r2;
+                r0 += e*e*e;
+                if (!grad) continue;
+                float r = sqrt(r2);
+                float f = (h-r)*(h-r)/r;
+                g[0] += f*dx; g[1] += f*dy; g[2] += f*dz;
+            }
+        }
+    }
+    rho += mass*poly6*r0;
+    if (grad) for (int k=0; k<3; k++) grad[k] += g[k];
+}
+
+int VRSPHSolver::addParticle(Vec3d p, Vec3d v) {
+    px.push_back(p[0]); py.push_back(p[1]); pz.push_back(p[2]);
+    vx.push_back(v[0]); vy.push_back(v[1]); vz.push_back(v[2]);
+    ids.push_back(ids.size());
+    return ids.size()-1;
+}
+
+int VRSPHSolver::spawnCuboid(Vec3d min, Vec3d max, float s) {
+    if (s <= 0) return 0;
+    particleRadius = s*0.5;
+
+    // particle mass such that the lattice is at rest density
+    int K = ceil(h/s);
+    double W = 0;
+    for (int i=-K; i<=K; i++) for (int j=-K; j<=K; j++) for (int k=-K; k<=K; k++) {
+        double r2 = (i*i+j*j+k*k)*s*s;
+        if (r2 < h*h) W += poly6*pow(h*h-r2, 3);
+    }
+    mass = restDensity / W;
+
+    int nx = floor((max[0]-min[0])/s + 1e-3);
+    int ny = floor((max[1]-min[1])/s + 1e-3);
+    int nz = floor((max[2]-min[2])/s + 1e-3);
+    for (int i=0; i<nx; i++) {
+        for (int j=0; j<ny; j++) {
+            for (int k=0; k<nz; k++) addParticle( min + Vec3d(i+0.5, j+0.5, k+0.5)*s );
+        }
+    }
+    return nx*ny*nz;
+}
+
+void VRSPHSolver::clear() {
+    px.clear(); py.clear(); pz.clear();
+    vx.clear(); vy.clear(); vz.clear();
+    ax.clear(); ay.clear(); az.clear();
+    density.clear(); pressure.clear();
+    ids.clear();
+    accumulator = 0;
+}
+
+unsigned int VRSPHSolver::bucket(int x, int y, int z) {
+    return ( (unsigned int)(x)*73856093u ^ (unsigned int)(y)*19349663u ^ (unsigned int)(z)*83492791u ) & tableMask;
+}
+
+int VRSPHSolver::neighborBuckets(int i, int* res) { // distinct buckets of the 27 surrounding cells
+    int cx = floor(px[i]/h);
+    int cy = floor(py[i]/h);
+    int cz = floor(pz[i]/h);
+    int n = 0;
+    for (int x=cx-1; x<=cx+1; x++) {
+        for (int y=cy-1; y<=cy+1; y++) {
+            for (int z=cz-1; z<=cz+1; z++) {
+                int b = bucket(x,y,z);
+                bool known = false;
+                for (int k=0; k<n; k++) if (res[k] == b) { known = true; break; }
+                if (!known) res[n++] = b;
+            }
+        }
+    }
+    return n;
+}
+
+void VRSPHSolver::sortParticles() {
+    int N = px.size();
+    unsigned int T = 64;
+    while (T < 2*(unsigned int)N) T *= 2;
+    tableMask = T-1;
+
+    buckets.resize(N);
+    #pragma omp parallel for
+    for (int i=0; i<N; i++) buckets[i] = bucket(floor(px[i]/h), floor(py[i]/h), floor(pz[i]/h));
+
+    bucketStart.assign(T+1, 0);
+    for (int i=0; i<N; i++) bucketStart[buckets[i]+1]++;
+    for (unsigned int b=0; b<T; b++) bucketStart[b+1] += bucketStart[b];
+
+    perm.resize(N);
+    vector<int> pos(bucketStart.begin(), bucketStart.end()-1);
+    for (int i=0; i<N; i++) perm[pos[buckets[i]]++] = i;
+
+    // reorder particle data, neighbours end up close in memory
+    tmp.resize(N);
+    for (auto v : {&px, &py, &pz, &vx, &vy, &vz}) {
+        auto& a = *v;
+        #pragma omp parallel for
+        for (int k=0; k<N; k++) tmp[k] = a[perm[k]];
+        a.swap(tmp);
+    }
+    tmpi.resize(N);
+    #pragma omp parallel for
+    for (int k=0; k<N; k++) tmpi[k] = ids[perm[k]];
+    ids.swap(tmpi);
+}
+
+void VRSPHSolver::computeDensities() {
+    int N = px.size();
+    density.resize(N);
+    pressure.resize(N);
+    float h2 = h*h;
+
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int i=0; i<N; i++) {
+        int nb[27];
+        int Nb = neighborBuckets(i, nb);
+        float rho = 0;
+        for (int k=0; k<Nb; k++) {
+            for (int j=bucketStart[nb[k]]; j<bucketStart[nb[k]+1]; j++) {
+                float dx = px[i]-px[j], dy = py[i]-py[j], dz = pz[i]-pz[j];
+                float r2 = dx*dx+dy*dy+dz*dz;
+                if (r2 >= h2) continue;
+                float d = h2-r2;
+                rho += d*d*d;
+            }
+        }
+        density[i] = mass*poly6*rho;
+        if (useDomain) wallContribution(i, density[i], 0);
+        float r = density[i]/restDensity; // Tait equation, no tensile forces
+        float r7 = r*r*r*r*r*r*r;
+        pressure[i] = max(0.f, restDensity*stiffness/7 * (r7-1));
+    }
+}
+
+void VRSPHSolver::computeForces() {
+    int N = px.size();
+    ax.resize(N);
+    ay.resize(N);
+    az.resize(N);
+    float h2 = h*h;
+    float gx = gravity[0], gy = gravity[1], gz = gravity[2];
+
+    float c = sqrt(stiffness); // speed of sound
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int i=0; i<N; i++) {
+        int nb[27];
+        int Nb = neighborBuckets(i, nb);
+        float Pi = pressure[i]/(density[i]*density[i]);
+        float fx = 0, fy = 0, fz = 0;
+        for (int k=0; k<Nb; k++) {
+            for (int j=bucketStart[nb[k]]; j<bucketStart[nb[k]+1]; j++) {
+                if (j == i) continue;
+                float dx = px[i]-px[j], dy = py[i]-py[j], dz = pz[i]-pz[j];
+                float r2 = dx*dx+dy*dy+dz*dz;
+                if (r2 >= h2 || r2 == 0) continue;
+                float r = sqrt(r2);
+                float d = h-r;
+                float f = Pi + pressure[j]/(density[j]*density[j]);
+
+                // artificial viscosity for approaching particles, Monaghan 1992
+                float vr = (vx[i]-vx[j])*dx + (vy[i]-vy[j])*dy + (vz[i]-vz[j])*dz;
+                if (vr < 0) f += -2*viscosity*h*c/(density[i]+density[j]) * vr/(r2 + 0.01*h2);
+
+                f *= -spikyGrad*d*d/r;
+                fx += f*dx; fy += f*dy; fz += f*dz;
+            }
+        }
+        float a[3] = { mass*fx + gx, mass*fy + gy, mass*fz + gz };
+        if (useDomain) { // virtual particles at rest density with the same pressure
+            float rho = 0;
+            float g[3] = {0,0,0};
+            wallContribution(i, rho, g);
+            float w = -mass*(Pi + pressure[i]/(restDensity*restDensity))*spikyGrad;
+            for (int k=0; k<3; k++) a[k] += w*g[k];
+        }
+        ax[i] = a[0];
+        ay[i] = a[1];
+        az[i] = a[2];
+    }
+}
+
+void VRSPHSolver::integrate() {
+    int N = px.size();
+    float h2 = h*h;
+
+    #pragma omp parallel for
+    for (int i=0; i<N; i++) {
+        vx[i] += ax[i]*dt;
+        vy[i] += ay[i]*dt;
+        vz[i] += az[i]*dt;
+    }
+
+    // positions move with the XSPH smoothed velocity
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int i=0; i<N; i++) {
+        int nb[27];
+        int Nb = neighborBuckets(i, nb);
+        float sx = 0, sy = 0, sz = 0;
+        for (int k=0; k<Nb; k++) {
+            for (int j=bucketStart[nb[k]]; j<bucketStart[nb[k]+1]; j++) {
+                float dx = px[i]-px[j], dy = py[i]-py[j], dz = pz[i]-pz[j];
+                float r2 = dx*dx+dy*dy+dz*dz;
+                if (r2 >= h2 || j == i) continue;
+                float d = h2-r2;
+                float w = 2*d*d*d / (density[i]+density[j]);
+                sx += w*(vx[j]-vx[i]); sy += w*(vy[j]-vy[i]); sz += w*(vz[j]-vz[i]);
+            }
+        }
+        float e = xsph*mass*poly6;
+        ax[i] = vx[i] + e*sx; // reuse the acceleration buffer
+        ay[i] = vy[i] + e*sy;
+        az[i] = vz[i] + e*sz;
+    }
+
+    #pragma omp parallel for
+    for (int i=0; i<N; i++) {
+        px[i] += ax[i]*dt;
+        py[i] += ay[i]*dt;
+        pz[i] += az[i]*dt;
+    }
+}
+
+void VRSPHSolver::applyDomain() {
+    if (!useDomain) return;
+    int N = px.size();
+    float r = particleRadius*0.5; // the wall pressure keeps particles away, this is only a safeguard
+    float b1[3] = { float(domainMin[0]+r), float(domainMin[1]+r), float(domainMin[2]+r) };
+    float b2[3] = { float(domainMax[0]-r), float(domainMax[1]-r), float(domainMax[2]-r) };
+
+    auto clamp = [&](float& x, float& v, int k) {
+        if (x < b1[k]) { x = b1[k]; if (v < 0) v *= -restitution; }
+        if (x > b2[k]) { x = b2[k]; if (v > 0) v *= -restitution; }
+    };
+
+    #pragma omp parallel for
+    for (int i=0; i<N; i++) {
+        clamp(px[i], vx[i], 0);
+        clamp(py[i], vy[i], 1);
+        clamp(pz[i], vz[i], 2);
+    }
+}
+
+void VRSPHSolver::step() {
+    if (px.size() == 0) return;
+    sortParticles();
+    computeDensities();
+    computeForces();
+    integrate();
+    applyDomain();
+    if (boundaryCb) boundaryCb();
+    steps++;
+}
+
+int VRSPHSolver::update(double elapsed) {
+    accumulator += elapsed;
+    int n = 0;
+    while (accumulator >= dt && n < maxSubsteps) {
+        step();
+        accumulator -= dt;
+        n++;
+    }
+    if (n == maxSubsteps) accumulator = 0; // drop time we cannot catch up with
+    return n;
+}
+
+float VRSPHSolver::getMaxSpeed() {
+    float v2 = 0;
+    for (unsigned int i=0; i<vx.size(); i++) v2 = max(v2, vx[i]*vx[i]+vy[i]*vy[i]+vz[i]*vz[i]);
+    return sqrt(v2);
+}
+
+float VRSPHSolver::getAverageDensity() {
+    if (density.size() == 0) return 0;
+    double d = 0;
+    for (auto r : density) d += r;
+    return d/density.size();
+}
+
+vector<int> VRSPHSolver::getParticles(Vec3d min, Vec3d max) {
+    vector<int> res;
+    for (unsigned int i=0; i<px.size(); i++) {
+        if (px[i] < min[0] || px[i] > max[0]) continue;
+        if (py[i] < min[1] || py[i] > max[1]) continue;
+        if (pz[i] < min[2] || pz[i] > max[2]) continue;
+        res.push_back(i);
+    }
+    return res;
+}
@@ -0,0 +1,121 @@
+#ifndef VRSPHSOLVER_H_INCLUDED
+#define VRSPHSOLVER_H_INCLUDED
+
+#include <OpenSG/OSGVector.h>
+#include <vector>
+#include <functional>
+#include "addons/Bullet/VRPhysicsFwd.h"
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Standalone SPH fluid solver, weakly compressible (Tait equation, stiffness is the squared speed of sound)
+    with Müller kernels, Monaghan artificial viscosity and XSPH velocity smoothing.
+    Particle data is stored as structure of arrays and reordered every step by a counting sort into the
+    buckets of a hashed uniform grid with cell size h, neighbours are found in the 27 surrounding cells.
+    The simulation advances in fixed time steps, update(dt) runs as many substeps as the elapsed time needs.
+    Walls of the domain box are handled by the solver, other boundaries through the boundary callback.
+*/
+
+class VRSPHSolver {
+    private:
+        // particle data, sorted by grid bucket
+        vector<float> px, py, pz;
+        vector<float> vx, vy, vz;
+        vector<float> ax, ay, az;
+        vector<float> density, pressure;
+        vector<int> ids;
+
+        // grid
+        vector<int> buckets; // per particle
+        vector<int> bucketStart; // first particle of each bucket, size is table size + 1
+        vector<int> perm;
+        vector<float> tmp;
+        vector<int> tmpi;
+        unsigned int tableMask = 0;
+
+        float h = 0.1;
+        float mass = 1;
+        float restDensity = 1000;
+        float stiffness = 1000;
+        float viscosity = 0.2; // artificial viscosity alpha
+        float xsph = 0.3;
+        float restitution = 0.2;
+        float particleRadius = 0.025;
+        Vec3d gravity = Vec3d(0,-9.81,0);
+
+        float dt = 0.001;
+        int maxSubsteps = 40;
+        double accumulator = 0;
+        long long steps = 0;
+
+        bool useDomain = false;
+        Vec3d domainMin, domainMax;
+        function<void()> boundaryCb;
+
+        // kernel constants
+        float poly6 = 0;
+        float spikyGrad = 0;
+
+        void updateKernels();
+        void wallContribution(int i, float& rho, float* grad);
+        unsigned int bucket(int x, int y, int z);
+        int neighborBuckets(int i, int* res);
+        void sortParticles();
+        void computeDensities();
+        void computeForces();
+        void integrate();
+        void applyDomain();
+
+    public:
+        VRSPHSolver();
+        ~VRSPHSolver();
+        static VRSPHSolverPtr create();
+
+        void setKernelRadius(float h);
+        void setMass(float m);
+        void setRestDensity(float rho);
+        void setStiffness(float k);
+        void setViscosity(float alpha);
+        void setXSPH(float eps);
+        void setRestitution(float r);
+        void setGravity(Vec3d g);
+        void setTimeStep(float dt, int maxSubsteps = 40);
+        void setDomain(Vec3d min, Vec3d max);
+        void setBoundaryCallback(function<void()> cb);
+
+        float getKernelRadius();
+        float getMass();
+        float getRestDensity();
+        float getTimeStep();
+        float getParticleRadius();
+
+        int addParticle(Vec3d p, Vec3d v = Vec3d());
+        int spawnCuboid(Vec3d min, Vec3d max, float spacing);
+        void clear();
+
+        int update(double elapsed);
+        void step();
+
+        int size();
+        long long getSteps();
+        int getID(int i);
+        Vec3d getPosition(int i);
+        Vec3d getVelocity(int i);
+        void setPosition(int i, Vec3d p);
+        void setVelocity(int i, Vec3d v);
+        float getDensity(int i);
+        float getPressure(int i);
+        const vector<float>& getX();
+        const vector<float>& getY();
+        const vector<float>& getZ();
+
+        float getMaxSpeed();
+        float getAverageDensity();
+        vector<int> getParticles(Vec3d min, Vec3d max);
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRSPHSOLVER_H_INCLUDED
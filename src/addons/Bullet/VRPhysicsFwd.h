@@ -7,6 +7,7 @@ namespace OSG {
     ptrFwd(CarSound);
     ptrFwd(VRCarDynamics);
     ptrFwd(VRDriver);
+    ptrFwd(VRSPHSolver);
 }
 
 #endif // VRPHYSICSFWD_H_INCLUDED
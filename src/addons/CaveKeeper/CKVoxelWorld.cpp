@@ -0,0 +1,294 @@
+#include "CKVoxelWorld.h"
+
+#include <cmath>
+
+OSG_BEGIN_NAMESPACE
+using namespace std;
+
+CKVoxelWorld::CKVoxelWorld() {}
+CKVoxelWorld::~CKVoxelWorld() {}
+
+CKVoxelWorldPtr CKVoxelWorld::create() { return CKVoxelWorldPtr( new CKVoxelWorld() ); }
+
+long long CKVoxelWorld::key(int cx, int cy, int cz) {
+    const long long m = (1<<21)-1;
+    return ((cx & m) << 42) | ((cy & m) << 21) | (cz & m);
+}
+
+Vec3i CKVoxelWorld::getChunkCoords(long long k) {
+    int c[3];
+    for (int i=0; i<3; i++) {
+        c[i] = (k >> (42-21*i)) & ((1<<21)-1);
+        if (c[i] & (1<<20)) c[i] -= 1<<21;
+    }
+    return Vec3i(c[0], c[1], c[2]);
+}
+
+long long CKVoxelWorld::getChunkKey(Vec3i c) { return key(c[0], c[1], c[2]); }
+
+int CKVoxelWorld::floorDiv(int a) { return a >= 0 ? a/S : -((-a-1)/S) - 1; }
+
+const CKVoxelWorld::Chunk* CKVoxelWorld::getChunk(long long k) const {
+    auto c = chunks.find(k);
+    return c == chunks.end() ? 0 : &c->second;
+}
+
+void CKVoxelWorld::markDirty(Vec3i p) { // faces on the chunk border belong to both chunks
+    int c[3], l[3];
+    for (int i=0; i<3; i++) {
+        c[i] = floorDiv(p[i]);
+        l[i] = p[i] - c[i]*S;
+    }
+    dirty.insert(key(c[0], c[1], c[2]));
+    for (int i=0; i<3; i++) {
+        int n[3] = { c[0], c[1], c[2] };
+        if (l[i] == 0) { n[i]--; dirty.insert(key(n[0], n[1], n[2])); }
+        if (l[i] == S-1) { n[i]++; dirty.insert(key(n[0], n[1], n[2])); }
+    }
+}
+
+void CKVoxelWorld::setBlock(Vec3i p, unsigned char type) {
+    int cx = floorDiv(p[0]), cy = floorDiv(p[1]), cz = floorDiv(p[2]);
+    long long k = key(cx, cy, cz);
+    auto it = chunks.find(k);
+    if (it == chunks.end()) {
+        if (type == 0) return;
+        it = chunks.insert(make_pair(k, Chunk())).first;
+    }
+
+    Chunk& c = it->second;
+    unsigned char& b = c.blocks[(p[0]-cx*S) + S*((p[1]-cy*S) + S*(p[2]-cz*S))];
+    if (b == type) return;
+    if (b == 0) c.count++;
+    if (type == 0) c.count--;
+    b = type;
+    if (c.count == 0) chunks.erase(it);
+    markDirty(p);
+}
+
+unsigned char CKVoxelWorld::getBlock(Vec3i p) const {
+    int cx = floorDiv(p[0]), cy = floorDiv(p[1]), cz = floorDiv(p[2]);
+    const Chunk* c = getChunk(key(cx, cy, cz));
+    if (!c) return 0;
+    return c->blocks[(p[0]-cx*S) + S*((p[1]-cy*S) + S*(p[2]-cz*S))];
+}
+
+int CKVoxelWorld::dig(Vec3i center, float radius) {
+    int n = 0;
+    int r = ceil(radius);
+    for (int i=-r; i<=r; i++) {
+        for (int j=-r; j<=r; j++) {
+            for (int k=-r; k<=r; k++) {
+                if (i*i+j*j+k*k > radius*radius) continue;
+                Vec3i p = center + Vec3i(i,j,k);
+                if (getBlock(p) == 0) continue;
+                setBlock(p, 0);
+                n++;
+            }
+        }
+    }
+    return n;
+}
+
+int CKVoxelWorld::fill(Vec3i center, float radius, unsigned char type) {
+    int n = 0;
+    int r = ceil(radius);
+    for (int i=-r; i<=r; i++) {
+        for (int j=-r; j<=r; j++) {
+            for (int k=-r; k<=r; k++) {
+                if (i*i+j*j+k*k > radius*radius) continue;
+                Vec3i p = center + Vec3i(i,j,k);
+                if (getBlock(p) == type) continue;
+                setBlock(p, type);
+                n++;
+            }
+        }
+    }
+    return n;
+}
+
+void CKVoxelWorld::clear() {
+    for (auto& c : chunks) dirty.insert(c.first);
+    chunks.clear();
+}
+
+void CKVoxelWorld::addLight(Vec3f p) { // the chunks with blocks in reach of the light are meshed again
+    lights.push_back(p);
+    for (auto& c : chunks) {
+        Vec3i co = getChunkCoords(c.first);
+        float D2 = 0;
+        for (int i=0; i<3; i++) {
+            float a = co[i]*S - 0.5, b = a + S;
+            float d = p[i] < a ? a-p[i] : p[i] > b ? p[i]-b : 0;
+            D2 += d*d;
+        }
+        if (D2 <= lightRadius*lightRadius) dirty.insert(c.first);
+    }
+}
+
+int CKVoxelWorld::getChunkCount() { return chunks.size(); }
+
+size_t CKVoxelWorld::getBlockCount() {
+    size_t n = 0;
+    for (auto& c : chunks) n += c.second.count;
+    return n;
+}
+
+bool CKVoxelWorld::hasDirtyChunks() { return dirty.size() > 0; }
+vector<long long> CKVoxelWorld::getDirtyChunks() { return vector<long long>(dirty.begin(), dirty.end()); }
+
+CKVoxelWorldPtr CKVoxelWorld::extractDirty() { // the faces of a chunk depend on its six face neighbours
+    auto w = create();
+    w->lights = lights;
+    w->lightRadius = lightRadius;
+    w->ambient = ambient;
+    for (auto k : dirty) {
+        Vec3i c = getChunkCoords(k);
+        for (int i=0; i<7; i++) {
+            Vec3i n = c;
+            if (i > 0) n[(i-1)/2] += i%2 ? 1 : -1;
+            long long nk = getChunkKey(n);
+            auto it = chunks.find(nk);
+            if (it != chunks.end()) w->chunks.insert(*it);
+        }
+    }
+    w->dirty.swap(dirty);
+    return w;
+}
+
+void CKVoxelWorld::meshChunk(long long k, Mesh& mesh, bool greedy) const {
+    mesh = Mesh();
+    const Chunk* c = getChunk(k);
+    if (!c) return;
+    Vec3i co = getChunkCoords(k);
+    int base[3] = { co[0]*S, co[1]*S, co[2]*S };
+
+    auto block = [&](int x, int y, int z) -> unsigned char {
+        if (x >= 0 && x < S && y >= 0 && y < S && z >= 0 && z < S) return c->blocks[x + S*(y + S*z)];
+        return getBlock(Vec3i(base[0]+x, base[1]+y, base[2]+z));
+    };
+
+    vector<Vec3f> near; // lanterns in reach of blocks of this chunk
+    Vec3f mid(base[0]+0.5*S-0.5, base[1]+0.5*S-0.5, base[2]+0.5*S-0.5);
+    for (auto& l : lights) if ((l-mid).length() <= lightRadius + 0.87*S) near.push_back(l);
+
+    auto quantize = [](float L) { return floor(L*64+0.5)/64; }; // faces with the same light are merged
+
+    auto light = [&](Vec3f b, Vec3f P, Vec3f n) { // like CKOctree::element::updateLightning, the brightest lantern counts
+        float L = ambient;
+        for (auto& l : near) {
+            if ((l-b).length() > lightRadius) continue;
+            Vec3f v = l - P;
+            float d = v.length();
+            float cs = d > 0 ? v.dot(n)/d : 1;
+            if (cs <= 0) continue;
+            L = max(L, min(0.1f + 2*cs/(0.5f+d), 2.0f));
+        }
+        return quantize(L);
+    };
+
+    auto center = [&](int d, int s, int i, int j) {
+        int u = (d+1)%3, v = (d+2)%3;
+        Vec3f c;
+        c[d] = base[d] + s;
+        c[u] = base[u] + i;
+        c[v] = base[v] + j;
+        return c;
+    };
+
+    auto corner = [&](int d, int dir, int s, int i, int j) {
+        int u = (d+1)%3, v = (d+2)%3;
+        Vec3f c;
+        c[d] = base[d] + s + 0.5*dir;
+        c[u] = base[u] + i - 0.5;
+        c[v] = base[v] + j - 0.5;
+        return c;
+    };
+
+    auto quad = [&](int d, int dir, int s, int i, int j, int w, int h, float shade) {
+        int U[4] = { 0, w, w, 0 };
+        int V[4] = { 0, 0, h, h };
+        if (dir < 0) { swap(U[1], U[3]); swap(V[1], V[3]); } // keep the faces ccw from outside
+        int n = mesh.positions.size();
+        Vec3f N;
+        N[d] = dir;
+        for (int q=0; q<4; q++) {
+            Vec3f P = corner(d, dir, s, i+U[q], j+V[q]);
+            float L = shade >= 0 ? shade : light(center(d, s, i, j), P, N); // unmerged face with varying light
+            mesh.positions.push_back(P);
+            mesh.normals.push_back(N);
+            mesh.texCoords.push_back(Vec2f(U[q], V[q]));
+            mesh.colors.push_back(Vec3f(L, L, L));
+        }
+        int I[6] = { n, n+1, n+2, n, n+2, n+3 };
+        mesh.indices.insert(mesh.indices.end(), I, I+6);
+    };
+
+    vector<unsigned char> mask(S*S);
+    vector<float> shades(S*S); // light of the face if equal at all corners, else -1
+    for (int d=0; d<3; d++) {
+        int u = (d+1)%3, v = (d+2)%3;
+        for (int dir=-1; dir<=1; dir+=2) {
+            Vec3f N;
+            N[d] = dir;
+            for (int s=0; s<S; s++) {
+
+                // visible faces of this slice
+                for (int j=0; j<S; j++) {
+                    for (int i=0; i<S; i++) {
+                        int p[3];
+                        p[d] = s; p[u] = i; p[v] = j;
+                        unsigned char t = block(p[0], p[1], p[2]);
+                        if (t) {
+                            p[d] += dir;
+                            if (block(p[0], p[1], p[2])) t = 0;
+                        }
+                        mask[i+j*S] = t;
+
+                        float shade = quantize(ambient);
+                        if (t && near.size()) {
+                            Vec3f b = center(d, s, i, j);
+                            float L[4];
+                            for (int q=0; q<4; q++) L[q] = light(b, corner(d, dir, s, i+q%2, j+q/2), N);
+                            shade = L[0] == L[1] && L[0] == L[2] && L[0] == L[3] ? L[0] : -1;
+                        }
+                        shades[i+j*S] = shade;
+                    }
+                }
+
+                // merge faces of the same type and the same light into rectangles
+                for (int j=0; j<S; j++) {
+                    for (int i=0; i<S;) {
+                        unsigned char t = mask[i+j*S];
+                        if (t == 0) { i++; continue; }
+                        float shade = shades[i+j*S];
+                        auto same = [&](int k) { return mask[k] == t && shades[k] == shade; };
+                        int w = 1, h = 1;
+                        if (greedy && shade >= 0) {
+                            while (i+w < S && same(i+w+j*S)) w++;
+                            for (; j+h < S; h++) {
+                                bool row = true;
+                                for (int a=0; a<w && row; a++) row = same(i+a+(j+h)*S);
+                                if (!row) break;
+                            }
+                        }
+                        for (int b=0; b<h; b++) for (int a=0; a<w; a++) mask[i+a+(j+b)*S] = 0;
+                        quad(d, dir, s, i, j, w, h, shade);
+                        i += w;
+                    }
+                }
+            }
+        }
+    }
+}
+
+vector<long long> CKVoxelWorld::remesh(vector<Mesh>& meshes) {
+    vector<long long> keys = getDirtyChunks();
+    meshes.resize(keys.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (unsigned int i=0; i<keys.size(); i++) meshChunk(keys[i], meshes[i]);
+    dirty.clear();
+    return keys;
+}
+
+OSG_END_NAMESPACE
@@ -0,0 +1,81 @@
+#ifndef CKVOXELWORLD_H_INCLUDED
+#define CKVOXELWORLD_H_INCLUDED
+
+#include <OpenSG/OSGVector.h>
+#include <unordered_map>
+#include <vector>
+#include <set>
+#include "core/utils/VRFwdDeclTemplate.h"
+
+OSG_BEGIN_NAMESPACE
+using namespace std;
+
+ptrFwd(CKVoxelWorld);
+
+/**
+    Block storage for the cave world, blocks are bytes (0 is air) in chunks of 32^3 kept in a hash map.
+    Changes mark the affected chunks dirty, dirty chunks are meshed again with greedy face merging,
+    coplanar faces of the same block type and the same light are merged into rectangles.
+    The lanterns light the face corners like the vertex lights of the CKOctree, the light is stored in the vertex colors.
+    Meshing can run on a snapshot of the dirty chunks and their neighbours while the world is changed further.
+    The block at p fills the cube p +- 0.5, like the cubes of the CKOctree.
+*/
+
+class CKVoxelWorld {
+    public:
+        static const int S = 32;
+
+        struct Mesh { // triangles
+            vector<Vec3f> positions;
+            vector<Vec3f> normals;
+            vector<Vec2f> texCoords;
+            vector<Vec3f> colors; // light
+            vector<int> indices;
+        };
+
+    private:
+        struct Chunk {
+            vector<unsigned char> blocks;
+            int count = 0;
+            Chunk() : blocks(S*S*S, 0) {}
+        };
+
+        unordered_map<long long, Chunk> chunks;
+        set<long long> dirty;
+        vector<Vec3f> lights;
+        float lightRadius = 10;
+        float ambient = 0.2;
+
+        static long long key(int cx, int cy, int cz);
+        static int floorDiv(int a);
+        const Chunk* getChunk(long long k) const;
+        void markDirty(Vec3i p);
+
+    public:
+        CKVoxelWorld();
+        ~CKVoxelWorld();
+        static CKVoxelWorldPtr create();
+
+        static Vec3i getChunkCoords(long long key);
+        static long long getChunkKey(Vec3i chunk);
+
+        void setBlock(Vec3i p, unsigned char type);
+        unsigned char getBlock(Vec3i p) const;
+        int dig(Vec3i center, float radius);
+        int fill(Vec3i center, float radius, unsigned char type = 1);
+        void clear();
+        void addLight(Vec3f p);
+
+        int getChunkCount();
+        size_t getBlockCount();
+
+        bool hasDirtyChunks();
+        vector<long long> getDirtyChunks();
+        CKVoxelWorldPtr extractDirty(); // copy of the dirty chunks for meshing in another thread, they are no longer dirty here
+        void meshChunk(long long key, Mesh& mesh, bool greedy = true) const;
+        vector<long long> remesh(vector<Mesh>& meshes);
+};
+
+OSG_END_NAMESPACE
+
+#endif // CKVOXELWORLD_H_INCLUDED
@@ -5,6 +5,7 @@
 #include <OpenSG/OSGGeometry.h>
 #include <OpenSG/OSGGeoProperties.h>
 #include <OpenSG/OSGSimpleMaterial.h>
+#include <boost/thread/thread.hpp>
 
 #include "core/scene/VRSceneManager.h"
 #include "core/scene/VRScene.h"
@@ -56,28 +57,14 @@ VRMaterialPtr BlockWorld::initMaterial(string texture) {
 
     string wdir = VRSceneManager::get()->getOriginalWorkdir();
 
-    //simple material
+    //simple material, the light of the lanterns comes with the vertex colors
     VRMaterialPtr mat = VRMaterial::create("cavekeeper_mat");
     mat->setDiffuse(Color3f(0.8,0.5,0.1));
     mat->readFragmentShader(wdir+"/shader/Blockworld.fp");
     mat->readVertexShader(wdir+"/shader/Blockworld.vp");
-    mat->readGeometryShader(wdir+"/shader/Blockworld.gp");
-
-    //shader parameter
-    float voxel = 1.0;
-    mat->setShaderParameter("Vox0", Vec4f(voxel, 0.0, 0.0, 0.0) );
-    mat->setShaderParameter("Vox1", Vec4f(0.0, voxel, 0.0, 0.0) );
-    mat->setShaderParameter("Vox2", Vec4f(0.0, 0.0, voxel, 0.0) );
-
-    mat->setShaderParameter("cam_pos", Vec4f(0.0, 0.0, 0.0, 0.0) );
-
     mat->setShaderParameter("texture", 0);
-    mat->setShaderParameter("tc1", Vec2f(0,0));
-    mat->setShaderParameter("tc2", Vec2f(1,0));
-    mat->setShaderParameter("tc3", Vec2f(1,1));
-    mat->setShaderParameter("tc4", Vec2f(0,1));
 
-    //texture
+    //texture, the chunk meshes have one texture repetition per block
     VRTextureGenerator tgen;
     tgen.setSize(512,512);
     tgen.add(PERLIN, 1./2, Color3f(0.3,0.1,0.1), Color3f(0.9,0.5,0.1));
@@ -90,70 +77,38 @@ VRMaterialPtr BlockWorld::initMaterial(string texture) {
     return mat;
 }
 
-VRGeometryPtr BlockWorld::createChunk(vector<CKOctree::element*>& elements) {
+void BlockWorld::uploadChunk(long long key, CKVoxelWorld::Mesh& mesh) {
+    if (mesh.indices.size() == 0) {
+        if (chunks.count(key)) chunks[key]->destroy();
+        chunks.erase(key);
+        return;
+    }
 
-    GeometryMTRecPtr g = Geometry::create();
-    GeoUInt8PropertyRecPtr      Type = GeoUInt8Property::create();
-    GeoUInt32PropertyRecPtr     Length = GeoUInt32Property::create();
     GeoPnt3fPropertyRecPtr      Pos = GeoPnt3fProperty::create();
     GeoVec3fPropertyRecPtr      Norms = GeoVec3fProperty::create();
+    GeoVec2fPropertyRecPtr      Texs = GeoVec2fProperty::create();
     GeoVec3fPropertyRecPtr      Colors = GeoVec3fProperty::create();
-    GeoVec2fPropertyRefPtr      texs = GeoVec2fProperty::create();
     GeoUInt32PropertyRecPtr     Indices = GeoUInt32Property::create();
-    SimpleMaterialRecPtr        Mat = SimpleMaterial::create();
-
-    GeoVec4fPropertyRefPtr      vLights = GeoVec4fProperty::create();
-
-    Type->addValue(GL_POINTS);
-    Length->addValue(3*elements.size());
-
-    int c = 0;
-
-    for(uint i=0;i<elements.size();i++) {
-		CKOctree::element* e = elements[i];
-        for (int j=0;j<3;j++) {
-            Pos->addValue(e->pos);
 
-            Vec4d L1 = e->vertexLight[j];
-            Vec4d L2 = e->vertexLight[j+3];
+    for (auto& p : mesh.positions) Pos->addValue(Pnt3f(p[0], p[1], p[2]));
+    for (auto& n : mesh.normals) Norms->addValue(n);
+    for (auto& t : mesh.texCoords) Texs->addValue(t);
+    for (auto& c : mesh.colors) Colors->addValue(c);
+    for (auto i : mesh.indices) Indices->addValue(i);
 
-            Norms->addValue(Vec3d(L1[0], L1[1], L1[2]));
-            Colors->addValue(Vec3d(L2[0], L2[1], L2[2]));
-            texs->addValue(Vec3d(L1[3], L2[3]));
-            Indices->addValue(c);
-            c++;
-        }
+    if (!chunks.count(key)) {
+        chunks[key] = VRGeometry::create("chunk");
+        chunks[key]->setMaterial(initMaterial("dirt"));
+        anchor->addChild(chunks[key]);
     }
 
-
-    g->setTypes(Type);
-    g->setLengths(Length);
-    g->setPositions(Pos);
-
-    g->setNormals(Norms);
-    g->setColors(Colors);
-    g->setTexCoords(texs);
-    g->setIndices(Indices);
-
-    g->setMaterial(Mat);
-
-    VRGeometryPtr geo = VRGeometry::create("chunk");
-    geo->setMesh( OSGGeometry::create(g) );
-    return geo;
-}
-
-VRGeometryPtr BlockWorld::initChunk() {
-	vector<CKOctree::element*>* elements = new vector<CKOctree::element*>();
-	VRFunction<CKOctree::element*>* fkt = new VRFunction<CKOctree::element*>("blockworld_appendtovector", boost::bind(&BlockWorld::appendToVector, this, elements, _1));
-    tree->traverse(fkt);
-    delete fkt;
-
-    VRGeometryPtr chunk = createChunk(*elements);
-    delete elements;
-
-    chunk->setMaterial(initMaterial("dirt"));
-
-    return chunk;
+    auto geo = chunks[key];
+    geo->setType(GL_TRIANGLES);
+    geo->setPositions(Pos);
+    geo->setNormals(Norms);
+    geo->setTexCoords(Texs);
+    geo->setColors(Colors);
+    geo->setIndices(Indices, true);
 }
 
 void BlockWorld::appendToVector(vector<CKOctree::element*>* elements, CKOctree::element* e) {
@@ -162,13 +117,29 @@ void BlockWorld::appendToVector(vector<CKOctree::element*>* elements, CKOctree::
 
 // update methods
 
-void BlockWorld::updateShaderCamPos() {
-    //VRTransformPtr e = VRSceneManager::get()->getTrackerUser(); // TODO
-    VRTransformPtr e = 0;
-    auto scene = VRScene::getCurrent();
-    if (e == 0 && scene) e = scene->getActiveCamera();
-    Vec4f cam_pos = Vec4f(e->getWorldPosition());
-    for (auto m : materials) m.second->setShaderParameter("cam_pos", cam_pos);
+void BlockWorld::startMeshing() { // the worker meshes a copy of the dirty chunks, the world may change meanwhile
+    auto job = shared_ptr<MeshJob>( new MeshJob() );
+    job->snapshot = voxels->extractDirty();
+    meshJob = job;
+    mesher = new boost::thread([job]() {
+        job->keys = job->snapshot->remesh(job->meshes);
+        job->done = true;
+    });
+}
+
+void BlockWorld::uploadMeshes() {
+    mesher->join();
+    delete mesher;
+    mesher = 0;
+    for (unsigned int i=0; i<meshJob->keys.size(); i++) uploadChunk(meshJob->keys[i], meshJob->meshes[i]);
+    meshJob = 0;
+}
+
+void BlockWorld::updateChunks(bool wait) { // upload the meshes finished since the last frame, then mesh the new changes in the background
+    if (!voxels) return;
+    if (mesher && (wait || meshJob->done)) uploadMeshes();
+    if (!mesher && voxels->hasDirtyChunks()) startMeshing();
+    if (wait && mesher) uploadMeshes();
 }
 
 BlockWorld::BlockWorld() {
@@ -176,33 +147,41 @@ BlockWorld::BlockWorld() {
     anchor->setPersistency(0);
 }
 
-BlockWorld::~BlockWorld() {}
+BlockWorld::~BlockWorld() {
+    if (mesher) { mesher->join(); delete mesher; }
+}
 
 void BlockWorld::initWorld() {
 	tree = new CKOctree();
     createSphere(6, Vec3i(0,0,0));
 
-    // TODO ?
+    voxels = CKVoxelWorld::create();
+	vector<CKOctree::element*> elements;
+	VRFunction<CKOctree::element*>* fkt = new VRFunction<CKOctree::element*>("blockworld_appendtovector", boost::bind(&BlockWorld::appendToVector, this, &elements, _1));
+    tree->traverse(fkt);
+    delete fkt;
+    for (auto e : elements) if (e->leaf) voxels->setBlock(Vec3i(e->pos), 1);
+
     auto scene = VRScene::getCurrent();
-    updatePtr = VRUpdateCb::create("blockworld_update", boost::bind(&BlockWorld::updateShaderCamPos, this));
+    updatePtr = VRUpdateCb::create("blockworld_update", boost::bind(&BlockWorld::updateChunks, this));
     if (scene) scene->addUpdateFkt(updatePtr, 1);
 
-    chunks[0] = initChunk();
-    anchor->addChild(chunks[0]);
+    updateChunks(true);
 }
 
 VRObjectPtr BlockWorld::getAnchor() { return anchor; }
 
-void BlockWorld::redraw(int chunk_id) {
-    if (chunks.count(chunk_id)) chunks[chunk_id]->destroy();
-    chunks[chunk_id] = initChunk();
-    anchor->addChild(chunks[chunk_id]);
+void BlockWorld::redraw() { updateChunks(); }
+
+void BlockWorld::syncBlock(Vec3d p) {
+    voxels->setBlock(Vec3i(p), tree->isLeaf(p) ? 1 : 0);
 }
 
 void CaveKeeper::placeLight(Vec3d p) {
     auto l = tree->addLight(p);
 	auto elements = tree->getAround(p, 10);
 	for (auto e : elements) e->updateLightning(l);
+	voxels->addLight(Vec3f(p));
 }
 
 int CaveKeeper::intersect(VRDevicePtr dev) {
@@ -212,14 +191,19 @@ int CaveKeeper::intersect(VRDevicePtr dev) {
 }
 
 int CaveKeeper::addBlock(Vec3i p) {
+    voxels->setBlock(p, 1);
     return tree->add(p)->ID;
 }
 
 void CaveKeeper::remBlock(int i) {
     auto e = tree->getElement(i);
     if (e) {
+        Vec3d p = e->pos;
         tree->addAround(e);
         tree->rem(e);
+        for (int i=-1;i<2;i++) // the removed block and the revealed rock around it
+            for (int j=-1;j<2;j++)
+                for (int k=-1;k<2;k++) syncBlock(p + Vec3d(i,j,k));
         redraw();
     }
 }
@@ -5,21 +5,25 @@
 #include <map>
 #include <string>
 #include <vector>
+#include <atomic>
 #include "CKOctree.h"
+#include "CKVoxelWorld.h"
 #include "core/utils/VRFunctionFwd.h"
 #include "core/objects/VRObjectFwd.h"
 
+namespace boost { class thread; }
+
 OSG_BEGIN_NAMESPACE;
 using namespace std;
 
 // -------------- TODO --------
 // check if element exists when adding to octree
-// when changing the world, only change the minimum data, do not rebuild the full mesh!
 // bumpmap
 
 class BlockWorld {
     public:
 		CKOctree* tree = 0;
+		CKVoxelWorldPtr voxels; // blocks for meshing, mirrors the leafs of the tree
 
         VRObjectPtr getAnchor();
 
@@ -27,9 +31,20 @@ class BlockWorld {
         VRObjectPtr anchor;
 
         map<string, VRMaterialPtr> materials;
-        map<int, VRGeometryPtr> chunks;
+        map<long long, VRGeometryPtr> chunks;
         VRUpdateCbPtr updatePtr;
 
+        struct MeshJob {
+            CKVoxelWorldPtr snapshot;
+            vector<long long> keys;
+            vector<CKVoxelWorld::Mesh> meshes;
+            atomic<bool> done;
+            MeshJob() : done(false) {}
+        };
+
+        boost::thread* mesher = 0;
+        shared_ptr<MeshJob> meshJob;
+
         // octree population algorithm
 
         void createPlane(int w);
@@ -37,14 +52,15 @@ class BlockWorld {
         // mesh methods
 
         VRMaterialPtr initMaterial(string texture);
-		VRGeometryPtr createChunk(vector<CKOctree::element*>& elements);
-        VRGeometryPtr initChunk();
+		void uploadChunk(long long key, CKVoxelWorld::Mesh& mesh);
+		void startMeshing();
+		void uploadMeshes();
 
 		void appendToVector(vector<CKOctree::element*>* elements, CKOctree::element* e);
 
         // update methods
 
-        void updateShaderCamPos();
+        void updateChunks(bool wait = false);
 
     protected:
         BlockWorld();
@@ -52,7 +68,8 @@ class BlockWorld {
 
         void initWorld();
 
-        void redraw(int chunk_id = 0);
+        void syncBlock(Vec3d p);
+        void redraw();
 };
 
 class CaveKeeper : public BlockWorld {
@@ -0,0 +1,313 @@
+#include "CSGEvaluator.h"
+#include "CGALTypedefs.h"
+#include "PolyhedronBuilder.h"
+
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Surface_mesh.h>
+#include <CGAL/boost/graph/helpers.h>
+#include <CGAL/Polygon_mesh_processing/corefinement.h>
+
+#include <iostream>
+#include <functional>
+
+using namespace OSG;
+
+typedef CGAL::Exact_predicates_inexact_constructions_kernel Epick;
+typedef CGAL::Surface_mesh<Epick::Point_3> CSGSurfaceMesh;
+
+struct CSGResult::Data {
+    shared_ptr<CGAL::Polyhedron> polyhedron; // nef backend
+    shared_ptr<CSGSurfaceMesh> mesh; // corefine backend
+};
+
+
+// -------------- result ------------------------
+
+CSGResult::CSGResult() : data(new Data()) {}
+CSGResult::~CSGResult() {}
+CSGResultPtr CSGResult::create() { return CSGResultPtr( new CSGResult() ); }
+
+CSGResultPtr CSGResult::create(CGAL::Polyhedron* p) {
+    auto r = create();
+    r->data->polyhedron = shared_ptr<CGAL::Polyhedron>(p);
+    return r;
+}
+CSGResult::Data* CSGResult::getData() { return data.get(); }
+
+void CSGResult::getTriangles(vector<Vec3d>& positions, vector<int>& indices) {
+    positions.clear();
+    indices.clear();
+    vector<int> poly;
+    auto addPolygon = [&]() {
+        for (unsigned int i=2; i<poly.size(); i++) {
+            indices.push_back(poly[0]);
+            indices.push_back(poly[i-1]);
+            indices.push_back(poly[i]);
+        }
+        poly.clear();
+    };
+
+    if (auto p = data->polyhedron) {
+        map<const void*, int> IDs;
+        for (auto v = p->vertices_begin(); v != p->vertices_end(); v++) {
+            IDs[&*v] = positions.size();
+            auto& q = v->point();
+            positions.push_back( Vec3d(CGAL::to_double(q.x()), CGAL::to_double(q.y()), CGAL::to_double(q.z())) );
+        }
+        for (auto f = p->facets_begin(); f != p->facets_end(); f++) {
+            auto c = f->facet_begin();
+            do poly.push_back( IDs[&*c->vertex()] ); while (++c != f->facet_begin());
+            addPolygon();
+        }
+    }
+
+    if (auto m = data->mesh) {
+        vector<int> IDs(m->num_vertices(), -1);
+        for (auto v : m->vertices()) {
+            IDs[v] = positions.size();
+            auto& q = m->point(v);
+            positions.push_back( Vec3d(q.x(), q.y(), q.z()) );
+        }
+        for (auto f : m->faces()) {
+            for (auto v : CGAL::vertices_around_face(m->halfedge(f), *m)) poly.push_back(IDs[v]);
+            addPolygon();
+        }
+    }
+}
+
+double CSGResult::getVolume() { // divergence theorem
+    vector<Vec3d> pos;
+    vector<int> inds;
+    getTriangles(pos, inds);
+    double V = 0;
+    for (unsigned int i=0; i+2<inds.size(); i+=3) V += pos[inds[i]].dot( pos[inds[i+1]].cross(pos[inds[i+2]]) );
+    return V/6;
+}
+
+int CSGResult::getEulerCharacteristic() {
+    if (auto p = data->polyhedron) return int(p->size_of_vertices()) - int(p->size_of_halfedges()/2) + int(p->size_of_facets());
+    if (auto m = data->mesh) return int(m->number_of_vertices()) - int(m->number_of_edges()) + int(m->number_of_faces());
+    return 0;
+}
+
+int CSGResult::getComponents() {
+    vector<Vec3d> pos;
+    vector<int> inds;
+    getTriangles(pos, inds);
+
+    vector<int> parent(pos.size());
+    for (unsigned int i=0; i<parent.size(); i++) parent[i] = i;
+    function<int(int)> root = [&](int i) { return parent[i] == i ? i : parent[i] = root(parent[i]); };
+    for (unsigned int i=0; i+2<inds.size(); i+=3) {
+        parent[root(inds[i+1])] = root(inds[i]);
+        parent[root(inds[i+2])] = root(inds[i]);
+    }
+
+    vector<bool> used(pos.size(), false);
+    for (auto i : inds) used[i] = true;
+    int N = 0;
+    for (unsigned int i=0; i<parent.size(); i++) if (used[i] && root(i) == int(i)) N++;
+    return N;
+}
+
+bool CSGResult::isClosed() {
+    if (auto p = data->polyhedron) return p->is_closed();
+    if (auto m = data->mesh) return CGAL::is_closed(*m);
+    return false;
+}
+
+
+// -------------- node ------------------------
+
+CSGNode::CSGNode() {}
+CSGNode::~CSGNode() {}
+
+CSGNodePtr CSGNode::create(string operation, CSGNodePtr a, CSGNodePtr b) {
+    auto n = CSGNodePtr( new CSGNode() );
+    n->operation = operation;
+    n->children.push_back(a);
+    n->children.push_back(b);
+    return n;
+}
+
+CSGNodePtr CSGNode::create(const vector<Vec3d>& positions, const vector<int>& indices) {
+    auto n = CSGNodePtr( new CSGNode() );
+    n->positions = positions;
+    n->indices = indices;
+    n->hash = hashData(positions.data(), positions.size()*sizeof(Vec3d));
+    n->hash = hashData(indices.data(), indices.size()*sizeof(int), n->hash);
+    return n;
+}
+
+CSGNodePtr CSGNode::create(CSGResultPtr result, size_t hash) {
+    auto n = CSGNodePtr( new CSGNode() );
+    n->result = result;
+    n->hash = hash;
+    return n;
+}
+
+size_t CSGNode::hashData(const void* data, size_t size, size_t seed) { // FNV-1a
+    const unsigned char* b = (const unsigned char*)data;
+    size_t h = seed;
+    for (size_t i=0; i<size; i++) {
+        h ^= b[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void CSGNode::computeHash() { // leaves are hashed on creation
+    if (children.size() == 0) return;
+    for (auto c : children) c->computeHash();
+    hash = hashData(operation.c_str(), operation.size());
+    for (auto c : children) hash = hashData(&c->hash, sizeof(size_t), hash);
+}
+
+
+// -------------- evaluator ------------------------
+
+CSGEvaluator::CSGEvaluator(BACKEND backend) : backend(backend) {}
+CSGEvaluator::~CSGEvaluator() {}
+CSGEvaluatorPtr CSGEvaluator::create(BACKEND backend) { return CSGEvaluatorPtr( new CSGEvaluator(backend) ); }
+
+CSGEvaluator::BACKEND CSGEvaluator::getBackend() { return backend; }
+void CSGEvaluator::setParallel(bool b) { parallel = b; }
+void CSGEvaluator::setCacheSize(size_t N) { cacheSize = N; }
+int CSGEvaluator::getOperations() { return operations; }
+int CSGEvaluator::getCacheHits() { return hits; }
+
+void CSGEvaluator::clearCache() {
+    lock_guard<mutex> lock(cacheMutex);
+    cache.clear();
+}
+
+CSGResultPtr CSGEvaluator::lookup(size_t hash) { return lookup(hash, false); }
+
+CSGResultPtr CSGEvaluator::lookup(size_t hash, bool count) {
+    lock_guard<mutex> lock(cacheMutex);
+    auto e = cache.find(hash);
+    if (e == cache.end()) return 0;
+    e->second.used = ++clock;
+    if (count) hits++;
+    return e->second.result;
+}
+
+void CSGEvaluator::store(size_t hash, CSGResultPtr r) {
+    lock_guard<mutex> lock(cacheMutex);
+    Entry& e = cache[hash];
+    e.result = r;
+    e.used = ++clock;
+    while (cache.size() > cacheSize) { // drop the least recently used result
+        auto oldest = cache.begin();
+        for (auto c = cache.begin(); c != cache.end(); c++) if (c->second.used < oldest->second.used) oldest = c;
+        cache.erase(oldest);
+    }
+}
+
+CSGResultPtr CSGEvaluator::build(CSGNode* n) {
+    if (n->positions.size() == 0 || n->indices.size() < 3) { cout << "CSGEvaluator: Warning: empty leaf!\n"; return 0; }
+    auto r = CSGResult::create();
+
+    if (backend == NEF) {
+        vector<CGAL::Point> points;
+        vector<size_t> inds(n->indices.begin(), n->indices.end());
+        for (auto& p : n->positions) points.push_back( CGAL::Point(p[0], p[1], p[2]) );
+        auto poly = make_shared<CGAL::Polyhedron>();
+        PolyhedronBuilder<CGAL::HalfedgeDS> builder(points, inds);
+        poly->delegate(builder);
+        r->getData()->polyhedron = poly;
+    }
+
+    if (backend == COREFINE) {
+        auto mesh = make_shared<CSGSurfaceMesh>();
+        vector<CSGSurfaceMesh::Vertex_index> verts;
+        for (auto& p : n->positions) verts.push_back( mesh->add_vertex(Epick::Point_3(p[0], p[1], p[2])) );
+        for (unsigned int i=0; i+2<n->indices.size(); i+=3) {
+            auto f = mesh->add_face(verts[n->indices[i]], verts[n->indices[i+1]], verts[n->indices[i+2]]);
+            if (f == CSGSurfaceMesh::null_face()) { cout << "CSGEvaluator: Warning: leaf is not a manifold mesh!\n"; return 0; }
+        }
+        r->getData()->mesh = mesh;
+    }
+
+    if (!r->isClosed()) { cout << "CSGEvaluator: Warning: leaf is not a closed mesh!\n"; return 0; }
+    return r;
+}
+
+CSGResultPtr CSGEvaluator::operate(string operation, CSGResultPtr a, CSGResultPtr b) {
+    auto r = CSGResult::create();
+
+    if (backend == NEF) {
+        try {
+            CGAL::Nef_Polyhedron np1(*a->getData()->polyhedron), np2(*b->getData()->polyhedron);
+            if (operation == "unite") np1 += np2;
+            else if (operation == "subtract") np1 -= np2;
+            else if (operation == "intersect") np1 = np1.intersection(np2);
+            else { cout << "CSGEvaluator: Warning: unexpected CSG operation " << operation << endl; return 0; }
+            if (!np1.is_simple()) { cout << "CSGEvaluator: Warning: result of " << operation << " is not a 2-manifold!\n"; return 0; }
+            auto p = make_shared<CGAL::Polyhedron>();
+            np1.convert_to_polyhedron(*p);
+            r->getData()->polyhedron = p;
+        } catch (exception& e) { cout << "CSGEvaluator::operate exception: " << e.what() << endl; return 0; }
+    }
+
+    if (backend == COREFINE) {
+        namespace PMP = CGAL::Polygon_mesh_processing;
+        CSGSurfaceMesh A = *a->getData()->mesh; // corefinement changes its input
+        CSGSurfaceMesh B = *b->getData()->mesh;
+        auto m = make_shared<CSGSurfaceMesh>();
+        bool ok = false;
+        try {
+            if (operation == "unite") ok = PMP::corefine_and_compute_union(A, B, *m);
+            else if (operation == "subtract") ok = PMP::corefine_and_compute_difference(A, B, *m);
+            else if (operation == "intersect") ok = PMP::corefine_and_compute_intersection(A, B, *m);
+            else { cout << "CSGEvaluator: Warning: unexpected CSG operation " << operation << endl; return 0; }
+        } catch (exception& e) { cout << "CSGEvaluator::operate exception: " << e.what() << endl; return 0; }
+        if (!ok) { cout << "CSGEvaluator: Warning: result of " << operation << " is not a 2-manifold!\n"; return 0; }
+        r->getData()->mesh = m;
+    }
+
+    return r;
+}
+
+CSGResultPtr CSGEvaluator::eval(CSGNode* n) {
+    if (auto r = lookup(n->hash, true)) return r;
+
+    if (n->children.size() == 0) {
+        CSGResultPtr r = n->result ? n->result : build(n);
+        if (r) store(n->hash, r);
+        return r;
+    }
+
+    if (n->children.size() != 2) { cout << "CSGEvaluator: Warning: " << n->operation << " needs two operands!\n"; return 0; }
+
+    CSGResultPtr a, b;
+    CSGNode* A = n->children[0].get();
+    CSGNode* B = n->children[1].get();
+    #pragma omp task shared(a) if(parallel && backend == COREFINE)
+    a = eval(A);
+    b = eval(B);
+    #pragma omp taskwait
+    if (!a || !b) return 0;
+
+    auto r = operate(n->operation, a, b);
+    if (!r) return 0;
+    store(n->hash, r);
+    #pragma omp atomic
+    operations++;
+    return r;
+}
+
+CSGResultPtr CSGEvaluator::evaluate(CSGNodePtr root) {
+    if (root == 0) return 0;
+    operations = 0;
+    hits = 0;
+    root->computeHash();
+
+    CSGResultPtr r;
+    #pragma omp parallel if(parallel && backend == COREFINE)
+    {
+        #pragma omp single
+        r = eval(root.get());
+    }
+    return r;
+}
@@ -0,0 +1,125 @@
+#ifndef CSGEVALUATOR_H_INCLUDED
+#define CSGEVALUATOR_H_INCLUDED
+
+#include <OpenSG/OSGVector.h>
+#include <vector>
+#include <map>
+#include <string>
+#include <mutex>
+#include "core/utils/VRFwdDeclTemplate.h"
+
+namespace CGAL { class Polyhedron; }
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+ptrFwd(CSGNode);
+ptrFwd(CSGResult);
+ptrFwd(CSGEvaluator);
+
+/**
+    Closed solid computed by a CSGEvaluator, the data depends on the backend.
+*/
+class CSGResult {
+    public:
+        struct Data;
+
+    private:
+        shared_ptr<Data> data;
+
+    public:
+        CSGResult();
+        ~CSGResult();
+        static CSGResultPtr create();
+        static CSGResultPtr create(CGAL::Polyhedron* p); // takes ownership of p
+
+        Data* getData();
+
+        void getTriangles(vector<Vec3d>& positions, vector<int>& indices); // polygons are split in fans
+        double getVolume();
+        int getEulerCharacteristic();
+        int getComponents();
+        bool isClosed();
+};
+
+/**
+    Node of a CSG tree, a leaf holds a closed triangle mesh in world coordinates,
+    an inner node combines its two children by "unite", "subtract" or "intersect".
+    Leaves are hashed by content, inner nodes by operation and child hashes.
+*/
+class CSGNode {
+    public:
+        string operation;
+        vector<CSGNodePtr> children;
+        vector<Vec3d> positions;
+        vector<int> indices;
+        CSGResultPtr result; // leaf already known to the evaluator
+        size_t hash = 0;
+
+        CSGNode();
+        ~CSGNode();
+
+        static CSGNodePtr create(string operation, CSGNodePtr a, CSGNodePtr b);
+        static CSGNodePtr create(const vector<Vec3d>& positions, const vector<int>& indices);
+        static CSGNodePtr create(CSGResultPtr result, size_t hash);
+
+        static size_t hashData(const void* data, size_t size, size_t seed = 14695981039346656037ULL);
+        void computeHash();
+};
+
+/**
+    Evaluates CSG trees and caches the results of all subtrees by their hash, a changed leaf
+    only invalidates the subtrees above it. The least recently used results are dropped above the cache size.
+    Backends are "nef", exact Nef polyhedra, and "corefine", mesh corefinement with exact predicates.
+    With the corefine backend independent subtrees are evaluated in parallel,
+    the lazy exact kernel of the Nef polyhedra can not be shared between threads.
+*/
+class CSGEvaluator {
+    public:
+        enum BACKEND {
+            NEF,
+            COREFINE
+        };
+
+    private:
+        struct Entry {
+            CSGResultPtr result;
+            size_t used = 0;
+        };
+
+        BACKEND backend = NEF;
+        bool parallel = true;
+        size_t cacheSize = 256;
+        map<size_t, Entry> cache;
+        size_t clock = 0;
+        mutex cacheMutex;
+
+        int operations = 0;
+        int hits = 0;
+
+        CSGResultPtr lookup(size_t hash, bool count);
+        void store(size_t hash, CSGResultPtr r);
+        CSGResultPtr eval(CSGNode* n);
+        CSGResultPtr build(CSGNode* n);
+        CSGResultPtr operate(string operation, CSGResultPtr a, CSGResultPtr b);
+
+    public:
+        CSGEvaluator(BACKEND backend = NEF);
+        ~CSGEvaluator();
+        static CSGEvaluatorPtr create(BACKEND backend = NEF);
+
+        BACKEND getBackend();
+        void setParallel(bool b);
+        void setCacheSize(size_t N);
+        void clearCache();
+
+        CSGResultPtr lookup(size_t hash);
+        CSGResultPtr evaluate(CSGNodePtr root);
+
+        int getOperations(); // operations computed in the last evaluation
+        int getCacheHits(); // subtrees taken from the cache in the last evaluation
+};
+
+OSG_END_NAMESPACE;
+
+#endif // CSGEVALUATOR_H_INCLUDED
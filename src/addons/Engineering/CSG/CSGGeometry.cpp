@@ -30,13 +30,29 @@ vector<string> CSGGeometry::getOperations() {
     return ops;
 }
 
+vector<string> CSGGeometry::getBackends() {
+    vector<string> backends;
+    backends.push_back("nef");
+    backends.push_back("corefine");
+    return backends;
+}
+
+CSGEvaluatorPtr CSGGeometry::getEvaluator(string backend) {
+    static map<string, CSGEvaluatorPtr> evaluators;
+    if (!evaluators.count(backend)) {
+        auto b = backend == "corefine" ? CSGEvaluator::COREFINE : CSGEvaluator::NEF;
+        evaluators[backend] = CSGEvaluator::create(b);
+    }
+    return evaluators[backend];
+}
+
 CSGGeometry::CSGGeometry(string name) : VRGeometry(name) {
 	oct = new Octree(thresholdL);
 	type = "CSGGeometry";
 	dm->read(oldWorldTrans);
-	polyhedron = new CGAL::Polyhedron();
 
 	store("op", &operation);
+	store("backend", &backend);
 }
 
 CSGGeometry::~CSGGeometry() {}
@@ -44,35 +60,6 @@ CSGGeometry::~CSGGeometry() {}
 CSGGeometryPtr CSGGeometry::ptr() { return static_pointer_cast<CSGGeometry>( shared_from_this() ); }
 CSGGeometryPtr CSGGeometry::create(string name) { return shared_ptr<CSGGeometry>(new CSGGeometry(name) ); }
 
-void CSGGeometry::setCSGGeometry(CGAL::Polyhedron *p) {
-	if (!p->is_valid()) return;
-	polyhedron = p;
-	VRGeometry::setMesh( OSGGeometry::create((GeometryMTRecPtr)toOsgGeometry(p)) );
-}
-
-CGAL::Polyhedron* CSGGeometry::getCSGGeometry() {
-    if (polyhedron == 0) {
-        Matrix4d worldTransform = getWorldMatrix();
-        bool success;
-        polyhedron = toPolyhedron(getMesh()->geo, worldTransform, success);
-    }
-
-	return polyhedron;
-}
-
-void CSGGeometry::operate(CGAL::Polyhedron *p1, CGAL::Polyhedron *p2) {
-	if (!p1->is_closed() || !p2->is_closed()) return;
-
-    try {
-        CGAL::Nef_Polyhedron np1(*p1), np2(*p2);
-        if (operation == "unite") np1 += np2;
-        else if(operation == "subtract") np1 -= np2;
-        else if(operation == "intersect") np1 = np1.intersection(np2);
-        else cout << "CSGGeometry: Warning: unexpected CSG operation!\n";
-        np1.convert_to_polyhedron(*polyhedron);
-    } catch (exception e) { cout << getName() << ": CSGGeometry::operate exception: " << e.what() << endl; }
-}
-
 void CSGGeometry::applyTransform(CGAL::Polyhedron* p, Matrix4d m) {
     if (p == 0) return;
     CGAL::Transformation t(m[0][0], m[1][0], m[2][0], m[3][0],
@@ -82,13 +69,13 @@ void CSGGeometry::applyTransform(CGAL::Polyhedron* p, Matrix4d m) {
     transform(p->points_begin(), p->points_end(), p->points_begin(), t);
 }
 
-GeometryTransitPtr CSGGeometry::toOsgGeometry(CGAL::Polyhedron *p) {
+GeometryTransitPtr CSGGeometry::toOsgGeometry(const vector<Vec3d>& pos, const vector<int>& inds) {
 	GeoPnt3fPropertyRecPtr positions = GeoPnt3fProperty::create();
 	GeoVec3fPropertyRecPtr normals = GeoVec3fProperty::create();
 	GeoUInt32PropertyRecPtr indices = GeoUInt32Property::create();
 
 	/*
-	 * Iterate over all faces, add their vertices to 'positions' && write indices at
+	 * Iterate over all triangles, add their vertices to 'positions' && write indices at
 	 * the same time. Results in no shared vertices && therefore no normal interpolation between
 	 * faces, but makes cubes look good. Well, well...
 	 */
@@ -104,23 +91,16 @@ GeometryTransitPtr CSGGeometry::toOsgGeometry(CGAL::Polyhedron *p) {
 
 	// Convert indices && positions
 	int curIndex = 0;
-	for (CGAL::Polyhedron::Facet_const_iterator it = p->facets_begin(); it != p->facets_end(); it++) {
-		CGAL::Polyhedron::Halfedge_around_facet_const_circulator circ = it->facet_begin();
-		do {
-			CGAL::Point cgalPos = circ->vertex()->point();
-			// We need to transform each point from global coordinates into our local coordinate system
-			// (CGAL uses global, OpenSG has geometry in node-local coords)
-			OSG::Vec3d vecPos = OSG::Vec3d(CGAL::to_double(cgalPos.x()),
-											  CGAL::to_double(cgalPos.y()),
-											  CGAL::to_double(cgalPos.z()));
-			OSG::Vec3d localVec = worldToLocal * (vecPos - translation);
-			OSG::Pnt3d osgPos(localVec.x(), localVec.y(), localVec.z());
-
-			positions->addValue(osgPos);
-			normals->addValue(Vec3d(0,1,0));
-			indices->addValue(curIndex);
-			curIndex++;
-		} while (++circ != it->facet_begin());
+	for (int i : inds) {
+		// We need to transform each point from global coordinates into our local coordinate system
+		// (CGAL uses global, OpenSG has geometry in node-local coords)
+		OSG::Vec3d localVec = worldToLocal * (pos[i] - translation);
+		OSG::Pnt3d osgPos(localVec.x(), localVec.y(), localVec.z());
+
+		positions->addValue(osgPos);
+		normals->addValue(Vec3d(0,1,0));
+		indices->addValue(curIndex);
+		curIndex++;
 	}
 
 	GeoUInt8PropertyRecPtr types = GeoUInt8Property::create();
@@ -149,9 +129,7 @@ size_t CSGGeometry::isKnownPoint(OSG::Pnt3f newPoint) {
 
 void CSGGeometry::enableEditMode() {
 	// Reset our result geometry
-	CGAL::Polyhedron* p = new CGAL::Polyhedron();
-	setCSGGeometry(p);
-	delete p;
+	VRGeometry::setMesh( OSGGeometry::create((GeometryMTRecPtr)toOsgGeometry(vector<Vec3d>(), vector<int>())) );
 
 	for (auto c : children) {
 		if (c->getType() == string("Geometry") || c->getType() == string("CSGGeometry")) c->setVisible(true);
@@ -201,7 +179,15 @@ void CSGGeometry::setOperation(string op) {
 	if (!getEditMode()) setEditMode(true);
 }
 
+void CSGGeometry::setBackend(string b) {
+	vector<string> backends = getBackends();
+	if (std::find(backends.begin(), backends.end(), b) == backends.end()) return;
+	backend = b;
+	if (!getEditMode()) setEditMode(true);
+}
+
 bool CSGGeometry::getEditMode() { return editMode; }
 string CSGGeometry::getOperation() { return operation; }
+string CSGGeometry::getBackend() { return backend; }
 
 OSG_END_NAMESPACE
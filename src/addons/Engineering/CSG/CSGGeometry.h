@@ -4,6 +4,7 @@
 #include <string>
 #include <OpenSG/OSGGeometry.h>
 #include "core/objects/geometry/VRGeometry.h"
+#include "CSGEvaluator.h"
 
 namespace CGAL { class Polyhedron; }
 
@@ -13,8 +14,8 @@ class Octree;
 
 class CSGGeometry : public VRGeometry {
     private:
-        CGAL::Polyhedron* polyhedron = 0;
         string operation = "unite";
+        string backend = "nef";
         bool editMode = true;
         Matrix4d oldWorldTrans;
         float thresholdL = 1e-4;
@@ -23,13 +24,12 @@ class CSGGeometry : public VRGeometry {
 
     protected:
         void applyTransform(CGAL::Polyhedron* p, Matrix4d m);
-        void setCSGGeometry(CGAL::Polyhedron* p);
-        CGAL::Polyhedron* getCSGGeometry();
         size_t isKnownPoint(OSG::Pnt3f newPoint);
-        GeometryTransitPtr toOsgGeometry(CGAL::Polyhedron* p);
+        GeometryTransitPtr toOsgGeometry(const vector<Vec3d>& positions, const vector<int>& indices);
         CGAL::Polyhedron* toPolyhedron(GeometryMTRecPtr geometry, Matrix4d worldTransform, bool& success);
 
-        void operate(CGAL::Polyhedron* minuend, CGAL::Polyhedron* subtrahend);
+        size_t hashGeometry(VRGeometryPtr geo);
+        CSGNodePtr toCSGTree(CSGEvaluatorPtr evaluator);
 
         void enableEditMode();
         bool disableEditMode();
@@ -51,6 +51,11 @@ class CSGGeometry : public VRGeometry {
         string getOperation();
         static vector<string> getOperations();
 
+        void setBackend(string b);
+        string getBackend();
+        static vector<string> getBackends();
+        static CSGEvaluatorPtr getEvaluator(string backend); // shared by all CSG geometries, holds the cache
+
         void markEdges(vector<Vec2i> edges);
 };
 
@@ -157,53 +157,98 @@ void CSGGeometry::markEdges(vector<Vec2i> edges) {
     setColors(cols);
 }
 
-bool CSGGeometry::disableEditMode() {
-	if (children.size() != 2) { cout << "CSGGeometry: Warning: editMode disabled with less than 2 children. Doing nothing.\n"; return false; }
+size_t CSGGeometry::hashGeometry(VRGeometryPtr geo) { // mesh data, world transform and the merge thresholds
+    GeometryMTRecPtr g = geo->getMesh()->geo;
+    Matrix4d m = geo->getWorldMatrix();
+    size_t h = CSGNode::hashData(m.getValues(), 16*sizeof(double));
+    h = CSGNode::hashData(&thresholdL, sizeof(float), h);
+    h = CSGNode::hashData(&thresholdA, sizeof(float), h);
+
+    if (auto pos = g->getPositions()) {
+        for (UInt32 i=0; i<pos->size(); i++) {
+            Pnt3f p = pos->getValue<Pnt3f>(i);
+            h = CSGNode::hashData(&p, sizeof(Pnt3f), h);
+        }
+    }
 
-	vector<CGAL::Polyhedron*> polys(2,0); // We need two child geometries to work with
-
-	for (int i=0; i<2; i++) { // Prepare the polyhedra
-		VRObjectPtr obj = children[i];
-        obj->setVisible(false);
-
-		if (obj->getType() == string("Geometry")) {
-			VRGeometryPtr geo = static_pointer_cast<VRGeometry>(obj);
-            cout << "child: " << geo->getName() << " toPolyhedron\n";
-            bool success;
-			try {
-			    polys[i] = toPolyhedron( geo->getMesh()->geo, geo->getWorldMatrix(), success );
-			} catch (exception e) {
-			    success = false;
-			    cout << getName() << ": toPolyhedron exception: " << e.what() << endl;
-			}
+    vector<GeoIntegralProperty*> props = { g->getIndices(), g->getTypes(), g->getLengths() };
+    for (auto prop : props) {
+        if (prop == 0) continue;
+        for (UInt32 i=0; i<prop->size(); i++) {
+            UInt32 v = prop->getValue(i);
+            h = CSGNode::hashData(&v, sizeof(UInt32), h);
+        }
+    }
+    return h;
+}
 
-            if (!success) {
-			    cout << getName() << ": toPolyhedron went totaly wrong :(\n";
-                //setCSGGeometry(polys[i]);
-                //obj->setVisible(true); // We stay in edit mode, so both children need to be visible
-                return false;
-            }
+CSGNodePtr CSGGeometry::toCSGTree(CSGEvaluatorPtr evaluator) {
+	if (children.size() != 2) { cout << "CSGGeometry: Warning: " << getName() << " has not exactly 2 children.\n"; return 0; }
+
+	vector<CSGNodePtr> operands;
+	for (auto obj : children) {
+		if (obj->getType() == "CSGGeometry") {
+			CSGNodePtr n = static_pointer_cast<CSGGeometry>(obj)->toCSGTree(evaluator);
+			if (n == 0) return 0;
+			operands.push_back(n);
 			continue;
 		}
 
-		if(obj->getType() == "CSGGeometry") {
-			CSGGeometryPtr geo = static_pointer_cast<CSGGeometry>(obj);
-			polys[i] = geo->getCSGGeometry(); // TODO: where does this come from?? keep the old!
+		if (obj->getType() != "Geometry") {
+			cout << "Warning! " << obj->getName() << " has wrong type " << obj->getType();
+			cout << ", it should be 'Geometry' or 'CSGGeometry'!" << endl;
+			return 0;
+		}
+
+		VRGeometryPtr geo = static_pointer_cast<VRGeometry>(obj);
+		size_t h = hashGeometry(geo);
+		if (auto r = evaluator->lookup(h)) { // unchanged geometry, skip the conversion
+			operands.push_back( CSGNode::create(r, h) );
 			continue;
 		}
 
-		cout << "Warning! polyhedron " << i << " not acquired because ";
-		cout << obj->getName() << " has wrong type " << obj->getType();
-		cout << ", it should be 'Geometry' or 'CSGGeometry'!" << endl;
+		cout << "child: " << geo->getName() << " toPolyhedron\n";
+		bool success = false;
+		CGAL::Polyhedron* p = 0;
+		try {
+			p = toPolyhedron( geo->getMesh()->geo, geo->getWorldMatrix(), success );
+		} catch (exception e) {
+			success = false;
+			cout << getName() << ": toPolyhedron exception: " << e.what() << endl;
+		}
+
+		if (!success) {
+			cout << getName() << ": toPolyhedron went totaly wrong :(\n";
+			delete p;
+			return 0;
+		}
+
+		// the leaf is the welded world space mesh, keyed by the hash of the source geometry
+		vector<Vec3d> pos;
+		vector<int> inds;
+		CSGResult::create(p)->getTriangles(pos, inds);
+		CSGNodePtr leaf = CSGNode::create(pos, inds);
+		leaf->hash = h;
+		operands.push_back(leaf);
 	}
 
-	if (polys[0] == 0) cout << "Warning! first polyhedron is 0! " << children[0]->getName() << endl;
-	if (polys[1] == 0) cout << "Warning! second polyhedron is 0! " << children[1]->getName() << endl;
-	if (polys[0] == 0 || polys[1] == 0) return false;
-    if (!polys[0]->is_closed() || !polys[1]->is_closed()) return false;
+	return CSGNode::create(operation, operands[0], operands[1]);
+}
+
+bool CSGGeometry::disableEditMode() {
+	if (children.size() != 2) { cout << "CSGGeometry: Warning: editMode disabled with less than 2 children. Doing nothing.\n"; return false; }
+
+	auto evaluator = getEvaluator(backend);
+	CSGNodePtr tree = toCSGTree(evaluator);
+	if (tree == 0) return false;
+
+	CSGResultPtr result = evaluator->evaluate(tree);
+	if (result == 0) { cout << getName() << ": CSG evaluation failed!\n"; return false; }
+	for (auto c : children) c->setVisible(false);
 
-    operate(polys[0], polys[1]);
-	for (auto p : polys) delete p; // clean up
-    setCSGGeometry(polyhedron);
+	vector<Vec3d> positions;
+	vector<int> indices;
+	result->getTriangles(positions, indices);
+	VRGeometry::setMesh( OSGGeometry::create((GeometryMTRecPtr)toOsgGeometry(positions, indices)) );
 	return true;
 }
@@ -53,6 +53,8 @@ PyMethodDef VRPyCSG::methods[] = {
     {"setEditMode", (PyCFunction)VRPyCSG::setEditMode, METH_VARARGS, "set CSG object edit mode, set it to false to compute and show the result - setEditMode(bool b)" },
     {"markEdges", (PyCFunction)VRPyCSG::markEdges, METH_VARARGS, "Color the edges of the polyhedron, pass a list of int pairs - markEdges([[i1,i2],[i1,i3],...])\nPass an empty list to hide edges." },
     {"setThreshold", (PyCFunction)VRPyCSG::setThreshold, METH_VARARGS, "Set the threashold used to merge double vertices - setThreshold( float )\n default is 1e-4" },
+    {"getBackend", (PyCFunction)VRPyCSG::getBackend, METH_VARARGS, "get CSG backend" },
+    {"setBackend", (PyCFunction)VRPyCSG::setBackend, METH_VARARGS, "set CSG backend - setBackend(string s)\n use one of: 'nef' (exact Nef polyhedra), 'corefine' (mesh corefinement, evaluates independent subtrees in parallel)" },
     {NULL}  /* Sentinel */
 };
 
@@ -97,3 +99,14 @@ PyObject* VRPyCSG::setEditMode(VRPyCSG* self, PyObject* args) {
     bool b = parseBool(args);
 	return PyBool_FromLong(self->objPtr->setEditMode(b));
 }
+
+PyObject* VRPyCSG::getBackend(VRPyCSG* self) {
+    if (self->objPtr == 0) { PyErr_SetString(err, "VRPyCSG::getBackend, Object is invalid"); return NULL; }
+    return PyString_FromString(self->objPtr->getBackend().c_str());
+}
+
+PyObject* VRPyCSG::setBackend(VRPyCSG* self, PyObject* args) {
+    if (self->objPtr == 0) { PyErr_SetString(err, "VRPyCSG::setBackend, Object is invalid"); return NULL; }
+    self->objPtr->setBackend( parseString(args) );
+    Py_RETURN_TRUE;
+}
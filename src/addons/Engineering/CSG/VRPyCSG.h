@@ -14,6 +14,8 @@ struct VRPyCSG : VRPyBaseT<OSG::CSGGeometry> {
     static PyObject* setEditMode(VRPyCSG* self, PyObject* args);
     static PyObject* markEdges(VRPyCSG* self, PyObject* args);
     static PyObject* setThreshold(VRPyCSG* self, PyObject* args);
+    static PyObject* getBackend(VRPyCSG* self);
+    static PyObject* setBackend(VRPyCSG* self, PyObject* args);
 };
 
 #endif // VRPYCSG_H_INCLUDED
@@ -9,6 +9,11 @@
 #include <OpenSG/OSGGeoProperties.h>
 #include <OpenSG/OSGShaderVariableOSG.h>
 #include <OpenSG/OSGQuaternion.h>
+#include <unordered_map>
+#include <algorithm>
+#include <fstream>
+#include <cstdlib>
+#include <cctype>
 
 #define GLSL(shader) #shader
 
@@ -224,22 +229,33 @@ void VRAtom::print() {
     cout << endl;
 }
 
-void VRAtom::propagateTransformation(Matrix4d& T, uint flag, bool self) {
+void VRAtom::propagateTransformation(Matrix4d& T, uint flag, bool self, vector<VRAtom*>* moved) {
     if (flag == recFlag) return;
     recFlag = flag;
 
-    if (self) {
-        Matrix4d m = T;
-        m.mult(transformation);
-        transformation = m;
-    }
+    vector<VRAtom*> front(1, this); // no recursion, long chains would overflow the stack
+    while (front.size()) {
+        VRAtom* a = front.back();
+        front.pop_back();
+        if (moved) moved->push_back(a);
 
-    for (auto& b : bonds) {
-        if (b.second.atom2 == 0) { // duplet
-            T.mult(b.second.p1, b.second.p1);
-            T.mult(b.second.p2, b.second.p2);
+        if (self || a != this) {
+            Matrix4d m = T;
+            m.mult(a->transformation);
+            a->transformation = m;
+        }
+
+        for (auto& b : a->bonds) {
+            VRAtom* n = b.second.atom2;
+            if (n == 0) { // duplet
+                T.mult(b.second.p1, b.second.p1);
+                T.mult(b.second.p2, b.second.p2);
+                continue;
+            }
+            if (n->recFlag == flag) continue;
+            n->recFlag = flag;
+            front.push_back(n);
         }
-        else b.second.atom2->propagateTransformation(T, flag);
     }
 }
 
@@ -304,14 +320,17 @@ void VRMolecule::updateGeo() {
     int j=0;
     for (auto a : atoms) {
         PeriodicTableEntry aP = a.second->getParams();
+        a.second->geoID = i;
         cols->addValue(aP.color);
         Pos->addValue(a.second->getTransformation()[3]);
         Norms->addValue( Vec3d(0, r_scale*aP.radius, 0) );
         Indices->addValue(i++);
 
         // bonds
-        for (auto b : a.second->getBonds()) {
+        for (auto& b : a.second->getBonds()) {
+            b.second.geoID = -1;
             if (b.second.atom2 == 0) { // duplet
+                b.second.geoID = j;
                 Pos2->addValue(b.second.p1);
                 Pos2->addValue(b.second.p2);
                 Norms2->addValue( Vec3d(0, 1, 0) );
@@ -322,6 +341,7 @@ void VRMolecule::updateGeo() {
             }
 
             if (b.second.atom2->getID() < a.first) {
+                b.second.geoID = j;
                 PeriodicTableEntry bP = b.second.atom2->getParams();
                 Pos2->addValue(a.second->getTransformation()[3]);
                 Pos2->addValue(b.second.atom2->getTransformation()[3]);
@@ -363,6 +383,43 @@ void VRMolecule::updateGeo() {
     bonds_geo->setIndices(Indices2);
     bonds_geo->setMaterial(mat2);
 
+    atomPositions = Pos;
+    bondPositions = Pos2;
+    updateLabels();
+    updateCoords();
+}
+
+/**
+ * writes the new positions of the moved atoms and their bonds into the existing geometry,
+ * the topology of the molecule has to be the same as in the last updateGeo
+ */
+void VRMolecule::updateAtomGeo(const vector<VRAtom*>& moved) {
+    if (!atomPositions || !bondPositions) { updateGeo(); return; }
+
+    for (auto a : moved) {
+        if (a->geoID < 0 || a->geoID >= (int)atomPositions->size()) { updateGeo(); return; }
+        atomPositions->setValue(Vec3d(a->getTransformation()[3]), a->geoID);
+
+        for (auto& b : a->getBonds()) {
+            VRBond* drawn = &b.second;
+            VRAtom* n = b.second.atom2;
+            if (n && drawn->geoID < 0) { // drawn by the other atom
+                auto c = n->getBonds().find(b.second.slot);
+                if (c == n->getBonds().end()) continue;
+                drawn = &c->second;
+            }
+            if (drawn->geoID < 0) continue;
+
+            if (drawn->atom2 == 0) { // duplet
+                bondPositions->setValue(drawn->p1, drawn->geoID);
+                bondPositions->setValue(drawn->p2, drawn->geoID+1);
+            } else {
+                bondPositions->setValue(Vec3d(drawn->atom1->getTransformation()[3]), drawn->geoID);
+                bondPositions->setValue(Vec3d(drawn->atom2->getTransformation()[3]), drawn->geoID+1);
+            }
+        }
+    }
+
     updateLabels();
     updateCoords();
 }
@@ -508,8 +565,9 @@ void VRMolecule::rotateBond(int a, int b, float f) {
 
     //cout << "ROTATE bound " << a << "-" << b << " around " << dir << " with " << f << endl;
 
-    B->propagateTransformation(T, now);
-    updateGeo();
+    vector<VRAtom*> moved;
+    B->propagateTransformation(T, now, true, &moved);
+    updateAtomGeo(moved);
 }
 
 void VRMolecule::changeBond(int a, int b, int t) {
@@ -690,6 +748,150 @@ VRAtom* VRMolecule::getAtom(int ID) {
     return 0;
 }
 
+int VRMolecule::getAtomCount() { return atoms.size(); }
+VRGeometryPtr VRMolecule::getBondsGeometry() { return bonds_geo; }
+
+void VRMolecule::setAtomPositions(const vector<int>& IDs, const vector<Vec3d>& positions) {
+    if (IDs.size() != positions.size()) { cout << "VRMolecule::setAtomPositions: got " << IDs.size() << " IDs but " << positions.size() << " positions" << endl; return; }
+
+    vector<VRAtom*> moved;
+    for (uint i=0; i<IDs.size(); i++) {
+        auto a = atoms.find(IDs[i]);
+        if (a == atoms.end()) continue;
+        VRAtom* at = a->second;
+        Vec3d d = positions[i] - Vec3d(at->transformation[3]);
+        at->transformation.setTranslate(positions[i]);
+        for (auto& b : at->bonds) {
+            if (b.second.atom2 != 0) continue;
+            b.second.p1 += d; // duplets follow their atom
+            b.second.p2 += d;
+        }
+        moved.push_back(at);
+    }
+    updateAtomGeo(moved);
+}
+
+/**
+ * bonds all atoms closer than the sum of their radii times the tolerance,
+ * the atoms are sorted into a grid, only atoms in neighbouring cells are checked
+ */
+int VRMolecule::autoBond(float tolerance) {
+    float rmax = 0;
+    for (auto a : atoms) rmax = max(rmax, a.second->params.radius);
+    float cell = 2*rmax*tolerance;
+    if (cell <= 0) return 0;
+
+    auto key = [cell](Vec3d p, int i, int j, int k) -> long long {
+        const long long m = (1<<21)-1;
+        long long x = ((long long)floor(p[0]/cell) + i) & m;
+        long long y = ((long long)floor(p[1]/cell) + j) & m;
+        long long z = ((long long)floor(p[2]/cell) + k) & m;
+        return (x << 42) | (y << 21) | z;
+    };
+
+    unordered_map<long long, vector<VRAtom*>> grid;
+    for (auto a : atoms) grid[key(Vec3d(a.second->transformation[3]), 0,0,0)].push_back(a.second);
+
+    int N = 0;
+    vector<pair<float, VRAtom*>> candidates;
+    for (auto a : atoms) {
+        VRAtom* A = a.second;
+        Vec3d p = Vec3d(A->transformation[3]);
+        candidates.clear();
+        for (int i=-1; i<=1; i++) {
+            for (int j=-1; j<=1; j++) {
+                for (int k=-1; k<=1; k++) {
+                    auto c = grid.find(key(p,i,j,k));
+                    if (c == grid.end()) continue;
+                    for (auto B : c->second) {
+                        if (B->ID <= A->ID) continue;
+                        float dmax = (A->params.radius + B->params.radius)*tolerance;
+                        float d2 = (Vec3d(B->transformation[3]) - p).squareLength();
+                        if (d2 < dmax*dmax) candidates.push_back(make_pair(d2, B));
+                    }
+                }
+            }
+        }
+
+        sort(candidates.begin(), candidates.end()); // closest atoms bond first
+        for (auto c : candidates) if (A->append(c.second, 1)) N++;
+    }
+    return N;
+}
+
+/**
+ * loads the ATOM, HETATM and CONECT records of a PDB file, the whole file is read at once,
+ * without CONECT records the atoms are bonded by distance
+ */
+void VRMolecule::loadPDB(string path) {
+    if (PeriodicTable.size() == 0) initAtomicTables();
+    ifstream file(path.c_str(), ios::binary);
+    if (!file) { cout << "VRMolecule::loadPDB: could not open " << path << endl; return; }
+    string data( (istreambuf_iterator<char>(file)), istreambuf_iterator<char>() );
+
+    definition = "";
+    atoms.clear();
+    unordered_map<int, VRAtom*> serials;
+    vector<pair<int,int>> conects;
+    int skipped = 0;
+
+    auto field = [&](size_t l, size_t n, int c, int w) -> string { // columns of the line starting at l with length n
+        if (c >= (int)n) return "";
+        string f = data.substr(l+c, min(w, int(n)-c));
+        size_t a = f.find_first_not_of(' ');
+        if (a == string::npos) return "";
+        return f.substr(a, f.find_last_not_of(' ')-a+1);
+    };
+
+    size_t l = 0;
+    while (l < data.size()) {
+        size_t e = data.find('\n', l);
+        if (e == string::npos) e = data.size();
+        size_t n = e-l;
+        if (n > 0 && data[e-1] == '\r') n--;
+
+        bool atom = data.compare(l, 6, "ATOM  ") == 0 || data.compare(l, 6, "HETATM") == 0;
+        if (atom && n >= 54) {
+            string type = field(l, n, 76, 2);
+            if (type == "") { // old files, element from the atom name
+                type = field(l, n, 12, 4);
+                while (type.size() && isNumber(type[0])) type = type.substr(1);
+                type = type.substr(0, 1);
+            }
+            if (type.size() > 1) type = string(1, toupper(type[0])) + char(tolower(type[1]));
+
+            if (PeriodicTable.count(type) == 0) skipped++;
+            else {
+                int ID = atoms.size();
+                VRAtom* at = new VRAtom(type, ID);
+                at->bonds.clear(); // no duplets, there is no structure to place them
+                at->transformation.setTranslate( Vec3d(atof(field(l,n,30,8).c_str()), atof(field(l,n,38,8).c_str()), atof(field(l,n,46,8).c_str())) );
+                atoms.insert(atoms.end(), make_pair(ID, at));
+                serials[atoi(field(l, n, 6, 5).c_str())] = at;
+            }
+        }
+
+        if (data.compare(l, 6, "CONECT") == 0) {
+            int a = atoi(field(l, n, 6, 5).c_str());
+            for (int c=11; c<=26; c+=5) {
+                string b = field(l, n, c, 5);
+                if (b != "") conects.push_back(make_pair(a, atoi(b.c_str())));
+            }
+        }
+
+        l = e+1;
+    }
+
+    if (skipped) cout << "VRMolecule::loadPDB: skipped " << skipped << " atoms of unknown type" << endl;
+    if (conects.size() == 0) autoBond();
+    for (auto c : conects) {
+        if (serials.count(c.first) == 0 || serials.count(c.second) == 0) continue;
+        serials[c.first]->append(serials[c.second], 1);
+    }
+
+    updateGeo();
+}
+
 string VRMolecule::a_fp =
 "#version 120\n"
 GLSL(
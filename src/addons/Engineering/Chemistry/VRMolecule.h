@@ -1,6 +1,7 @@
 #ifndef VRMOLECULE_H_INCLUDED
 #define VRMOLECULE_H_INCLUDED
 
+#include <OpenSG/OSGGeoProperties.h>
 #include "core/objects/geometry/VRGeometry.h"
 
 class VRNumberingEngine;
@@ -25,6 +26,7 @@ struct VRBond {
     int slot = 0;
     bool extra = false;
     Pnt3d p1, p2;
+    int geoID = -1; // first vertex in the bonds geometry, only on the bond side that is drawn
 
     VRBond();
     VRBond(int t, int s, VRAtom* a2, VRAtom* a1);
@@ -36,6 +38,7 @@ class VRAtom {
         PeriodicTableEntry params;
 
         int ID = 0; // ID in molecule
+        int geoID = -1; // vertex in the atoms geometry
         bool full = false; // all valence electrons bound
         Matrix4d transformation;
 
@@ -62,7 +65,7 @@ class VRAtom {
 		bool append(VRAtom* b, int bType, bool extra = false);
 		void detach(VRAtom* a);
 
-		void propagateTransformation(Matrix4d& T, uint flag, bool self = true);
+		void propagateTransformation(Matrix4d& T, uint flag, bool self = true, vector<VRAtom*>* moved = 0);
 
 		void print();
 };
@@ -75,6 +78,8 @@ class VRMolecule : public VRGeometry {
         VRGeometryPtr bonds_geo = 0;
         VRGeometryPtr coords_geo = 0;
         VRNumberingEnginePtr labels = 0;
+        GeoPnt3fPropertyRecPtr atomPositions;
+        GeoPnt3fPropertyRecPtr bondPositions;
         bool doLabels = false;
         bool doCoords = false;
 
@@ -91,6 +96,7 @@ class VRMolecule : public VRGeometry {
 		void addAtom(int a, int b);
 		void updateLabels();
 		void updateCoords();
+		void updateAtomGeo(const vector<VRAtom*>& moved);
 
 		int getID();
 		vector<string> parse(string mol, bool verbose = false);
@@ -105,9 +111,14 @@ class VRMolecule : public VRGeometry {
 
         void set(string definition);
         void setRandom(int N);
+        void loadPDB(string path);
+        int autoBond(float tolerance = 1.2);
         string getDefinition();
 
         VRAtom* getAtom(int ID);
+        int getAtomCount();
+        void setAtomPositions(const vector<int>& IDs, const vector<Vec3d>& positions);
+        VRGeometryPtr getBondsGeometry();
 
         void setLocalOrigin(int ID);
 
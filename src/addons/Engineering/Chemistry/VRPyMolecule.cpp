@@ -48,6 +48,8 @@ template<> PyTypeObject VRPyBaseT<OSG::VRMolecule>::type = {
 PyMethodDef VRPyMolecule::methods[] = {
     {"set", (PyCFunction)VRPyMolecule::set, METH_VARARGS, "Set the molecule from string - set('CH4')" },
     {"setRandom", (PyCFunction)VRPyMolecule::setRandom, METH_VARARGS, "Set a random molecule - setRandom(123)" },
+    {"loadPDB", (PyCFunction)VRPyMolecule::loadPDB, METH_VARARGS, "Load the atoms and bonds of a PDB file - loadPDB('protein.pdb')" },
+    {"autoBond", (PyCFunction)VRPyMolecule::autoBond, METH_VARARGS, "Bond all atoms closer than the sum of their radii times the tolerance, returns the number of new bonds - int autoBond(float tolerance = 1.2)" },
     {"showLabels", (PyCFunction)VRPyMolecule::showLabels, METH_VARARGS, "Display the ID of each atom - showLabels(True)" },
     {"showCoords", (PyCFunction)VRPyMolecule::showCoords, METH_VARARGS, "Display the coordinate system of each atom - showCoords(True)" },
     {"substitute", (PyCFunction)VRPyMolecule::substitute, METH_VARARGS, "Substitute an atom of both molecules to append the second to this - substitute(int aID, mol b, int bID)" },
@@ -87,6 +89,21 @@ PyObject* VRPyMolecule::setRandom(VRPyMolecule* self, PyObject* args) {
     Py_RETURN_TRUE;
 }
 
+PyObject* VRPyMolecule::loadPDB(VRPyMolecule* self, PyObject* args) {
+    if (self->objPtr == 0) { PyErr_SetString(err, "VRPyMolecule::loadPDB - Object is invalid"); return NULL; }
+    self->objPtr->loadPDB( parseString(args) );
+    Py_RETURN_TRUE;
+}
+
+PyObject* VRPyMolecule::autoBond(VRPyMolecule* self, PyObject* args) {
+    if (self->objPtr == 0) { PyErr_SetString(err, "VRPyMolecule::autoBond - Object is invalid"); return NULL; }
+    float t = 1.2;
+    if (! PyArg_ParseTuple(args, "|f", &t)) return NULL;
+    int N = self->objPtr->autoBond(t);
+    self->objPtr->updateGeo();
+    return PyInt_FromLong(N);
+}
+
 PyObject* VRPyMolecule::showLabels(VRPyMolecule* self, PyObject* args) {
     if (self->objPtr == 0) { PyErr_SetString(err, "VRPyMolecule::showLabels - Object is invalid"); return NULL; }
     self->objPtr->showLabels( parseBool(args) );
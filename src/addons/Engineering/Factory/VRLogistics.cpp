@@ -6,6 +6,8 @@
 #include "core/objects/material/VRMaterial.h"
 #include "core/utils/toString.h"
 #include <GL/glut.h>
+#include <queue>
+#include <functional>
 
 #include <OpenSG/OSGMatrixUtility.h>
 
@@ -403,6 +405,246 @@ VRStrokePtr FNetwork::stroke(Color3f c, float k) {
 }
 
 
+// --------------------------------------------------------------------- SIMULATION
+
+FSimulation::FSimulation() {}
+FSimulation::~FSimulation() {}
+
+shared_ptr<FSimulation> FSimulation::create() { return shared_ptr<FSimulation>(new FSimulation()); }
+
+int FSimulation::addNode(Vec3d p) {
+    nodes.push_back(p);
+    outLanes.push_back(vector<int>());
+    waiting.push_back(deque<int>());
+    return nodes.size()-1;
+}
+
+int FSimulation::addLane(int from, int to, float speed) {
+    int N = nodes.size();
+    if (from < 0 || to < 0 || from >= N || to >= N || from == to) { cout << "FSimulation::addLane, invalid nodes " << from << " " << to << endl; return -1; }
+    Lane l;
+    l.from = from;
+    l.to = to;
+    l.length = max((nodes[to]-nodes[from]).length(), 1e-3);
+    l.speed = speed;
+    lanes.push_back(l);
+    outLanes[from].push_back(lanes.size()-1);
+    routes.clear();
+    return lanes.size()-1;
+}
+
+void FSimulation::addNetwork(shared_ptr<FNetwork> n, float speed) {
+    if (!n) return;
+    auto fn = n->getNodes();
+    for (auto node : fn) {
+        auto t = node->getTransform();
+        if (t && !fnodes.count(node->getID())) fnodes[node->getID()] = addNode(t->getWorldPosition());
+    }
+    for (auto node : fn) {
+        if (!fnodes.count(node->getID())) continue;
+        for (auto o : node->getOutgoing()) {
+            if (fnodes.count(o.first)) addLane(fnodes[node->getID()], fnodes[o.first], speed);
+        }
+    }
+}
+
+int FSimulation::getNode(shared_ptr<FNode> n) { return n && fnodes.count(n->getID()) ? fnodes[n->getID()] : -1; }
+
+vector<int>& FSimulation::getRoute(int target) { // shortest paths to the target, by lane length
+    if (routes.count(target)) return routes[target];
+    int N = nodes.size();
+    vector<vector<int>> inLanes(N);
+    for (unsigned int l=0; l<lanes.size(); l++) inLanes[lanes[l].to].push_back(l);
+
+    vector<double> dist(N, -1);
+    typedef pair<double, int> Entry;
+    priority_queue<Entry, vector<Entry>, greater<Entry>> Q;
+    dist[target] = 0;
+    Q.push(Entry(0, target));
+    while (!Q.empty()) {
+        auto e = Q.top(); Q.pop();
+        if (e.first > dist[e.second]) continue;
+        for (int l : inLanes[e.second]) {
+            int n = lanes[l].from;
+            double d = e.first + lanes[l].length;
+            if (dist[n] >= 0 && dist[n] <= d) continue;
+            dist[n] = d;
+            Q.push(Entry(d, n));
+        }
+    }
+
+    auto& route = routes[target];
+    route.assign(N, -1);
+    for (int n=0; n<N; n++) {
+        double best = -1;
+        for (int l : outLanes[n]) {
+            double d = dist[lanes[l].to];
+            if (d < 0) continue;
+            d += lanes[l].length;
+            if (best < 0 || d < best) { best = d; route[n] = l; }
+        }
+    }
+    return route;
+}
+
+int FSimulation::nextLane(int node, int target) {
+    if (target < 0 || target >= int(nodes.size())) return -1;
+    return getRoute(target)[node];
+}
+
+bool FSimulation::enter(int i, int l) {
+    Lane& L = lanes[l];
+    if (L.items.size() && items[L.items.back()].s < gap) return false; // no space at the lane start
+    L.items.push_back(i);
+    L.idle = false;
+    Item& I = items[i];
+    I.lane = l;
+    I.node = -1;
+    I.s = 0;
+    I.moved = true;
+    return true;
+}
+
+void FSimulation::moveLane(int l, float dt) { // items advance until they reach the lane end or the item in front
+    Lane& L = lanes[l];
+    float ds = L.speed*dt;
+    float limit = L.length;
+    bool changed = false;
+    for (int i : L.items) {
+        Item& I = items[i];
+        float s = min(I.s + ds, limit);
+        if (s > I.s) { I.s = s; I.moved = true; changed = true; }
+        limit = max(I.s - gap, 0.f);
+    }
+    L.idle = !changed;
+}
+
+void FSimulation::step(float dt) {
+    active.clear();
+    for (unsigned int l=0; l<lanes.size(); l++) if (lanes[l].items.size() && !lanes[l].idle) active.push_back(l);
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (int k=0; k<int(active.size()); k++) moveLane(active[k], dt);
+
+    // transfers in lane and node order, the result does not depend on the threads
+    auto deliver = [&](int i, int node) {
+        Item& I = items[i];
+        I.lane = -1;
+        I.node = node;
+        I.delivered = true;
+        I.moved = true;
+        delivered.push_back(i);
+    };
+
+    for (unsigned int l=0; l<lanes.size(); l++) {
+        Lane& L = lanes[l];
+        while (L.items.size()) {
+            int i = L.items.front();
+            if (items[i].s < L.length) break;
+            if (items[i].target != L.to) {
+                int n = nextLane(L.to, items[i].target);
+                if (n < 0 || n == int(l) || !enter(i, n)) break; // waits at the lane end
+            } else deliver(i, L.to);
+            L.items.pop_front();
+            L.idle = false;
+        }
+    }
+
+    for (unsigned int n=0; n<waiting.size(); n++) {
+        auto& W = waiting[n];
+        while (W.size()) {
+            int i = W.front();
+            if (items[i].target != int(n)) {
+                int l = nextLane(n, items[i].target);
+                if (l < 0 || !enter(i, l)) break;
+            } else deliver(i, n);
+            W.pop_front();
+        }
+    }
+
+    time += dt;
+}
+
+int FSimulation::advance(double dt) {
+    accumulated += dt;
+    int N = 0;
+    while (accumulated >= timeStep) {
+        step(timeStep);
+        accumulated -= timeStep;
+        N++;
+    }
+    return N;
+}
+
+int FSimulation::addItem(int node, int target, shared_ptr<FObject> o) {
+    if (node < 0 || node >= int(nodes.size())) { cout << "FSimulation::addItem, invalid node " << node << endl; return -1; }
+    Item I;
+    I.node = node;
+    I.target = target;
+    items.push_back(I);
+    objects.push_back(o);
+    waiting[node].push_back(items.size()-1);
+    return items.size()-1;
+}
+
+void FSimulation::send(int i, int target) {
+    if (i < 0 || i >= int(items.size())) return;
+    Item& I = items[i];
+    if (I.lane >= 0) { cout << "FSimulation::send, item " << i << " is on its way" << endl; return; }
+    I.target = target;
+    if (!I.delivered) return; // still waiting at its start node
+    I.delivered = false;
+    waiting[I.node].push_back(i);
+}
+
+FSimulation::Item FSimulation::getItem(int i) { return i >= 0 && i < int(items.size()) ? items[i] : Item(); }
+
+int FSimulation::sync() {
+    int N = 0;
+    for (unsigned int i=0; i<items.size(); i++) {
+        Item& I = items[i];
+        if (!I.moved || !objects[i]) continue;
+        auto t = objects[i]->getTransformation();
+        if (!t || !t->isVisible()) continue; // updated once visible again
+
+        Vec3d pos = nodes[I.node >= 0 ? I.node : 0];
+        Vec3d dir(0,0,-1);
+        if (I.lane >= 0) {
+            Lane& L = lanes[I.lane];
+            dir = nodes[L.to] - nodes[L.from];
+            pos = nodes[L.from] + dir*(I.s/L.length);
+            dir.normalize();
+        }
+
+        Matrix4d m;
+        MatrixLookAt( m, pos, pos+dir, Vec3d(0,1,0) );
+        t->setWorldMatrix(m);
+        I.moved = false;
+        N++;
+    }
+    return N;
+}
+
+void FSimulation::setGap(float g) { gap = max(g, 0.f); }
+void FSimulation::setTimeStep(float dt) { if (dt > 0) timeStep = dt; }
+
+double FSimulation::getTime() { return time; }
+vector<int> FSimulation::getDelivered() {
+    vector<int> res;
+    res.swap(delivered);
+    return res;
+}
+int FSimulation::getNodeCount() { return nodes.size(); }
+int FSimulation::getLaneCount() { return lanes.size(); }
+int FSimulation::getItemCount() { return items.size(); }
+
+int FSimulation::getMovingCount() {
+    int N = 0;
+    for (auto& L : lanes) N += L.items.size();
+    return N;
+}
+
+
 // --------------------------------------------------------------------- LOGISTICS
 
 
@@ -469,6 +711,11 @@ vector<shared_ptr<FContainer>> FLogistics::getContainers() {
 
 shared_ptr<FLogistics> FLogistics::create() { return shared_ptr<FLogistics>(new FLogistics()); }
 
+shared_ptr<FSimulation> FLogistics::getSimulation() {
+    if (!simulation) simulation = FSimulation::create();
+    return simulation;
+}
+
 void FLogistics::update() {
 
     static float t2 = 0;
@@ -480,4 +727,9 @@ void FLogistics::update() {
     for (t_ritr = transporter.rbegin(); t_ritr != transporter.rend(); t_ritr++) {
         t_ritr->second->update(dt);
     }
+
+    if (simulation) {
+        simulation->advance(dt);
+        simulation->sync();
+    }
 }
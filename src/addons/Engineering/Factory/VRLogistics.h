@@ -4,6 +4,7 @@
 #include <map>
 #include <vector>
 #include <stack>
+#include <deque>
 #include <memory>
 
 #include <OpenSG/OSGVector.h>
@@ -17,6 +18,7 @@ class FNetwork;
 class FProduct;
 class FStack;
 class FTransporter;
+class FSimulation;
 class FLogistics;
 
 using namespace std;
@@ -201,8 +203,87 @@ class FTransporter : public FID {
         friend class FLogistics;
 };
 
+/**
+    Simulation core for large transport networks, independent of the scene graph.
+    Nodes, lanes and items live in flat arrays, a lane is a conveyor between two nodes on which items queue up with a minimal gap.
+    Items are routed to their target node along the shortest path, lanes are stepped in parallel with a fixed time step,
+    lanes without moving items are skipped. Items waiting at the lane end or at their start node enter the next lane when it has space.
+    Only the transformations of visible objects of moved items are updated by sync.
+*/
+class FSimulation {
+    public:
+        struct Item {
+            int lane = -1;
+            int node = -1; // start or target node while not on a lane
+            int target = -1;
+            float s = 0; // position along the lane
+            bool moved = false; // since the last sync
+            bool delivered = false;
+        };
+
+    private:
+        struct Lane {
+            int from = 0;
+            int to = 0;
+            float length = 1;
+            float speed = 1;
+            bool idle = false; // no item moved in the last step
+            std::deque<int> items; // front item is the most advanced
+        };
+
+        std::vector<OSG::Vec3d> nodes;
+        std::vector<std::vector<int>> outLanes;
+        std::vector<std::deque<int>> waiting; // items waiting at a node to enter a lane
+        std::vector<Lane> lanes;
+        std::vector<Item> items;
+        std::vector<shared_ptr<FObject>> objects; // one for each item, may be 0
+        std::map<int, std::vector<int>> routes; // next lane for each node, by target node
+        std::map<int, int> fnodes; // FNode ID to node
+        std::vector<int> active; // lanes with items
+
+        float gap = 0.5;
+        float timeStep = 0.02;
+        double time = 0;
+        double accumulated = 0;
+        std::vector<int> delivered;
+
+        std::vector<int>& getRoute(int target);
+        int nextLane(int node, int target);
+        bool enter(int item, int lane);
+        void moveLane(int lane, float dt);
+
+    public:
+        FSimulation();
+        ~FSimulation();
+        static shared_ptr<FSimulation> create();
+
+        int addNode(OSG::Vec3d p);
+        int addLane(int from, int to, float speed = 1);
+        void addNetwork(shared_ptr<FNetwork> n, float speed = 1); // nodes with transformation only
+        int getNode(shared_ptr<FNode> n);
+
+        int addItem(int node, int target, shared_ptr<FObject> o = 0);
+        void send(int item, int target); // an item waiting or delivered at a node
+        Item getItem(int item);
+
+        void setGap(float g);
+        void setTimeStep(float dt);
+
+        void step(float dt);
+        int advance(double dt); // fixed steps for the accumulated time, returns the number of steps
+        int sync(); // returns the number of updated transformations
+
+        double getTime();
+        std::vector<int> getDelivered(); // items delivered since the last call
+        int getNodeCount();
+        int getLaneCount();
+        int getItemCount();
+        int getMovingCount();
+};
+
 class FLogistics {
     private:
+        shared_ptr<FSimulation> simulation;
         std::map<int, shared_ptr<FNetwork>> networks;
         std::map<int, shared_ptr<FObject>> objects;
         std::map<int, shared_ptr<FTransporter>> transporter;
@@ -224,6 +305,7 @@ class FLogistics {
         shared_ptr<FContainer> addContainer(OSG::VRTransformPtr t);
         void fillContainer(shared_ptr<FContainer> c, int N, OSG::VRTransformPtr t);
         std::vector<shared_ptr<FContainer>> getContainers();
+        shared_ptr<FSimulation> getSimulation();
 
         void update();
         void run();
@@ -4,6 +4,9 @@
 
 #include <OpenSG/OSGGeoProperties.h>
 #include <OpenSG/OSGGeometry.h>
+#include <algorithm>
+#include <deque>
+#include <cmath>
 
 OSG_BEGIN_NAMESPACE;
 
@@ -77,10 +80,26 @@ bool MChange::same(MChange c) {
     return true;
 }
 
-bool MPart::propagateMovement() { // recursion
+bool MPart::propagateMovement() { // breadth first walk over the engagement graph
     bool res = true;
-    for (auto n : neighbors) {
-        res = n.first->propagateMovement(change, n.second) ? res : false;
+    deque<MPart*> front;
+    front.push_back(this);
+    while (front.size()) {
+        MPart* p = front.front();
+        front.pop_front();
+        for (auto n : p->neighbors) {
+            MPart* q = n.first;
+            MChange c = p->change;
+            n.second->translateChange(c);
+            if (q->change.time == c.time) {
+                if (!q->change.same(c)) res = false;
+                continue;
+            } // TODO: either it is the same change || another change in the same timestep..
+
+            q->change = c;
+            q->move();
+            front.push_back(q);
+        }
     }
     return res;
 }
@@ -222,6 +241,8 @@ VRGear* MGear::gear() { return (VRGear*)prim; }
 VRThread* MThread::thread() { return (VRThread*)prim; }
 
 void MPart::move() {}
+float MPart::getBoundingRadius() { return -1; }
+float MGear::getBoundingRadius() { return gear()->radius() + gear()->teeth_size; }
 void MGear::move() { trans->rotate(change.dx/gear()->radius(), Vec3d(0,0,1)); }
 void MChain::move() { if (geo == 0) return; updateGeo(); }
 void MThread::move() { trans->rotate(change.a, Vec3d(0,0,1)); }
@@ -410,6 +431,81 @@ VRGeometryPtr MChain::init() {
     return geo;
 }
 
+// -------------- broadphase ------------------------
+
+long long MBroadphase::key(Vec3d p) {
+    const long long m = (1<<21)-1;
+    long long c[3];
+    for (int i=0; i<3; i++) c[i] = (long long)floor(p[i]/cellSize) & m;
+    return (c[0] << 42) | (c[1] << 21) | c[2];
+}
+
+void MBroadphase::unbin(MPart* p) {
+    auto b = bins.find(p);
+    if (b == bins.end()) return;
+    auto cell = cells.find(b->second);
+    auto& v = cell->second;
+    v.erase( remove(v.begin(), v.end(), p), v.end() );
+    if (v.size() == 0) cells.erase(cell);
+    bins.erase(b);
+}
+
+void MBroadphase::add(MPart* p) {
+    float r = p->getBoundingRadius();
+    if (r < 0) { unbounded.push_back(p); return; }
+
+    float s = max(2*r, 1e-3f);
+    if (s > cellSize) { // cells have to grow, bin all parts again
+        cellSize = s;
+        vector<MPart*> binned;
+        for (auto b : bins) binned.push_back(b.first);
+        cells.clear();
+        bins.clear();
+        for (auto b : binned) {
+            long long k = key(Vec3d(b->reference[3]));
+            bins[b] = k;
+            cells[k].push_back(b);
+        }
+    }
+
+    long long k = key(Vec3d(p->reference[3]));
+    bins[p] = k;
+    cells[k].push_back(p);
+}
+
+void MBroadphase::update(MPart* p) {
+    auto b = bins.find(p);
+    if (b == bins.end()) return;
+    long long k = key(Vec3d(p->reference[3]));
+    if (b->second == k) return;
+    unbin(p);
+    bins[p] = k;
+    cells[k].push_back(p);
+}
+
+void MBroadphase::clear() {
+    cellSize = 0;
+    cells.clear();
+    bins.clear();
+    unbounded.clear();
+}
+
+vector<MPart*> MBroadphase::getCandidates(MPart* p, const vector<MPart*>& all) {
+    if (bins.count(p) == 0) return all;
+    vector<MPart*> res = unbounded;
+    Vec3d c = Vec3d(p->reference[3]);
+    for (int i=-1; i<=1; i++) {
+        for (int j=-1; j<=1; j++) {
+            for (int k=-1; k<=1; k++) {
+                auto cell = cells.find( key(c + Vec3d(i,j,k)*cellSize) );
+                if (cell == cells.end()) continue;
+                for (auto q : cell->second) if (find(res.begin(), res.end(), q) == res.end()) res.push_back(q);
+            }
+        }
+    }
+    return res;
+}
+
 // -------------- mechanism ------------------------
 
 VRMechanism::VRMechanism() {;}
@@ -418,13 +514,18 @@ void VRMechanism::clear() {
     for (auto part : parts) delete part;
     parts.clear();
     cache.clear();
+    broadphase.clear();
 }
 
+void VRMechanism::setBroadphase(bool b) { useBroadphase = b; }
+
 void VRMechanism::add(VRGeometryPtr part, VRTransformPtr trans) {
     MPart* p = MPart::make(part, trans);
     if (p == 0) return;
+    p->apply();
     cache[part] = p;
     parts.push_back(p);
+    broadphase.add(p);
 }
 
 VRGeometryPtr VRMechanism::addChain(float w, vector<VRGeometryPtr> geos, string dirs) {
@@ -452,6 +553,7 @@ VRGeometryPtr VRMechanism::addChain(float w, vector<VRGeometryPtr> geos, string
     }
     c->setDirs(dirs);
     parts.push_back(c);
+    broadphase.add(c);
     return c->init();
 }
 
@@ -467,7 +569,7 @@ void VRMechanism::update() {
     for (auto& part : parts) if (part->changed()) changed_parts.push_back(part);
 
     for (auto& part : changed_parts) {
-        part->updateNeighbors(parts);
+        part->updateNeighbors( useBroadphase ? broadphase.getCandidates(part, parts) : parts );
         part->computeState();
         part->computeChange();
         //part->printChange();
@@ -484,7 +586,10 @@ void VRMechanism::update() {
         }
     }
 
-    for (auto part : parts) part->apply();
+    for (auto part : parts) {
+        part->apply();
+        broadphase.update(part);
+    }
     for (auto part : changed_parts) part->changed();
 }
 
@@ -2,6 +2,7 @@
 #define VRMECHANISM_H_INCLUDED
 
 #include <vector>
+#include <unordered_map>
 #include <OpenSG/OSGVector.h>
 #include "core/objects/geometry/VRGeometry.h"
 
@@ -103,6 +104,7 @@ class MPart {
 
         virtual void computeChange();
         virtual void move();
+        virtual float getBoundingRadius();
         virtual void updateNeighbors(vector<MPart*> parts) = 0;
 
         static MPart* make(VRGeometryPtr g, VRTransformPtr t);
@@ -117,6 +119,7 @@ class MGear : public MPart {
 
         void computeChange();
         void move();
+        float getBoundingRadius();
         void updateNeighbors(vector<MPart*> parts);
 };
 
@@ -155,10 +158,34 @@ class MChain : public MPart {
         void updateNeighbors(vector<MPart*> parts);
 };
 
+/**
+    Uniform grid over the reference positions of the parts, the cells are as large as the biggest part,
+    so engaging parts are always in neighbouring cells. A part is only moved to another cell when its
+    reference position changes. Parts without bounds (chains, threads) are candidates for every part.
+*/
+class MBroadphase {
+    private:
+        float cellSize = 0;
+        unordered_map<long long, vector<MPart*>> cells;
+        unordered_map<MPart*, long long> bins;
+        vector<MPart*> unbounded;
+
+        long long key(Vec3d p);
+        void unbin(MPart* p);
+
+    public:
+        void add(MPart* p);
+        void update(MPart* p);
+        void clear();
+        vector<MPart*> getCandidates(MPart* p, const vector<MPart*>& all);
+};
+
 class VRMechanism {
     private:
         map<VRGeometryPtr, MPart*> cache;
         vector<MPart*> parts;
+        MBroadphase broadphase;
+        bool useBroadphase = true;
 
     public:
         VRMechanism();
@@ -168,6 +195,7 @@ class VRMechanism {
         void add(VRGeometryPtr part, VRTransformPtr trans = 0);
         void clear();
         void update();
+        void setBroadphase(bool b);
         VRGeometryPtr addChain(float w, vector<VRGeometryPtr> geos, string dirs);
 };
 
@@ -12,6 +12,7 @@ PyMethodDef VRPyMechanism::methods[] = {
     {"update", (PyCFunction)VRPyMechanism::update, METH_NOARGS, "Update mechanism simulation" },
     {"clear", (PyCFunction)VRPyMechanism::clear, METH_NOARGS, "Clear mechanism parts" },
     {"addChain", (PyCFunction)VRPyMechanism::addChain, METH_VARARGS, "Add chain - addChain(float width, [G1, G2, G3, ...])" },
+    {"setBroadphase", (PyCFunction)VRPyMechanism::setBroadphase, METH_VARARGS, "Use the grid broadphase to find engaging parts, else every part is checked against all others - setBroadphase(bool)" },
     {NULL}  /* Sentinel */
 };
 
@@ -49,3 +50,9 @@ PyObject* VRPyMechanism::addChain(VRPyMechanism* self, PyObject* args) {
     }
     return VRPyTypeCaster::cast( self->objPtr->addChain(w, geos, PyString_AsString(dirs) ) );
 }
+
+PyObject* VRPyMechanism::setBroadphase(VRPyMechanism* self, PyObject* args) {
+    if (!self->valid()) return NULL;
+    self->objPtr->setBroadphase( parseBool(args) );
+    Py_RETURN_TRUE;
+}
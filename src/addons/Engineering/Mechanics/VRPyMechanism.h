@@ -13,6 +13,7 @@ struct VRPyMechanism : VRPyBaseT<OSG::VRMechanism> {
     static PyObject* clear(VRPyMechanism* self);
     static PyObject* update(VRPyMechanism* self);
     static PyObject* addChain(VRPyMechanism* self, PyObject* args);
+    static PyObject* setBroadphase(VRPyMechanism* self, PyObject* args);
 };
 
 #endif // VRPYMECHANISM_H_INCLUDED
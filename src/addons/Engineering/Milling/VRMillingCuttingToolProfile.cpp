@@ -33,6 +33,8 @@ float VRMillingCuttingToolProfile::getLength() {
     return 0;
 }
 
+vector<Vec2d> VRMillingCuttingToolProfile::getProfile() { return profile; }
+
 float VRMillingCuttingToolProfile::maxProfile(Vec3d toolPosition, Vec3d cubePosition, Vec3d cubeSize) {
     float py = cubePosition[1];
     float sy = cubeSize[1];
@@ -28,6 +28,7 @@ class VRMillingCuttingToolProfile {
         void addPointProfile(Vec2d point);
         float maxProfile(Vec3d position, Vec3d cubePosition, Vec3d cubeSize);
         float getLength();
+        vector<Vec2d> getProfile();
 };
 
 OSG_END_NAMESPACE;
@@ -0,0 +1,242 @@
+#include "VRMillingDexels.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace OSG;
+
+VRMillingDexels::VRMillingDexels() {}
+VRMillingDexels::~VRMillingDexels() {}
+
+VRMillingDexelsPtr VRMillingDexels::create() { return VRMillingDexelsPtr( new VRMillingDexels() ); }
+
+int VRMillingDexels::getRaysX() { return nx; }
+int VRMillingDexels::getRaysZ() { return nz; }
+float VRMillingDexels::getCellSize() { return cell; }
+int VRMillingDexels::getTileCount() { return tilesX*tilesZ; }
+const vector<VRMillingDexels::Segment>& VRMillingDexels::getSegments(int i, int k) { return rays[i+k*nx]; }
+
+void VRMillingDexels::init(Vec3d min, Vec3d s, float cellSize) {
+    origin = min;
+    size = s;
+    cell = cellSize;
+    nx = max(1, int(round(size[0]/cell)));
+    nz = max(1, int(round(size[2]/cell)));
+    Segment full = { float(origin[1]), float(origin[1]+size[1]) };
+    rays.assign(nx*nz, vector<Segment>(1, full));
+    setTileSize(tileSize);
+}
+
+void VRMillingDexels::setTileSize(int n) {
+    tileSize = max(1, n);
+    tilesX = (nx+tileSize-1)/tileSize;
+    tilesZ = (nz+tileSize-1)/tileSize;
+    dirty.assign(tilesX*tilesZ, 1);
+}
+
+void VRMillingDexels::setTool(const vector<Vec2d>& p) {
+    profile = p;
+    sort(profile.begin(), profile.end(), [](const Vec2d& a, const Vec2d& b) { return a[0] < b[0]; });
+    toolRadius = 0;
+    for (auto& q : profile) toolRadius = max(toolRadius, float(q[1]));
+}
+
+bool VRMillingDexels::radiusRange(float d, float& h0, float& h1) { // heights of the tool where its radius is at least d
+    h0 = 1e30;
+    h1 = -1e30;
+    if (profile.size() == 1 && profile[0][1] >= d) { h0 = h1 = profile[0][0]; }
+    for (unsigned int k=0; k+1<profile.size(); k++) {
+        float ha = profile[k][0], ra = profile[k][1];
+        float hb = profile[k+1][0], rb = profile[k+1][1];
+        if (ra < d && rb < d) continue;
+        float a = ha, b = hb;
+        if (ra < d) a = ha + (d-ra)/(rb-ra)*(hb-ha);
+        if (rb < d) b = ha + (d-ra)/(rb-ra)*(hb-ha);
+        h0 = min(h0, a);
+        h1 = max(h1, b);
+    }
+    return h0 <= h1;
+}
+
+bool VRMillingDexels::removeInterval(vector<Segment>& ray, float a, float b) {
+    bool overlap = false;
+    for (auto& s : ray) if (s.y1 > a && s.y0 < b) { overlap = true; break; }
+    if (!overlap) return false;
+
+    vector<Segment> res;
+    res.reserve(ray.size()+1);
+    for (auto& s : ray) {
+        if (s.y1 <= a || s.y0 >= b) { res.push_back(s); continue; }
+        if (a - s.y0 > 1e-6) res.push_back({s.y0, a});
+        if (s.y1 - b > 1e-6) res.push_back({b, s.y1});
+    }
+    ray.swap(res);
+    return true;
+}
+
+void VRMillingDexels::markDirty(int i, int k) { // the faces of a ray are also part of its neighbours mesh
+    int tx = i/tileSize, tz = k/tileSize;
+    int ix = i%tileSize, iz = k%tileSize;
+    int T[5] = { tx + tz*tilesX, -1, -1, -1, -1 };
+    if (ix == 0 && tx > 0) T[1] = T[0]-1;
+    if (ix == tileSize-1 && tx < tilesX-1) T[2] = T[0]+1;
+    if (iz == 0 && tz > 0) T[3] = T[0]-tilesX;
+    if (iz == tileSize-1 && tz < tilesZ-1) T[4] = T[0]+tilesX;
+    for (int t : T) {
+        if (t < 0) continue;
+        #pragma omp atomic write
+        dirty[t] = 1;
+    }
+}
+
+int VRMillingDexels::cut(Vec3d tip) { return cutSegment(tip, tip); }
+
+int VRMillingDexels::cutPath(const vector<Vec3d>& path) {
+    int n = 0;
+    if (path.size() == 1) n += cut(path[0]);
+    for (unsigned int i=1; i<path.size(); i++) n += cutSegment(path[i-1], path[i]);
+    return n;
+}
+
+int VRMillingDexels::cutSegment(Vec3d p0, Vec3d p1) {
+    if (rays.size() == 0 || profile.size() == 0) return 0;
+    double R = toolRadius;
+    double ax = p0[0]-origin[0], az = p0[2]-origin[2];
+    double bx = p1[0]-origin[0], bz = p1[2]-origin[2];
+    double ya = p0[1], yb = p1[1];
+    double ex = bx-ax, ez = bz-az;
+    double L2 = ex*ex + ez*ez;
+
+    int i0 = max(0, int(floor((min(ax,bx)-R)/cell)));
+    int i1 = min(nx-1, int(floor((max(ax,bx)+R)/cell)));
+    int k0 = max(0, int(floor((min(az,bz)-R)/cell)));
+    int k1 = min(nz-1, int(floor((max(az,bz)+R)/cell)));
+    if (i0 > i1 || k0 > k1) return 0;
+
+    int changed = 0;
+    #pragma omp parallel for reduction(+:changed) schedule(dynamic)
+    for (int k=k0; k<=k1; k++) {
+        for (int i=i0; i<=i1; i++) {
+            double cx = (i+0.5)*cell, cz = (k+0.5)*cell;
+
+            // parameter range of the move where the ray is below the tool
+            double t0 = 0, t1 = 1, tc = 0;
+            if (L2 > 1e-12) {
+                tc = ((cx-ax)*ex + (cz-az)*ez)/L2;
+                double qx = ax+tc*ex-cx, qz = az+tc*ez-cz;
+                double d2 = qx*qx + qz*qz;
+                if (d2 > R*R) continue;
+                double w = sqrt((R*R-d2)/L2);
+                t0 = max(0.0, tc-w);
+                t1 = min(1.0, tc+w);
+                if (t0 > t1) continue;
+                tc = min(max(tc, 0.0), 1.0);
+            } else {
+                double qx = ax-cx, qz = az-cz;
+                if (qx*qx + qz*qz > R*R) continue;
+            }
+
+            // for horizontal moves the closest tool position cuts deepest, else sample the move
+            float lo = 1e30, hi = -1e30;
+            auto sample = [&](double t) {
+                double qx = ax+t*ex-cx, qz = az+t*ez-cz;
+                float h0, h1;
+                if (!radiusRange(sqrt(qx*qx + qz*qz), h0, h1)) return;
+                double y = ya + t*(yb-ya);
+                lo = min(lo, float(y+h0));
+                hi = max(hi, float(y+h1));
+            };
+            sample(tc);
+            int K = min(256, 1 + int(ceil(abs(yb-ya)*(t1-t0)/(0.25*cell))));
+            if (K > 1) for (int s=0; s<K; s++) sample(t0 + (t1-t0)*s/(K-1));
+            if (lo > hi) continue;
+
+            if (removeInterval(rays[i+k*nx], lo, hi)) {
+                markDirty(i, k);
+                changed++;
+            }
+        }
+    }
+    return changed;
+}
+
+double VRMillingDexels::getVolume() {
+    double V = 0;
+    for (auto& r : rays) for (auto& s : r) V += s.y1-s.y0;
+    return V*cell*cell;
+}
+
+vector<int> VRMillingDexels::getDirtyTiles() {
+    vector<int> res;
+    for (unsigned int t=0; t<dirty.size(); t++) if (dirty[t]) res.push_back(t);
+    return res;
+}
+
+const vector<VRMillingDexels::Segment>* VRMillingDexels::getRay(int i, int k) {
+    if (i < 0 || k < 0 || i >= nx || k >= nz) return 0;
+    return &rays[i+k*nx];
+}
+
+void VRMillingDexels::buildTile(int tile, Mesh& mesh) {
+    mesh.positions.clear();
+    mesh.normals.clear();
+    int tx = tile%tilesX, tz = tile/tilesX;
+
+    auto quad = [&](Vec3f a, Vec3f b, Vec3f c, Vec3f d, Vec3f n) {
+        mesh.positions.push_back(a);
+        mesh.positions.push_back(b);
+        mesh.positions.push_back(c);
+        mesh.positions.push_back(d);
+        for (int j=0; j<4; j++) mesh.normals.push_back(n);
+    };
+
+    vector<Segment> exposed;
+    auto subtract = [&](const vector<Segment>& own, const vector<Segment>* other) { // parts of own not covered by other
+        exposed.clear();
+        for (auto& s : own) {
+            float y = s.y0;
+            if (other) {
+                for (auto& o : *other) {
+                    if (o.y1 <= y) continue;
+                    if (o.y0 >= s.y1) break;
+                    if (o.y0 > y) exposed.push_back({y, o.y0});
+                    y = max(y, o.y1);
+                    if (y >= s.y1) break;
+                }
+            }
+            if (y < s.y1) exposed.push_back({y, s.y1});
+        }
+    };
+
+    for (int k=tz*tileSize; k<min(nz, (tz+1)*tileSize); k++) {
+        for (int i=tx*tileSize; i<min(nx, (tx+1)*tileSize); i++) {
+            auto& ray = rays[i+k*nx];
+            if (ray.size() == 0) continue;
+            float x0 = origin[0] + i*cell, x1 = x0 + cell;
+            float z0 = origin[2] + k*cell, z1 = z0 + cell;
+
+            for (auto& s : ray) {
+                quad(Vec3f(x0,s.y1,z0), Vec3f(x0,s.y1,z1), Vec3f(x1,s.y1,z1), Vec3f(x1,s.y1,z0), Vec3f(0,1,0));
+                quad(Vec3f(x0,s.y0,z0), Vec3f(x1,s.y0,z0), Vec3f(x1,s.y0,z1), Vec3f(x0,s.y0,z1), Vec3f(0,-1,0));
+            }
+
+            subtract(ray, getRay(i+1,k));
+            for (auto& s : exposed) quad(Vec3f(x1,s.y0,z0), Vec3f(x1,s.y1,z0), Vec3f(x1,s.y1,z1), Vec3f(x1,s.y0,z1), Vec3f(1,0,0));
+            subtract(ray, getRay(i-1,k));
+            for (auto& s : exposed) quad(Vec3f(x0,s.y0,z0), Vec3f(x0,s.y0,z1), Vec3f(x0,s.y1,z1), Vec3f(x0,s.y1,z0), Vec3f(-1,0,0));
+            subtract(ray, getRay(i,k+1));
+            for (auto& s : exposed) quad(Vec3f(x0,s.y0,z1), Vec3f(x1,s.y0,z1), Vec3f(x1,s.y1,z1), Vec3f(x0,s.y1,z1), Vec3f(0,0,1));
+            subtract(ray, getRay(i,k-1));
+            for (auto& s : exposed) quad(Vec3f(x0,s.y0,z0), Vec3f(x0,s.y1,z0), Vec3f(x1,s.y1,z0), Vec3f(x1,s.y0,z0), Vec3f(0,0,-1));
+        }
+    }
+}
+
+vector<int> VRMillingDexels::remesh(vector<Mesh>& meshes) {
+    vector<int> tiles = getDirtyTiles();
+    meshes.resize(tiles.size());
+    #pragma omp parallel for schedule(dynamic)
+    for (unsigned int j=0; j<tiles.size(); j++) buildTile(tiles[j], meshes[j]);
+    for (int t : tiles) dirty[t] = 0;
+    return tiles;
+}
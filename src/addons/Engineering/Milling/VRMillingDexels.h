@@ -0,0 +1,77 @@
+#ifndef VRMILLINGDEXELS_H_INCLUDED
+#define VRMILLINGDEXELS_H_INCLUDED
+
+#include <OpenSG/OSGVector.h>
+#include <vector>
+#include "core/objects/VRObjectFwd.h"
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Dexel model of a milling workpiece, a grid of rays in the xz plane, each ray along y stores the
+    material as sorted list of intervals. The tool is a body of revolution around the y axis given by its
+    profile (height above the tip, radius), a linear tool move subtracts the swept tool from all rays below it.
+    The grid is split into tiles, only tiles touched by a cut are meshed again.
+*/
+
+class VRMillingDexels {
+    public:
+        struct Segment {
+            float y0, y1;
+        };
+
+        struct Mesh { // quads
+            vector<Vec3f> positions;
+            vector<Vec3f> normals;
+        };
+
+    private:
+        int nx = 0;
+        int nz = 0;
+        float cell = 0.01;
+        Vec3d origin;
+        Vec3d size;
+        vector< vector<Segment> > rays;
+
+        vector<Vec2d> profile; // height above tip, radius
+        float toolRadius = 0;
+
+        int tileSize = 32;
+        int tilesX = 0;
+        int tilesZ = 0;
+        vector<char> dirty;
+
+        bool radiusRange(float d, float& h0, float& h1);
+        bool removeInterval(vector<Segment>& ray, float a, float b);
+        void markDirty(int i, int k);
+        const vector<Segment>* getRay(int i, int k);
+
+    public:
+        VRMillingDexels();
+        ~VRMillingDexels();
+        static VRMillingDexelsPtr create();
+
+        void init(Vec3d min, Vec3d size, float cellSize);
+        void setTool(const vector<Vec2d>& profile);
+        void setTileSize(int n);
+
+        int cut(Vec3d tip);
+        int cutSegment(Vec3d p0, Vec3d p1);
+        int cutPath(const vector<Vec3d>& path);
+
+        int getRaysX();
+        int getRaysZ();
+        float getCellSize();
+        double getVolume();
+        const vector<Segment>& getSegments(int i, int k);
+
+        int getTileCount();
+        vector<int> getDirtyTiles();
+        void buildTile(int tile, Mesh& mesh);
+        vector<int> remesh(vector<Mesh>& meshes);
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRMILLINGDEXELS_H_INCLUDED
@@ -1,8 +1,10 @@
 #include "VRMillingWorkPiece.h"
 #include "core/scene/VRScene.h"
 #include "core/math/pose.h"
+#include "VRMillingDexels.h"
 
 #include <boost/bind.hpp>
+#include <iostream>
 
 OSG_BEGIN_NAMESPACE
 using namespace std;
@@ -23,6 +25,7 @@ void VRMillingWorkPiece::setCuttingTool(VRTransformPtr geo) {
 
 void VRMillingWorkPiece::setCuttingProfile(shared_ptr<VRMillingCuttingToolProfile> profile) {
     cuttingProfile = profile;
+    if (dexels && profile) dexels->setTool(profile->getProfile());
 }
 
 void VRMillingWorkPiece::init(Vec3i gSize, float bSize) {
@@ -39,6 +42,10 @@ void VRMillingWorkPiece::init(Vec3i gSize, float bSize) {
         rootElement = nullptr;
     }
 
+    dexels.reset();
+    for (auto g : dexelTiles) if (g) g->destroy();
+    dexelTiles.clear();
+
     int maxElements = gSize[0] * gSize[1] * gSize[2];
     maxTreeLevel = (int) std::log2(maxElements);
     geometryCreateLevel = 0;
@@ -54,8 +61,78 @@ void VRMillingWorkPiece::init(Vec3i gSize, float bSize) {
     rootElement->build();
 }
 
+/**
+ * dexel mode, the workpiece is a grid of gSize[0] x gSize[2] rays along y,
+ * material is removed with the swept tool profile and only the touched tiles are meshed again
+ */
+void VRMillingWorkPiece::initDexels(Vec3i gSize, float bSize) {
+    gridSize = gSize;
+    blockSize = bSize;
+
+    if (rootElement != nullptr) {
+        delete rootElement;
+        rootElement = nullptr;
+    }
+
+    for (auto g : dexelTiles) if (g) g->destroy();
+    dexelTiles.clear();
+
+    Vec3d size = Vec3d(gridSize) * blockSize;
+    dexels = VRMillingDexels::create();
+    dexels->init(-size*0.5, size, blockSize);
+    if (cuttingProfile) dexels->setTool(cuttingProfile->getProfile());
+    lastToolValid = false;
+    updateDexelGeometry();
+}
+
 void VRMillingWorkPiece::reset() {
-    init(gridSize, blockSize);
+    if (dexels) initDexels(gridSize, blockSize);
+    else init(gridSize, blockSize);
+}
+
+/**
+ * cuts along a tool path given in workpiece coordinates, the workpiece center is the origin
+ */
+void VRMillingWorkPiece::millPath(vector<Vec3d> path) {
+    if (!dexels) { cout << "VRMillingWorkPiece::millPath: only supported in dexel mode, use initDexels" << endl; return; }
+    if (cuttingProfile == nullptr) { cout << "VRMillingWorkPiece::millPath: no cutting profile" << endl; return; }
+    dexels->cutPath(path);
+    updateDexelGeometry();
+}
+
+double VRMillingWorkPiece::getVolume() { return dexels ? dexels->getVolume() : 0; }
+VRMillingDexelsPtr VRMillingWorkPiece::getDexels() { return dexels; }
+
+void VRMillingWorkPiece::updateDexelGeometry() {
+    vector<VRMillingDexels::Mesh> meshes;
+    vector<int> tiles = dexels->remesh(meshes); // in parallel
+    dexelTiles.resize(dexels->getTileCount());
+
+    for (unsigned int j=0; j<tiles.size(); j++) {
+        auto& geometry = dexelTiles[tiles[j]];
+        if (geometry == nullptr) {
+            geometry = VRGeometry::create("wpelem");
+            geometry->setType(GL_QUADS);
+            geometry->setMaterial(getMaterial());
+            addChild(geometry);
+        }
+
+        GeoPnt3fPropertyRecPtr positions = GeoPnt3fProperty::create();
+        GeoVec3fPropertyRecPtr normals = GeoVec3fProperty::create();
+        GeoUInt32PropertyRecPtr indices = GeoUInt32Property::create();
+        auto& mesh = meshes[j];
+        for (uint32_t i=0; i<mesh.positions.size(); i++) {
+            auto& p = mesh.positions[i];
+            positions->push_back(Pnt3f(p[0], p[1], p[2]));
+            normals->push_back(mesh.normals[i]);
+            indices->push_back(i);
+        }
+
+        geometry->setPositions(positions);
+        geometry->setNormals(normals);
+        geometry->setIndices(indices, true);
+        geometry->setPositionalTexCoords();
+    }
 }
 
 void VRMillingWorkPiece::update() {
@@ -73,6 +150,16 @@ void VRMillingWorkPiece::update() {
         toolPosition = geo->getWorldPosition();
     }
 
+    if (dexels) {
+        Vec3d p = toolPosition - getWorldPosition();
+        int n = lastToolValid ? dexels->cutSegment(lastToolPosition, p) : dexels->cut(p);
+        lastToolPosition = p;
+        lastToolValid = true;
+        if (n == 0) return;
+        if (updateCount++ % geometryUpdateWait == 0) updateDexelGeometry();
+        return;
+    }
+
     if (!rootElement->collide(toolPosition)) {
         return;
     }
@@ -83,7 +170,8 @@ void VRMillingWorkPiece::update() {
 }
 
 void VRMillingWorkPiece::updateGeometry() {
-    rootElement->build();
+    if (dexels) updateDexelGeometry();
+    else if (rootElement) rootElement->build();
 }
 
 void VRMillingWorkPiece::setLevelsPerGeometry(int levels) {
@@ -81,6 +81,13 @@ class VRMillingWorkPiece : public VRGeometry {
         void update();
         VRWorkpieceElement* rootElement;
 
+        // dexel mode
+        VRMillingDexelsPtr dexels;
+        vector<VRGeometryPtr> dexelTiles;
+        Vec3d lastToolPosition;
+        bool lastToolValid = false;
+        void updateDexelGeometry();
+
     public:
         float blockSize = 0.01;
         int geometryCreateLevel = 0;
@@ -91,11 +98,16 @@ class VRMillingWorkPiece : public VRGeometry {
         VRMillingWorkPiecePtr ptr();
         static VRMillingWorkPiecePtr create(string name = "millingWorkPiece");
         void init(Vec3i gSize, float bSize = 0.01);
+        void initDexels(Vec3i gSize, float bSize = 0.01);
         void reset();
 
         void setCuttingTool(VRTransformPtr geo);
         void setCuttingProfile(shared_ptr<VRMillingCuttingToolProfile> profile);
 
+        void millPath(vector<Vec3d> path);
+        double getVolume();
+        VRMillingDexelsPtr getDexels();
+
         void updateGeometry();
         void setLevelsPerGeometry(int levels);  // this will take effect after the next reset
         void setRefreshWait(int updatesToWait); // this will take effect immediately
@@ -13,8 +13,17 @@ PyMethodDef VRPyMillingWorkPiece::methods[] = {
         " float sizeOfSmallestBlock ). sizeOfSmallestBlock is the edge length of the smallest cube"
         " while the blocksPerDimension will determine the size of the Workpiece."
         " For example ([1000, 1000, 1000], 0.01) will give a cube of the length x,y,z = 10"},
+    {"initDexels", (PyCFunction)VRPyMillingWorkPiece::initDexels, METH_VARARGS,
+        "Init the workpiece as dexel model - initDexels( [int] blocksPerDimension, float sizeOfSmallestBlock )."
+        " blocksPerDimension x and z give the number of dexel rays, y only the height of the workpiece."
+        " Suited for high resolutions, only the touched regions are meshed again"},
     {"reset", (PyCFunction)VRPyMillingWorkPiece::reset, METH_NOARGS,
         "resets the whole milling workpiece"},
+    {"millPath", (PyCFunction)VRPyMillingWorkPiece::millPath, METH_VARARGS,
+        "Remove the material swept by the cutting tool along a path, dexel mode only - millPath( [[x,y,z]] )."
+        " The points are the tool tip in workpiece coordinates, the workpiece center is the origin" },
+    {"getVolume", (PyCFunction)VRPyMillingWorkPiece::getVolume, METH_NOARGS,
+        "Return the remaining material volume, dexel mode only - float getVolume()" },
     {"setCuttingTool", (PyCFunction)VRPyMillingWorkPiece::setCuttingTool, METH_VARARGS,
         "Set cutting tool geometry - setCuttingTool(geo)" },
     {"setRefreshWait", (PyCFunction)VRPyMillingWorkPiece::setRefreshWait, METH_VARARGS,
@@ -47,6 +56,29 @@ PyObject* VRPyMillingWorkPiece::init(VRPyMillingWorkPiece* self, PyObject* args)
     Py_RETURN_TRUE;
 }
 
+PyObject* VRPyMillingWorkPiece::initDexels(VRPyMillingWorkPiece* self, PyObject* args) {
+    if (!self->valid()) return NULL;
+    PyObject* vec; float s;
+    if (! PyArg_ParseTuple(args, "Of", &vec, &s)) return NULL;
+    self->objPtr->initDexels(parseVec3iList(vec), s);
+    Py_RETURN_TRUE;
+}
+
+PyObject* VRPyMillingWorkPiece::millPath(VRPyMillingWorkPiece* self, PyObject* args) {
+    if (!self->valid()) return NULL;
+    PyObject* v;
+    if (! PyArg_ParseTuple(args, "O", &v)) return NULL;
+    vector<Vec3d> path;
+    for (int i=0; i<pySize(v); i++) path.push_back( parseVec3dList( PyList_GetItem(v,i) ) );
+    self->objPtr->millPath(path);
+    Py_RETURN_TRUE;
+}
+
+PyObject* VRPyMillingWorkPiece::getVolume(VRPyMillingWorkPiece* self) {
+    if (!self->valid()) return NULL;
+    return PyFloat_FromDouble( self->objPtr->getVolume() );
+}
+
 PyObject* VRPyMillingWorkPiece::setCuttingTool(VRPyMillingWorkPiece* self, PyObject* args) {
     if (!self->valid()) return NULL;
     VRPyTransform* geo;
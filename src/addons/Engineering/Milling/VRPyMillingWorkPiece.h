@@ -8,7 +8,10 @@ struct VRPyMillingWorkPiece : VRPyBaseT<OSG::VRMillingWorkPiece> {
     static PyMethodDef methods[];
 
     static PyObject* init(VRPyMillingWorkPiece* self, PyObject* args);
+    static PyObject* initDexels(VRPyMillingWorkPiece* self, PyObject* args);
     static PyObject* reset(VRPyMillingWorkPiece* self);
+    static PyObject* millPath(VRPyMillingWorkPiece* self, PyObject* args);
+    static PyObject* getVolume(VRPyMillingWorkPiece* self);
     static PyObject* setCuttingTool(VRPyMillingWorkPiece* self, PyObject* args);
     static PyObject* setCuttingToolProfile(VRPyMillingWorkPiece* self, PyObject* args);
     static PyObject* setRefreshWait(VRPyMillingWorkPiece* self, PyObject* args);
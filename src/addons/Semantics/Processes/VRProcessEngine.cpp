@@ -1,15 +1,269 @@
 #include "VRProcessEngine.h"
+#include "VRProcess.h"
+#include "core/scene/VRScene.h"
+
+#include <iostream>
+#include <functional>
+#include <boost/bind.hpp>
 
 using namespace OSG;
 
+bool VRProcessEngine::Event::operator<(const Event& e) const {
+    if (time != e.time) return time > e.time;
+    return seq > e.seq;
+}
+
 VRProcessEngine::VRProcessEngine() {}
-VRProcessEngine::~VRProcessEngine() {}
+
+VRProcessEngine::~VRProcessEngine() {
+    auto scene = VRScene::getCurrent();
+    if (scene && updateCb) scene->dropUpdateFkt(updateCb);
+}
 
 VRProcessEnginePtr VRProcessEngine::create() { return VRProcessEnginePtr( new VRProcessEngine() ); }
 
-void VRProcessEngine::setProcess(VRProcessPtr p) { process = p; }
+void VRProcessEngine::setProcess(VRProcessPtr p) {
+    process = p;
+    subjects.clear();
+    messages.clear();
+    if (!p || !p->getInteractionDiagram()) { reset(); return; }
+
+    // subjects and the messages between them
+    auto inter = p->getInteractionDiagram();
+    auto& nodes = inter->processnodes;
+    for (auto n : nodes) if (n.second && n.second->type == SUBJECT) subjects[n.first] = Subject();
+    auto& edges = inter->getEdges();
+    for (unsigned int i=0; i<edges.size(); i++) {
+        for (auto& e : edges[i]) {
+            if (!nodes.count(i) || !nodes.count(e.to)) continue;
+            auto n1 = nodes[i];
+            auto n2 = nodes[e.to];
+            if (n1->type == SUBJECT && n2->type == MESSAGE) messages[e.to].sender = i;
+            if (n1->type == MESSAGE && n2->type == SUBJECT) messages[i].receiver = e.to;
+        }
+    }
+    for (auto m = messages.begin(); m != messages.end();) {
+        if (m->second.sender < 0 || m->second.receiver < 0) m = messages.erase(m);
+        else m++;
+    }
+
+    // states and transitions of the behaviors, transition nodes connect two action nodes
+    for (auto& s : subjects) {
+        auto diag = p->getBehaviorDiagram(s.first);
+        if (!diag) continue;
+        for (auto n : diag->processnodes) {
+            if (!n.second || n.second->type != ACTION) continue;
+            s.second.states[n.first] = State();
+            if (s.second.initial < 0) s.second.initial = n.first;
+        }
+
+        auto& edges = diag->getEdges();
+        for (auto& st : s.second.states) {
+            if (st.first >= int(edges.size())) continue;
+            for (auto& e : edges[st.first]) {
+                if (e.to >= int(edges.size())) continue;
+                for (auto& e2 : edges[e.to]) {
+                    if (!s.second.states.count(e2.to)) continue;
+                    Transition t;
+                    t.node = e.to;
+                    t.target = e2.to;
+                    st.second.transitions.push_back(t);
+                }
+            }
+        }
+    }
+
+    reset();
+}
+
 VRProcessPtr VRProcessEngine::getProcess() { return process; }
 
-void VRProcessEngine::reset() {}
-void VRProcessEngine::run(float speed) {}
-void VRProcessEngine::pause() {}
+VRProcessEngine::State* VRProcessEngine::getState(int subject, int state) {
+    auto s = subjects.find(subject);
+    if (s == subjects.end()) return 0;
+    auto st = s->second.states.find(state);
+    if (st == s->second.states.end()) return 0;
+    return &st->second;
+}
+
+void VRProcessEngine::setSeed(unsigned int s) { seed = s; }
+
+void VRProcessEngine::setInstances(int subject, int N) {
+    if (!subjects.count(subject)) { cout << "VRProcessEngine::setInstances, unknown subject " << subject << endl; return; }
+    subjects[subject].instances = max(N, 0);
+}
+
+void VRProcessEngine::setInitialState(int subject, int state) {
+    if (!getState(subject, state)) { cout << "VRProcessEngine::setInitialState, unknown state " << state << " of subject " << subject << endl; return; }
+    subjects[subject].initial = state;
+}
+
+void VRProcessEngine::setDuration(int subject, int state, double t) {
+    auto s = getState(subject, state);
+    if (!s) { cout << "VRProcessEngine::setDuration, unknown state " << state << " of subject " << subject << endl; return; }
+    s->duration = max(t, 0.0);
+}
+
+void VRProcessEngine::setSendMessage(int subject, int state, int message) {
+    auto s = getState(subject, state);
+    if (!s) { cout << "VRProcessEngine::setSendMessage, unknown state " << state << " of subject " << subject << endl; return; }
+    if (message >= 0 && (!messages.count(message) || messages[message].sender != subject)) {
+        cout << "VRProcessEngine::setSendMessage, subject " << subject << " does not send message " << message << endl;
+        return;
+    }
+    s->send = message;
+}
+
+void VRProcessEngine::setReceiveMessage(int subject, int transition, int message) {
+    if (!subjects.count(subject)) { cout << "VRProcessEngine::setReceiveMessage, unknown subject " << subject << endl; return; }
+    if (message >= 0 && (!messages.count(message) || messages[message].receiver != subject)) {
+        cout << "VRProcessEngine::setReceiveMessage, subject " << subject << " does not receive message " << message << endl;
+        return;
+    }
+    for (auto& s : subjects[subject].states) {
+        for (auto& t : s.second.transitions) if (t.node == transition) t.message = message;
+    }
+}
+
+void VRProcessEngine::setMessageDelay(int message, double t) {
+    if (!messages.count(message)) { cout << "VRProcessEngine::setMessageDelay, unknown message " << message << endl; return; }
+    messages[message].delay = max(t, 0.0);
+}
+
+void VRProcessEngine::schedule(EVENT type, double t, int actor, int data, int from) {
+    Event e;
+    e.time = t;
+    e.seq = seq++;
+    e.type = type;
+    e.actor = actor;
+    e.data = data;
+    e.from = from;
+    calendar.push(e);
+}
+
+void VRProcessEngine::enter(int a, int state) {
+    auto& actor = actors[a];
+    actor.state = state;
+    actor.waiting = false;
+    if (auto s = getState(actor.subject, state)) schedule(STATE_DONE, time + s->duration, a, state);
+}
+
+void VRProcessEngine::leave(int a) {
+    auto& actor = actors[a];
+    auto s = getState(actor.subject, actor.state);
+    if (!s || s->transitions.size() == 0) return; // end state
+
+    vector<int> unguarded;
+    for (unsigned int i=0; i<s->transitions.size(); i++) if (s->transitions[i].message < 0) unguarded.push_back(i);
+    if (unguarded.size()) { enter(a, s->transitions[ unguarded[rng()%unguarded.size()] ].target); return; }
+
+    for (auto& t : s->transitions) {
+        auto m = actor.inbox.find(t.message);
+        if (m == actor.inbox.end()) continue;
+        actor.partners[ actors[m->second.front()].subject ] = m->second.front();
+        m->second.pop_front();
+        if (m->second.empty()) actor.inbox.erase(m);
+        enter(a, t.target);
+        return;
+    }
+    actor.waiting = true; // until a message arrives
+}
+
+void VRProcessEngine::handle(const Event& e) {
+    time = e.time;
+    processed++;
+    for (size_t v : { hash<double>()(e.time), size_t(e.type), size_t(e.actor), size_t(e.data), size_t(e.from) }) {
+        traceHash ^= v + 0x9e3779b9 + (traceHash << 6) + (traceHash >> 2);
+    }
+
+    auto& actor = actors[e.actor];
+    if (e.type == STATE_DONE) {
+        if (actor.state != e.data) return;
+        auto s = getState(actor.subject, actor.state);
+        if (s && s->send >= 0) {
+            auto& m = messages[s->send];
+            auto& r = subjects[m.receiver];
+            auto p = actor.partners.find(m.receiver);
+            if (p != actor.partners.end()) schedule(MESSAGE_ARRIVED, time + m.delay, p->second, s->send, e.actor);
+            else if (r.instances > 0) schedule(MESSAGE_ARRIVED, time + m.delay, r.firstActor + actor.instance % r.instances, s->send, e.actor);
+        }
+        leave(e.actor);
+    }
+
+    if (e.type == MESSAGE_ARRIVED) {
+        actor.inbox[e.data].push_back(e.from);
+        if (actor.waiting) leave(e.actor);
+    }
+}
+
+void VRProcessEngine::reset() {
+    calendar = priority_queue<Event>();
+    time = 0;
+    seq = 0;
+    processed = 0;
+    traceHash = 0;
+    rng.seed(seed);
+
+    actors.clear();
+    for (auto& s : subjects) {
+        s.second.firstActor = actors.size();
+        for (int i=0; i<s.second.instances; i++) {
+            Actor a;
+            a.subject = s.first;
+            a.instance = i;
+            actors.push_back(a);
+        }
+    }
+
+    for (unsigned int i=0; i<actors.size(); i++) {
+        auto& s = subjects[actors[i].subject];
+        if (s.initial >= 0) enter(i, s.initial);
+    }
+}
+
+bool VRProcessEngine::step() {
+    if (calendar.empty()) return false;
+    Event e = calendar.top();
+    calendar.pop();
+    handle(e);
+    return true;
+}
+
+int VRProcessEngine::simulate(double until) {
+    int N = 0;
+    while (!calendar.empty() && calendar.top().time <= until) { step(); N++; }
+    if (until > time) time = until;
+    return N;
+}
+
+void VRProcessEngine::update() { // simulated time follows the frame time
+    if (!running) return;
+    double dt = frameTimer.stop()*0.001;
+    frameTimer.start();
+    simulate(time + dt*speed);
+}
+
+void VRProcessEngine::run(float s) {
+    speed = s;
+    running = true;
+    frameTimer.start();
+    if (!updateCb) updateCb = VRUpdateCb::create("process_engine", boost::bind(&VRProcessEngine::update, this));
+    auto scene = VRScene::getCurrent();
+    if (scene) scene->addUpdateFkt(updateCb);
+}
+
+void VRProcessEngine::pause() {
+    running = false;
+    auto scene = VRScene::getCurrent();
+    if (scene && updateCb) scene->dropUpdateFkt(updateCb);
+}
+
+bool VRProcessEngine::isRunning() { return running; }
+
+double VRProcessEngine::getTime() { return time; }
+size_t VRProcessEngine::getEventCount() { return processed; }
+size_t VRProcessEngine::getQueueSize() { return calendar.size(); }
+size_t VRProcessEngine::getTraceHash() { return traceHash; }
+int VRProcessEngine::getActorCount() { return actors.size(); }
+int VRProcessEngine::getActorSubject(int actor) { return actor >= 0 && actor < int(actors.size()) ? actors[actor].subject : -1; }
+int VRProcessEngine::getActorState(int actor) { return actor >= 0 && actor < int(actors.size()) ? actors[actor].state : -1; }
@@ -3,20 +3,107 @@
 
 #include "addons/Semantics/VRSemanticsFwd.h"
 #include "core/math/VRMathFwd.h"
+#include "core/utils/VRFunctionFwd.h"
+#include "core/utils/VRTimer.h"
 #include <map>
+#include <queue>
+#include <deque>
+#include <random>
 #include <OpenSG/OSGVector.h>
 
 using namespace std;
 OSG_BEGIN_NAMESPACE;
 
+/**
+    Discrete event simulation of a subject oriented process.
+    Each subject of the interaction diagram is played by one or more actors walking through the states of its behavior diagram.
+    An actor leaves a state after its duration and sends the message of the state, if any, to an actor of the receiving subject,
+    the last actor of that subject it received a message from or else the one with the same instance number modulo the instances.
+    Transitions can wait for a message, unguarded transitions are taken first, a random one if there are several.
+    Events are ordered by time, simultaneous events by creation, with the same seed a run is replayed exactly.
+    run paces the simulation to the frame loop, simulate and step process the events as fast as possible.
+    Changed instances and initial states take effect with the next reset.
+*/
+
 class VRProcessEngine {
+    public:
+        enum EVENT {
+            STATE_DONE,
+            MESSAGE_ARRIVED
+        };
+
+        struct Event {
+            double time = 0;
+            long long seq = 0;
+            EVENT type = STATE_DONE;
+            int actor = 0;
+            int data = 0; // state or message node
+            int from = -1; // sending actor
+
+            bool operator<(const Event& e) const; // later events first, the calendar pops the earliest
+        };
+
     private:
+        struct Transition {
+            int node = -1; // transition node in the behavior diagram
+            int target = -1;
+            int message = -1; // message node in the interaction diagram to wait for, -1 if unguarded
+        };
+
+        struct State {
+            double duration = 1;
+            int send = -1; // message node sent when the state is left
+            vector<Transition> transitions;
+        };
+
+        struct Subject {
+            int instances = 1;
+            int initial = -1;
+            int firstActor = 0;
+            map<int, State> states;
+        };
+
+        struct Message {
+            int sender = -1;
+            int receiver = -1;
+            double delay = 0;
+        };
+
+        struct Actor {
+            int subject = -1;
+            int instance = 0;
+            int state = -1;
+            bool waiting = false;
+            map<int, deque<int>> inbox; // senders of the received messages not yet consumed
+            map<int, int> partners; // last actor of a subject a message was consumed from
+        };
+
         VRProcessPtr process;
-        VRStateMachineMapPtr processState;
-        map<int, VRStateMachineMapPtr> subjectStates;
+        map<int, Subject> subjects;
+        map<int, Message> messages;
+        vector<Actor> actors;
+
+        priority_queue<Event> calendar;
+        double time = 0;
+        long long seq = 0;
+        unsigned int seed = 0;
+        mt19937 rng;
+        size_t processed = 0;
+        size_t traceHash = 0;
+
+        bool running = false;
+        float speed = 1;
+        VRTimer frameTimer;
+        VRUpdateCbPtr updateCb;
 
         void update();
 
+        State* getState(int subject, int state);
+        void schedule(EVENT type, double t, int actor, int data, int from = -1);
+        void enter(int actor, int state);
+        void leave(int actor);
+        void handle(const Event& e);
+
     public:
         VRProcessEngine();
         ~VRProcessEngine();
@@ -26,20 +113,31 @@ class VRProcessEngine {
         void setProcess(VRProcessPtr p);
         VRProcessPtr getProcess();
 
+        void setSeed(unsigned int s);
+        void setInstances(int subject, int N);
+        void setInitialState(int subject, int state);
+        void setDuration(int subject, int state, double t);
+        void setSendMessage(int subject, int state, int message);
+        void setReceiveMessage(int subject, int transition, int message);
+        void setMessageDelay(int message, double t);
+
         void reset();
         void run(float speed = 1);
         void pause();
-};
+        bool isRunning();
 
-OSG_END_NAMESPACE;
+        bool step();
+        int simulate(double until); // process all events up to the time until
 
-/**
-
-Concept:
-    - run process in simulated environment
-    - realtime simulation
-    - interactive simulation
+        double getTime();
+        size_t getEventCount(); // processed events since the last reset
+        size_t getQueueSize();
+        size_t getTraceHash(); // hash over all processed events
+        int getActorCount();
+        int getActorSubject(int actor);
+        int getActorState(int actor);
+};
 
-*/
+OSG_END_NAMESPACE;
 
 #endif // VRPROCESSENGINE_H_INCLUDED
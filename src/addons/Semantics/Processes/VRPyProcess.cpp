@@ -149,6 +149,19 @@ PyMethodDef VRPyProcessEngine::methods[] = {
     {"run", (PyCFunction)VRPyProcessEngine::run, METH_VARARGS, "Run the simulation with a simulation speed multiplier, 1 is real time - run(float s)" },
     {"reset", (PyCFunction)VRPyProcessEngine::reset, METH_NOARGS, "Reset simulation - reset()" },
     {"pause", (PyCFunction)VRPyProcessEngine::pause, METH_NOARGS, "Pause simulation - pause()" },
+    {"setSeed", PyWrap(ProcessEngine, setSeed, "Set the seed of the random transitions, used on reset", void, unsigned int ) },
+    {"setInstances", PyWrap(ProcessEngine, setInstances, "Set the number of actors of a subject, used on reset", void, int, int ) },
+    {"setInitialState", PyWrap(ProcessEngine, setInitialState, "Set the initial state of a subject, used on reset", void, int, int ) },
+    {"setDuration", PyWrap(ProcessEngine, setDuration, "Set the duration of a subject state", void, int, int, double ) },
+    {"setSendMessage", PyWrap(ProcessEngine, setSendMessage, "Set the message sent when leaving a subject state", void, int, int, int ) },
+    {"setReceiveMessage", PyWrap(ProcessEngine, setReceiveMessage, "Set the message a subject transition waits for", void, int, int, int ) },
+    {"setMessageDelay", PyWrap(ProcessEngine, setMessageDelay, "Set the delivery time of a message", void, int, double ) },
+    {"simulate", PyWrap(ProcessEngine, simulate, "Process all events up to a simulation time, returns the number of events", int, double ) },
+    {"step", PyWrap(ProcessEngine, step, "Process the next event", bool ) },
+    {"getTime", PyWrap(ProcessEngine, getTime, "Return the simulation time", double ) },
+    {"getActorCount", PyWrap(ProcessEngine, getActorCount, "Return the number of actors", int ) },
+    {"getActorSubject", PyWrap(ProcessEngine, getActorSubject, "Return the subject of an actor", int, int ) },
+    {"getActorState", PyWrap(ProcessEngine, getActorState, "Return the current state of an actor", int, int ) },
     {NULL}  /* Sentinel */
 };
 
@@ -1,9 +1,11 @@
 #include "VRConcept.h"
 #include "VRProperty.h"
+#include "VROntology.h"
 #include "core/utils/toString.h"
 #include "core/utils/VRStorage_template.h"
 
 #include <iostream>
+#include <algorithm>
 
 using namespace OSG;
 
@@ -53,14 +55,34 @@ void VRConcept::setup() {
     for (auto p : tmp) p.second->append(ptr());
 }
 
+vector<VROntologyPtr> getIndexingOntologies(VRConceptPtr parent, VRConceptPtr child) {
+    vector<VROntologyPtr> res;
+    for (auto c : {parent, child}) {
+        for (auto w : c->ontologies) {
+            auto o = w.lock();
+            if (o && find(res.begin(), res.end(), o) == res.end()) res.push_back(o);
+        }
+    }
+    return res;
+}
+
+void VRConcept::addOntology(VROntologyPtr o) {
+    for (auto w : ontologies) if (w.lock() == o) return;
+    ontologies.push_back(o);
+}
+
 void VRConcept::removeChild(VRConceptPtr c) {
     //if (children.count(c->ID)) children.erase(c->ID);
-    if (c->parents.count(ID)) c->parents.erase(ID);
+    if (!c->parents.count(ID)) return;
+    c->parents.erase(ID);
+    for (auto o : getIndexingOntologies(ptr(), c)) o->unlinkConcepts(ptr(), c);
 }
 
 void VRConcept::removeParent(VRConceptPtr c) {
     //if (c->children.count(ID)) c->children.erase(ID);
-    if (parents.count(c->ID)) parents.erase(c->ID);
+    if (!parents.count(c->ID)) return;
+    parents.erase(c->ID);
+    for (auto o : getIndexingOntologies(c, ptr())) o->unlinkConcepts(c, ptr());
 }
 
 void VRConcept::remProperty(VRPropertyPtr p) { if (properties.count(p->ID)) properties.erase(p->ID); }
@@ -77,6 +99,7 @@ void VRConcept::append(VRConceptPtr c, bool link) {
     //cout << "VRConcept::append " << c->getName() << " to " << getName() << " ID " << c->ID << " " << ID << endl;
     //children[c->ID] = c;
     c->parents[ID] = ptr();
+    for (auto o : getIndexingOntologies(ptr(), c)) o->linkConcepts(ptr(), c);
     if (!link) return;
     //link[c->ID] = ; // TODO
 }
@@ -30,6 +30,7 @@ struct VRConcept : public std::enable_shared_from_this<VRConcept>, public VROnto
     static map<string, VRConceptPtr> ConceptsByName;
 
     //VROntologyWeakPtr ontology;
+    vector<VROntologyWeakPtr> ontologies; // indexing this concept, notified of parent links
     map<int, VRConceptPtr> parents;
     //map<int, VRConceptPtr> children;
     map<int, VRPropertyPtr> properties;
@@ -47,6 +48,7 @@ struct VRConcept : public std::enable_shared_from_this<VRConcept>, public VROnto
     void append(VRConceptPtr c, bool link = false);
     void removeChild(VRConceptPtr c);
     void removeParent(VRConceptPtr c);
+    void addOntology(VROntologyPtr o);
 
     VRPropertyPtr addProperty(string name, string type);
     VRPropertyPtr addProperty(string name, VRConceptPtr c);
@@ -1,6 +1,7 @@
 #include "VREntity.h"
 #include "VRProperty.h"
 #include "VROntology.h"
+#include "VRRuleEngine.h"
 #include "core/utils/VRStorage_template.h"
 #include "core/utils/VRTimer.h"
 #include "core/gui/VRGuiManager.h"
@@ -35,7 +36,21 @@ VREntityPtr VREntity::create(string name, VROntologyPtr o, VRConceptPtr c) { ret
 void VREntity::setSGObject(VRObjectPtr o) { sgObject = o; }
 VRObjectPtr VREntity::getSGObject() { return sgObject.lock(); }
 
-void VREntity::addConcept(VRConceptPtr c) { concepts.push_back(c); }
+void VREntity::addConcept(VRConceptPtr c) {
+    concepts.push_back(c);
+    if (auto o = ontology.lock()) { // update the concept index
+        auto e = o->getEntity(ID);
+        if (e.get() == this) o->indexEntity(e);
+    }
+    changed();
+}
+
+void VREntity::changed() {
+    auto o = ontology.lock();
+    if (!o || !o->ruleEngine) return;
+    auto e = o->getEntity(ID);
+    if (e.get() == this) o->ruleEngine->update(e);
+}
 
 vector<VRConceptPtr> VREntity::getConcepts() {
     vector<VRConceptPtr> res;
@@ -74,6 +89,7 @@ void VREntity::set(string name, string value, int pos) {
     auto prop = get(name);
     if (!prop) { WARN("Warning (set): Entity " + this->name + " has no property " + name); return; }
     properties[name][pos]->value = value;
+    changed();
     // TODO: warn if vector size bigger 1
 }
 
@@ -83,12 +99,14 @@ void VREntity::add(string name, string value) {
     prop = prop->copy();
     prop->value = value;
     properties[name].push_back( prop );
+    changed();
 }
 
 void VREntity::clear(string name) {
     auto prop = getProperty(name);
     if (!prop) { WARN("Warning (clear): Entity " + this->name + " has no property " + name); return; }
     properties[name].clear();
+    changed();
 }
 
 void VREntity::rem(VRPropertyPtr p) {
@@ -96,6 +114,7 @@ void VREntity::rem(VRPropertyPtr p) {
     if (properties.count(name)) {
         auto& v = properties[name];
         v.erase( remove(v.begin(), v.end(), p), v.end() );
+        changed();
     }
 }
 
@@ -65,6 +65,7 @@ struct VREntity : public VROntoID, public VRName {
     Vec3d getVec3(const string& prop, int i = 0);
     vector< Vec3d > getAllVec3(const string& prop);
 
+    void changed(); // notifies the rule engine of the ontology
     bool is_a(const string& concept);
     string toString();
     void save(xmlpp::Element* e, int p);
@@ -1,5 +1,6 @@
 #include "VROntology.h"
 #include "VRReasoner.h"
+#include "VRRuleEngine.h"
 #include "VRProperty.h"
 #include "VROWLImport.h"
 #include "core/utils/toString.h"
@@ -9,6 +10,10 @@
 #include "core/gui/VRGuiManager.h"
 #include "core/gui/VRGuiConsole.h"
 #include <iostream>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <set>
 #include <boost/filesystem.hpp>
 
 #define WARN(x) \
@@ -55,6 +60,7 @@ void VROntology::setup() {
         for (auto c : i.second->conceptNames) i.second->addConcept( concepts[c].lock() ); // update concept
         entities[i.second->ID] = i.second; // update ID mapping
     }
+    indexDirty = true;
 
     auto rls = rules;
     rules.clear();
@@ -128,13 +134,15 @@ void VROntology::addConcept(VRConceptPtr c) {
     if (c == thing) return;
     concepts[c->getName()] = c;
     if (!c->hasParent()) thing->append(c);
+    if (!indexDirty) insertConcept(c);
 }
 
 void VROntology::remConcept(VRConceptPtr c) {
     if (c == thing) return;
     if (!concepts.count(c->getName())) return;
-    c->detach();
+    c->detach(); // unlinks it in the index
     concepts.erase(c->getName());
+    ruleEngine = 0; // memberships of the entities changed
 }
 
 void VROntology::renameConcept(VRConceptPtr c, string newName) {
@@ -149,6 +157,8 @@ void VROntology::remEntity(VREntityPtr e) {
     if (!e) return;
     if (!entities.count(e->ID)) return;
     entities.erase(e->ID);
+    indexEntity(e, false);
+    if (ruleEngine) ruleEngine->remEntity(e);
 }
 
 void VROntology::remEntities(string concept) {
@@ -158,11 +168,13 @@ void VROntology::remEntities(string concept) {
 void VROntology::remRule(VROntologyRulePtr r) {
     if (!rules.count(r->ID)) return;
     rules.erase(r->ID);
+    if (ruleEngine) ruleEngine->remRule(r);
 }
 
 void VROntology::renameEntity(VREntityPtr e, string s) {
     if (!entities.count(e->ID)) return;
     e->setName(s);
+    if (ruleEngine) ruleEngine->update(e);
 }
 
 //void VROntology::import(VROntologyPtr o) { dependencies[o->getName()] = o; }
@@ -175,6 +187,8 @@ void VROntology::merge(VROntologyPtr o) { // Todo: check it well!
         auto cn = c.second.lock();
         if (cn) concepts[cn->getName()] = cn;
     }
+    indexDirty = true;
+    ruleEngine = 0; // rebuilt with the new rules on next use
 }
 
 map<int, vector<VRConceptPtr>> VROntology::getChildrenMap() {
@@ -201,6 +215,7 @@ vector<VROntologyRulePtr> VROntology::getRules() {
 VROntologyRulePtr VROntology::addRule(string rule, string ac) {
     VROntologyRulePtr r = VROntologyRule::create(rule, ac);
     rules[r->ID] = r;
+    if (ruleEngine) ruleEngine->addRule(r);
     return r;
 }
 
@@ -225,8 +240,11 @@ void VROntology::addEntity(VREntityPtr& e) {
     //pair<int, VREntityPtr> p1(e->ID,0);
     //auto p2 = entities.insert(p1);
     //p2.first->second = e;
+    if (entities.count(e->ID)) indexEntity(entities[e->ID], false);
     entities[e->ID] = e;
     entitiesByName[e->getName()] = e;
+    indexEntity(e);
+    if (ruleEngine) ruleEngine->addEntity(e);
 
     //cout << "VROntology::addEntity " << entities.size() << " " << entities[e->ID] << endl;
 }
@@ -254,16 +272,246 @@ VREntityPtr VROntology::getEntity(string e) {
 
 vector<VREntityPtr> VROntology::getEntities(string concept) {
     vector<VREntityPtr> res;
-    if (concept != "") {
-        for (auto i : entities) {
-            for (auto c : i.second->getConcepts()) {
-                if(c && c->is_a(concept)) { res.push_back(i.second); break; }
-            }
+    if (concept == "") {
+        for (auto i : entities) res.push_back(i.second);
+        return res;
+    }
+
+    auto c = getConcept(concept);
+    if (!c) return res;
+    updateIndex();
+    if (!conceptEntities.count(c->ID)) return res;
+    for (auto& e : conceptEntities[c->ID]) res.push_back(e.second);
+    return res;
+}
+
+namespace {
+    void mergeIntervals(vector<pair<int, int>>& I) {
+        sort(I.begin(), I.end());
+        vector<pair<int, int>> merged;
+        for (auto i : I) {
+            if (merged.size() && i.first <= merged.back().second+1) merged.back().second = max(merged.back().second, i.second);
+            else merged.push_back(i);
         }
-    } else for (auto i : entities) res.push_back(i.second);
+        I = merged;
+    }
+}
+
+void VROntology::updateIndex() {
+    if (!indexDirty) return;
+    taxonomy.clear();
+    conceptEntities.clear();
+
+    // the concepts of the ontology and of its entities with all ancestors
+    map<int, VRConceptPtr> nodes;
+    map<int, vector<VRConceptPtr>> children;
+    vector<VRConceptPtr> stack;
+    for (auto c : concepts) if (auto p = c.second.lock()) stack.push_back(p);
+    for (auto e : entities) for (auto c : e.second->getConcepts()) stack.push_back(c);
+    while (stack.size()) {
+        auto c = stack.back();
+        stack.pop_back();
+        if (nodes.count(c->ID)) continue;
+        nodes[c->ID] = c;
+        for (auto p : c->parents) {
+            children[p.first].push_back(c);
+            stack.push_back(p.second);
+        }
+    }
+
+    // pre-order numbers and tree intervals of a spanning tree
+    int counter = 0;
+    function<void(VRConceptPtr)> visit = [&](VRConceptPtr c) {
+        int pre = counter++;
+        taxonomy[c->ID].pre = pre;
+        for (auto k : children[c->ID]) if (!taxonomy.count(k->ID)) visit(k);
+        taxonomy[c->ID].intervals.push_back(make_pair(pre, counter-1));
+    };
+    for (auto n : nodes) if (n.second->parents.size() == 0) visit(n.second);
+    nextPre = counter;
+
+    // add the intervals of children outside the spanning tree, collect the ancestors
+    map<int, bool> done;
+    function<void(int)> close = [&](int ID) {
+        if (done[ID]) return;
+        done[ID] = true;
+        auto& I = taxonomy[ID].intervals;
+        for (auto k : children[ID]) {
+            close(k->ID);
+            auto& J = taxonomy[k->ID].intervals;
+            I.insert(I.end(), J.begin(), J.end());
+            taxonomy[ID].children.insert(k->ID);
+        }
+        mergeIntervals(I);
+    };
+
+    function<void(VRConceptPtr)> collect = [&](VRConceptPtr c) {
+        if (taxonomy[c->ID].ancestors.size()) return;
+        vector<int> A(1, c->ID);
+        for (auto p : c->parents) {
+            collect(p.second);
+            auto& P = taxonomy[p.first].ancestors;
+            A.insert(A.end(), P.begin(), P.end());
+        }
+        sort(A.begin(), A.end());
+        A.erase(unique(A.begin(), A.end()), A.end());
+        taxonomy[c->ID].ancestors = A;
+    };
+
+    for (auto n : nodes) {
+        close(n.first);
+        collect(n.second);
+        taxonomy[n.first].concept = n.second;
+        n.second->addOntology(ptr());
+    }
+
+    indexDirty = false;
+    for (auto e : entities) indexEntity(e.second);
+}
+
+vector<int> VROntology::getDescendants(int ID) {
+    vector<int> res;
+    set<int> visited;
+    vector<int> stack(1, ID);
+    while (stack.size()) {
+        int i = stack.back();
+        stack.pop_back();
+        if (visited.count(i)) continue;
+        visited.insert(i);
+        res.push_back(i);
+        for (int k : taxonomy[i].children) stack.push_back(k);
+    }
     return res;
 }
 
+void VROntology::insertConcept(VRConceptPtr c) { // a concept unknown to the index has no indexed descendants
+    if (taxonomy.count(c->ID)) return;
+    for (auto p : c->parents) insertConcept(p.second);
+    auto& n = taxonomy[c->ID];
+    n.pre = nextPre++;
+    n.concept = c;
+    n.intervals.push_back(make_pair(n.pre, n.pre));
+    n.ancestors.push_back(c->ID);
+    c->addOntology(ptr());
+    for (auto p : c->parents) linkIndex(p.second, c);
+}
+
+void VROntology::linkIndex(VRConceptPtr parent, VRConceptPtr child) {
+    auto& P = taxonomy[parent->ID];
+    auto& C = taxonomy[child->ID];
+    P.children.insert(child->ID);
+    vector<int> PA = P.ancestors;
+
+    for (int d : getDescendants(child->ID)) { // the descendants of the child get the ancestors of the parent
+        auto& A = taxonomy[d].ancestors;
+        A.insert(A.end(), PA.begin(), PA.end());
+        sort(A.begin(), A.end());
+        A.erase(unique(A.begin(), A.end()), A.end());
+    }
+
+    for (int a : PA) { // the ancestors of the parent get the descendants of the child
+        auto& I = taxonomy[a].intervals;
+        I.insert(I.end(), C.intervals.begin(), C.intervals.end());
+        mergeIntervals(I);
+    }
+
+    if (!conceptEntities.count(child->ID) || conceptEntities[child->ID].size() == 0) return;
+    auto E = conceptEntities[child->ID];
+    for (int a : PA) conceptEntities[a].insert(E.begin(), E.end());
+    ruleEngine = 0; // memberships of the entities changed
+}
+
+void VROntology::linkConcepts(VRConceptPtr parent, VRConceptPtr child) {
+    taxonomyVersion++;
+    if (indexDirty) return;
+    if (!taxonomy.count(child->ID)) { insertConcept(child); return; } // links all its parents
+    insertConcept(parent);
+    linkIndex(parent, child);
+}
+
+void VROntology::unlinkConcepts(VRConceptPtr parent, VRConceptPtr child) {
+    taxonomyVersion++;
+    if (indexDirty || !taxonomy.count(parent->ID) || !taxonomy.count(child->ID)) return;
+    taxonomy[parent->ID].children.erase(child->ID);
+    vector<int> PA = taxonomy[parent->ID].ancestors; // they lose the descendants of the child
+
+    // ancestors of the descendants of the child, recomputed from their remaining parents
+    auto D = getDescendants(child->ID);
+    for (int d : D) taxonomy[d].ancestors.clear();
+    function<void(int)> collect = [&](int ID) {
+        auto& n = taxonomy[ID];
+        if (n.ancestors.size()) return;
+        vector<int> A(1, ID);
+        if (auto c = n.concept.lock()) {
+            for (auto p : c->parents) {
+                if (!taxonomy.count(p.first)) continue;
+                collect(p.first);
+                auto& P = taxonomy[p.first].ancestors;
+                A.insert(A.end(), P.begin(), P.end());
+            }
+        }
+        sort(A.begin(), A.end());
+        A.erase(unique(A.begin(), A.end()), A.end());
+        n.ancestors = A;
+    };
+    for (int d : D) collect(d);
+
+    // intervals of the former ancestors of the parent, children first, they have more ancestors
+    sort(PA.begin(), PA.end(), [&](int a, int b) { return taxonomy[a].ancestors.size() > taxonomy[b].ancestors.size(); });
+    for (int a : PA) {
+        auto& n = taxonomy[a];
+        vector<pair<int, int>> I(1, make_pair(n.pre, n.pre));
+        for (int k : n.children) {
+            auto& J = taxonomy[k].intervals;
+            I.insert(I.end(), J.begin(), J.end());
+        }
+        mergeIntervals(I);
+        n.intervals = I;
+    }
+
+    if (!conceptEntities.count(child->ID) || conceptEntities[child->ID].size() == 0) return;
+    auto E = conceptEntities[child->ID];
+    for (auto e : E) {
+        for (int a : PA) {
+            bool below = false;
+            for (auto c : e.second->getConcepts()) {
+                auto& A = taxonomy[c->ID].ancestors;
+                if (binary_search(A.begin(), A.end(), a)) { below = true; break; }
+            }
+            if (!below) conceptEntities[a].erase(e.first);
+        }
+    }
+    ruleEngine = 0; // memberships of the entities changed
+}
+
+void VROntology::indexEntity(VREntityPtr e, bool add) {
+    if (indexDirty) return; // built on the next query
+    for (auto c : e->getConcepts()) {
+        if (!taxonomy.count(c->ID)) insertConcept(c); // concept of another ontology
+        for (int a : taxonomy[c->ID].ancestors) {
+            if (add) conceptEntities[a][e->ID] = e;
+            else conceptEntities[a].erase(e->ID);
+        }
+    }
+}
+
+bool VROntology::isA(VRConceptPtr c, VRConceptPtr parent) {
+    if (!c || !parent) return false;
+    updateIndex();
+    if (!taxonomy.count(c->ID) || !taxonomy.count(parent->ID)) return c->is_a(parent);
+    int pre = taxonomy[c->ID].pre;
+    auto& I = taxonomy[parent->ID].intervals;
+    auto i = upper_bound(I.begin(), I.end(), make_pair(pre, numeric_limits<int>::max()));
+    return i != I.begin() && (--i)->second >= pre;
+}
+
+bool VROntology::isA(VREntityPtr e, string concept) {
+    auto p = getConcept(concept);
+    if (!e || !p) return false;
+    for (auto c : e->getConcepts()) if (isA(c, p)) return true;
+    return false;
+}
+
 string VROntology::toString() {
     string res = "Taxonomy:\n";
     auto cMap = getChildrenMap();
@@ -297,5 +545,10 @@ vector<VREntityPtr> VROntology::process(string query) {
     return r->process(query, ptr());
 }
 
+VRRuleEnginePtr VROntology::getRuleEngine() {
+    if (!ruleEngine) ruleEngine = VRRuleEngine::create(ptr());
+    return ruleEngine;
+}
+
 
 
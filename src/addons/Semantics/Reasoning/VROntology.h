@@ -10,6 +10,7 @@
 
 #include <string>
 #include <map>
+#include <set>
 #include <unordered_map>
 #include <vector>
 #include <memory>
@@ -17,7 +18,24 @@
 using namespace std;
 OSG_BEGIN_NAMESPACE;
 
+/**
+    The ontology keeps an index from concepts to their entities, including the entities of all sub concepts.
+    The taxonomy is encoded by the pre-order numbers of a spanning tree, each concept keeps the merged
+    pre-order intervals of its descendants, a subsumption check is a lookup in those intervals,
+    constant time for single inheritance.
+    Entity changes and concept links update the index directly, new concepts are numbered after the others.
+    Loading and merging ontologies rebuild it on the next query.
+*/
+
 struct VROntology : public std::enable_shared_from_this<VROntology>, public VRName {
+    struct TaxonomyNode {
+        int pre = 0;
+        vector<pair<int, int>> intervals; // pre-order ranges of all descendants
+        vector<int> ancestors; // concept IDs, including the concept itself
+        set<int> children; // concept IDs
+        VRConceptWeakPtr concept;
+    };
+
     static map<string, VROntologyPtr> library;
     static void setupLibrary();
 
@@ -33,6 +51,13 @@ struct VROntology : public std::enable_shared_from_this<VROntology>, public VRNa
 
     map<string, VRConceptPtr> recentConcepts; // performance optimization
 
+    bool indexDirty = true;
+    int taxonomyVersion = 0; // changes with every concept link in this ontology
+    int nextPre = 0;
+    unordered_map<int, TaxonomyNode> taxonomy; // by concept ID
+    unordered_map<int, map<int, VREntityPtr>> conceptEntities; // by concept ID, entities by ID
+    VRRuleEnginePtr ruleEngine; // created on first use, kept up to date with the entities and rules
+
     VROntology(string name);
     static VROntologyPtr create(string name = "");
     VROntologyPtr ptr();
@@ -70,6 +95,16 @@ struct VROntology : public std::enable_shared_from_this<VROntology>, public VRNa
 
     vector<VROntologyRulePtr> getRules();
 
+    void updateIndex();
+    void indexEntity(VREntityPtr e, bool add = true);
+    void insertConcept(VRConceptPtr c);
+    void linkIndex(VRConceptPtr parent, VRConceptPtr child);
+    vector<int> getDescendants(int ID);
+    void linkConcepts(VRConceptPtr parent, VRConceptPtr child); // called by the concepts
+    void unlinkConcepts(VRConceptPtr parent, VRConceptPtr child);
+    bool isA(VRConceptPtr c, VRConceptPtr parent);
+    bool isA(VREntityPtr e, string concept);
+
     void open(string path);
     void addModule(string mod);
     string toString();
@@ -78,6 +113,7 @@ struct VROntology : public std::enable_shared_from_this<VROntology>, public VRNa
     string getFlag();
 
     vector<VREntityPtr> process(string query);
+    VRRuleEnginePtr getRuleEngine();
 };
 
 OSG_END_NAMESPACE;
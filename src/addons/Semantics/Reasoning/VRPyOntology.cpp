@@ -16,6 +16,9 @@ simpleVRPyType(Concept, 0);
 simpleVRPyType(Property, 0);
 simpleVRPyType(OntologyRule, 0);
 simpleVRPyType(Reasoner, New_ptr);
+simpleVRPyType(RuleEngine, 0);
+
+template<> PyObject* VRPyTypeCaster::cast(const VRRuleEnginePtr& e) { return VRPyRuleEngine::fromSharedPtr(e); }
 
 template<> bool toValue(PyObject* o, VREntityPtr& v) { if (!VRPyEntity::check(o)) return 0; v = ((VRPyEntity*)o)->objPtr; return 1; }
 template<> bool toValue(PyObject* o, VROntologyPtr& v) { if (!VRPyOntology::check(o)) return 0; v = ((VRPyOntology*)o)->objPtr; return 1; }
@@ -302,6 +305,7 @@ PyMethodDef VRPyOntology::methods[] = {
     //{"addModule", (PyCFunction)proxy<string, VRPyOntology, void (VROntology::*)(string), &VROntology::addModule>::set, METH_VARARGS, "Add module from library - addModule( str name )" },
     {"addModule", PyWrap(Ontology, addModule, "Add module from library", void, string) },
     {"process", (PyCFunction)VRPyOntology::process, METH_VARARGS, "Process a query - process( str query )" },
+    {"getRuleEngine", PyWrap(Ontology, getRuleEngine, "Return the rule engine, created on first call, queries are then answered incrementally", VRRuleEnginePtr) },
     {NULL}  /* Sentinel */
 };
 
@@ -457,3 +461,14 @@ PyObject* VRPyReasoner::process(VRPyReasoner* self, PyObject* args) {
     return pyres;
 }
 
+// --------------------- RuleEngine --------------------
+
+PyMethodDef VRPyRuleEngine::methods[] = {
+    {"process", PyWrap(RuleEngine, process, "Return the entities matching a query, the results are cached until the next change", vector<VREntityPtr>, string) },
+    {"getMatches", PyWrap(RuleEngine, getMatches, "Return the matches of all rules with the given head, one entity ID for each variable", vector<VRRuleEngine::Token>, string) },
+    {"fire", PyWrapOpt(RuleEngine, fire, "Apply the rule heads to the matches until nothing changes, returns the number of changes", "10", int, int) },
+    {"covers", PyWrap(RuleEngine, covers, "Check if the network supports the query and all rules", bool, string) },
+    {"getRuleCount", PyWrap(RuleEngine, getRuleCount, "Return the number of compiled rules", int) },
+    {"getActivations", PyWrap(RuleEngine, getActivations, "Return the number of created tokens", int) },
+    {NULL}  /* Sentinel */
+};
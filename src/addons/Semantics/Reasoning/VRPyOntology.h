@@ -3,6 +3,7 @@
 
 #include "VROntology.h"
 #include "VRReasoner.h"
+#include "VRRuleEngine.h"
 #include "core/scripting/VRPyBase.h"
 
 struct VRPyProperty : VRPyBaseT<OSG::VRProperty> {
@@ -69,4 +70,8 @@ struct VRPyReasoner : VRPyBaseT<OSG::VRReasoner> {
     static PyObject* process(VRPyReasoner* self, PyObject* args);
 };
 
+struct VRPyRuleEngine : VRPyBaseT<OSG::VRRuleEngine> {
+    static PyMethodDef methods[];
+};
+
 #endif // VRPYONTOLOGY_H_INCLUDED
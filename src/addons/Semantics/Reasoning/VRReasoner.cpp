@@ -1,5 +1,6 @@
 #include "VRReasoner.h"
 #include "VROntology.h"
+#include "VRRuleEngine.h"
 #include "VRProperty.h"
 
 #include <iostream>
@@ -131,7 +132,7 @@ bool VRReasoner::builtin(VRStatementPtr s, VRSemanticContextPtr c) {
                     auto e_var = c->vars[v];
                     for (auto ep : e_var->entities) {
                         auto e = ep.second;
-                        if (e->is_a("Vector")) params[i][er.get()] = e->get("x")->value +" "+ e->get("y")->value +" "+ e->get("z")->value;
+                        if (c->onto->isA(e, "Vector")) params[i][er.get()] = e->get("x")->value +" "+ e->get("y")->value +" "+ e->get("z")->value;
                         else params[i][er.get()] = e->getName();
                     }
                 }
@@ -143,7 +144,7 @@ bool VRReasoner::builtin(VRStatementPtr s, VRSemanticContextPtr c) {
             for (auto ep : t.var->entities) {
                 auto e = ep.second;
                 if (!e) continue;
-                if (e->is_a("Vector")) params[i][e.get()] = e->get("x")->value +" "+ e->get("y")->value +" "+ e->get("z")->value;
+                if (c->onto->isA(e, "Vector")) params[i][e.get()] = e->get("x")->value +" "+ e->get("y")->value +" "+ e->get("z")->value;
                 else params[i][e.get()] = e->getName();
             }
             continue;
@@ -293,7 +294,7 @@ bool VRReasoner::evaluate(VRStatementPtr statement, VRSemanticContextPtr context
             string name = statement->terms[0].path.root;
             if (context->vars.count(name)) { // there is already a variable with that name!
                 auto var = context->vars[name];
-                if ( c->is_a(var->concept) && var->concept != concept ) { // the variable is not the same type or a subtype of concept!
+                if ( context->onto->isA(c, context->onto->getConcept(var->concept)) && var->concept != concept ) { // the variable is not the same type or a subtype of concept!
                     //TODO: what happens then?
                     //  are the entities that don't have the concept removed from the variable? I think not...
                 }
@@ -316,6 +317,15 @@ bool VRReasoner::evaluate(VRStatementPtr statement, VRSemanticContextPtr context
 vector<VREntityPtr> VRReasoner::process(string initial_query, VROntologyPtr onto) {
     print(initial_query);
 
+    if (auto engine = onto->ruleEngine) { // incremental matching, the rule network answers without evaluating the rules again
+        if (engine->covers(initial_query)) {
+            engine->fire();
+            auto res = engine->process(initial_query);
+            print(" rule engine: " + toString(res.size()) + " instances");
+            return res;
+        }
+    }
+
     auto context = VRSemanticContext::create(onto); // create context
     context->queries.push_back(Query(initial_query));
 
@@ -0,0 +1,337 @@
+#include "VRRuleEngine.h"
+#include "VROntology.h"
+#include "VRStatement.h"
+#include "VRProperty.h"
+
+#include <iostream>
+#include <algorithm>
+
+using namespace OSG;
+
+bool VRRuleEngine::BetaMemory::add(const Token& t) {
+    if (!tokens.insert(t).second) return false;
+    for (int ID : t) byEntity[ID].insert(t);
+    return true;
+}
+
+void VRRuleEngine::BetaMemory::remove(const Token& t) {
+    Token tmp = t; // t may be an element of byEntity
+    tokens.erase(tmp);
+    for (int ID : tmp) {
+        auto b = byEntity.find(ID);
+        if (b == byEntity.end()) continue;
+        b->second.erase(tmp);
+        if (b->second.size() == 0) byEntity.erase(b);
+    }
+}
+
+VRRuleEngine::VRRuleEngine(VROntologyPtr onto) : ontology(onto) {
+    for (auto r : onto->getRules()) addRule(r);
+    for (auto e : onto->entities) addEntity(e.second);
+}
+
+VRRuleEngine::~VRRuleEngine() {}
+
+VRRuleEnginePtr VRRuleEngine::create(VROntologyPtr onto) { return VRRuleEnginePtr( new VRRuleEngine(onto) ); }
+
+int VRRuleEngine::getRuleCount() { return rules.size(); }
+int VRRuleEngine::getActivations() { return activations; }
+
+vector<string> VRRuleEngine::values(VREntityPtr e, const string& prop) {
+    vector<string> res;
+    if (prop == "") { res.push_back(e->getName()); return res; }
+    for (auto p : e->getAll(prop)) res.push_back(p->value);
+    return res;
+}
+
+bool VRRuleEngine::passes(const Test& t, VREntityPtr e1, VREntityPtr e2) {
+    bool equal = false;
+    auto v1 = values(e1, t.prop1);
+    if (t.var2 < 0) {
+        for (auto& v : v1) if (v == t.constant) { equal = true; break; }
+    } else {
+        auto v2 = values(e2, t.prop2);
+        for (auto& a : v1) {
+            for (auto& b : v2) if (a == b) { equal = true; break; }
+            if (equal) break;
+        }
+    }
+    return equal != t.negate;
+}
+
+bool VRRuleEngine::passes(Alpha* a, VREntityPtr e) {
+    auto onto = ontology.lock();
+    if (!onto) return false;
+    bool isA = false;
+    for (auto c : e->getConcepts()) if (onto->isA(c, a->concept)) { isA = true; break; }
+    if (!isA) return false;
+    for (auto& t : a->tests) if (!passes(t, e, e)) return false;
+    return true;
+}
+
+bool VRRuleEngine::joins(Rule* r, int level, const Token& t, VREntityPtr e) {
+    for (auto& test : r->joins[level]) {
+        auto e1 = test.var1 == level ? e : entities[t[test.var1]];
+        auto e2 = test.var2 == level ? e : entities[t[test.var2]];
+        if (!passes(test, e1, e2)) return false;
+    }
+    return true;
+}
+
+int VRRuleEngine::varIndex(Rule* r, const string& var) {
+    for (unsigned int i=0; i<r->vars.size(); i++) if (r->vars[i] == var) return i;
+    return -1;
+}
+
+VRRuleEngine::Alpha* VRRuleEngine::getAlpha(VRConceptPtr concept, vector<Test> tests) {
+    vector<string> keys;
+    for (auto& t : tests) {
+        string k = t.prop1 + (t.negate ? "!=" : "==");
+        k += t.var2 < 0 ? "'" + t.constant + "'" : "." + t.prop2;
+        keys.push_back(k);
+    }
+    sort(keys.begin(), keys.end());
+    string key = concept->getName() + "(" + toString(concept->ID) + ")";
+    for (auto& k : keys) key += " " + k;
+
+    if (!alphas.count(key)) {
+        auto a = make_shared<Alpha>();
+        a->concept = concept;
+        a->tests = tests;
+        for (auto e : entities) if (passes(a.get(), e.second)) a->memory.insert(e.first);
+        alphas[key] = a;
+    }
+    return alphas[key].get();
+}
+
+shared_ptr<VRRuleEngine::Rule> VRRuleEngine::compile(VROntologyRulePtr r) {
+    auto onto = ontology.lock();
+    if (!r || !r->query || !onto) return 0;
+    auto R = make_shared<Rule>();
+    R->rule = r;
+    R->head = r->query;
+
+    // concept statements declare the variables
+    vector<VRConceptPtr> concepts;
+    for (auto s : r->statements) {
+        if (s->terms.size() != 1) continue;
+        auto c = onto->getConcept(s->verb);
+        if (!c) continue;
+        R->vars.push_back(s->terms[0].path.root);
+        concepts.push_back(c);
+    }
+    int N = R->vars.size();
+    if (N == 0) { cout << "VRRuleEngine: rule " << r->rule << " declares no variables!\n"; return 0; }
+
+    vector<vector<Test>> alphaTests(N);
+    R->joins.resize(N);
+    for (auto s : r->statements) {
+        if (s->terms.size() == 1 && onto->getConcept(s->verb)) continue;
+        bool supported = (s->verb == "is" || s->verb == "is_not" || s->verb == "has") && s->terms.size() == 2;
+        for (auto& t : s->terms) if (t.path.size() > 2) supported = false;
+        if (!supported) { cout << "VRRuleEngine: unsupported statement " << s->toString() << " in rule " << r->rule << endl; return 0; }
+
+        Term* a = &s->terms[0];
+        Term* b = &s->terms[1];
+        int v1 = varIndex(R.get(), a->path.root);
+        int v2 = varIndex(R.get(), b->path.root);
+        if (v1 < 0) { swap(a, b); swap(v1, v2); }
+        if (v1 < 0) { cout << "VRRuleEngine: no variable in statement " << s->toString() << " in rule " << r->rule << endl; return 0; }
+
+        Test t;
+        t.var1 = v1;
+        t.prop1 = a->path.size() > 1 ? a->path.nodes[1] : "";
+        t.negate = s->verb == "is_not";
+        if (v2 < 0) t.constant = b->str;
+        else {
+            t.var2 = v2;
+            t.prop2 = b->path.size() > 1 ? b->path.nodes[1] : "";
+        }
+
+        if (v2 < 0 || v2 == v1) { // test on a single entity
+            if (v2 == v1) t.var2 = t.var1 = 0;
+            else t.var1 = 0;
+            alphaTests[v1].push_back(t);
+        } else R->joins[max(v1, v2)].push_back(t);
+    }
+
+    R->memories.resize(N);
+    for (int i=0; i<N; i++) {
+        Alpha* a = getAlpha(concepts[i], alphaTests[i]);
+        a->successors.push_back( make_pair(R.get(), i) );
+        for (auto& j : R->joins) {
+            for (auto& t : j) {
+                if (t.var1 == i || t.var2 == i) a->joined = true; // a property or the name of the entity
+            }
+        }
+        R->alphas.push_back(a);
+    }
+    return R;
+}
+
+void VRRuleEngine::seed(Rule* r) {
+    for (int ID : r->alphas[0]->memory) addToken(r, 0, Token(1, ID));
+}
+
+bool VRRuleEngine::addRule(VROntologyRulePtr r) {
+    auto R = compile(r);
+    if (!R) { skipped++; return false; }
+    rules.push_back(R);
+    seed(R.get());
+    return true;
+}
+
+void VRRuleEngine::remRule(VROntologyRulePtr r) {
+    for (auto& a : alphas) {
+        auto& S = a.second->successors;
+        S.erase(remove_if(S.begin(), S.end(), [&](const pair<Rule*, int>& s) { return s.first->rule == r; }), S.end());
+    }
+    int N = rules.size();
+    rules.erase(remove_if(rules.begin(), rules.end(), [&](const shared_ptr<Rule>& R) { return R->rule == r; }), rules.end());
+    if (N == int(rules.size()) && skipped > 0) skipped--; // was not supported
+}
+
+bool VRRuleEngine::covers(string query) {
+    if (skipped) return false;
+    if (!queries.count(query)) {
+        auto r = compile( VROntologyRule::create(query, "") );
+        queries[query] = r;
+        if (r) seed(r.get());
+    }
+    return queries[query] != 0;
+}
+
+void VRRuleEngine::addToken(Rule* r, int level, const Token& t) {
+    if (!r->memories[level].add(t)) return;
+    activations++;
+    r->changed = true;
+
+    int next = level+1;
+    if (next == int(r->vars.size())) return;
+    for (int ID : r->alphas[next]->memory) {
+        auto e = entities[ID];
+        if (!joins(r, next, t, e)) continue;
+        Token t2 = t;
+        t2.push_back(ID);
+        addToken(r, next, t2);
+    }
+}
+
+void VRRuleEngine::activate(Alpha* a, VREntityPtr e) {
+    a->memory.insert(e->ID);
+    for (auto s : a->successors) {
+        Rule* r = s.first;
+        int level = s.second;
+        if (level == 0) { addToken(r, 0, Token(1, e->ID)); continue; }
+        for (auto& t : r->memories[level-1].tokens) { // only memories from level on change
+            if (!joins(r, level, t, e)) continue;
+            Token t2 = t;
+            t2.push_back(e->ID);
+            addToken(r, level, t2);
+        }
+    }
+}
+
+void VRRuleEngine::deactivate(Alpha* a, int ID) {
+    a->memory.erase(ID);
+    for (auto s : a->successors) {
+        Rule* r = s.first;
+        int level = s.second;
+        for (unsigned int k=level; k<r->memories.size(); k++) {
+            auto& M = r->memories[k];
+            auto b = M.byEntity.find(ID);
+            if (b == M.byEntity.end()) continue;
+            vector<Token> outdated;
+            for (auto& t : b->second) if (t[level] == ID) outdated.push_back(t);
+            for (auto& t : outdated) M.remove(t);
+            if (outdated.size()) r->changed = true;
+        }
+    }
+}
+
+void VRRuleEngine::addEntity(VREntityPtr e) {
+    if (!e) return;
+    entities[e->ID] = e;
+    update(e);
+}
+
+void VRRuleEngine::remEntity(VREntityPtr e) {
+    if (!e) return;
+    entities.erase(e->ID);
+    for (auto& a : alphas) if (a.second->memory.count(e->ID)) deactivate(a.second.get(), e->ID);
+}
+
+void VRRuleEngine::update(VREntityPtr e) {
+    if (!e || !entities.count(e->ID)) return;
+    for (auto& a : alphas) {
+        Alpha* A = a.second.get();
+        bool was = A->memory.count(e->ID);
+        bool is = passes(A, e);
+        if (was && (!is || A->joined)) deactivate(A, e->ID); // joins read its properties or name, match it again
+        if (is && (!was || A->joined)) activate(A, e);
+    }
+}
+
+void VRRuleEngine::setValue(VREntityPtr e, string prop, string value) {
+    if (!e) return;
+    e->set(prop, value);
+    auto onto = ontology.lock();
+    if (!onto || onto->ruleEngine.get() != this || e->ontology.lock() != onto) update(e); // else the entity notifies the engine
+}
+
+vector<VRRuleEngine::Token> VRRuleEngine::getMatches(string head) {
+    vector<Token> res;
+    for (auto r : rules) {
+        if (r->head->verb != head) continue;
+        auto& M = r->memories.back().tokens;
+        res.insert(res.end(), M.begin(), M.end());
+    }
+    return res;
+}
+
+vector<VREntityPtr> VRRuleEngine::process(string query) {
+    if (!queries.count(query)) {
+        auto r = compile( VROntologyRule::create(query, "") );
+        queries[query] = r;
+        if (r) seed(r.get());
+    }
+
+    auto r = queries[query];
+    if (!r) return vector<VREntityPtr>();
+    if (r->changed) { // recompute the results only after changes
+        r->results.clear();
+        int v = 0;
+        if (r->head->terms.size()) v = max(0, varIndex(r.get(), r->head->terms[0].path.root));
+        std::set<int> IDs;
+        for (auto& t : r->memories.back().tokens) IDs.insert(t[v]);
+        for (int ID : IDs) r->results.push_back(entities[ID]);
+        r->changed = false;
+    }
+    return r->results;
+}
+
+int VRRuleEngine::fire(int maxIterations) {
+    int changes = 0;
+    for (int i=0; i<maxIterations; i++) {
+        int N = 0;
+        for (auto r : rules) {
+            auto h = r->head;
+            if (h->verb != "is" || h->terms.size() != 2 || h->terms[0].path.size() != 2) continue;
+            int v = varIndex(r.get(), h->terms[0].path.root);
+            if (v < 0) continue;
+            string prop = h->terms[0].path.nodes[1];
+            string value = h->terms[1].str;
+            auto tokens = r->memories.back().tokens; // copy, setting values changes the memories
+            for (auto& t : tokens) {
+                auto e = entities[t[v]];
+                auto vals = values(e, prop);
+                if (vals.size() == 1 && vals[0] == value) continue;
+                setValue(e, prop, value);
+                N++;
+            }
+        }
+        changes += N;
+        if (N == 0) break;
+    }
+    return changes;
+}
@@ -0,0 +1,119 @@
+#ifndef VRRULEENGINE_H_INCLUDED
+#define VRRULEENGINE_H_INCLUDED
+
+#include <OpenSG/OSGConfig.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <memory>
+
+#include "../VRSemanticsFwd.h"
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Incremental matching of ontology rules in a Rete network, rules are compiled once.
+    The body statements Concept(x), is(x.p,v), is_not(x.p,v) and has(x.p,y) become alpha nodes,
+    tests on one variable shared by all rules, and join tests between the variables of a rule.
+    Alpha memories hold the entities passing the alpha tests, the beta memories of a rule
+    the partial matches of its first variables, the last one all matches of the rule.
+    Entity changes are propagated through the network, matches and query results stay valid
+    until the next change. Paths are limited to a variable and one property, x or x.p.
+    Rule heads of the form is(x.p,v) are applied to all matches by fire.
+    The engine of an ontology, VROntology::getRuleEngine, is notified of all entity and rule changes,
+    the reasoner answers queries with it when the network covers the query and all rules.
+*/
+
+class VRRuleEngine {
+    public:
+        typedef vector<int> Token; // entity IDs, one for each variable of the rule
+
+    private:
+        struct Test { // values of var1.prop1 equal the constant or values of var2.prop2
+            int var1 = 0;
+            string prop1;
+            int var2 = -1;
+            string prop2;
+            string constant;
+            bool negate = false;
+        };
+
+        struct Rule;
+
+        struct Alpha {
+            VRConceptPtr concept;
+            vector<Test> tests;
+            set<int> memory;
+            vector<pair<Rule*, int>> successors; // rule and variable
+            bool joined = false; // a join reads properties or the name of the variable
+        };
+
+        struct BetaMemory {
+            set<Token> tokens;
+            unordered_map<int, set<Token>> byEntity;
+            bool add(const Token& t);
+            void remove(const Token& t);
+        };
+
+        struct Rule {
+            VROntologyRulePtr rule;
+            VRStatementPtr head;
+            vector<string> vars;
+            vector<Alpha*> alphas; // one for each variable
+            vector<vector<Test>> joins; // tests of variable i with variables before i
+            vector<BetaMemory> memories; // matches of the variables 0..i
+            bool changed = true;
+            vector<VREntityPtr> results; // query results, distinct entities of the first head variable
+        };
+
+        VROntologyWeakPtr ontology;
+        map<int, VREntityPtr> entities;
+        map<string, shared_ptr<Alpha>> alphas;
+        vector<shared_ptr<Rule>> rules;
+        map<string, shared_ptr<Rule>> queries; // 0 if not supported
+        int activations = 0;
+        int skipped = 0; // rules not supported by the network
+
+        vector<string> values(VREntityPtr e, const string& prop);
+        bool passes(const Test& t, VREntityPtr e1, VREntityPtr e2);
+        bool passes(Alpha* a, VREntityPtr e);
+
+        bool joins(Rule* r, int level, const Token& t, VREntityPtr e);
+        int varIndex(Rule* r, const string& var);
+
+        shared_ptr<Rule> compile(VROntologyRulePtr r);
+        Alpha* getAlpha(VRConceptPtr concept, vector<Test> tests);
+        void seed(Rule* r);
+
+        void addToken(Rule* r, int level, const Token& t);
+        void activate(Alpha* a, VREntityPtr e);
+        void deactivate(Alpha* a, int ID);
+
+    public:
+        VRRuleEngine(VROntologyPtr onto);
+        ~VRRuleEngine();
+        static VRRuleEnginePtr create(VROntologyPtr onto);
+
+        bool addRule(VROntologyRulePtr r);
+        void remRule(VROntologyRulePtr r);
+        int getRuleCount();
+        bool covers(string query); // the query and all rules compile, the matches are complete
+
+        void addEntity(VREntityPtr e);
+        void remEntity(VREntityPtr e);
+        void update(VREntityPtr e);
+        void setValue(VREntityPtr e, string prop, string value);
+
+        vector<Token> getMatches(string head);
+        vector<VREntityPtr> process(string query);
+        int fire(int maxIterations = 10);
+
+        int getActivations(); // tokens created since the engine was created
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRRULEENGINE_H_INCLUDED
@@ -4,6 +4,7 @@
 #include "core/objects/geometry/OSGGeometry.h"
 #include "core/objects/material/VRMaterial.h"
 #include "core/math/Octree.h"
+#include "core/math/VRVertexWelder.h"
 #include <OpenSG/OSGGeometry.h>
 #include <OpenSG/OSGGeoProperties.h>
 #include <OpenSG/OSGGeoFunctions.h>
@@ -18,44 +19,50 @@ VRSegmentation::VRSegmentation() {}
 void VRSegmentation::removeDuplicates(VRGeometryPtr geo) {
     if (geo == 0) return;
     if (geo->getMesh() == 0) return;
+    auto mesh = geo->getMesh()->geo;
+    auto gpos = mesh->getPositions();
+    if (!gpos) return;
+
+    // triangle corners as position indices, only referenced positions are welded
+    vector<int> corners;
+    vector<int> used(gpos->size(), -1);
+    vector<Vec3f> P;
+    vector<Vec3f> N;
+    bool hasNormals = mesh->getNormals() && mesh->getNormals()->size() > 0;
+	TriangleIterator it(mesh);
+	for (; !it.isAtEnd() ;++it) {
+        for (int i=0; i<3; i++) {
+            int j = it.getPositionIndex(i);
+            if (used[j] < 0) {
+                used[j] = P.size();
+                P.push_back( Vec3f(gpos->getValue<Pnt3f>(j)) );
+                if (hasNormals) N.push_back( Vec3f(it.getNormal(i)) );
+            }
+            corners.push_back(used[j]);
+        }
+	}
+
+	VRVertexWelder welder(1e-4);
+	welder.weld(P);
+	auto welded = welder.getPositions(P);
+	auto tris = welder.remapIndices(corners, 3, true);
+	auto normals = welder.merge(N); // averaged over the welded vertices
 
     GeoPnt3fPropertyRecPtr pos = GeoPnt3fProperty::create();
     GeoVec3fPropertyRecPtr norms = GeoVec3fProperty::create();
     GeoUInt32PropertyRecPtr inds = GeoUInt32Property::create();
     GeoUInt32PropertyRecPtr lengths = GeoUInt32Property::create();
-	size_t curIndex = 0;
-	float threshold = 1e-4;
-	size_t NLM = numeric_limits<size_t>::max();
-	Octree oct(threshold);
-
-	TriangleIterator it(geo->getMesh()->geo);
-	for (; !it.isAtEnd() ;++it) {
-        vector<size_t> IDs(3);
-        for (int i=0; i<3; i++) {
-            auto p = it.getPosition(i);
-            vector<void*> resultData = oct.radiusSearch(Vec3d(p), threshold);
-            if (resultData.size() > 0) IDs[i] = *(size_t*)resultData.at(0);
-            else IDs[i] = NLM;
+    pos->editField().resize(welded.size());
+    norms->editField().resize(welded.size());
+    inds->editField().resize(tris.size());
+    for (uint i=0; i<welded.size(); i++) pos->editField()[i] = Pnt3f(welded[i]);
+    for (uint i=0; i<tris.size(); i++) inds->editField()[i] = tris[i];
+    if (hasNormals) {
+        for (uint i=0; i<normals.size(); i++) {
+            normals[i].normalize();
+            norms->editField()[i] = normals[i];
         }
-
-		for (int i=0; i<3; i++) {
-			if (IDs[i] == NLM) {
-                auto p = it.getPosition(i);
-                auto n = it.getNormal(i);
-				pos->addValue(p);
-				norms->addValue(n);
-				IDs[i] = curIndex;
-				size_t *curIndexPtr = new size_t;
-				*curIndexPtr = curIndex;
-				oct.add(Vec3d(p), curIndexPtr);
-				curIndex++;
-			}
-		}
-
-		if (IDs[0] == IDs[1] || IDs[0] == IDs[2] || IDs[1] == IDs[2]) continue;
-
-		for (int i=0; i<3; i++) inds->addValue(IDs[i]);
-	}
+    }
 
     lengths->addValue(inds->size());
 	geo->setPositions(pos);
@@ -64,9 +71,7 @@ void VRSegmentation::removeDuplicates(VRGeometryPtr geo) {
 	geo->setType(GL_TRIANGLES);
 	geo->setLengths(lengths);
 
-	calcVertexNormals(geo->getMesh()->geo);
-
-	for (void* o : oct.getData()) delete (size_t*)o; // Cleanup
+	if (!hasNormals) calcVertexNormals(geo->getMesh()->geo);
 }
 
 
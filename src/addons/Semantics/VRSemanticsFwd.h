@@ -18,6 +18,7 @@ ptrFwd(VROntologyRule);
 ptrFwd(VROntologyLink);
 ptrFwd(VRSemanticContext);
 ptrFwd(VRReasoner);
+ptrFwd(VRRuleEngine);
 ptrFwd(VRStatement);
 ptrFwd(Variable);
 ptrFwd(VRProcess);
@@ -7,6 +7,7 @@
 #include "core/objects/object/VRObject.h"
 #include "core/objects/geometry/VRGeometry.h"
 #include "core/objects/geometry/VRGeoData.h"
+#include "core/objects/geometry/VRInstancedGeometry.h"
 #include "core/objects/geometry/VRPhysics.h"
 #include "core/objects/material/VRMaterial.h"
 #include "core/objects/material/VRTextureGenerator.h"
@@ -164,6 +165,7 @@ VRLodLeafPtr VRLodTree::remObject(VRTransformPtr obj) { // TODO, finish it!
 VRNature::VRNature(string name) : VRLodTree(name, 5) {
     storeMap("templateTrees", &treeTemplates, true);
     storeMap("trees", &treeEntries, true);
+    storeMap("treeInstances", &treeInstanceEntries, true);
     regStorageSetupFkt( VRUpdateCb::create("woods setup", boost::bind(&VRNature::setup, this)) );
 }
 
@@ -178,6 +180,15 @@ void VRNature::setup() {
         tree->setPose(t.second->pos);
         addTree(tree, 0, false);
     }
+
+    for (auto& t : treeInstanceEntries) {
+        string type = t.second->type;
+        int ID = -1;
+        if (treeTemplates.count(type)) ID = createTreeInstance(type, t.second->pos->pos(), false);
+        else if (bushTemplates.count(type)) ID = createBushInstance(type, t.second->pos->pos(), false);
+        else { cout << "VRNature::setup Warning, " << type << " is not a tree template!" << endl; continue; }
+        if (ID >= 0) treeInstanceKeys[ID] = t.first;
+    }
     computeLODs();
 }
 
@@ -225,6 +236,50 @@ VRTreePtr VRNature::createBush(string type, Vec3d p) {
     return t;
 }
 
+VRInstancedGeometryPtr VRNature::getTreeInstances() {
+    if (!treeInstances) {
+        treeInstances = VRInstancedGeometry::create("treeInstances");
+        treeInstances->setPersistency(0);
+        treeInstances->setCellSize(50);
+        addChild(treeInstances);
+    }
+    return treeInstances;
+}
+
+int VRNature::createTreeInstance(string type, Vec3d p, bool addToStore) {
+    if (!treeTemplates.count(type)) return -1;
+    if (terrain) terrain->elevatePoint(p);
+    auto pose = Pose::create(p);
+    int ID = treeTemplates[type]->addInstance(getTreeInstances(), pose);
+    if (addToStore && ID >= 0) storeInstance(ID, pose, type);
+    return ID;
+}
+
+int VRNature::createBushInstance(string type, Vec3d p, bool addToStore) {
+    if (!bushTemplates.count(type)) return -1;
+    if (terrain) terrain->elevatePoint(p);
+    auto pose = Pose::create(p);
+    int ID = bushTemplates[type]->addInstance(getTreeInstances(), pose);
+    if (addToStore && ID >= 0) storeInstance(ID, pose, type);
+    return ID;
+}
+
+void VRNature::storeInstance(int ID, PosePtr pose, string type) { // the instance IDs are not stable across reloads
+    auto te = VRObjectManager::Entry::create();
+    te->set(pose, type);
+    int key = treeInstanceEntries.size() ? treeInstanceEntries.rbegin()->first+1 : 0;
+    treeInstanceEntries[key] = te;
+    treeInstanceKeys[ID] = key;
+}
+
+void VRNature::removeTreeInstance(int ID) {
+    if (!treeInstances) return;
+    treeInstances->remInstance(ID);
+    if (!treeInstanceKeys.count(ID)) return;
+    treeInstanceEntries.erase(treeInstanceKeys[ID]);
+    treeInstanceKeys.erase(ID);
+}
+
 void VRNature::simpleInit(int treeTypes, int bushTypes) {
     auto doTree = [&]() {
 		float H = 2+rand()*6.0/RAND_MAX;
@@ -542,6 +597,9 @@ void VRNature::clear() {
     treeRefs.clear();
     treeEntries.clear();
     treeTemplates.clear();
+    treeInstanceEntries.clear();
+    treeInstanceKeys.clear();
+    treeInstances = 0;
     VRLodTree::reset();
 }
 
@@ -60,6 +60,9 @@ class VRNature : public VRLodTree, public VRWorldModule {
         map<string, VRTreePtr> bushTemplates;
         map<string, shared_ptr<VRObjectManager::Entry> > treeEntries;
         map<VRTree*, VRTreePtr> treeRefs;
+        map<int, shared_ptr<VRObjectManager::Entry> > treeInstanceEntries; // instanced trees and bushes by storage key
+        map<int, int> treeInstanceKeys; // instance ID to storage key
+        VRInstancedGeometryPtr treeInstances;
         VRGeometryPtr collisionMesh;
 
         map<VRGrassPatch*, VRGrassPatchPtr> grassPatchRefs;
@@ -74,6 +77,7 @@ class VRNature : public VRLodTree, public VRWorldModule {
 
         void setup();
         void initLOD();
+        void storeInstance(int ID, PosePtr pose, string type);
 
     public:
         VRNature(string name);
@@ -95,6 +99,12 @@ class VRNature : public VRLodTree, public VRWorldModule {
         VRTreePtr createRandomTree(Vec3d p);
         VRTreePtr createRandomBush(Vec3d p);
 
+        // instanced trees, no scene graph node and LOD per tree
+        int createTreeInstance(string type, Vec3d p, bool addToStore = true);
+        int createBushInstance(string type, Vec3d p, bool addToStore = true);
+        void removeTreeInstance(int ID);
+        VRInstancedGeometryPtr getTreeInstances();
+
         void addWoods(VRPolygonPtr area, bool addGround = 0);
         void addScrub(VRPolygonPtr area, bool addGround = 0);
         void addGrassPatch(VRPolygonPtr area, bool updateLODs = 0, bool addGround = 0);
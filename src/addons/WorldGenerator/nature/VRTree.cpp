@@ -2,6 +2,7 @@
 
 #include "core/objects/geometry/VRGeoData.h"
 #include "core/objects/geometry/OSGGeometry.h"
+#include "core/objects/geometry/VRInstancedGeometry.h"
 #include "core/objects/material/VRMaterial.h"
 #include "core/objects/material/VRTextureGenerator.h"
 #include "core/objects/VRLod.h"
@@ -403,6 +404,13 @@ void VRTree::setLeafMaterial(VRMaterialPtr mat) {
     for (auto g : leafGeos) g->setMaterial(mat);
 }
 
+int VRTree::addInstance(VRInstancedGeometryPtr instances, PosePtr pose) { // the tree is used as prototype, no duplicate
+    if (!instances) return -1;
+    int proto = instances->getPrototype(ptr());
+    if (proto < 0) proto = instances->addPrototype(ptr(), getName());
+    return instances->addInstance(proto, pose);
+}
+
 void VRTree::createHullLeafLod(VRGeoData& geo, int lvl, Vec3d offset, int ID) {
     Matrix4d Offset;
     Offset.setTranslate(offset); // TODO, use tree transformation rotation?
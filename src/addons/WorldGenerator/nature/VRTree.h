@@ -65,6 +65,8 @@ class VRTree : public VRTransform {
         void addLeafs(int lvl, int amount, float size = 0.03);
         void setLeafMaterial(VRMaterialPtr mat);
 
+        int addInstance(VRInstancedGeometryPtr instances, PosePtr pose);
+
         void createHullTrunkLod(VRGeoData& geo, int lvl, Vec3d offset, int ID);
         void createHullLeafLod(VRGeoData& geo, int lvl, Vec3d offset, int ID);
 };
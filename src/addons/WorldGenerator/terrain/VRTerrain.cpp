@@ -36,8 +36,10 @@ VREmbankment::~VREmbankment() {}
 VREmbankmentPtr VREmbankment::create(pathPtr p1, pathPtr p2, pathPtr p3, pathPtr p4) { return VREmbankmentPtr( new VREmbankment(p1,p2,p3,p4) ); }
 
 bool VREmbankment::isInside(Vec2d p) { return area.isInside(p); }
+Boundingbox VREmbankment::getAreaBounds() { return area.getBoundingBox(); } // x and z
+void VREmbankment::prepareQueries() { p1->buildBVH(); p2->buildBVH(); }
 
-float VREmbankment::getHeight(Vec2d p) { // TODO: optimize!
+float VREmbankment::getHeight(Vec2d p) { // closest point queries go through the path segment BVH
     auto computeHeight = [&](float h) {
         Vec3d P(p[0], h, p[1]);
         float t1 = p1->getClosestPoint(P);
@@ -56,7 +58,7 @@ float VREmbankment::getHeight(Vec2d p) { // TODO: optimize!
     return h3;
 }
 
-vector<Vec3d> VREmbankment::probeHeight(Vec2d p) { // TODO: optimize!
+vector<Vec3d> VREmbankment::probeHeight(Vec2d p) {
     vector<Vec3d> res(3);
 
     auto computeHeight = [&](float h) {
@@ -423,22 +425,130 @@ void VRTerrain::elevateObject(VRTransformPtr t, float offset) { auto p = t->getF
 void VRTerrain::elevatePose(PosePtr p, float offset) { auto P = p->pos(); elevatePoint(P, offset); p->setPos(P); }
 void VRTerrain::elevatePoint(Vec3d& p, float offset, bool useEmbankments) { p[1] = getHeight(Vec2d(p[0], p[2]), useEmbankments) + offset; }
 
+vector<double> VRTerrain::getHeights(const vector<Vec2d>& pnts, bool useEmbankments) {
+    int N = pnts.size();
+    vector<double> res(N, 0);
+    if (!tex || N == 0) return res;
+
+    int W = tex->getSize()[0];
+    int H = tex->getSize()[1];
+    int Wm = W-1;
+    int Hm = H-1;
+    auto img = tex->getImage();
+    const float* data = 0; // direct access to RGBA maps, read like getPixel does
+    if (img && tex->getChannels() == 4) data = (const float*)img->getData();
+
+    // embankments binned into a grid over the terrain, points outside go to the border cells
+    const int G = 32;
+    vector<VREmbankmentPtr> embs;
+    vector<Boundingbox> bounds;
+    vector< vector<int> > cells;
+    auto cellIndex = [&](double x, double z, int& cx, int& cz) {
+        cx = max(0, min(G-1, int( floor((x/size[0]+0.5)*G) )));
+        cz = max(0, min(G-1, int( floor((z/size[1]+0.5)*G) )));
+    };
+    if (useEmbankments && embankments.size() > 0) {
+        cells.resize(G*G);
+        for (auto e : embankments) {
+            e.second->prepareQueries();
+            auto b = e.second->getAreaBounds();
+            int x1, z1, x2, z2;
+            cellIndex(b.min()[0], b.min()[2], x1, z1);
+            cellIndex(b.max()[0], b.max()[2], x2, z2);
+            for (int i=x1; i<=x2; i++) for (int j=z1; j<=z2; j++) cells[i+j*G].push_back(embs.size());
+            embs.push_back(e.second);
+            bounds.push_back(b);
+        }
+    }
+
+    const int B = 256;
+    #pragma omp parallel for schedule(dynamic, 4)
+    for (int b=0; b<N; b+=B) {
+        int n = min(B, N-b);
+        double U[B], V[B];
+        int X0[B], X1[B], Y0[B], Y1[B];
+
+        // same arithmetic as getHeight, clamped like VRTexture::getPixel
+        for (int k=0; k<n; k++) {
+            const Vec2d& p = pnts[b+k];
+            double u = (p[0]/size[0] + 0.5)*Wm;
+            double v = (p[1]/size[1] + 0.5)*Hm;
+            int i = round(u-0.5);
+            int j = round(v-0.5);
+            U[k] = u-i;
+            V[k] = v-j;
+            X0[k] = max(0, min(W-1, i));
+            X1[k] = max(0, min(W-1, i+1));
+            Y0[k] = max(0, min(H-1, j));
+            Y1[k] = max(0, min(H-1, j+1));
+        }
+
+        if (data) {
+            for (int k=0; k<n; k++) {
+                double h00 = data[4*(X0[k]+Y0[k]*W)+3];
+                double h10 = data[4*(X1[k]+Y0[k]*W)+3];
+                double h01 = data[4*(X0[k]+Y1[k]*W)+3];
+                double h11 = data[4*(X1[k]+Y1[k]*W)+3];
+                double u = U[k], v = V[k];
+                res[b+k] = ( h00*(1-u) + h10*u )*(1-v) + ( h01*(1-u) + h11*u )*v;
+            }
+        } else {
+            for (int k=0; k<n; k++) {
+                double h00 = tex->getPixel(Vec3i(X0[k],Y0[k],0))[3];
+                double h10 = tex->getPixel(Vec3i(X1[k],Y0[k],0))[3];
+                double h01 = tex->getPixel(Vec3i(X0[k],Y1[k],0))[3];
+                double h11 = tex->getPixel(Vec3i(X1[k],Y1[k],0))[3];
+                double u = U[k], v = V[k];
+                res[b+k] = ( h00*(1-u) + h10*u )*(1-v) + ( h01*(1-u) + h11*u )*v;
+            }
+        }
+
+        if (cells.size() == 0) continue;
+        for (int k=0; k<n; k++) {
+            const Vec2d& p = pnts[b+k];
+            int cx, cz;
+            cellIndex(p[0], p[1], cx, cz);
+            for (int e : cells[cx+cz*G]) {
+                const Boundingbox& bb = bounds[e];
+                if (p[0] < bb.min()[0] || p[0] > bb.max()[0] || p[1] < bb.min()[2] || p[1] > bb.max()[2]) continue;
+                if (!embs[e]->isInside(p)) continue;
+                double h = embs[e]->getHeight(p);
+                if (h > res[b+k]) res[b+k] = h;
+            }
+        }
+    }
+
+    return res;
+}
+
+void VRTerrain::elevatePoints(vector<Vec3d>& pnts, float offset, bool useEmbankments) {
+    vector<Vec2d> P(pnts.size());
+    for (uint i=0; i<pnts.size(); i++) P[i] = Vec2d(pnts[i][0], pnts[i][2]);
+    auto heights = getHeights(P, useEmbankments);
+    for (uint i=0; i<pnts.size(); i++) pnts[i][1] = heights[i] + offset;
+}
+
 void VRTerrain::elevateVertices(VRGeometryPtr geo, float offset) {
     if (!terrain) return;
     GeoPnt3fPropertyRecPtr pos = (GeoPnt3fProperty*)geo->getMesh()->geo->getPositions();
+    vector<Vec2d> P(pos->size());
+    for (uint i=0; i<pos->size(); i++) {
+        Pnt3f p = pos->getValue(i);
+        P[i] = Vec2d(p[0], p[2]);
+    }
+    auto heights = getHeights(P);
     for (uint i=0; i<pos->size(); i++) {
-        Pnt3f p;
-        pos->getValue(p, i);
-        p[1] = getHeight(Vec2d(p[0], p[2])) + offset;
+        Pnt3f p = pos->getValue(i);
+        p[1] = heights[i] + offset;
         pos->setValue(p, i);
     }
 }
 
 void VRTerrain::elevatePolygon(VRPolygonPtr poly, float offset, bool useEmbankments) {
-    for (auto p2 : poly->get()) {
-        Vec3d p3(p2[0], 0, p2[1]);
-        elevatePoint(p3, offset, useEmbankments);
-        poly->addPoint(p3);
+    auto heights = getHeights(poly->get(), useEmbankments);
+    for (uint i=0; i<heights.size(); i++) {
+        Vec2d p2 = poly->get()[i];
+        poly->addPoint( Vec3d(p2[0], heights[i] + offset, p2[1]) );
     }
     poly->get().clear();
 }
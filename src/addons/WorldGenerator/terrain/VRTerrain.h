@@ -23,6 +23,8 @@ class VREmbankment : public VRGeometry{
         static VREmbankmentPtr create(pathPtr p1, pathPtr p2, pathPtr p3, pathPtr p4);
 
         bool isInside(Vec2d p);
+        Boundingbox getAreaBounds();
+        void prepareQueries();
         float getHeight(Vec2d p);
         vector<Vec3d> probeHeight( Vec2d p);
 
@@ -79,7 +81,9 @@ class VRTerrain : public VRGeometry, public VRWorldModule {
         void projectOSM();
 
         double getHeight( const Vec2d& p, bool useEmbankments = true );
+        vector<double> getHeights( const vector<Vec2d>& pnts, bool useEmbankments = true );
         void elevatePoint( Vec3d& p, float offset = 0, bool useEmbankments = true );
+        void elevatePoints( vector<Vec3d>& pnts, float offset = 0, bool useEmbankments = true );
         void elevatePose( PosePtr p, float offset = 0 );
         void elevatePolygon( VRPolygonPtr p, float offset = 0, bool useEmbankments = true );
         void elevateObject( VRTransformPtr p, float offset = 0 );
@@ -144,7 +144,7 @@ void parseParams(int argc, char **argv) {
                 port = parameter;
             default:
                 cout << "\nunknown option " << option << ", usage:";
-                cout << "\n -c : Connection type, Multicast, SockPipeline or StreamSock (default)";
+                cout << "\n -c : Connection type, Multicast, SockPipeline, StreamSock (default) or CompressedStreamSock";
                 cout << "\n -n : Multicast name";
                 cout << "\n -a : Address?";
                 cout << "\n -s : Screen configuration, 0.0:640x480+0+0 (default) 0.0:f (fullscreen)";
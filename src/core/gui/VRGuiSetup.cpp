@@ -79,6 +79,12 @@ void VRGuiSetup::closeAllExpander() {
     setExpanderSensitivity("expander29", false);
 }
 
+string getMultiWindowState(VRMultiWindow* mwin) { // with the traffic of the last frame when the sync stream is compressed
+    string s = mwin->getStateString();
+    if (!mwin->hasType(0) || !mwin->getSyncCodec()) return s;
+    return s + ", sync " + toString(mwin->getSyncBytes()/1024) + " KB (" + toString(mwin->getSyncRawBytes()/1024) + " KB raw)";
+}
+
 void VRGuiSetup::updateObjectData() {
     bool device = false;
     guard = true;
@@ -102,11 +108,12 @@ void VRGuiSetup::updateObjectData() {
             ssy << ny;
             setTextEntry("entry33", ssx.str());
             setTextEntry("entry34", ssy.str());
-            setLabel("win_state", mwin->getStateString());
+            setLabel("win_state", getMultiWindowState(mwin));
             string ct = mwin->getConnectionType();
             if (ct == "Multicast") setRadioButton("radiobutton6", 1);
             if (ct == "SockPipeline") setRadioButton("radiobutton7", 1);
             if (ct == "StreamSock") setRadioButton("radiobutton9", 1);
+            if (ct == "CompressedStreamSock") setRadioButton("radiobutton19", 1);
 
             //TODO: clear server array && add entry for each nx * ny
             Glib::RefPtr<Gtk::ListStore> servers = Glib::RefPtr<Gtk::ListStore>::cast_static(VRGuiBuilder()->get_object("serverlist"));
@@ -577,6 +584,7 @@ void VRGuiSetup::on_server_ct_toggled() {
     string ct = "StreamSock";
     if ( getRadioButtonState("radiobutton6") ) ct = "Multicast";
     if ( getRadioButtonState("radiobutton7") ) ct = "SockPipeline";
+    if ( getRadioButtonState("radiobutton19") ) ct = "CompressedStreamSock";
 
     VRMultiWindow* mwin = (VRMultiWindow*)selected_object;
     mwin->setConnectionType(ct);
@@ -1164,6 +1172,7 @@ VRGuiSetup::VRGuiSetup() {
     setRadioButtonCallback("radiobutton6", sigc::mem_fun(*this, &VRGuiSetup::on_server_ct_toggled) );
     setRadioButtonCallback("radiobutton7", sigc::mem_fun(*this, &VRGuiSetup::on_server_ct_toggled) );
     setRadioButtonCallback("radiobutton9", sigc::mem_fun(*this, &VRGuiSetup::on_server_ct_toggled) );
+    setRadioButtonCallback("radiobutton19", sigc::mem_fun(*this, &VRGuiSetup::on_server_ct_toggled) );
     setRadioButtonCallback("radiobutton10", sigc::mem_fun(*this, &VRGuiSetup::on_netslave_edited));
     setRadioButtonCallback("radiobutton11", sigc::mem_fun(*this, &VRGuiSetup::on_netslave_edited));
     setRadioButtonCallback("radiobutton12", sigc::mem_fun(*this, &VRGuiSetup::on_netslave_edited));
@@ -1241,7 +1250,7 @@ void VRGuiSetup::setTreeRow(Glib::RefPtr<Gtk::TreeStore> tree_store, Gtk::TreeSt
 }
 
 void VRGuiSetup::updateStatus() {
-    if (mwindow != 0) setLabel("win_state", mwindow->getStateString());
+    if (mwindow != 0) setLabel("win_state", getMultiWindowState(mwindow));
 }
 
 void VRGuiSetup::updateSetup() {
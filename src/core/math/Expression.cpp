@@ -1,6 +1,10 @@
 #include "Expression.h"
 #include "core/utils/toString.h"
+#include <iostream>
 #include <stack>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
 
 using namespace OSG;
 
@@ -39,13 +43,19 @@ Expression::ValueBase* Expression::Value<T>::div(Expression::ValueBase* n) {
     return 0;
 }
 
+template<>
+Expression::ValueBase* Expression::Value<float>::div(Expression::ValueBase* n) {
+    if (auto v2 = dynamic_cast<Value<float>*>(n)) return new Value<float>(value / v2->value);
+    return 0;
+}
+
 
 
 Expression::Node::Node(string s) : param(s) {;}
 Expression::Node::~Node() { if (value) delete value; }
 
-void Expression::Node::setValue(float f) { value = new Value<float>(f); }
-void Expression::Node::setValue(Vec3d v) { value = new Value<Vec3d>(v); }
+void Expression::Node::setValue(float f) { if (value) delete value; value = new Value<float>(f); }
+void Expression::Node::setValue(Vec3d v) { if (value) delete value; value = new Value<Vec3d>(v); }
 void Expression::Node::setValue(string s) {
     int N = std::count(s.begin(), s.end(), ' ');
     if (N == 0) setValue(toFloat(s));
@@ -54,8 +64,8 @@ void Expression::Node::setValue(string s) {
 
 string Expression::Node::toString() {
     string res = value ? value->toString() : param;
-    if (right) res = right->toString() + res;
-    if (left) res += left->toString();
+    if (left) res = left->toString() + res;
+    if (right) res += right->toString();
     return res;
 }
 
@@ -69,6 +79,7 @@ string Expression::Node::treeToString(string indent) {
 
 void Expression::Node::compute() { // compute value based on left and right values and param as operator
     if (left->value == 0 || right->value == 0) return;
+    if (value) { delete value; value = 0; }
     char op = param[0];
     if (op == '+') value = left->value->add(right->value);
     if (op == '-') value = left->value->sub(right->value);
@@ -117,22 +128,20 @@ void Expression::convToPrefixExpr() { // convert infix to prefix expression
         }
         char o = t[0];
 
-        if ( o == '(' || OperatorStack.size() == 0 || OperatorHierarchy[o] < OperatorHierarchy[OperatorStack.top()] ) {
-            OperatorStack.push(o); continue;
-        }
-
         if ( o == ')' ) {
             while( OperatorStack.top() != '(' ) processTriple();
-            o = OperatorStack.top(); OperatorStack.pop();
+            OperatorStack.pop();
             continue;
         }
 
-        if ( OperatorHierarchy[o] >= OperatorHierarchy[OperatorStack.top()] ) {
-            while( OperatorStack.size() != 0 and OperatorHierarchy[o] >= OperatorHierarchy[OperatorStack.top()] ) {
-                processTriple();
-            }
-            OperatorStack.push(o);
+        if ( o == '(' || OperatorStack.size() == 0 || OperatorHierarchy[o] < OperatorHierarchy[OperatorStack.top()] ) {
+            OperatorStack.push(o); continue;
+        }
+
+        while( OperatorStack.size() != 0 and OperatorStack.top() != '(' and OperatorHierarchy[o] >= OperatorHierarchy[OperatorStack.top()] ) {
+            processTriple();
         }
+        OperatorStack.push(o);
     }
 
     while( OperatorStack.size() ) processTriple();
@@ -163,8 +172,8 @@ void Expression::buildTree() { // build a binary expression tree from the prefix
         node = new Node(t);
         nodes.push_back(node);
         if ( t.size() == 1 && isMathToken(t[0]) ) { // found operator
+            node->left = nodeStack.top(); nodeStack.pop(); // tokens are read backwards, the first operand is on top
             node->right = nodeStack.top(); nodeStack.pop();
-            node->left = nodeStack.top(); nodeStack.pop();
             nodeStack.push(node);
         } else nodeStack.push(node);
     }
@@ -215,7 +224,153 @@ string Expression::compute() { // compute result of binary expression tree
 
 string Expression::toString() { return tree->toString(); }
 
+static double applyOp(Expression::Program::OPCODE op, double a, double b) {
+    switch (op) {
+        case Expression::Program::ADD: return a + b;
+        case Expression::Program::SUB: return a - b;
+        case Expression::Program::MULT: return a * b;
+        case Expression::Program::DIV: return a / b;
+    }
+    return 0;
+}
+
+Expression::Program Expression::compile(vector<string> vars) {
+    Program p;
+    p.variables = vars;
+    if (!tree) computeTree();
+    if (!tree) return p;
+
+    struct Operand { // constant, variable or temporary
+        char kind = 'c';
+        double c = 0;
+        int i = 0;
+    };
+
+    struct Op {
+        Program::OPCODE op;
+        Operand r, a, b;
+    };
+
+    vector<Op> ops;
+    vector<int> freeTemps;
+    int temps = 0;
+    bool ok = true;
+
+    auto isConst = [](const Operand& o, double c) { return o.kind == 'c' && o.c == c; };
+
+    std::function<Operand(Node*)> emit = [&](Node* n) -> Operand {
+        Operand o;
+        if (!n->left || !n->right) { // leaf
+            if (auto v = dynamic_cast<Value<float>*>(n->value)) { o.c = v->value; return o; }
+            if (n->value) { ok = false; return o; } // only scalar values
+            char* end = 0;
+            double d = strtod(n->param.c_str(), &end);
+            if (n->param.size() && *end == 0) { o.c = d; return o; }
+            o.kind = 'v';
+            o.i = p.getVariable(n->param);
+            if (o.i < 0) { o.i = p.variables.size(); p.variables.push_back(n->param); }
+            return o;
+        }
+
+        Operand a = emit(n->left);
+        Operand b = emit(n->right);
+        char c = n->param[0];
+        Program::OPCODE op = Program::ADD;
+        if (c == '-') op = Program::SUB;
+        if (c == '*') op = Program::MULT;
+        if (c == '/') op = Program::DIV;
+
+        // constant folding
+        if (a.kind == 'c' && b.kind == 'c') { o.c = applyOp(op, a.c, b.c); return o; }
+        if (isConst(b, 0) && (op == Program::ADD || op == Program::SUB)) return a;
+        if (isConst(a, 0) && op == Program::ADD) return b;
+        if (isConst(b, 1) && (op == Program::MULT || op == Program::DIV)) return a;
+        if (isConst(a, 1) && op == Program::MULT) return b;
+
+        // operand temporaries are free again once read
+        if (a.kind == 't') freeTemps.push_back(a.i);
+        if (b.kind == 't') freeTemps.push_back(b.i);
+        o.kind = 't';
+        if (freeTemps.size()) { o.i = freeTemps.back(); freeTemps.pop_back(); }
+        else o.i = temps++;
+        ops.push_back({op, o, a, b});
+        return o;
+    };
+
+    Operand res = emit(tree);
+    if (!ok) { cout << "Expression::compile failed, only scalar expressions are supported: " << data << endl; return p; }
+
+    // map the operands to registers
+    int V = p.variables.size();
+    map<double, int> constIDs;
+    auto reg = [&](const Operand& o) -> int {
+        if (o.kind == 'v') return o.i;
+        if (o.kind == 't') return -1-o.i; // resolved below, the number of constants is not known yet
+        if (!constIDs.count(o.c)) { constIDs[o.c] = p.constants.size(); p.constants.push_back(o.c); }
+        return V + constIDs[o.c];
+    };
+
+    for (auto& o : ops) p.code.push_back({o.op, reg(o.r), reg(o.a), reg(o.b)});
+    p.result = reg(res);
 
+    int T0 = V + p.constants.size();
+    auto resolve = [&](int& r) { if (r < 0) r = T0-1-r; };
+    for (auto& I : p.code) { resolve(I.r); resolve(I.a); resolve(I.b); }
+    resolve(p.result);
+    p.registers = T0 + temps;
+    return p;
+}
 
+bool Expression::Program::valid() { return result >= 0; }
 
+int Expression::Program::getVariable(string name) {
+    for (unsigned int i=0; i<variables.size(); i++) if (variables[i] == name) return i;
+    return -1;
+}
 
+double Expression::Program::evaluate(const vector<double>& values) {
+    if (result < 0 || values.size() < variables.size()) return 0;
+    vector<double> R(registers);
+    int V = variables.size();
+    for (int i=0; i<V; i++) R[i] = values[i];
+    for (unsigned int i=0; i<constants.size(); i++) R[V+i] = constants[i];
+    for (auto& I : code) R[I.r] = applyOp(I.op, R[I.a], R[I.b]);
+    return R[result];
+}
+
+void Expression::Program::evaluate(const vector<double>& bindings, vector<double>& results) {
+    size_t N = results.size();
+    int V = variables.size();
+    if (result < 0 || bindings.size() < V*N) return;
+
+    // blocks of bindings are evaluated one instruction at a time, the inner loops vectorize
+    const int B = 256;
+    int blocks = (N+B-1)/B;
+
+    #pragma omp parallel if (blocks > 16)
+    {
+        vector<double> R(size_t(registers)*B);
+        for (unsigned int c=0; c<constants.size(); c++) fill(&R[(V+c)*B], &R[(V+c)*B]+B, constants[c]);
+
+        #pragma omp for schedule(static)
+        for (int k=0; k<blocks; k++) {
+            size_t i0 = size_t(k)*B;
+            int n = min(size_t(B), N-i0);
+            for (int v=0; v<V; v++) copy(&bindings[v*N+i0], &bindings[v*N+i0]+n, &R[v*B]);
+
+            for (auto& I : code) {
+                double* r = &R[I.r*B];
+                const double* a = &R[I.a*B];
+                const double* b = &R[I.b*B];
+                switch (I.op) {
+                    case ADD: for (int i=0; i<n; i++) r[i] = a[i] + b[i]; break;
+                    case SUB: for (int i=0; i<n; i++) r[i] = a[i] - b[i]; break;
+                    case MULT: for (int i=0; i<n; i++) r[i] = a[i] * b[i]; break;
+                    case DIV: for (int i=0; i<n; i++) r[i] = a[i] / b[i]; break;
+                }
+            }
+
+            copy(&R[result*B], &R[result*B]+n, &results[i0]);
+        }
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include <OpenSG/OSGVector.h>
 
@@ -54,6 +55,31 @@ class Expression {
             void compute();
         };
 
+        /**
+            Flat register program compiled from the expression tree, for repeated scalar evaluation.
+            Numbers and leafs with a float value become constants, the other leafs variables,
+            operations on constants only are folded at compile time.
+            The registers are the variables, followed by the constants and the temporaries.
+        */
+        struct Program {
+            enum OPCODE { ADD, SUB, MULT, DIV };
+            struct Instruction {
+                OPCODE op;
+                int r, a, b; // registers, r = a op b
+            };
+
+            vector<string> variables;
+            vector<double> constants;
+            vector<Instruction> code;
+            int registers = 0;
+            int result = -1; // register of the result, -1 if the compilation failed
+
+            bool valid();
+            int getVariable(string name);
+            double evaluate(const vector<double>& values); // one value for each variable
+            void evaluate(const vector<double>& bindings, vector<double>& results); // all bindings of a variable in a row, N = results.size()
+        };
+
     public:
         string data;
         Node* tree = 0;
@@ -74,6 +100,8 @@ class Expression {
         vector<Node*> getLeafs();
         string compute();
         string toString();
+
+        Program compile(vector<string> variables = vector<string>()); // fixes the order of the given variables, others are appended
 };
 
 OSG_END_NAMESPACE;
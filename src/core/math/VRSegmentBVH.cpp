@@ -0,0 +1,134 @@
+#include "VRSegmentBVH.h"
+
+#include <algorithm>
+
+using namespace OSG;
+
+VRSegmentBVH::VRSegmentBVH() {}
+
+bool VRSegmentBVH::empty() { return nodes.size() == 0; }
+int VRSegmentBVH::size() { return order.size(); }
+
+void VRSegmentBVH::build(const vector<Vec3d>& P) {
+    points = P;
+    nodes.clear();
+    order.clear();
+    if (points.size() < 2) return;
+
+    int N = points.size()-1;
+    vector<Vec3d> centers(N);
+    order.resize(N);
+    for (int i=0; i<N; i++) {
+        centers[i] = (points[i]+points[i+1])*0.5;
+        order[i] = i;
+    }
+
+    nodes.reserve(2*N/leafSize+2);
+    nodes.push_back(Node());
+    buildNode(0, 0, N, centers);
+}
+
+void VRSegmentBVH::buildNode(int n, int start, int count, vector<Vec3d>& centers) {
+    Vec3d bb1(1e20,1e20,1e20), bb2(-1e20,-1e20,-1e20);
+    Vec3d c1 = bb1, c2 = bb2;
+    for (int k=start; k<start+count; k++) {
+        int i = order[k];
+        for (int a=0; a<3; a++) {
+            bb1[a] = min(bb1[a], min(points[i][a], points[i+1][a]));
+            bb2[a] = max(bb2[a], max(points[i][a], points[i+1][a]));
+            c1[a] = min(c1[a], centers[i][a]);
+            c2[a] = max(c2[a], centers[i][a]);
+        }
+    }
+    nodes[n].bb1 = bb1;
+    nodes[n].bb2 = bb2;
+
+    if (count <= leafSize) {
+        nodes[n].start = start;
+        nodes[n].count = count;
+        return;
+    }
+
+    Vec3d e = c2-c1;
+    int axis = 0;
+    if (e[1] > e[axis]) axis = 1;
+    if (e[2] > e[axis]) axis = 2;
+    int half = count/2;
+    nth_element(order.begin()+start, order.begin()+start+half, order.begin()+start+count,
+                [&](int a, int b) { return centers[a][axis] < centers[b][axis]; });
+
+    int l = nodes.size();
+    nodes[n].left = l;
+    nodes.push_back(Node());
+    nodes.push_back(Node());
+    buildNode(l, start, half, centers);
+    buildNode(l+1, start+half, count-half, centers);
+}
+
+double VRSegmentBVH::boxDist2(const Node& n, const Vec3d& p) {
+    double d2 = 0;
+    for (int a=0; a<3; a++) {
+        double d = 0;
+        if (p[a] < n.bb1[a]) d = n.bb1[a]-p[a];
+        if (p[a] > n.bb2[a]) d = p[a]-n.bb2[a];
+        d2 += d*d;
+    }
+    return d2;
+}
+
+// same arithmetic as the linear scan in path
+void VRSegmentBVH::testSegment(const Vec3d& p1, const Vec3d& p2, const Vec3d& p, int i, Result& res) {
+    auto d = p2-p1;
+    auto L2 = d.squareLength();
+    auto t = -(p1-p).dot(d)/L2;
+    auto ps = p1+d*t;
+    if (t<0) { ps = p1; t = 0; }
+    if (t>1) { ps = p2; t = 1; }
+    float D2 = (ps-p).squareLength();
+    if (res.dist2 > D2 || (res.dist2 == D2 && i < res.segment)) {
+        res.dist2 = D2;
+        res.segment = i;
+        res.t = t;
+    }
+}
+
+VRSegmentBVH::Result VRSegmentBVH::closestLinear(const vector<Vec3d>& points, const Vec3d& p) {
+    Result res;
+    for (unsigned int i=1; i<points.size(); i++) testSegment(points[i-1], points[i], p, i-1, res);
+    return res;
+}
+
+VRSegmentBVH::Result VRSegmentBVH::closest(const Vec3d& p) {
+    Result res;
+    if (nodes.size() == 0) return res;
+
+    int stack[128];
+    int S = 0;
+    stack[S++] = 0;
+    while (S > 0) {
+        const Node& n = nodes[stack[--S]];
+        double bound = double(res.dist2)*(1+1e-5) + 1e-12; // keep ties of the float distances
+        if (boxDist2(n, p) > bound) continue;
+
+        if (n.left < 0) {
+            for (int k=n.start; k<n.start+n.count; k++) {
+                int i = order[k];
+                testSegment(points[i], points[i+1], p, i, res);
+            }
+            continue;
+        }
+
+        int a = n.left, b = n.left+1; // push the far child first
+        if (boxDist2(nodes[a], p) > boxDist2(nodes[b], p)) swap(a,b);
+        stack[S++] = b;
+        stack[S++] = a;
+    }
+    return res;
+}
+
+vector<VRSegmentBVH::Result> VRSegmentBVH::closest(const vector<Vec3d>& P) {
+    vector<Result> res(P.size());
+    #pragma omp parallel for schedule(dynamic, 256)
+    for (int i=0; i<int(P.size()); i++) res[i] = closest(P[i]);
+    return res;
+}
@@ -0,0 +1,57 @@
+#ifndef VRSEGMENTBVH_H_INCLUDED
+#define VRSEGMENTBVH_H_INCLUDED
+
+#include <OpenSG/OSGVector.h>
+#include <vector>
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Bounding volume hierarchy over the segments of a polyline.
+    Nodes are axis aligned boxes split at the median of the longest axis, stored in a flat array.
+    Closest point queries visit the nearer child first and prune boxes farther away than the best segment,
+    results are identical to the linear scan, ties go to the lowest segment.
+*/
+
+class VRSegmentBVH {
+    public:
+        struct Result {
+            int segment = -1;
+            double t = 0; // on the segment
+            float dist2 = 1.0e20;
+        };
+
+    private:
+        struct Node {
+            Vec3d bb1, bb2;
+            int left = -1; // inner node: right child is left+1
+            int start = 0; // leaf: range in order
+            int count = 0;
+        };
+
+        vector<Vec3d> points;
+        vector<Node> nodes;
+        vector<int> order; // segments sorted by node
+        int leafSize = 4;
+
+        void buildNode(int n, int start, int count, vector<Vec3d>& centers);
+        static double boxDist2(const Node& n, const Vec3d& p);
+
+    public:
+        VRSegmentBVH();
+
+        void build(const vector<Vec3d>& points);
+        bool empty();
+        int size();
+
+        Result closest(const Vec3d& p);
+        vector<Result> closest(const vector<Vec3d>& points);
+
+        static void testSegment(const Vec3d& p1, const Vec3d& p2, const Vec3d& p, int i, Result& res);
+        static Result closestLinear(const vector<Vec3d>& points, const Vec3d& p);
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRSEGMENTBVH_H_INCLUDED
@@ -0,0 +1,163 @@
+#include "VRVertexWelder.h"
+
+#include <algorithm>
+#include <cmath>
+#ifdef _OPENMP
+#include <parallel/algorithm>
+#endif
+
+using namespace OSG;
+
+VRVertexWelder::VRVertexWelder(float t) : tolerance(t) {}
+
+int VRVertexWelder::size() { return reps.size(); }
+const vector<int>& VRVertexWelder::getMapping() { return mapping; }
+const vector<int>& VRVertexWelder::getRepresentatives() { return reps; }
+
+int64_t VRVertexWelder::cellCoord(float x, float c, int* side) { // in double and clamped, huge coordinates or tiny cells would overflow an int
+    double f = double(x)/c;
+    double X = max(-1e18, min(1e18, floor(f)));
+    if (side) *side = (f-X < 0.5) ? -1 : 1;
+    return int64_t(X);
+}
+
+uint64_t VRVertexWelder::cellKey(int64_t x, int64_t y, int64_t z) { // 21 bit per axis, cells far apart may share a key, the distance test keeps them apart
+    const uint64_t m = (1<<21)-1;
+    return (uint64_t(x) & m) << 42 | (uint64_t(y) & m) << 21 | (uint64_t(z) & m);
+}
+
+namespace {
+    inline uint64_t hashKey(uint64_t k, int bits) { return (k * 0x9E3779B97F4A7C15ULL) >> (64-bits); }
+
+    inline float dist2(const Vec3f& a, const Vec3f& b) {
+        float x = a[0]-b[0], y = a[1]-b[1], z = a[2]-b[2];
+        return x*x + y*y + z*z;
+    }
+}
+
+int VRVertexWelder::findCell(uint64_t key) {
+    uint64_t mask = (uint64_t(1) << tableBits) - 1;
+    for (uint64_t h = hashKey(key, tableBits); ; h = (h+1) & mask) {
+        int c = table[h];
+        if (c < 0) return -1;
+        if (keys[c] == key) return c;
+    }
+}
+
+void VRVertexWelder::weld(const vector<Vec3f>& P) {
+    int N = P.size();
+    float t2 = tolerance*tolerance;
+    float c = max(2.01f*tolerance, 1e-9f); // with a cell size above 2*tolerance only 8 cells need to be checked
+
+    // sort vertices by cell, ties by index
+    vector<pair<uint64_t, int>> kv(N);
+    #pragma omp parallel for
+    for (int i=0; i<N; i++) {
+        const Vec3f& p = P[i];
+        kv[i] = make_pair( cellKey(cellCoord(p[0], c), cellCoord(p[1], c), cellCoord(p[2], c)), i );
+    }
+#ifdef _OPENMP
+    __gnu_parallel::sort(kv.begin(), kv.end());
+#else
+    sort(kv.begin(), kv.end());
+#endif
+
+    keys.clear();
+    cellStart.clear();
+    sorted.resize(N);
+    for (int i=0; i<N; i++) {
+        sorted[i] = kv[i].second;
+        if (i == 0 || kv[i].first != kv[i-1].first) {
+            keys.push_back(kv[i].first);
+            cellStart.push_back(i);
+        }
+    }
+    cellStart.push_back(N);
+    kv.clear();
+
+    tableBits = 1;
+    while ((size_t(1) << tableBits) < 2*keys.size()) tableBits++;
+    table.assign(size_t(1) << tableBits, -1);
+    uint64_t mask = (uint64_t(1) << tableBits) - 1;
+    for (unsigned int i=0; i<keys.size(); i++) {
+        uint64_t h = hashKey(keys[i], tableBits);
+        while (table[h] >= 0) h = (h+1) & mask;
+        table[h] = i;
+    }
+
+    // greedy in index order, merge into the lowest kept vertex in range
+    vector<int> rep(N);
+    for (int i=0; i<N; i++) {
+        const Vec3f& p = P[i];
+        int best = i;
+        int64_t X[3];
+        int D[3];
+        for (int k=0; k<3; k++) X[k] = cellCoord(p[k], c, &D[k]);
+
+        for (int a=0; a<2; a++) for (int b=0; b<2; b++) for (int d=0; d<2; d++) {
+            int cell = findCell( cellKey(X[0]+a*D[0], X[1]+b*D[1], X[2]+d*D[2]) );
+            if (cell < 0) continue;
+            for (int k=cellStart[cell]; k<cellStart[cell+1]; k++) {
+                int j = sorted[k];
+                if (j >= best) break;
+                if (rep[j] != j) continue;
+                if (dist2(p, P[j]) <= t2) { best = j; break; }
+            }
+        }
+        rep[i] = best;
+    }
+
+    // compact
+    mapping.resize(N);
+    reps.clear();
+    counts.clear();
+    for (int i=0; i<N; i++) {
+        if (rep[i] == i) {
+            mapping[i] = reps.size();
+            reps.push_back(i);
+            counts.push_back(0);
+        } else mapping[i] = mapping[rep[i]];
+        counts[mapping[i]]++;
+    }
+
+    table.clear();
+}
+
+vector<Vec3f> VRVertexWelder::getPositions(const vector<Vec3f>& P) {
+    vector<Vec3f> res(reps.size());
+    #pragma omp parallel for
+    for (int i=0; i<int(reps.size()); i++) res[i] = P[reps[i]];
+    return res;
+}
+
+vector<int> VRVertexWelder::remapIndices(const vector<int>& indices, int S, bool dropDegenerate) {
+    vector<int> res;
+    res.reserve(indices.size());
+    vector<int> prim(S);
+    for (unsigned int i=0; i+S<=indices.size(); i+=S) {
+        bool degenerate = false;
+        for (int k=0; k<S; k++) {
+            prim[k] = mapping[indices[i+k]];
+            for (int l=0; l<k; l++) if (prim[l] == prim[k]) degenerate = true;
+        }
+        if (degenerate && dropDegenerate) continue;
+        res.insert(res.end(), prim.begin(), prim.end());
+    }
+    return res;
+}
+
+vector<int> VRVertexWelder::weldBruteForce(const vector<Vec3f>& P, float tolerance) {
+    int N = P.size();
+    float t2 = tolerance*tolerance;
+    vector<int> rep(N), mapping(N);
+    int n = 0;
+    for (int i=0; i<N; i++) {
+        rep[i] = i;
+        for (int j=0; j<i; j++) {
+            if (rep[j] != j) continue;
+            if (dist2(P[i], P[j]) <= t2) { rep[i] = j; break; }
+        }
+        mapping[i] = (rep[i] == i) ? n++ : mapping[rep[i]];
+    }
+    return mapping;
+}
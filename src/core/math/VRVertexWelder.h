@@ -0,0 +1,63 @@
+#ifndef VRVERTEXWELDER_H_INCLUDED
+#define VRVERTEXWELDER_H_INCLUDED
+
+#include <OpenSG/OSGVector.h>
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Tolerance based vertex welding on a uniform grid spatial hash.
+    Vertices are sorted by cell key, each vertex is merged into the first (lowest index) kept
+    vertex within the tolerance. The cells are larger than twice the tolerance, so only the 8 cells
+    around the cell corner next to the vertex have to be checked.
+*/
+
+class VRVertexWelder {
+    private:
+        float tolerance = 1e-4;
+        vector<int> mapping; // old vertex -> new vertex
+        vector<int> reps; // new vertex -> representative old vertex
+        vector<int> counts; // old vertices per new vertex
+
+        vector<uint64_t> keys; // sorted cell keys, one entry per cell
+        vector<int> cellStart;
+        vector<int> sorted; // vertex indices sorted by cell
+        vector<int> table; // open addressing, cell key -> cell
+        int tableBits = 0;
+
+        static int64_t cellCoord(float x, float c, int* side = 0);
+        static uint64_t cellKey(int64_t x, int64_t y, int64_t z);
+        int findCell(uint64_t key);
+
+    public:
+        VRVertexWelder(float tolerance = 1e-4);
+
+        void weld(const vector<Vec3f>& positions);
+
+        int size();
+        const vector<int>& getMapping();
+        const vector<int>& getRepresentatives();
+
+        vector<Vec3f> getPositions(const vector<Vec3f>& positions);
+        template<class T> vector<T> merge(const vector<T>& attribute);
+        vector<int> remapIndices(const vector<int>& indices, int primitiveSize = 3, bool dropDegenerate = true);
+
+        static vector<int> weldBruteForce(const vector<Vec3f>& positions, float tolerance);
+};
+
+template<class T>
+vector<T> VRVertexWelder::merge(const vector<T>& attribute) {
+    vector<T> res(reps.size(), T());
+    if (attribute.size() != mapping.size()) return res;
+    for (unsigned int i=0; i<mapping.size(); i++) res[mapping[i]] += attribute[i];
+    #pragma omp parallel for
+    for (int i=0; i<int(res.size()); i++) res[i] *= 1.0/counts[i];
+    return res;
+}
+
+OSG_END_NAMESPACE;
+
+#endif // VRVERTEXWELDER_H_INCLUDED
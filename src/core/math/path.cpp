@@ -2,6 +2,7 @@
 #include "core/objects/VRTransform.h"
 #include "core/math/polygon.h"
 #include "core/math/equation.h"
+#include "core/math/VRSegmentBVH.h"
 #include "core/utils/toString.h"
 #include "core/utils/VRStorage_template.h"
 
@@ -246,6 +247,7 @@ int path::size() { return points.size(); }
 void path::compute(int N) {
     if (points.size() <= 1) return;
     iterations = N;
+    bvh = 0;
 
     int Nsegs = points.size()-1; // degree 3
     if (degree == 2) Nsegs = (points.size()-1)/2;
@@ -414,28 +416,29 @@ PosePtr path::getPose(float t, int i, int j, bool fast) {
     return Pose::create(getPosition(t,i,j,fast), d, u);
 }
 
-float path::getClosestPoint(Vec3d p) {
-    float dist2 = 1.0e20;
-    float t_min = 0;
+VRSegmentBVH* path::getBVH() {
+    if (!bvh) {
+        bvh = shared_ptr<VRSegmentBVH>( new VRSegmentBVH() );
+        bvh->build(positions);
+    }
+    return bvh.get();
+}
 
-    for (uint i=1; i<positions.size(); i++){
-        Vec3d p1 = positions[i-1];
-        Vec3d p2 = positions[i];
+void path::buildBVH() { getBVH(); }
 
-        auto d = p2-p1;
-        auto L2 = d.squareLength();
-        auto t = -(p1-p).dot(d)/L2;
-        auto ps = p1+d*t;
-        if (t<0) { ps = p1; t = 0; }
-        if (t>1) { ps = p2; t = 1; }
-        float D2 = (ps-p).squareLength();
-        if (dist2 > D2) {
-            dist2 = D2;
-            t_min = (float(i-1)+t)/(positions.size()-1);
-        }
-    }
+float path::getClosestPoint(Vec3d p) {
+    if (positions.size() < 2) return 0;
+    auto r = getBVH()->closest(p);
+    if (r.segment < 0) return 0;
+    return (float(r.segment)+r.t)/(positions.size()-1);
+}
 
-    return t_min;
+vector<float> path::getClosestPoints(const vector<Vec3d>& pnts) {
+    vector<float> res(pnts.size(), 0);
+    if (positions.size() < 2) return res;
+    auto R = getBVH()->closest(pnts);
+    for (uint i=0; i<R.size(); i++) if (R[i].segment >= 0) res[i] = (float(R[i].segment)+R[i].t)/(positions.size()-1);
+    return res;
 }
 
 float path::getDistanceToHull(Vec3d p) {
@@ -458,22 +461,16 @@ float path::getDistanceToHull(Vec3d p) {
 }
 
 float path::getDistance(Vec3d p) {
-    float dist2 = 1.0e20;
-
-    for (uint i=1; i<positions.size(); i++){
-        Vec3d p1 = positions[i-1];
-        Vec3d p2 = positions[i];
-        auto d = p2-p1;
-        auto L2 = d.squareLength();
-        auto t = -(p1-p).dot(d)/L2;
-        auto ps = p1+d*t;
-        if (t<0) ps = p1;
-        if (t>1) ps = p2;
-        float D2 = (ps-p).squareLength();
-        if (dist2 > D2) dist2 = D2;
-    }
+    if (positions.size() < 2) return sqrt(1.0e20);
+    return sqrt( getBVH()->closest(p).dist2 );
+}
 
-    return sqrt(dist2);
+vector<float> path::getDistances(const vector<Vec3d>& pnts) {
+    vector<float> res(pnts.size(), sqrt(1.0e20));
+    if (positions.size() < 2) return res;
+    auto R = getBVH()->closest(pnts);
+    for (uint i=0; i<R.size(); i++) res[i] = sqrt(R[i].dist2);
+    return res;
 }
 
 void path::clear() {
@@ -482,6 +479,7 @@ void path::clear() {
     directions.clear();
     up_vectors.clear();
     colors.clear();
+    bvh = 0;
 }
 
 void clampSegment(int& i, int& j, int N) {
@@ -10,6 +10,8 @@
 OSG_BEGIN_NAMESPACE;
 using namespace std;
 
+class VRSegmentBVH;
+
 class path : public VRStorage {
     private:
         vector<Pose> points;
@@ -24,6 +26,9 @@ class path : public VRStorage {
         vector<Vec3d> directions;
         vector<Vec3d> up_vectors;
         vector<Vec3d> colors;
+        shared_ptr<VRSegmentBVH> bvh; // built on first query after compute
+
+        VRSegmentBVH* getBVH();
 
         Vec3d interp(vector<Vec3d>& vec, float t, int i = 0, int j = 0);
         Vec3d projectInPlane(Vec3d v, Vec3d n, bool keep_length);
@@ -59,6 +64,9 @@ class path : public VRStorage {
 
         float getClosestPoint(Vec3d p); // return t parameter on path
         float getDistance(Vec3d p);
+        vector<float> getClosestPoints(const vector<Vec3d>& pnts); // batched, in parallel
+        void buildBVH(); // build the query hierarchy now, before concurrent queries
+        vector<float> getDistances(const vector<Vec3d>& pnts);
         float getDistanceToHull(Vec3d p);
         vector<double> computeInflectionPoints(int i = 0, int j = 0, float threshold = 1e-9, float accelerationThreshold = 0, Vec3i axis = Vec3i(1,1,1));
 
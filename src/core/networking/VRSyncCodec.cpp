@@ -0,0 +1,177 @@
+#include "VRSyncCodec.h"
+
+#include <zlib.h>
+#include <cstring>
+#include <cstdint>
+
+using namespace OSG;
+
+namespace {
+    const size_t headerSize = 7;
+
+    void toPlanes(const char* in, char* out, size_t N) { // byte k of every 32 bit word into plane k, the tail stays
+        size_t W = N/4;
+        for (size_t i=0; i<W; i++)
+            for (int k=0; k<4; k++) out[k*W + i] = in[4*i + k];
+        memcpy(out + 4*W, in + 4*W, N - 4*W);
+    }
+
+    void fromPlanes(const char* in, char* out, size_t N) {
+        size_t W = N/4;
+        for (size_t i=0; i<W; i++)
+            for (int k=0; k<4; k++) out[4*i + k] = in[k*W + i];
+        memcpy(out + 4*W, in + 4*W, N - 4*W);
+    }
+
+    uint32_t word(const char* d, size_t i) { uint32_t w; memcpy(&w, d + 4*i, 4); return w; }
+    void setWord(char* d, size_t i, uint32_t w) { memcpy(d + 4*i, &w, 4); }
+    uint32_t zigzag(uint32_t d) { return (d << 1) ^ (0u - (d >> 31)); } // small negative and positive differences to small numbers
+    uint32_t unzigzag(uint32_t z) { return (z >> 1) ^ (0u - (z & 1)); }
+
+    /**
+        Residuals of the 32 bit words against a prediction from the reference buffers, as integers on the bit patterns.
+        For floats with unchanged sign and exponent this is the difference of the mantissas,
+        first order predicts the previous value, second order extrapolates linearly from the two previous values.
+        Bytes beyond the words or the references are XOR'ed or kept.
+    */
+    void residuals(const char* data, size_t N, const string* r1, const string* r2, char* out) {
+        size_t W = N/4;
+        for (size_t i=0; i<W; i++) {
+            uint32_t p = word(r1->data(), i);
+            if (r2) p = 2*p - word(r2->data(), i);
+            setWord(out, i, zigzag(word(data, i) - p));
+        }
+        for (size_t i=4*W; i<N; i++) out[i] = data[i] ^ (*r1)[i];
+    }
+
+    void restore(char* data, size_t N, const string* r1, const string* r2) {
+        size_t W = N/4;
+        for (size_t i=0; i<W; i++) {
+            uint32_t p = word(r1->data(), i);
+            if (r2) p = 2*p - word(r2->data(), i);
+            setWord(data, i, unzigzag(word(data, i)) + p);
+        }
+        for (size_t i=4*W; i<N; i++) data[i] ^= (*r1)[i];
+    }
+
+    size_t cost(const string& s) { // nonzero bytes, a cheap estimate of the compressed size
+        size_t n = 0;
+        for (char c : s) n += c != 0;
+        return n;
+    }
+}
+
+VRSyncCodec::VRSyncCodec() {}
+VRSyncCodec::~VRSyncCodec() {}
+
+void VRSyncCodec::reset() {
+    history.clear();
+    frames = rawBytes = packetBytes = 0;
+    lastRaw = lastPacket = 0;
+}
+
+int VRSyncCodec::findReference(const char* data, size_t N) { // compare a sample of the bytes of buffers with the same size
+    int best = -1;
+    size_t bestScore = 0;
+    size_t stride = max(size_t(1), N/64);
+    for (size_t r=0; r<history.size(); r++) {
+        auto& h = history[r];
+        if (h.size() != N) continue;
+        size_t score = 1;
+        for (size_t i=0; i<N; i += stride) if (h[i] == data[i]) score++;
+        if (score > bestScore) { bestScore = score; best = r; }
+    }
+    return best;
+}
+
+void VRSyncCodec::remember(const char* data, size_t N) {
+    history.push_front(string(data, N));
+    if (history.size() > historySize) history.pop_back();
+}
+
+void VRSyncCodec::encode(const char* data, size_t N, string& packet) {
+    uint8_t flags = 0;
+    int ref = N >= 64 ? findReference(data, N) : -1;
+    int ref2 = 2*ref+1; // the buffer at the same place one period earlier, if the stream repeats with the period of ref
+    if (ref >= 0 && (ref2 >= int(history.size()) || history[ref2].size() != N)) ref2 = -1;
+
+    work.assign(data, N);
+    if (ref >= 0) {
+        residuals(data, N, &history[ref], 0, &work[0]);
+        flags |= DELTA;
+        if (ref2 >= 0) {
+            string second(N, 0);
+            residuals(data, N, &history[ref], &history[ref2], &second[0]);
+            if (cost(second) < cost(work)) { work.swap(second); flags |= PREDICT; }
+        }
+    }
+
+    packet.resize(headerSize);
+    if (N >= 64) {
+        string planes(N, 0);
+        toPlanes(work.data(), &planes[0], N);
+        uLongf Z = compressBound(N);
+        packet.resize(headerSize + Z);
+        if (compress2((Bytef*)&packet[headerSize], &Z, (const Bytef*)planes.data(), N, 1) == Z_OK && Z < N) {
+            packet.resize(headerSize + Z);
+            flags |= COMPRESSED;
+        }
+    }
+
+    if (!(flags & COMPRESSED)) {
+        packet.resize(headerSize);
+        packet.append(work);
+    }
+
+    uint32_t n = N;
+    packet[0] = flags;
+    packet[1] = ref >= 0 ? ref : 0;
+    packet[2] = ref2 >= 0 ? ref2 : 0;
+    for (int i=0; i<4; i++) packet[3+i] = (n >> (8*i)) & 0xff;
+
+    remember(data, N);
+    frames++;
+    rawBytes += N;
+    packetBytes += packet.size();
+    lastRaw = N;
+    lastPacket = packet.size();
+}
+
+bool VRSyncCodec::decode(const char* packet, size_t P, string& data) {
+    if (P < headerSize) return false;
+    uint8_t flags = packet[0];
+    size_t ref = (uint8_t)packet[1];
+    size_t ref2 = (uint8_t)packet[2];
+    uint32_t N = 0;
+    for (int i=0; i<4; i++) N |= uint32_t((uint8_t)packet[3+i]) << (8*i);
+    if ((flags & DELTA) && (ref >= history.size() || history[ref].size() != N)) return false;
+    if ((flags & PREDICT) && (ref2 >= history.size() || history[ref2].size() != N)) return false;
+
+    data.resize(N);
+    if (flags & COMPRESSED) {
+        work.resize(N);
+        uLongf Z = N;
+        if (uncompress((Bytef*)&work[0], &Z, (const Bytef*)packet + headerSize, P - headerSize) != Z_OK || Z != N) return false;
+        fromPlanes(work.data(), &data[0], N);
+    } else {
+        if (P - headerSize != N) return false;
+        data.assign(packet + headerSize, N);
+    }
+
+    if (flags & DELTA) restore(&data[0], N, &history[ref], (flags & PREDICT) ? &history[ref2] : 0);
+
+    remember(data.data(), N);
+    frames++;
+    rawBytes += N;
+    packetBytes += P;
+    lastRaw = N;
+    lastPacket = P;
+    return true;
+}
+
+long long VRSyncCodec::getFrameCount() { return frames; }
+long long VRSyncCodec::getRawBytes() { return rawBytes; }
+long long VRSyncCodec::getPacketBytes() { return packetBytes; }
+int VRSyncCodec::getLastRawSize() { return lastRaw; }
+int VRSyncCodec::getLastPacketSize() { return lastPacket; }
+double VRSyncCodec::getRatio() { return packetBytes ? double(rawBytes)/packetBytes : 1; }
@@ -0,0 +1,63 @@
+#ifndef VRSYNCCODEC_H_INCLUDED
+#define VRSYNCCODEC_H_INCLUDED
+
+#include <OpenSG/OSGConfig.h>
+#include <string>
+#include <deque>
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+/**
+    Compression of the scene synchronization stream of the cluster, one packet per buffer of the connection.
+
+    Between frames the serialized change lists keep their layout, the same containers and fields with slowly changing values.
+    A buffer is coded against the most similar earlier buffer of the same size, word by word as the difference of the bit patterns,
+    or against the linear extrapolation from the two previous occurrences if that is cheaper, smooth motion then leaves small residuals.
+    The residuals are split into four byte planes, the zero high bytes line up, and compressed with zlib on its fastest level.
+    Encoder and decoder keep the same history, they have to see all packets in order.
+
+    packet: uint8 flags | uint8 reference | uint8 second reference | uint32 raw size | data
+*/
+
+class VRSyncCodec {
+    public:
+        enum FLAGS {
+            COMPRESSED = 1,
+            DELTA = 2,
+            PREDICT = 4
+        };
+
+    private:
+        deque<string> history; // last raw buffers, newest first
+        size_t historySize = 16;
+        string work;
+
+        long long frames = 0;
+        long long rawBytes = 0;
+        long long packetBytes = 0;
+        int lastRaw = 0;
+        int lastPacket = 0;
+
+        int findReference(const char* data, size_t N);
+        void remember(const char* data, size_t N);
+
+    public:
+        VRSyncCodec();
+        ~VRSyncCodec();
+
+        void encode(const char* data, size_t N, string& packet);
+        bool decode(const char* packet, size_t N, string& data); // false if the packet is corrupt
+        void reset();
+
+        long long getFrameCount();
+        long long getRawBytes();
+        long long getPacketBytes();
+        int getLastRawSize();
+        int getLastPacketSize();
+        double getRatio(); // raw over sent bytes
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRSYNCCODEC_H_INCLUDED
@@ -0,0 +1,52 @@
+#include "VRSyncConnection.h"
+
+#include <OpenSG/OSGBaseFunctions.h>
+#include <cstring>
+
+using namespace OSG;
+
+/* the packets are framed like the buffers of the stream sockets, a size in network byte order and the data */
+
+ConnectionType VRSyncGroupConnection::_type(&VRSyncGroupConnection::create, "CompressedStreamSock");
+ConnectionType VRSyncPointConnection::_type(&VRSyncPointConnection::create, "CompressedStreamSock");
+
+VRSyncGroupConnection::VRSyncGroupConnection() {}
+VRSyncGroupConnection::~VRSyncGroupConnection() {}
+
+GroupConnection* VRSyncGroupConnection::create() { return new VRSyncGroupConnection(); }
+const ConnectionType* VRSyncGroupConnection::getType() { return &_type; }
+VRSyncCodec& VRSyncGroupConnection::getCodec() { return codec; }
+
+void VRSyncGroupConnection::writeBuffer() {
+    UInt32 size = writeBufBegin()->getDataSize();
+    if (size == 0) return;
+
+    codec.encode((const char*)&_socketWriteBuffer[sizeof(SocketBufferHeader)], size, packet);
+    UInt32 n = osgHostToNet<UInt32>(packet.size());
+    for (UInt32 i=0; i<_sockets.size(); i++) {
+        _sockets[i].send(&n, sizeof(UInt32));
+        _sockets[i].send(packet.data(), packet.size());
+    }
+}
+
+
+VRSyncPointConnection::VRSyncPointConnection() {}
+VRSyncPointConnection::~VRSyncPointConnection() {}
+
+PointConnection* VRSyncPointConnection::create() { return new VRSyncPointConnection(); }
+const ConnectionType* VRSyncPointConnection::getType() { return &_type; }
+VRSyncCodec& VRSyncPointConnection::getCodec() { return codec; }
+
+void VRSyncPointConnection::readBuffer() {
+    UInt32 n = 0;
+    if (_socket.recv(&n, sizeof(UInt32)) == 0) throw ReadError("read got 0 bytes!");
+    n = osgNetToHost<UInt32>(n);
+
+    packet.resize(n);
+    if (n && _socket.recv(&packet[0], n) == 0) throw ReadError("read got 0 bytes!");
+    if (!codec.decode(packet.data(), n, data)) throw ReadError("corrupt CompressedStreamSock packet");
+    if (data.size() + sizeof(SocketBufferHeader) > _socketReadBuffer.size()) throw ReadError("CompressedStreamSock buffer too small");
+
+    memcpy(&_socketReadBuffer[sizeof(SocketBufferHeader)], data.data(), data.size());
+    readBufBegin()->setDataSize(data.size());
+}
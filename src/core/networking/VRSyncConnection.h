@@ -0,0 +1,61 @@
+#ifndef VRSYNCCONNECTION_H_INCLUDED
+#define VRSYNCCONNECTION_H_INCLUDED
+
+#include <OpenSG/OSGConfig.h>
+#include <OpenSG/OSGGroupSockConnection.h>
+#include <OpenSG/OSGPointSockConnection.h>
+#include <OpenSG/OSGConnectionType.h>
+#include "VRSyncCodec.h"
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+/**
+    Connection type 'CompressedStreamSock', the StreamSock connection of OpenSG with the buffers
+    from the cluster client to the servers coded by VRSyncCodec, the way back stays uncompressed.
+    The master window and the cluster servers have to use this type, set it as connection type of the
+    VRMultiWindow and start the VRServer with -c CompressedStreamSock.
+*/
+
+class VRSyncGroupConnection : public GroupSockConnection {
+    private:
+        static ConnectionType _type;
+        VRSyncCodec codec;
+        string packet;
+
+    protected:
+        virtual void writeBuffer();
+
+    public:
+        VRSyncGroupConnection();
+        virtual ~VRSyncGroupConnection();
+
+        static GroupConnection* create();
+        virtual const ConnectionType* getType();
+
+        VRSyncCodec& getCodec();
+};
+
+class VRSyncPointConnection : public PointSockConnection {
+    private:
+        static ConnectionType _type;
+        VRSyncCodec codec;
+        string packet;
+        string data;
+
+    protected:
+        virtual void readBuffer();
+
+    public:
+        VRSyncPointConnection();
+        virtual ~VRSyncPointConnection();
+
+        static PointConnection* create();
+        virtual const ConnectionType* getType();
+
+        VRSyncCodec& getCodec();
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRSYNCCONNECTION_H_INCLUDED
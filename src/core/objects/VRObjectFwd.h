@@ -18,6 +18,7 @@ ptrFwd(VRObject);
 ptrFwd(VRTransform);
 ptrFwd(VRGeometry);
 ptrFwd(VRGeoData);
+ptrFwd(VRInstancedGeometry);
 ptrFwd(VRCamera);
 ptrFwd(VRLod);
 ptrFwd(VRLodLeaf);
@@ -49,6 +50,7 @@ ptrFwd(VRTree);
 ptrFwd(CSGGeometry);
 ptrFwd(VRMillingWorkPiece);
 ptrFwd(VRMillingCuttingToolProfile);
+ptrFwd(VRMillingDexels);
 ptrFwd(VRHandGeo)
 
 }
@@ -210,6 +210,73 @@ bool VRGeoData::setTexCoord2(int i, Vec2d t) { if (data->texs2->size() > i) data
 bool VRGeoData::setColor(int i, Color3f c) { if (data->cols3->size() > i) data->cols3->setValue(c,i); else return 0; return 1; }
 bool VRGeoData::setColor(int i, Color4f c) { if (data->cols4->size() > i) data->cols4->setValue(c,i); else return 0; return 1; }
 
+void VRGeoData::reserve(int nVerts, int nIndices, bool normals, bool texCoords, bool colors) {
+    data->pos->editField().reserve(nVerts);
+    if (normals) data->norms->editField().reserve(nVerts);
+    if (texCoords) data->texs->editField().reserve(nVerts);
+    if (colors) data->cols3->editField().reserve(nVerts);
+    if (nIndices > 0) data->indices->editField().reserve(nIndices);
+}
+
+template<class F, class T>
+void padField(F& f, unsigned int n, const T& t) { // attributes shorter than the positions get default values
+    if (f.size() < n) f.resize(n, t);
+}
+
+template<class S, class F, class C>
+void appendField(const vector<S>& src, F& dst, unsigned int N0, const typename F::value_type& def, C convert) {
+    padField(dst, N0, def); // the earlier vertices may have had no such attribute
+    int o = dst.size();
+    dst.resize(o+src.size());
+    for (unsigned int i=0; i<src.size(); i++) dst[o+i] = convert(src[i]);
+}
+
+bool VRGeoData::checkBulkSizes(int N, int nNorms, int nTexs) {
+    if (nNorms != 0 && nNorms != N) { cout << "VRGeoData::pushVerts ERROR: got " << nNorms << " normals for " << N << " vertices" << endl; return false; }
+    if (nTexs != 0 && nTexs != N) { cout << "VRGeoData::pushVerts ERROR: got " << nTexs << " texture coordinates for " << N << " vertices" << endl; return false; }
+    return true;
+}
+
+void VRGeoData::padAttributes() { // keep the attributes aligned with the positions
+    unsigned int N = size();
+    if (data->norms->size() > 0) padField(data->norms->editField(), N, Vec3f(0,1,0));
+    if (data->texs->size() > 0) padField(data->texs->editField(), N, Vec2f(0,0));
+    if (data->texs2->size() > 0) padField(data->texs2->editField(), N, Vec2f(0,0));
+    if (data->cols3->size() > 0) padField(data->cols3->editField(), N, Vec3f(1,1,1));
+    if (data->cols4->size() > 0) padField(data->cols4->editField(), N, Vec4f(1,1,1,1));
+}
+
+int VRGeoData::pushVerts(const vector<Pnt3d>& pos, const vector<Vec3d>& norms, const vector<Vec2d>& texs) {
+    int N0 = size();
+    int N = pos.size();
+    if (!checkBulkSizes(N, norms.size(), texs.size())) return -1;
+    if (norms.size()) appendField(norms, data->norms->editField(), N0, Vec3f(0,1,0), [](const Vec3d& n) { return Vec3f(n[0], n[1], n[2]); });
+    if (texs.size()) appendField(texs, data->texs->editField(), N0, Vec2f(0,0), [](const Vec2d& t) { return Vec2f(t[0], t[1]); });
+    appendField(pos, data->pos->editField(), N0, Pnt3f(), [](const Pnt3d& p) { return Pnt3f(p[0], p[1], p[2]); });
+    padAttributes();
+    return N0;
+}
+
+int VRGeoData::pushVerts(const vector<Pnt3f>& pos, const vector<Vec3f>& norms, const vector<Vec2f>& texs) {
+    int N0 = size();
+    if (!checkBulkSizes(pos.size(), norms.size(), texs.size())) return -1;
+    if (norms.size()) appendField(norms, data->norms->editField(), N0, Vec3f(0,1,0), [](const Vec3f& n) { return n; });
+    if (texs.size()) appendField(texs, data->texs->editField(), N0, Vec2f(0,0), [](const Vec2f& t) { return t; });
+    appendField(pos, data->pos->editField(), N0, Pnt3f(), [](const Pnt3f& p) { return p; });
+    padAttributes();
+    return N0;
+}
+
+void VRGeoData::pushPrims(int type, const vector<int>& indices, int offset) {
+    if (indices.size() == 0) return;
+    auto& I = data->indices->editField();
+    int o = I.size();
+    I.resize(o+indices.size());
+    for (unsigned int i=0; i<indices.size(); i++) I[o+i] = indices[i] + offset;
+    if (isStripOrFan(type)) data->lastPrim = -1; // each call is a separate strip
+    updateType(type, indices.size());
+}
+
 void VRGeoData::pushQuad(Vec3d p, Vec3d n, Vec3d u, Vec2d s, bool addInds) {
     Vec3d x = -n.cross(u); x.normalize();
     pushVert(p - x*s[0]*0.5 - u*s[1]*0.5, n, Vec2d(0,0));
@@ -339,7 +406,7 @@ void VRGeoData::pushLine() { int N = size(); if (N > 1) pushLine(N-2, N-1); }
 void VRGeoData::pushTri() { int N = size(); if (N > 2) pushTri(N-3, N-2, N-1); }
 void VRGeoData::pushQuad() { int N = size(); if (N > 3) pushQuad(N-4, N-3, N-2, N-1); }
 
-void VRGeoData::pushPrim(Primitive p) {
+void VRGeoData::pushPrim(const Primitive& p) {
     int No = primNOffset(p.lid, p.type);
     int N = p.indices.size();
     //int iN0 = size();
@@ -371,15 +438,22 @@ void VRGeoData::apply(VRGeometryPtr geo, bool check) const {
 }
 
 void VRGeoData::append(const VRGeoData& geo, const Matrix4d& m) {
-    map<int, int> mapping;
-    for (auto p : geo) {
-        vector<int> ninds;
-        for (auto i : p.indices) {
-            if (!mapping.count(i)) mapping[i] = pushVert(geo, i, m);
-            ninds.push_back(mapping[i]);
+    auto od = geo.data;
+    bool doNorms = od->norms->size() > 0;
+    reserve(size() + geo.size(), data->indices->size() + od->indices->size(), doNorms, od->texs->size() > 0, od->cols3->size() > 0);
+
+    vector<int> mapping(geo.size(), -1);
+    Primitive np;
+    for (auto& p : geo) {
+        np.type = p.type;
+        np.lid = p.lid;
+        np.indices.resize(p.indices.size());
+        for (unsigned int j=0; j<p.indices.size(); j++) {
+            int i = p.indices[j];
+            if (mapping[i] < 0) mapping[i] = pushVert(geo, i, m);
+            np.indices[j] = mapping[i];
         }
-        p.indices = ninds;
-        pushPrim(p);
+        pushPrim(np);
     }
 }
 
@@ -453,21 +527,18 @@ int VRGeoData::primNOffset(int lID, int type) const {
 }
 
 bool VRGeoData::setIndices(Primitive& p) const {
-    vector<int> inds;
-
     if (p.tID >= int(data->types->size())) return false;
 
     int t = data->types->getValue(p.tID);
     int l = data->lengths->getValue(p.tID);
     int Np = primN(t);
     int Npo = primNOffset(p.lID, t);
+    p.indices.resize(Np); // reuses the buffer of the current primitive
     for (int j=0; j<Np; j++) {
         int k = p.pID + j - Npo;
-        int i = data->indices->getValue(k);
-        inds.push_back(i);
+        p.indices[j] = data->indices->getValue(k);
     }
     p.type = t;
-    p.indices = inds;
     p.lid = p.lID;
     p.tid = p.tID;
     p.lID += Np - Npo;
@@ -491,6 +562,7 @@ VRGeoData::PrimItr VRGeoData::begin() {
     if (!valid()) return end();
     current.tID = 0;
     current.lID = 0;
+    current.pID = 0;
     if (!setIndices(current)) return end();
     return PrimItr( this, &current );
 }
@@ -499,6 +571,7 @@ VRGeoData::PrimItr VRGeoData::begin() const {
     if (!valid()) return end();
     current.tID = 0;
     current.lID = 0;
+    current.pID = 0;
     if (!setIndices(current)) return end();
     return PrimItr( this, &current );
 }
@@ -23,6 +23,8 @@ class VRGeoData {
         bool isStripOrFan(int t);
         void extentType(int N);
         void updateType(int t, int N);
+        bool checkBulkSizes(int N, int nNorms, int nTexs);
+        void padAttributes();
 
     public:
         VRGeoData();
@@ -85,6 +87,13 @@ class VRGeoData {
         bool setColor(int i, Color3f c);
         bool setColor(int i, Color4f c);
 
+        // bulk construction, returns the index of the first new vertex or -1 if the attribute sizes do not match the positions
+        // attributes the geometry has but that are not passed are padded with defaults to stay aligned with the positions
+        void reserve(int nVerts, int nIndices = 0, bool normals = true, bool texCoords = false, bool colors = false);
+        int pushVerts(const vector<Pnt3d>& pos, const vector<Vec3d>& norms = vector<Vec3d>(), const vector<Vec2d>& texs = vector<Vec2d>());
+        int pushVerts(const vector<Pnt3f>& pos, const vector<Vec3f>& norms = vector<Vec3f>(), const vector<Vec2f>& texs = vector<Vec2f>());
+        void pushPrims(int type, const vector<int>& indices, int offset = 0);
+
         int pushVert(const VRGeoData& other, int i);
         int pushVert(const VRGeoData& other, int i, Matrix4d m);
 
@@ -127,7 +136,7 @@ class VRGeoData {
         int primN(int type) const;
         int primNOffset(int lID, int type) const;
         bool setIndices(Primitive& p) const ;
-        void pushPrim(Primitive p);
+        void pushPrim(const Primitive& p);
         Primitive* next() const;
 
         struct PrimItr : public std::iterator<std::forward_iterator_tag, Primitive*> {
@@ -903,6 +903,22 @@ void VRGeometry::showGeometricData(string type, bool b) {
     m->setLit(false);
 }
 
+void VRGeometry::save(xmlpp::Element* e, int p) {
+    VRTransform::save(e, p);
+    if (!e || getPersistency() <= p || meshChunk < 0) return;
+    e->set_attribute("meshchunk", toString(meshChunk));
+    meshChunk = -1;
+}
+
+void VRGeometry::load(xmlpp::Element* e) {
+    meshChunk = -1;
+    if (e && e->get_attribute("meshchunk")) meshChunk = toInt( e->get_attribute("meshchunk")->get_value() );
+    VRTransform::load(e);
+}
+
+void VRGeometry::setMeshChunk(int ID) { meshChunk = ID; }
+int VRGeometry::getMeshChunk() { return meshChunk; }
+
 void VRGeometry::setup() {
     string p1, p2, p3, p4;
     stringstream ss;
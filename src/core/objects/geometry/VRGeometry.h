@@ -40,6 +40,7 @@ class VRGeometry : public VRTransform {
         map<string, VRGeometryPtr> dataLayer;
 
         Reference source;
+        int meshChunk = -1;
 
         VRObjectPtr copy(vector<VRObjectPtr> children);
 
@@ -122,6 +123,11 @@ class VRGeometry : public VRTransform {
         void influence(vector<Vec3d> pnts, vector<Vec3d> values, int power, float color_code = -1, float dl_max = 1.0);
 
         void readSharedMemory(string segment, string object);
+
+        void save(xmlpp::Element* e, int p = 0);
+        void load(xmlpp::Element* e);
+        void setMeshChunk(int ID); // chunk of the mesh buffers in a binary scene, see VRSceneBinary
+        int getMeshChunk();
 };
 
 OSG_END_NAMESPACE;
@@ -0,0 +1,582 @@
+#include "VRInstancedGeometry.h"
+#include "VRGeometry.h"
+#include "VRGeoData.h"
+#include "core/objects/VRLod.h"
+#include "core/objects/object/OSGCore.h"
+#include "core/objects/material/VRMaterialT.h"
+#include "core/math/pose.h"
+#include "core/scene/VRSceneManager.h"
+#include "core/utils/VRFunction.h"
+#include "core/utils/toString.h"
+
+#include <OpenSG/OSGGeoInstancer.h>
+#include <OpenSG/OSGGeoProperties.h>
+#include <OpenSG/OSGTriangleIterator.h>
+#include <boost/bind.hpp>
+#include <algorithm>
+#include <limits>
+#include <regex>
+#include <cmath>
+
+using namespace OSG;
+
+VRInstancedGeometry::VRInstancedGeometry(string name) : VRTransform(name) {}
+
+VRInstancedGeometry::~VRInstancedGeometry() {}
+
+VRInstancedGeometryPtr VRInstancedGeometry::create(string name) { return VRInstancedGeometryPtr( new VRInstancedGeometry(name) ); }
+VRInstancedGeometryPtr VRInstancedGeometry::ptr() { return static_pointer_cast<VRInstancedGeometry>( shared_from_this() ); }
+
+int VRInstancedGeometry::getPrototypeCount() { return prototypes.size(); }
+int VRInstancedGeometry::getInstanceCount() { return protoIDs.size() - freeIDs.size(); }
+
+void VRInstancedGeometry::setCellSize(float s) {
+    if (s <= 0) return;
+    cellSize = s;
+    for (auto& c : cells) if (c.second.root) c.second.root->destroy();
+    cells.clear();
+    for (unsigned int i=0; i<protoIDs.size(); i++) {
+        if (protoIDs[i] < 0) continue;
+        cellKeys[i] = cellKey( Vec3d(transforms[i][3]) );
+        addToCell(i);
+    }
+}
+
+VRInstancedGeometry::CellKey VRInstancedGeometry::cellKey(Vec3d p) {
+    CellKey k;
+    for (int i=0; i<3; i++) { // clamped to the int64 range, NaN ends up in the lowest cell
+        double c = floor(p[i]/cellSize);
+        k[i] = c > -1e18 ? int64_t( min(c, 1e18) ) : int64_t(-1e18);
+    }
+    return k;
+}
+
+string instancedVertexShader(string vp) { // the instance transformation is applied to the vertex before the original program runs
+    string version;
+    if (vp.compare(0, 8, "#version") == 0) {
+        size_t e = vp.find('\n');
+        version = vp.substr(0, e) + "\n";
+        vp = e == string::npos ? "" : vp.substr(e+1);
+    }
+    int v = version.size() ? atoi(version.c_str()+9) : 110;
+    string in = v >= 130 ? "in " : "attribute ";
+
+    vp = regex_replace(vp, regex("\\b(attribute|in)\\s+vec[234]\\s+osg_(Vertex|Normal|MultiTexCoord[4-7])\\s*;"), "");
+    vp = regex_replace(vp, regex("\\b(osg|gl)_Vertex\\b"), "vrVertex");
+    vp = regex_replace(vp, regex("\\b(osg|gl)_Normal\\b"), "vrNormal");
+    vp = regex_replace(vp, regex("\\bvoid\\s+main\\s*\\("), "void vrInstancedMain(");
+
+    string h = version;
+    h += in + "vec4 osg_Vertex;\n";
+    h += in + "vec3 osg_Normal;\n";
+    for (int i=4; i<8; i++) h += in + "vec4 osg_MultiTexCoord" + toString(i) + ";\n";
+    h += "vec4 vrVertex;\n";
+    h += "vec3 vrNormal;\n";
+    h += "vec2 vrInstance; // instance ID and attribute\n";
+
+    string m = "\n";
+    m += "void main() {\n";
+    m += "  vrVertex = vec4(dot(osg_MultiTexCoord5, osg_Vertex), dot(osg_MultiTexCoord6, osg_Vertex), dot(osg_MultiTexCoord7, osg_Vertex), osg_Vertex.w);\n";
+    m += "  vrNormal = vec3(dot(osg_MultiTexCoord5.xyz, osg_Normal), dot(osg_MultiTexCoord6.xyz, osg_Normal), dot(osg_MultiTexCoord7.xyz, osg_Normal));\n";
+    m += "  vrInstance = osg_MultiTexCoord4.xy;\n";
+    m += "  vrInstancedMain();\n";
+    m += "}\n";
+    return h + vp + m;
+}
+
+string fixedFunctionVP(bool lit) { // replaces the fixed function pipeline of materials without shader, light 0 only
+    string vp;
+    vp += "#version 120\n";
+    vp += "attribute vec4 osg_Vertex;\n";
+    vp += "attribute vec3 osg_Normal;\n";
+    vp += "attribute vec4 osg_MultiTexCoord0;\n";
+    vp += "varying vec4 vertPos;\n";
+    vp += "varying vec3 vertNorm;\n";
+    vp += "void main(void) {\n";
+    vp += "  vertPos = gl_ModelViewMatrix * osg_Vertex;\n";
+    vp += "  vertNorm = gl_NormalMatrix * osg_Normal;\n";
+    if (lit) {
+        vp += "  vec3 n = normalize(vertNorm);\n";
+        vp += "  vec3 l = normalize(gl_LightSource[0].position.xyz - vertPos.xyz * gl_LightSource[0].position.w);\n";
+        vp += "  vec3 h = normalize(l - normalize(vertPos.xyz));\n";
+        vp += "  vec4 c = gl_FrontLightModelProduct.sceneColor + gl_FrontLightProduct[0].ambient;\n";
+        vp += "  c += gl_FrontLightProduct[0].diffuse * max(dot(n, l), 0.0);\n";
+        vp += "  c += gl_FrontLightProduct[0].specular * pow(max(dot(n, h), 0.0), gl_FrontMaterial.shininess);\n";
+        vp += "  gl_FrontColor = vec4(c.rgb, gl_FrontMaterial.diffuse.a);\n";
+    } else vp += "  gl_FrontColor = gl_Color;\n";
+    vp += "  gl_BackColor = gl_FrontColor;\n";
+    vp += "  gl_TexCoord[0] = osg_MultiTexCoord0;\n";
+    vp += "  gl_Position = gl_ModelViewProjectionMatrix * osg_Vertex;\n";
+    vp += "}\n";
+    return vp;
+}
+
+string fixedFunctionFP(bool tex, bool deferred) {
+    string fp;
+    fp += "#version 120\n";
+    if (tex) fp += "uniform sampler2D tex0;\n";
+    if (deferred) fp += "uniform int isLit;\n";
+    fp += "varying vec4 vertPos;\n";
+    fp += "varying vec3 vertNorm;\n";
+    fp += "void main(void) {\n";
+    fp += "  vec4 col = gl_Color;\n";
+    if (deferred) fp += "  if (isLit != 0) col = gl_FrontMaterial.diffuse;\n";
+    if (tex) fp += "  col *= texture2D(tex0, gl_TexCoord[0].xy);\n";
+    if (deferred) {
+        fp += "  gl_FragData[0] = vec4(vertPos.xyz / vertPos.w, 1.0);\n";
+        fp += "  gl_FragData[1] = vec4(normalize(vertNorm), isLit);\n";
+        fp += "  gl_FragData[2] = vec4(col.rgb, 0);\n";
+    } else fp += "  gl_FragColor = col;\n";
+    fp += "}\n";
+    return fp;
+}
+
+VRMaterialPtr VRInstancedGeometry::getInstancedMaterial(VRMaterialPtr mat) {
+    if (!mat) mat = VRMaterial::getDefault();
+    if (instancedMats.count(mat.get())) return instancedMats[mat.get()];
+
+    auto m = static_pointer_cast<VRMaterial>( mat->duplicate() );
+    for (int i=0; i<m->getNPasses(); i++) {
+        m->setActivePass(i);
+        string vp = m->getVertexShader();
+        if (vp == "") {
+            bool tex = m->getTextureObjChunk(0) != 0;
+            vp = fixedFunctionVP(m->isLit());
+            m->setFragmentShader(fixedFunctionFP(tex, false), "instancedFS");
+            m->setFragmentShader(fixedFunctionFP(tex, true), "instancedDFS", true);
+            if (tex) m->setShaderParameter("tex0", 0);
+            m->setShaderParameter("isLit", int(m->isLit()));
+        }
+        m->setVertexShader(instancedVertexShader(vp), "instancedVS");
+    }
+    m->setActivePass(0);
+    instancedMats[mat.get()] = m;
+    return m;
+}
+
+struct PartData {
+    VRGeoData data;
+    VRMaterialPtr mat;
+};
+
+void collectParts(VRObjectPtr o, Matrix4d m, int level, map<int, vector<PartData>>& levels, VRInstancedGeometry::Prototype& proto) {
+    if (auto t = dynamic_pointer_cast<VRTransform>(o)) m.mult( t->getMatrix() );
+
+    if (o->hasTag("geometry")) {
+        auto geo = static_pointer_cast<VRGeometry>(o);
+        if (geo->getMesh() && geo->getMesh()->geo->getPositions()) {
+            auto& parts = levels[level];
+            auto mat = geo->getMaterial();
+            PartData* part = 0;
+            for (auto& p : parts) if (p.mat == mat) part = &p;
+            if (!part) {
+                parts.push_back(PartData());
+                part = &parts.back();
+                part->mat = mat;
+            }
+            int N0 = part->data.size();
+            part->data.append(geo, m);
+            for (int i=N0; i<part->data.size(); i++) proto.box.update( Vec3d(part->data.getPosition(i)) );
+        }
+    }
+
+    auto children = o->getChildren();
+    if (o->getType() == "Lod") {
+        if (children.size() == 0) return;
+        if (level >= 0) { collectParts(children[0], m, level, levels, proto); return; } // nested Lods use their finest level
+        auto d = static_pointer_cast<VRLod>(o)->getDistances();
+        if (d.size() > proto.distances.size()) proto.distances = d;
+        for (unsigned int i=0; i<children.size(); i++) collectParts(children[i], m, i, levels, proto);
+        return;
+    }
+    for (auto c : children) collectParts(c, m, level, levels, proto);
+}
+
+int VRInstancedGeometry::addPrototype(VRObjectPtr tmpl, string name) {
+    if (!tmpl) return -1;
+    if (prototypeIDs.count(tmpl.get())) return prototypeIDs[tmpl.get()];
+
+    Prototype proto;
+    proto.name = name != "" ? name : tmpl->getBaseName();
+    Matrix4d m;
+    if (auto t = dynamic_pointer_cast<VRTransform>(tmpl)) { // the template pose is replaced by the instance pose
+        m = t->getMatrix();
+        m.invert();
+    }
+
+    map<int, vector<PartData>> levels; // level -1 are the parts outside of any Lod
+    collectParts(tmpl, m, -1, levels, proto);
+    if (levels.size() == 0) cout << "VRInstancedGeometry::addPrototype Warning, " << proto.name << " has no geometry!" << endl;
+
+    int N = levels.size() ? max(1, levels.rbegin()->first+1) : 1;
+    proto.distances.resize(N-1, proto.distances.size() ? proto.distances.back() : 0);
+    for (int l=0; l<N; l++) {
+        vector<PartData> parts = levels.count(l) ? levels[l] : vector<PartData>();
+        for (auto& common : levels[-1]) { // shown on every level
+            PartData* part = 0;
+            for (auto& p : parts) if (p.mat == common.mat) part = &p;
+            if (part) part->data.append(common.data);
+            else parts.push_back(common);
+        }
+
+        proto.levels.push_back( vector<Part>() );
+        for (auto& p : parts) {
+            Part part;
+            part.mat = getInstancedMaterial(p.mat);
+            part.geo = p.data.asGeometry(proto.name + "_mesh");
+            part.geo->setPersistency(0);
+            part.geo->setMaterial(part.mat);
+            proto.levels.back().push_back(part);
+        }
+    }
+
+    prototypes.push_back(proto);
+    prototypeIDs[tmpl.get()] = prototypes.size()-1;
+    return prototypes.size()-1;
+}
+
+int VRInstancedGeometry::getPrototype(VRObjectPtr tmpl) {
+    if (!tmpl || !prototypeIDs.count(tmpl.get())) return -1;
+    return prototypeIDs[tmpl.get()];
+}
+
+void updateInstances(VRInstancedGeometryWeakPtr wp) { // the queued job may run after the object is gone
+    if (auto g = wp.lock()) g->update();
+}
+
+void VRInstancedGeometry::setDirty(const CellKey& key) {
+    cells[key].dirty = true;
+    if (updateQueued) return;
+    updateQueued = true;
+    if (!updateCb) updateCb = VRUpdateCb::create("instances update", boost::bind(updateInstances, VRInstancedGeometryWeakPtr(ptr())));
+    VRSceneManager::get()->queueJob(updateCb);
+}
+
+void VRInstancedGeometry::addToCell(int ID) {
+    auto& group = cells[cellKeys[ID]].groups[protoIDs[ID]];
+    slots[ID] = group.instances.size();
+    group.instances.push_back(ID);
+    setDirty(cellKeys[ID]);
+}
+
+void VRInstancedGeometry::remFromCell(int ID) { // the last instance of the group takes the free slot
+    auto& group = cells[cellKeys[ID]].groups[protoIDs[ID]];
+    int last = group.instances.back();
+    group.instances[slots[ID]] = last;
+    slots[last] = slots[ID];
+    group.instances.pop_back();
+    slots[ID] = -1;
+    setDirty(cellKeys[ID]);
+}
+
+Boundingbox VRInstancedGeometry::getInstanceBox(int ID) {
+    Boundingbox res;
+    auto& box = prototypes[protoIDs[ID]].box;
+    if (box.empty()) return res;
+    Vec3d b[2] = { box.min(), box.max() };
+    for (int i=0; i<8; i++) {
+        Pnt3d p( b[i&1][0], b[(i>>1)&1][1], b[(i>>2)&1][2] );
+        transforms[ID].mult(p, p);
+        res.update( Vec3d(p) );
+    }
+    return res;
+}
+
+void VRInstancedGeometry::writeInstance(int ID) { // dirty cells get all buffers on the next update
+    auto& cell = cells[cellKeys[ID]];
+    if (cell.dirty) return;
+    auto& group = cell.groups[protoIDs[ID]];
+    auto& m = transforms[ID];
+    int k = slots[ID];
+    group.buffers[0]->setValue( Vec4f(ID, attributes[ID], 0, 0), k );
+    for (int r=0; r<3; r++) group.buffers[r+1]->setValue( Vec4f(m[0][r], m[1][r], m[2][r], m[3][r]), k );
+
+    auto box = getInstanceBox(ID); // the volume only grows until the cell is rebuilt
+    if (box.empty() || (group.box.isInside(box.min()) && group.box.isInside(box.max()))) return;
+    group.box.update(box.min());
+    group.box.update(box.max());
+    for (auto b : group.batches) {
+        b->setVolume(group.box);
+        if (auto p = b->getParent()) p->getNode()->node->invalidateVolume();
+    }
+}
+
+int VRInstancedGeometry::addInstance(int prototype, PosePtr pose, float attribute) {
+    return addInstance(prototype, pose ? pose->asMatrix() : Matrix4d(), attribute);
+}
+
+int VRInstancedGeometry::addInstance(int prototype, const Matrix4d& m, float attribute) {
+    if (prototype < 0 || prototype >= int(prototypes.size())) return -1;
+
+    int ID = protoIDs.size();
+    if (freeIDs.size() > 0) { ID = freeIDs.back(); freeIDs.pop_back(); }
+    else {
+        protoIDs.push_back(-1);
+        transforms.push_back(Matrix4d());
+        attributes.push_back(0);
+        cellKeys.push_back(CellKey());
+        slots.push_back(-1);
+    }
+
+    protoIDs[ID] = prototype;
+    transforms[ID] = m;
+    attributes[ID] = attribute;
+    cellKeys[ID] = cellKey( Vec3d(m[3]) );
+    addToCell(ID);
+    return ID;
+}
+
+void VRInstancedGeometry::remInstance(int ID) {
+    if (ID < 0 || ID >= int(protoIDs.size()) || protoIDs[ID] < 0) return;
+    remFromCell(ID);
+    protoIDs[ID] = -1;
+    freeIDs.push_back(ID);
+}
+
+void VRInstancedGeometry::setInstancePose(int ID, PosePtr pose) {
+    if (ID < 0 || ID >= int(protoIDs.size()) || protoIDs[ID] < 0 || !pose) return;
+    transforms[ID] = pose->asMatrix();
+    auto key = cellKey( pose->pos() );
+    if (key == cellKeys[ID]) { writeInstance(ID); return; }
+    remFromCell(ID);
+    cellKeys[ID] = key;
+    addToCell(ID);
+}
+
+void VRInstancedGeometry::setInstanceAttribute(int ID, float attribute) {
+    if (ID < 0 || ID >= int(protoIDs.size()) || protoIDs[ID] < 0) return;
+    attributes[ID] = attribute;
+    writeInstance(ID);
+}
+
+PosePtr VRInstancedGeometry::getInstancePose(int ID) {
+    if (ID < 0 || ID >= int(protoIDs.size()) || protoIDs[ID] < 0) return 0;
+    return Pose::create(transforms[ID]);
+}
+
+float VRInstancedGeometry::getInstanceAttribute(int ID) {
+    if (ID < 0 || ID >= int(protoIDs.size())) return 0;
+    return attributes[ID];
+}
+
+int VRInstancedGeometry::getInstancePrototype(int ID) {
+    if (ID < 0 || ID >= int(protoIDs.size())) return -1;
+    return protoIDs[ID];
+}
+
+void VRInstancedGeometry::clearInstances() {
+    for (auto& c : cells) if (c.second.root) c.second.root->destroy();
+    cells.clear();
+    protoIDs.clear();
+    transforms.clear();
+    attributes.clear();
+    cellKeys.clear();
+    slots.clear();
+    freeIDs.clear();
+}
+
+void VRInstancedGeometry::buildCell(Cell& cell) { // only nodes and instance buffers, the meshes are shared
+    if (cell.root) cell.root->destroy();
+    cell.root = 0;
+    cell.dirty = false;
+    for (auto itr = cell.groups.begin(); itr != cell.groups.end();) {
+        if (itr->second.instances.size() == 0) itr = cell.groups.erase(itr);
+        else itr++;
+    }
+    if (cell.groups.size() == 0) return;
+
+    unsigned int N = 1;
+    vector<float> distances;
+    Boundingbox cellBox;
+    for (auto& g : cell.groups) {
+        auto& proto = prototypes[g.first];
+        auto& group = g.second;
+        if (proto.levels.size() > N) { N = proto.levels.size(); distances = proto.distances; }
+
+        GeoVec4fPropertyMTRecPtr data = GeoVec4fProperty::create();
+        GeoVec4fPropertyMTRecPtr rows[3] = { GeoVec4fProperty::create(), GeoVec4fProperty::create(), GeoVec4fProperty::create() };
+        group.box = Boundingbox();
+        for (unsigned int k=0; k<group.instances.size(); k++) {
+            int ID = group.instances[k];
+            auto& m = transforms[ID];
+            slots[ID] = k;
+            data->addValue( Vec4f(ID, attributes[ID], 0, 0) );
+            for (int r=0; r<3; r++) rows[r]->addValue( Vec4f(m[0][r], m[1][r], m[2][r], m[3][r]) );
+            auto box = getInstanceBox(ID);
+            if (box.empty()) continue;
+            group.box.update(box.min());
+            group.box.update(box.max());
+        }
+        group.buffers = { data, rows[0], rows[1], rows[2] };
+        if (group.box.empty()) continue;
+        cellBox.update(group.box.min());
+        cellBox.update(group.box.max());
+    }
+
+    vector<VRObjectPtr> levels;
+    if (N > 1) {
+        auto lod = VRLod::create("cell");
+        lod->setCenter( cellBox.empty() ? Vec3d() : cellBox.center() );
+        for (auto d : distances) lod->addDistance(d);
+        cell.root = lod;
+        for (unsigned int l=0; l<N; l++) {
+            levels.push_back( VRObject::create("level") );
+            levels.back()->setPersistency(0);
+            lod->addChild(levels.back());
+        }
+    } else {
+        cell.root = VRObject::create("cell");
+        levels.push_back(cell.root);
+    }
+    cell.root->setPersistency(0);
+    addChild(cell.root);
+
+    for (auto& g : cell.groups) {
+        auto& proto = prototypes[g.first];
+        auto& group = g.second;
+        group.batches.clear();
+        for (unsigned int l=0; l<N; l++) {
+            for (auto& part : proto.levels[ min(l, (unsigned int)proto.levels.size()-1) ]) {
+                GeoInstancerMTRecPtr instancer = GeoInstancer::create();
+                instancer->setBaseGeometry(part.geo->getMesh()->geo);
+                instancer->setMaterial(part.mat->getMaterial()->mat);
+                instancer->setNumInstances(group.instances.size());
+                for (unsigned int k=0; k<group.buffers.size(); k++) { // osg_MultiTexCoord4 to 7
+                    instancer->pushToProperties(group.buffers[k]);
+                    instancer->pushToPropIndices(12+k);
+                }
+
+                auto batch = VRObject::create("batch");
+                batch->setCore(OSGCore::create(instancer), "Instancer");
+                batch->setPersistency(0);
+                levels[l]->addChild(batch);
+                if (!group.box.empty()) batch->setVolume(group.box); // the instancer only knows the base geometry volume
+                group.batches.push_back(batch);
+            }
+        }
+    }
+}
+
+void VRInstancedGeometry::update() {
+    updateQueued = false;
+    vector<CellKey> empty;
+    for (auto& c : cells) {
+        if (!c.second.dirty) continue;
+        buildCell(c.second);
+        if (!c.second.root) empty.push_back(c.first);
+    }
+    for (auto& k : empty) cells.erase(k);
+}
+
+int VRInstancedGeometry::getBatchCount() {
+    int N = 0;
+    for (auto& c : cells) for (auto& g : c.second.groups) N += g.second.batches.size();
+    return N;
+}
+
+int VRInstancedGeometry::getMeshCount() {
+    int N = 0;
+    for (auto& p : prototypes) for (auto& l : p.levels) N += l.size();
+    return N;
+}
+
+vector<int> VRInstancedGeometry::getInstances(const Boundingbox& box) {
+    vector<int> res;
+    if (box.empty()) return res;
+
+    auto check = [&](Cell& c) {
+        for (auto& g : c.groups) for (auto ID : g.second.instances) if (box.isInside( Vec3d(transforms[ID][3]) )) res.push_back(ID);
+    };
+
+    CellKey k1 = cellKey(box.min());
+    CellKey k2 = cellKey(box.max());
+    double range = double(k2[0]-k1[0]+1)*double(k2[1]-k1[1]+1)*double(k2[2]-k1[2]+1);
+    if (range > cells.size()) { // large boxes, faster to check all cells
+        for (auto& c : cells) check(c.second);
+        return res;
+    }
+
+    CellKey k;
+    for (k[0]=k1[0]; k[0]<=k2[0]; k[0]++) for (k[1]=k1[1]; k[1]<=k2[1]; k[1]++) for (k[2]=k1[2]; k[2]<=k2[2]; k[2]++) {
+        auto c = cells.find(k);
+        if (c != cells.end()) check(c->second);
+    }
+    return res;
+}
+
+double rayBoxEntry(const Pnt3d& p, const Vec3d& d, const Boundingbox& box) { // -1 if missed
+    double t0 = 0, t1 = numeric_limits<double>::max();
+    Vec3d b1 = box.min();
+    Vec3d b2 = box.max();
+    for (int i=0; i<3; i++) {
+        if (abs(d[i]) < 1e-12) {
+            if (p[i] < b1[i] || p[i] > b2[i]) return -1;
+            continue;
+        }
+        double ta = (b1[i]-p[i])/d[i];
+        double tb = (b2[i]-p[i])/d[i];
+        t0 = max(t0, min(ta, tb));
+        t1 = min(t1, max(ta, tb));
+        if (t0 > t1) return -1;
+    }
+    return t0;
+}
+
+double rayTriangle(const Pnt3d& p, const Vec3d& d, Vec3d a, Vec3d b, Vec3d c) { // Moeller Trumbore, -1 if missed
+    Vec3d e1 = b-a;
+    Vec3d e2 = c-a;
+    Vec3d q = d.cross(e2);
+    double det = e1.dot(q);
+    if (abs(det) < 1e-12) return -1;
+    Vec3d s = p-Pnt3d(a);
+    double u = s.dot(q)/det;
+    if (u < 0 || u > 1) return -1;
+    Vec3d r = s.cross(e1);
+    double v = d.dot(r)/det;
+    if (v < 0 || u+v > 1) return -1;
+    double t = e2.dot(r)/det;
+    return t >= 0 ? t : -1;
+}
+
+int VRInstancedGeometry::getInstance(Line ray) { // the GeoInstancer is not intersectable, the ray is tested against the prototype meshes
+    Matrix4d w = getWorldMatrix();
+    w.invert();
+    Pnt3d p0( ray.getPosition() );
+    Vec3d d0( ray.getDirection() );
+    w.mult(p0, p0);
+    w.mult(d0, d0);
+
+    int res = -1;
+    double tMin = numeric_limits<double>::max();
+    for (auto& c : cells) {
+        for (auto& g : c.second.groups) {
+            auto& proto = prototypes[g.first];
+            if (proto.box.empty() || proto.levels.size() == 0) continue;
+            for (auto ID : g.second.instances) {
+                Matrix4d mi = transforms[ID]; // the ray in prototype space, the ray parameter stays comparable
+                mi.invert();
+                Pnt3d p;
+                Vec3d d;
+                mi.mult(p0, p);
+                mi.mult(d0, d);
+                double t = rayBoxEntry(p, d, proto.box);
+                if (t < 0 || t >= tMin) continue;
+
+                bool triangles = false;
+                double tHit = numeric_limits<double>::max();
+                for (auto& part : proto.levels[0]) {
+                    auto mesh = part.geo->getMesh()->geo;
+                    if (!mesh->getTypes() || mesh->getTypes()->size() == 0 || mesh->getTypes()->getValue(0) == GL_PATCHES) continue;
+                    triangles = true;
+                    for (TriangleIterator it(mesh); !it.isAtEnd(); ++it) {
+                        double ti = rayTriangle(p, d, Vec3d(it.getPosition(0)), Vec3d(it.getPosition(1)), Vec3d(it.getPosition(2)));
+                        if (ti >= 0 && ti < tHit) tHit = ti;
+                    }
+                }
+                if (triangles) t = tHit; // tessellated meshes are picked by their box
+                if (t < tMin) { tMin = t; res = ID; }
+            }
+        }
+    }
+    return res;
+}
@@ -0,0 +1,116 @@
+#ifndef VRINSTANCEDGEOMETRY_H_INCLUDED
+#define VRINSTANCEDGEOMETRY_H_INCLUDED
+
+#include "core/objects/VRTransform.h"
+#include "core/math/boundingbox.h"
+#include "core/utils/VRFunctionFwd.h"
+#include <OpenSG/OSGMatrix.h>
+#include <OpenSG/OSGLine.h>
+#include <cstdint>
+#include <array>
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+class GeoVectorProperty; OSG_GEN_CONTAINERPTR(GeoVectorProperty);
+
+/**
+    Many copies of a few prototype objects without a scene graph node per copy.
+    Each prototype keeps one mesh per material and detail level, built once in prototype space and shared by all its instances.
+    Instances are sorted into the cells of a uniform grid, a cell draws the instances of a prototype with one GeoInstancer per mesh,
+    fed with the instance transformation rows and the instance ID and attribute, and switches the detail level by distance.
+    Pose and attribute changes only write the instance buffers, adding or removing instances rebuilds the buffers of one cell.
+    The instanced materials get the instance data in osg_MultiTexCoord4 to 7, shaders can read vrInstance (ID, attribute).
+*/
+
+class VRInstancedGeometry : public VRTransform {
+    public:
+        typedef array<int64_t, 3> CellKey; // grid coordinates, compared as a whole so distant cells never share a key
+
+        struct Part {
+            VRGeometryPtr geo; // shared mesh in prototype space
+            VRMaterialPtr mat; // instanced variant of the template material
+        };
+
+        struct Prototype {
+            string name;
+            vector<vector<Part>> levels; // parts of each detail level
+            vector<float> distances; // switch distances of the template Lod
+            Boundingbox box;
+        };
+
+        struct Group { // the instances of one prototype in one cell
+            vector<int> instances;
+            vector<GeoVectorPropertyMTRecPtr> buffers; // instance data and transformation rows
+            vector<VRObjectPtr> batches;
+            Boundingbox box;
+        };
+
+        struct Cell {
+            VRObjectPtr root;
+            map<int, Group> groups;
+            bool dirty = true;
+        };
+
+    private:
+        float cellSize = 20;
+        vector<Prototype> prototypes;
+        map<VRObject*, int> prototypeIDs;
+        map<VRMaterial*, VRMaterialPtr> instancedMats;
+
+        // per instance data
+        vector<int> protoIDs; // -1 if removed
+        vector<Matrix4d> transforms;
+        vector<float> attributes;
+        vector<CellKey> cellKeys;
+        vector<int> slots; // index in the group of its cell
+        vector<int> freeIDs;
+
+        map<CellKey, Cell> cells;
+        bool updateQueued = false;
+        VRUpdateCbPtr updateCb;
+
+        CellKey cellKey(Vec3d p);
+        VRMaterialPtr getInstancedMaterial(VRMaterialPtr mat);
+        Boundingbox getInstanceBox(int ID);
+        void addToCell(int ID);
+        void remFromCell(int ID);
+        void writeInstance(int ID);
+        void setDirty(const CellKey& key);
+        void buildCell(Cell& cell);
+
+    public:
+        VRInstancedGeometry(string name);
+        ~VRInstancedGeometry();
+
+        static VRInstancedGeometryPtr create(string name = "instances");
+        VRInstancedGeometryPtr ptr();
+
+        void setCellSize(float s);
+
+        int addPrototype(VRObjectPtr tmpl, string name = "");
+        int getPrototype(VRObjectPtr tmpl);
+        int getPrototypeCount();
+
+        int addInstance(int prototype, PosePtr pose, float attribute = 0);
+        int addInstance(int prototype, const Matrix4d& m, float attribute = 0);
+        void remInstance(int ID);
+        void setInstancePose(int ID, PosePtr pose);
+        void setInstanceAttribute(int ID, float attribute);
+        PosePtr getInstancePose(int ID);
+        float getInstanceAttribute(int ID);
+        int getInstancePrototype(int ID);
+        int getInstanceCount();
+        void clearInstances();
+
+        vector<int> getInstances(const Boundingbox& box);
+        int getInstance(Line ray);
+
+        void update();
+        int getBatchCount();
+        int getMeshCount();
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRINSTANCEDGEOMETRY_H_INCLUDED
@@ -404,13 +404,11 @@ VRMaterialPtr VRMaterial::get(string s) {
     return materials[s].lock();
 }
 
-VRObjectPtr VRMaterial::copy(vector<VRObjectPtr> children) { // TODO: test it, may not work properly!
+VRObjectPtr VRMaterial::copy(vector<VRObjectPtr> children) {
     VRMaterialPtr mat = VRMaterial::create(getBaseName());
-
-    for (uint i=0; i<mats.size(); i++) {
-        if (i > 0) mat->addPass();
-        mat->mats[i] = mats[i]->copy();
-    }
+    mat->passes->mat->clearMaterials(); // the passes have to be replaced in the multi pass material too
+    mat->mats.clear();
+    mat->appendPasses(ptr());
 
     mat->force_transparency = force_transparency;
     mat->deferred = deferred;
@@ -964,9 +962,9 @@ void VRMaterial::readGeometryShader(string s) { setGeometryShader(readFile(s), s
 void VRMaterial::readTessControlShader(string s) { setTessControlShader(readFile(s), s); }
 void VRMaterial::readTessEvaluationShader(string s) { setTessEvaluationShader(readFile(s), s); }
 
-string VRMaterial::getVertexShader() { return ""; } // TODO
-string VRMaterial::getFragmentShader() { return ""; }
-string VRMaterial::getGeometryShader() { return ""; }
+string VRMaterial::getVertexShader() { auto md = mats[activePass]; return md->vProgram ? md->vProgram->getProgram() : ""; }
+string VRMaterial::getFragmentShader() { auto md = mats[activePass]; auto p = md->deferred ? md->fdProgram : md->fProgram; return p ? p->getProgram() : ""; }
+string VRMaterial::getGeometryShader() { auto md = mats[activePass]; return md->gProgram ? md->gProgram->getProgram() : ""; }
 
 void VRMaterial::setVertexScript(string script) {
     mats[activePass]->vertexScript = script;
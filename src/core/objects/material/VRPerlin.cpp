@@ -1,128 +1,95 @@
 #include "VRPerlin.h"
+
+#include <vector>
 
 OSG_BEGIN_NAMESPACE;
 using namespace std;
 
 VRPerlin::VRPerlin() {}
 
-float VRPerlin::lerp(float a0, float a1, float w) { return (1.0 - w)*a0 + w*a1; }
-float VRPerlin::hermite3(float w) { return 3*pow(w,2) - 2*pow(w,3); }
-float VRPerlin::hermite5(float w) { return 6*pow(w,5) - 15*pow(w,4) + 10*pow(w,3); }
-
-float VRPerlin::dotGridGradient(Vec3d* grid, Vec3i dim, Vec3i vi, Vec3d v) {
-    Vec3d d = v-Vec3d(vi); // Compute the distance vector
-
-    if (vi[0] >= dim[0]) vi[0] = 0; // cyclic boundary condition
-    if (vi[1] >= dim[1]) vi[1] = 0;
-    if (vi[2] >= dim[2]) vi[2] = 0;
-
-    int k = vi[0]+vi[1]*dim[0]+vi[2]*dim[1]*dim[0];
-    return d.dot( grid[k] );
-}
-
-float VRPerlin::perlin(Vec3d* grid, const Vec3i& dim, const Vec3d& v) {
-    // Determine grid cell coordinates
-    Vec3i v0 = Vec3i(v);
-    Vec3d s = v-Vec3d(v0);
-
-    // Interpolate between grid point gradients
-    Vec2d n, ix0, ix1, ix2;
-    float fu = hermite5(s[0]);
-    float fv = hermite5(s[1]);
-    float fw = s[2]; //hermite5(s[2]);
-
-    n[0] = dotGridGradient(grid, dim, v0             , v);
-    n[1] = dotGridGradient(grid, dim, v0+Vec3i(1,0,0), v);
-    ix0[0] = lerp(n[0], n[1], fu);
-
-    n[0] = dotGridGradient(grid, dim, v0+Vec3i(0,1,0), v);
-    n[1] = dotGridGradient(grid, dim, v0+Vec3i(1,1,0), v);
-    ix0[1] = lerp(n[0], n[1], fu);
+float VRPerlin::hermite5(float w) { return w*w*w*(w*(w*6 - 15) + 10); }
 
-    n[0] = dotGridGradient(grid, dim, v0+Vec3i(0,0,1), v);
-    n[1] = dotGridGradient(grid, dim, v0+Vec3i(1,0,1), v);
-    ix1[0] = lerp(n[0], n[1], fu);
-
-    n[0] = dotGridGradient(grid, dim, v0+Vec3i(0,1,1), v);
-    n[1] = dotGridGradient(grid, dim, v0+Vec3i(1,1,1), v);
-    ix1[1] = lerp(n[0], n[1], fu);
-
-    ix2[0] = lerp(ix0[0], ix0[1], fv);
-    ix2[1] = lerp(ix1[0], ix1[1], fv);
-    return lerp(ix2[0], ix2[1], fw);
-}
-
-void VRPerlin::apply(Color3f* data, Vec3i dims, float amount, Color3f c1, Color3f c2) {
+template<typename T, int N>
+void VRPerlin::compute(T* data, Vec3i dims, float amount, T c1, T c2) {
     float a = 0.5*amount;
     Vec3i dim(dims[0]*a, dims[1]*a, dims[2]*a);
     for (int i=0; i<3; i++) dim[i] = max(1,dim[i]);
-    Vec3d* grid = new Vec3d[ dim[0]*dim[1]*dim[2] ];
-    VRPerlin perl;
 
     // noise grid
+    vector<float> grid(3*dim[0]*dim[1]*dim[2]);
     for (int k=0; k<dim[2]; k++) {
         for (int j=0; j<dim[1]; j++) {
             for (int i=0; i<dim[0]; i++) {
                 Vec3d r = Vec3d(rand(), rand(), rand())*2.0/RAND_MAX - Vec3d(1,1,1);
                 r.normalize();
-                grid[i+j*dim[0]+k*dim[1]*dim[0]] = r;
+                int g = 3*(i+j*dim[0]+k*dim[1]*dim[0]);
+                grid[g] = r[0]; grid[g+1] = r[1]; grid[g+2] = r[2];
             }
         }
     }
 
-    // compute noise in grid and mix with data
-    for (int z=0; z<dims[2]; z++) {
-        for (int y=0; y<dims[1]; y++) {
-            for (int x=0; x<dims[0]; x++) {
-                float p = perl.perlin(grid, dim, Vec3d(x,y,z)*a );
-                Color3f c = c1*p + c2*(1-p);
-
-                int i = z*dims[1]*dims[0] + y*dims[0] + x;
-                data[i][0] *= c[0];
-                data[i][1] *= c[1];
-                data[i][2] *= c[2];
+    struct Axis { // lattice cells and weights along one axis
+        vector<int> i0, i1;
+        vector<float> s, f;
+
+        Axis(int size, int cells, double a, bool smooth) : i0(size), i1(size), s(size), f(size) {
+            for (int x=0; x<size; x++) {
+                double v = x*a;
+                int c = int(v);
+                s[x] = v - c;
+                f[x] = smooth ? hermite5(s[x]) : s[x];
+                i0[x] = c >= cells ? 0 : c; // cyclic boundary condition
+                i1[x] = c+1 >= cells ? 0 : c+1;
             }
         }
-    }
-
-    delete[] grid;
-}
+    };
 
-void VRPerlin::apply(Color4f* data, Vec3i dims, float amount, Color4f c1, Color4f c2) {
-    float a = 0.5*amount;
-    Vec3i dim(dims[0]*a, dims[1]*a, dims[2]*a);
-    for (int i=0; i<3; i++) dim[i] = max(1,dim[i]);
-    Vec3d* grid = new Vec3d[ dim[0]*dim[1]*dim[2] ];
-    VRPerlin perl;
+    Axis X(dims[0], dim[0], a, true);
+    Axis Y(dims[1], dim[1], a, true);
+    Axis Z(dims[2], dim[2], a, false);
 
-    // noise grid
-    for (int k=0; k<dim[2]; k++) {
-        for (int j=0; j<dim[1]; j++) {
-            for (int i=0; i<dim[0]; i++) {
-                Vec3d r = Vec3d(rand(), rand(), rand())*2.0/RAND_MAX - Vec3d(1,1,1);
-                r.normalize();
-                grid[i+j*dim[0]+k*dim[1]*dim[0]] = r;
-            }
-        }
-    }
+    auto lerp = [](float a0, float a1, float w) { return (1.0f - w)*a0 + w*a1; };
+    const float* G = &grid[0];
+    int W = dims[0];
+    int rows = dims[1]*dims[2];
 
     // compute noise in grid and mix with data
-    for (int z=0; z<dims[2]; z++) {
-        for (int y=0; y<dims[1]; y++) {
-            for (int x=0; x<dims[0]; x++) {
-                float p = perl.perlin(grid, dim, Vec3d(x,y,z)*a );
-                Color4f c = c1*p + c2*(1-p);
-
-                int i = z*dims[1]*dims[0] + y*dims[0] + x;
-                data[i][0] *= c[0];
-                data[i][1] *= c[1];
-                data[i][2] *= c[2];
-                data[i][3] *= c[3];
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (int r=0; r<rows; r++) {
+        int y = r%dims[1];
+        int z = r/dims[1];
+        int y0 = Y.i0[y]*dim[0], y1 = Y.i1[y]*dim[0];
+        int z0 = Z.i0[z]*dim[0]*dim[1], z1 = Z.i1[z]*dim[0]*dim[1];
+        float sy = Y.s[y], fv = Y.f[y];
+        float sz = Z.s[z], fw = Z.f[z];
+        const int* I0 = &X.i0[0];
+        const int* I1 = &X.i1[0];
+        const float* SX = &X.s[0];
+        const float* FU = &X.f[0];
+        T* row = data + size_t(r)*W;
+
+        for (int x=0; x<W; x++) {
+            float sx = SX[x], fu = FU[x];
+            auto dot = [&](int i, int j, int k, float dx, float dy, float dz) {
+                const float* g = G + 3*(i+j+k);
+                return g[0]*dx + g[1]*dy + g[2]*dz;
+            };
+
+            float a0 = lerp(dot(I0[x], y0, z0, sx, sy, sz), dot(I1[x], y0, z0, sx-1, sy, sz), fu);
+            float a1 = lerp(dot(I0[x], y1, z0, sx, sy-1, sz), dot(I1[x], y1, z0, sx-1, sy-1, sz), fu);
+            float p = lerp(a0, a1, fv);
+            if (fw != 0) {
+                float b0 = lerp(dot(I0[x], y0, z1, sx, sy, sz-1), dot(I1[x], y0, z1, sx-1, sy, sz-1), fu);
+                float b1 = lerp(dot(I0[x], y1, z1, sx, sy-1, sz-1), dot(I1[x], y1, z1, sx-1, sy-1, sz-1), fu);
+                p = lerp(p, lerp(b0, b1, fv), fw);
             }
+
+            for (int c=0; c<N; c++) row[x][c] *= c1[c]*p + c2[c]*(1-p);
         }
     }
-
-    delete[] grid;
 }
 
+void VRPerlin::apply(Color3f* data, Vec3i dims, float amount, Color3f c1, Color3f c2) { compute<Color3f, 3>(data, dims, amount, c1, c2); }
+void VRPerlin::apply(Color4f* data, Vec3i dims, float amount, Color4f c1, Color4f c2) { compute<Color4f, 4>(data, dims, amount, c1, c2); }
+
 OSG_END_NAMESPACE;
@@ -7,14 +7,17 @@
 OSG_BEGIN_NAMESPACE;
 using namespace std;
 
+/**
+    Gradient noise on a lattice of random unit gradients, the lattice is drawn with rand and wraps at the texture border.
+    The noise is evaluated row by row in parallel, cell indices and interpolation weights along x are computed once per layer.
+*/
+
 class VRPerlin {
     private:
-        float lerp(float a0, float a1, float w);
-        float hermite3(float w);
-        float hermite5(float w);
+        static float hermite5(float w);
 
-        float dotGridGradient(Vec3d* grid, Vec3i dim, Vec3i vi, Vec3d v);
-        float perlin(Vec3d* grid, const Vec3i& dim, const Vec3d& v);
+        template<typename T, int N>
+        static void compute(T* data, Vec3i dim, float amount, T c1, T c2);
 
     public:
         VRPerlin();
@@ -9,6 +9,9 @@
 #include "core/objects/material/VRTexture.h"
 #include "core/math/path.h"
 #include "core/math/polygon.h"
+
+#include <algorithm>
+#include <cmath>
 
 OSG_BEGIN_NAMESPACE;
 using namespace std;
@@ -98,12 +101,10 @@ void VRTextureGenerator::drawPolygon(VRPolygonPtr p, Color4f c, float h) {
 
 template<typename T>
 void VRTextureGenerator::applyFill(T* data, Color4f c) {
-    for (int k=0; k<depth; k++) {
-        for (int j=0; j<height; j++) {
-            for (int i=0; i<width; i++) {
-                applyPixel(data, Vec3i(i,j,k), c);
-            }
-        }
+    int rows = depth*height;
+    #pragma omp parallel for
+    for (int r=0; r<rows; r++) {
+        for (int i=0; i<width; i++) applyPixel(data, Vec3i(i, r%height, r/height), c);
     }
 }
 
@@ -237,41 +238,66 @@ void VRTextureGenerator::applyPath(T* data, pathPtr p, Color4f c, float w) {
 }
 
 template<typename T>
-void VRTextureGenerator::applyPolygon(T* data, VRPolygonPtr p, Color4f c, float h) {
+void VRTextureGenerator::applyPolygon(T* data, VRPolygonPtr p, Color4f c, float h) { // scanlines, nonzero winding rule like VRPolygon::isInside
     auto bb = p->getBoundingBox();
     Vec3d a = bb.min(); swap(a[1], a[2]);
     Vec3d b = bb.max(); swap(b[1], b[2]);
     Vec3i A = Vec3i( upscale( a ) ) - Vec3i(1,1,1);
     Vec3i B = Vec3i( upscale( b ) ) + Vec3i(1,1,1);
-    //float texelSize = 1.0/width; // TODO: non square textures?
-    for (int j=A[1]; j<B[1]; j++) {
-        for (int i=A[0]; i<B[0]; i++) {
-            Vec2d pos = Vec2d(float(i)/width, float(j)/height);
-            double d;
-            if (p->isInside(pos, d)) {
-                for (int k=0; k<depth; k++) applyPixel(data, clamp(Vec3i(i,j,k)), c);
-            } /*else if (d < texelSize) { // TODO: finish antialiasing feature
-                float a = 1.0 - d*width;
-                auto cc = c; cc[3] = a;
-                cout << "VRTextureGenerator::applyPolygon a " << a << endl;
-                //for (int k=0; k<depth; k++) applyPixel(data, clamp(Vec3i(i,j,k)), cc);
-                for (int k=0; k<depth; k++) applyPixel(data, clamp(Vec3i(i,j,k)), Color4f(a,0,1,1));
-                //for (int k=0; k<depth; k++) applyPixel(data, clamp(Vec3i(i,j,k)), Color4f(0,0,1,a));
-            }*/
+    int j0 = max(A[1], 0);
+    int j1 = min(B[1], height);
+    auto& points = p->get();
+    int N = points.size();
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (int j=j0; j<j1; j++) {
+        double y = float(j)/height;
+
+        // edge crossings of the scanline with their direction
+        vector<pair<double, int>> X;
+        for (int e=0; e<N; e++) {
+            Vec2d p1 = points[e];
+            Vec2d p2 = points[(e+1)%N];
+            int dir = 0;
+            if (p1[1] <= y && p2[1] > y) dir = 1;
+            if (p1[1] > y && p2[1] <= y) dir = -1;
+            if (dir == 0) continue;
+            X.push_back( make_pair(p1[0] + (y-p1[1])*(p2[0]-p1[0])/(p2[1]-p1[1]), dir) );
+        }
+        sort(X.begin(), X.end());
+
+        int wn = 0; // winding number right of the current crossing
+        for (auto& x : X) wn += x.second;
+        for (int m=0; m+1<int(X.size()); m++) {
+            wn -= X[m].second;
+            if (wn == 0) continue;
+            int i = max(0, int(floor(X[m].first*width)) - 1);
+            while (i < width && double(float(i)/width) < X[m].first) i++;
+            for (; i < width && double(float(i)/width) < X[m+1].first; i++) {
+                for (int k=0; k<depth; k++) applyPixel(data, Vec3i(i,j,k), c);
+            }
         }
     }
 }
 
 void VRTextureGenerator::clearStage() { layers.clear(); }
 
-VRTexturePtr VRTextureGenerator::compose(int seed) { // TODO: optimise!
+VRTexturePtr VRTextureGenerator::compose(int seed) { // layers are applied in order, each one in parallel over rows
     srand(seed);
     Vec3i dims(width, height, depth);
+    int N = width*height*depth;
+
+    Color3f* data3 = 0;
+    Color4f* data4 = 0;
+    if (hasAlpha) data4 = new Color4f[N];
+    else data3 = new Color3f[N];
+
+    #pragma omp parallel for
+    for (int i=0; i<N; i++) {
+        if (hasAlpha) data4[i] = Color4f(1,1,1,1);
+        else data3[i] = Color3f(1,1,1);
+    }
 
-    Color3f* data3 = new Color3f[width*height*depth];
-    Color4f* data4 = new Color4f[width*height*depth];
-    for (int i=0; i<width*height*depth; i++) data3[i] = Color3f(1,1,1);
-    for (int i=0; i<width*height*depth; i++) data4[i] = Color4f(1,1,1,1);
     for (auto l : layers) {
         if (!hasAlpha) {
             if (l.type == BRICKS) VRBricks::apply(data3, dims, l.amount, l.c31, l.c32);
@@ -297,8 +323,8 @@ VRTexturePtr VRTextureGenerator::compose(int seed) { // TODO: optimise!
     auto format = hasAlpha ? OSG::Image::OSG_RGBA_PF : OSG::Image::OSG_RGB_PF;
     if (hasAlpha) img->getImage()->set(format, width, height, depth, 0, 1, 0.0, (const uint8_t*)data4, OSG::Image::OSG_FLOAT32_IMAGEDATA, true, 1);
     else       img->getImage()->set(format, width, height, depth, 0, 1, 0.0, (const uint8_t*)data3, OSG::Image::OSG_FLOAT32_IMAGEDATA, true, 1);
-    delete[] data3;
-    delete[] data4;
+    if (data3) delete[] data3;
+    if (data4) delete[] data4;
     return img;
 }
 
@@ -1,5 +1,6 @@
 #include "VRObjectManager.h"
 #include "core/objects/VRTransform.h"
+#include "core/objects/geometry/VRInstancedGeometry.h"
 #include "core/utils/VRFunction.h"
 #include "core/utils/VRStorage_template.h"
 #include <boost/bind.hpp>
@@ -27,6 +28,7 @@ void VRObjectManager::Entry::set(PosePtr p, string t) {
 VRObjectManager::VRObjectManager(string name) : VRObject(name) {
     storeMap("templates", &templatesByName, true);
     storeMap("instances", &entries, true);
+    storeMap("instanced", &instanceEntries, true);
     regStorageSetupFkt( VRUpdateCb::create("object manager setup", boost::bind(&VRObjectManager::setup, this)) );
 }
 
@@ -43,6 +45,12 @@ void VRObjectManager::setup() {
         o->show();
         o->setPose(t.second->pos);
     }
+
+    for (auto& t : instanceEntries) {
+        if (!templatesByName.count(t.second->type)) { cout << "VRObjectManager::setup Warning, " << t.second->type << " is not a template!" << endl; continue; }
+        int ID = addInstance(t.second->type, t.second->pos, false);
+        if (ID >= 0) instanceKeys[ID] = t.first;
+    }
 }
 
 VRTransformPtr VRObjectManager::copy(string name, PosePtr p, bool addToStore) {
@@ -61,6 +69,39 @@ VRTransformPtr VRObjectManager::copy(string name, PosePtr p, bool addToStore) {
     return dupe;
 }
 
+VRInstancedGeometryPtr VRObjectManager::getInstancer() {
+    if (!instancer) {
+        instancer = VRInstancedGeometry::create("instances");
+        instancer->setPersistency(0);
+        addChild(instancer);
+    }
+    return instancer;
+}
+
+int VRObjectManager::addInstance(string name, PosePtr p, bool addToStore) {
+    auto t = getTemplate(name);
+    if (!t) return -1;
+    auto inst = getInstancer();
+    int proto = inst->addPrototype(t, name);
+    int ID = inst->addInstance(proto, p);
+    if (addToStore) { // instance IDs are reused and change on reload, the entry gets its own key
+        auto e = Entry::create();
+        e->set(p,name);
+        int key = instanceEntries.size() ? instanceEntries.rbegin()->first+1 : 0;
+        instanceEntries[key] = e;
+        instanceKeys[ID] = key;
+    }
+    return ID;
+}
+
+void VRObjectManager::remInstance(int ID) {
+    if (!instancer) return;
+    instancer->remInstance(ID);
+    if (!instanceKeys.count(ID)) return;
+    instanceEntries.erase(instanceKeys[ID]);
+    instanceKeys.erase(ID);
+}
+
 VRTransformPtr VRObjectManager::add(VRTransformPtr s) {
     if (!s) return 0;
     addTemplate(s, s->getBaseName());
@@ -98,6 +139,9 @@ void VRObjectManager::updateObject(VRTransformPtr t) {
 void VRObjectManager::clear(bool clearTemplates) {
     entries.clear();
     instances.clear();
+    instanceEntries.clear();
+    instanceKeys.clear();
+    instancer = 0;
     if (clearTemplates) templates.clear();
     if (clearTemplates) templatesByName.clear();
     clearChildren();
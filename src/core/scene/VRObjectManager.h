@@ -31,6 +31,9 @@ class VRObjectManager : public VRObject {
         map<string, VRTransformPtr> templatesByName;
         map<int, VRTransformWeakPtr> instances;
         map<string, shared_ptr<VRObjectManager::Entry> > entries;
+        map<int, shared_ptr<VRObjectManager::Entry> > instanceEntries; // stored by a key that survives reloading
+        map<int, int> instanceKeys; // instance ID to key of the stored entry
+        VRInstancedGeometryPtr instancer;
 
         void setup();
 
@@ -45,6 +48,9 @@ class VRObjectManager : public VRObject {
 
         VRTransformPtr add(VRTransformPtr s); // returns duplicate, first time the object is stored as template
         VRTransformPtr copy(string name, PosePtr p, bool addToStore = true); // returns duplicate
+        int addInstance(string name, PosePtr p, bool addToStore = true); // no duplicate, returns instance ID
+        void remInstance(int ID);
+        VRInstancedGeometryPtr getInstancer();
         void rem(VRTransformPtr o);
         void clear(bool clearTemplates = true);
         void updateObject(VRTransformPtr o);
@@ -0,0 +1,553 @@
+#include "VRSceneBinary.h"
+#include "VRSceneManager.h"
+#include "core/objects/geometry/VRGeometry.h"
+#include "core/objects/geometry/OSGGeometry.h"
+#include "core/utils/VRFunction.h"
+#include "core/utils/toString.h"
+
+#include <OpenSG/OSGGeometry.h>
+#include <OpenSG/OSGGeoProperties.h>
+#include <libxml++/libxml++.h>
+#include <libxml++/nodes/element.h>
+#include <boost/bind.hpp>
+#include <fstream>
+#include <cstring>
+#include <zlib.h>
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+namespace {
+    const char* magic = "PVRB";
+    const unsigned int version = 1;
+
+    enum { NODE_ELEMENT = 0, NODE_TEXT, NODE_CDATA, NODE_COMMENT, NODE_END };
+    enum { INDEX_NONE = 0, INDEX_POSITIONS, INDEX_OWN };
+
+    const vector<int> propertySlots = { Geometry::PositionsIndex, Geometry::NormalsIndex, Geometry::ColorsIndex, Geometry::TexCoordsIndex, Geometry::TexCoords1Index };
+
+    template<typename T> void put(string& buf, const T& t) { buf.append((const char*)&t, sizeof(T)); }
+    template<typename T> T get(const string& buf, size_t& p) {
+        T t;
+        if (p + sizeof(T) > buf.size()) { p = buf.size(); return T(); }
+        memcpy(&t, &buf[p], sizeof(T));
+        p += sizeof(T);
+        return t;
+    }
+
+    void putVarint(string& buf, size_t v) {
+        while (v >= 0x80) { buf += char((v & 0x7f) | 0x80); v >>= 7; }
+        buf += char(v);
+    }
+
+    size_t getVarint(const string& buf, size_t& p) {
+        size_t v = 0;
+        for (int s = 0; p < buf.size(); s += 7) {
+            unsigned char c = buf[p++];
+            v |= size_t(c & 0x7f) << s;
+            if (!(c & 0x80)) break;
+        }
+        return v;
+    }
+
+    void putStr(string& buf, const string& s) { putVarint(buf, s.size()); buf.append(s); }
+    string getStr(const string& buf, size_t& p) {
+        size_t N = getVarint(buf, p);
+        if (p + N > buf.size()) N = buf.size() - p;
+        string s = buf.substr(p, N);
+        p += N;
+        return s;
+    }
+
+    const string b64chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    string toBase64(const string& in) {
+        string out;
+        out.reserve((in.size()+2)/3*4);
+        int val = 0, bits = -6;
+        for (unsigned char c : in) {
+            val = (val << 8) + c;
+            bits += 8;
+            while (bits >= 0) { out += b64chars[(val >> bits) & 0x3f]; bits -= 6; }
+        }
+        if (bits > -6) out += b64chars[((val << 8) >> (bits + 8)) & 0x3f];
+        while (out.size() % 4) out += '=';
+        return out;
+    }
+
+    string fromBase64(const string& in) {
+        static vector<int> T;
+        if (T.size() == 0) { T.resize(256, -1); for (int i=0; i<64; i++) T[b64chars[i]] = i; }
+        string out;
+        int val = 0, bits = -8;
+        for (unsigned char c : in) {
+            if (T[c] == -1) continue; // skips padding and whitespace
+            val = (val << 6) + T[c];
+            bits += 6;
+            if (bits >= 0) { out += char((val >> bits) & 0xff); bits -= 8; }
+        }
+        return out;
+    }
+
+    void putIntegral(string& buf, GeoIntegralProperty* p) {
+        put<char>(buf, p != 0);
+        if (!p) return;
+        unsigned int N = p->size();
+        put(buf, N);
+        size_t o = buf.size();
+        buf.resize(o + N*sizeof(UInt32));
+        UInt32* d = (UInt32*)&buf[o];
+        for (unsigned int i=0; i<N; i++) d[i] = p->getValue<UInt32>(i);
+    }
+
+    void putVector(string& buf, GeoVectorProperty* p) {
+        put<char>(buf, p != 0);
+        if (!p) return;
+        unsigned int N = p->size();
+        char dim = p->getDimension();
+        put(buf, dim);
+        put(buf, N);
+        size_t o = buf.size();
+        buf.resize(o + N*dim*sizeof(float));
+        float* d = (float*)&buf[o];
+        for (unsigned int i=0; i<N; i++) {
+            Vec4f v = p->getValue<Vec4f>(i);
+            for (int j=0; j<dim; j++) d[i*dim+j] = v[j];
+        }
+    }
+
+    GeoIntegralPropertyRecPtr getIntegral(const string& buf, size_t& p, bool asUInt8 = false) {
+        if (!get<char>(buf, p)) return 0;
+        unsigned int N = get<unsigned int>(buf, p);
+        if (p + N*sizeof(UInt32) > buf.size()) { p = buf.size(); return 0; }
+        const UInt32* d = (const UInt32*)&buf[p];
+        p += N*sizeof(UInt32);
+
+        if (asUInt8) {
+            GeoUInt8PropertyRecPtr r = GeoUInt8Property::create();
+            auto& f = r->editField();
+            f.resize(N);
+            for (unsigned int i=0; i<N; i++) f[i] = d[i];
+            return r;
+        }
+
+        GeoUInt32PropertyRecPtr r = GeoUInt32Property::create();
+        auto& f = r->editField();
+        f.resize(N);
+        for (unsigned int i=0; i<N; i++) f[i] = d[i];
+        return r;
+    }
+
+    GeoVectorPropertyRecPtr getVector(const string& buf, size_t& p, bool asPoints = false) {
+        if (!get<char>(buf, p)) return 0;
+        char dim = get<char>(buf, p);
+        unsigned int N = get<unsigned int>(buf, p);
+        if (p + N*dim*sizeof(float) > buf.size()) { p = buf.size(); return 0; }
+        const float* d = (const float*)&buf[p];
+        p += N*dim*sizeof(float);
+
+        if (asPoints && dim == 3) {
+            GeoPnt3fPropertyRecPtr r = GeoPnt3fProperty::create();
+            auto& f = r->editField();
+            f.resize(N);
+            for (unsigned int i=0; i<N; i++) f[i] = Pnt3f(d[i*3], d[i*3+1], d[i*3+2]);
+            return r;
+        }
+
+        if (dim == 2) {
+            GeoVec2fPropertyRecPtr r = GeoVec2fProperty::create();
+            auto& f = r->editField();
+            f.resize(N);
+            for (unsigned int i=0; i<N; i++) f[i] = Vec2f(d[i*2], d[i*2+1]);
+            return r;
+        }
+
+        if (dim == 3) {
+            GeoVec3fPropertyRecPtr r = GeoVec3fProperty::create();
+            auto& f = r->editField();
+            f.resize(N);
+            for (unsigned int i=0; i<N; i++) f[i] = Vec3f(d[i*3], d[i*3+1], d[i*3+2]);
+            return r;
+        }
+
+        if (dim == 4) {
+            GeoVec4fPropertyRecPtr r = GeoVec4fProperty::create();
+            auto& f = r->editField();
+            f.resize(N);
+            for (unsigned int i=0; i<N; i++) f[i] = Vec4f(d[i*4], d[i*4+1], d[i*4+2], d[i*4+3]);
+            return r;
+        }
+
+        cout << "VRSceneBinary WARNING: unsupported vector property dimension " << int(dim) << endl;
+        return 0;
+    }
+}
+
+VRSceneBinary::VRSceneBinary() {}
+VRSceneBinary::~VRSceneBinary() {}
+
+VRSceneBinaryPtr VRSceneBinary::create() { return VRSceneBinaryPtr( new VRSceneBinary() ); }
+VRSceneBinaryPtr VRSceneBinary::ptr() { return shared_from_this(); }
+
+void VRSceneBinary::setCompression(bool b) { compression = b; }
+void VRSceneBinary::setLazyLoading(bool b, int perFrame) { lazy = b; geoBatch = max(perFrame, 1); }
+int VRSceneBinary::getGeometryCount() { return geoChunks.size(); }
+
+bool VRSceneBinary::isBinary(string path) {
+    ifstream f(path, ios::binary);
+    if (!f.good()) return false;
+    char m[4] = {0,0,0,0};
+    f.read(m, 4);
+    return strncmp(m, magic, 4) == 0;
+}
+
+void VRSceneBinary::addChunk(string tag, int ID, const string& data) {
+    Chunk c;
+    c.tag = tag;
+    c.ID = ID;
+    c.rawSize = data.size();
+    c.compressed = false;
+    c.data = data;
+
+    if (compression && data.size() > 64) {
+        uLongf N = compressBound(data.size());
+        string z(N, 0);
+        if (compress2((Bytef*)&z[0], &N, (const Bytef*)data.data(), data.size(), 1) == Z_OK && N < data.size()) {
+            z.resize(N);
+            c.data = z;
+            c.compressed = true;
+        }
+    }
+
+    c.size = c.data.size();
+    chunks.push_back(c);
+    if (tag == "GEOM") geoChunks[ID] = chunks.size()-1;
+}
+
+string VRSceneBinary::readStored(Chunk& c) {
+    if (c.offset == 0 || c.data.size() == c.size) return c.data;
+
+    string data(c.size, 0); // not yet read from disk
+    ifstream f(path, ios::binary);
+    f.seekg(c.offset);
+    f.read(&data[0], c.size);
+    if (!f.good()) { cout << "VRSceneBinary::readStored ERROR: failed to read chunk " << c.tag << " " << c.ID << " from " << path << endl; return ""; }
+    return data;
+}
+
+string VRSceneBinary::getChunkData(int i) {
+    if (i < 0 || i >= int(chunks.size())) return "";
+    Chunk& c = chunks[i];
+
+    string data = readStored(c);
+    if (!c.compressed) return data;
+    string raw(c.rawSize, 0);
+    uLongf N = c.rawSize;
+    if (uncompress((Bytef*)&raw[0], &N, (const Bytef*)data.data(), data.size()) != Z_OK || N != c.rawSize) {
+        cout << "VRSceneBinary::getChunkData ERROR: failed to decompress chunk " << c.tag << " " << c.ID << endl;
+        return "";
+    }
+    return raw;
+}
+
+int VRSceneBinary::findChunk(string tag) {
+    for (uint i=0; i<chunks.size(); i++) if (chunks[i].tag == tag) return i;
+    return -1;
+}
+
+int VRSceneBinary::addGeometry(OSGGeometryPtr mesh) {
+    if (!mesh || !mesh->geo) return -1;
+    auto geo = mesh->geo;
+
+    // every property with its own index, properties sharing the positions index only store a flag
+    GeoIntegralProperty* pIndex = geo->getIndex(Geometry::PositionsIndex);
+    string buf;
+    putIntegral(buf, geo->getTypes());
+    putIntegral(buf, geo->getLengths());
+    putIntegral(buf, pIndex);
+    for (auto slot : propertySlots) {
+        GeoIntegralProperty* index = geo->getIndex(slot);
+        putVector(buf, geo->getProperty(slot));
+        if (slot == Geometry::PositionsIndex) continue;
+        char mode = INDEX_NONE;
+        if (index) mode = (index == pIndex) ? INDEX_POSITIONS : INDEX_OWN;
+        put(buf, mode);
+        if (mode == INDEX_OWN) putIntegral(buf, index);
+    }
+
+    int ID = geoChunks.size();
+    addChunk("GEOM", ID, buf);
+    return ID;
+}
+
+OSGGeometryPtr VRSceneBinary::getGeometry(int ID) {
+    if (!geoChunks.count(ID)) return 0;
+    string buf = getChunkData(geoChunks[ID]);
+    if (buf.size() == 0) return 0;
+
+    size_t p = 0;
+    GeometryMTRecPtr geo = Geometry::create();
+    GeoIntegralPropertyRecPtr types = getIntegral(buf, p, true);
+    GeoIntegralPropertyRecPtr lengths = getIntegral(buf, p);
+    GeoIntegralPropertyRecPtr pIndex = getIntegral(buf, p);
+    if (types) geo->setTypes(types);
+    if (lengths) geo->setLengths(lengths);
+
+    for (auto slot : propertySlots) {
+        GeoVectorPropertyRecPtr prop = getVector(buf, p, slot == Geometry::PositionsIndex);
+        GeoIntegralPropertyRecPtr index = pIndex;
+        if (slot != Geometry::PositionsIndex) {
+            char mode = get<char>(buf, p);
+            if (mode == INDEX_NONE) index = 0;
+            if (mode == INDEX_OWN) index = getIntegral(buf, p);
+        }
+        if (prop) geo->setProperty(prop, slot);
+        if (prop && index) geo->setIndex(index, slot);
+    }
+    return OSGGeometry::create(geo);
+}
+
+void VRSceneBinary::addGeometries(VRObjectPtr root, int p) {
+    if (!root || root->getPersistency() <= p) return; // not saved, like in VRStorage::saveUnder
+    auto geo = dynamic_pointer_cast<VRGeometry>(root);
+    if (geo && geo->getReference().type == VRGeometry::CODE && geo->getMesh()) {
+        int ID = addGeometry(geo->getMesh());
+        if (ID >= 0) geo->setMeshChunk(ID);
+    }
+    for (auto c : root->getChildren()) addGeometries(c); // children are saved with persistency 0
+}
+
+void VRSceneBinary::requestGeometries(VRObjectPtr root) {
+    if (!root) return;
+    for (auto o : root->getChildren(true, "", true)) {
+        auto geo = dynamic_pointer_cast<VRGeometry>(o);
+        if (!geo || geo->getMeshChunk() < 0) continue;
+        if (geo->getReference().type == VRGeometry::CODE) requestGeometry(geo->getMeshChunk(), geo);
+        geo->setMeshChunk(-1);
+    }
+}
+
+void VRSceneBinary::requestGeometry(int ID, VRGeometryPtr geo) {
+    if (!geo) return;
+    pending[ID] = geo;
+}
+
+void VRSceneBinary::loadPendingGeometries() {
+    auto setMesh = [](VRSceneBinaryPtr self, int ID, VRGeometryWeakPtr wgeo) {
+        auto geo = wgeo.lock();
+        if (!geo) return;
+        auto mesh = self->getGeometry(ID);
+        if (!mesh) { cout << "VRSceneBinary WARNING: could not load geometry chunk " << ID << endl; return; }
+        auto mat = geo->getMaterial();
+        geo->setMesh(mesh);
+        if (mat) geo->setMaterial(mat);
+    };
+
+    int i = 0;
+    for (auto p : pending) {
+        if (!lazy) { setMesh(ptr(), p.first, p.second); continue; }
+        auto job = VRUpdateCb::create("binary_geo_load", boost::bind<void>(setMesh, ptr(), p.first, p.second));
+        VRSceneManager::get()->queueJob(job, 0, i/geoBatch);
+        i++;
+    }
+    pending.clear();
+}
+
+void VRSceneBinary::encodeDOM(xmlpp::Element* e, string& buf, map<string, int>& strings) {
+    auto strID = [&](const string& s) {
+        if (!strings.count(s)) { int N = strings.size(); strings[s] = N; }
+        return strings[s];
+    };
+
+    put<char>(buf, NODE_ELEMENT);
+    putVarint(buf, strID(e->get_name()));
+    putVarint(buf, strID(e->get_namespace_prefix()));
+
+    auto attribs = e->get_attributes();
+    putVarint(buf, attribs.size());
+    for (auto a : attribs) {
+        putVarint(buf, strID(a->get_name()));
+        putStr(buf, a->get_value());
+    }
+
+    for (auto n : e->get_children()) {
+        if (auto el = dynamic_cast<xmlpp::Element*>(n)) { encodeDOM(el, buf, strings); continue; }
+        if (auto t = dynamic_cast<xmlpp::CdataNode*>(n)) { put<char>(buf, NODE_CDATA); putStr(buf, t->get_content()); continue; }
+        if (auto t = dynamic_cast<xmlpp::TextNode*>(n)) { put<char>(buf, NODE_TEXT); putStr(buf, t->get_content()); continue; }
+        if (auto t = dynamic_cast<xmlpp::CommentNode*>(n)) { put<char>(buf, NODE_COMMENT); putStr(buf, t->get_content()); continue; }
+    }
+    put<char>(buf, NODE_END);
+}
+
+void VRSceneBinary::decodeDOM(const string& buf, size_t& p, const vector<string>& strings, xmlpp::Element* parent, xmlpp::Document& doc) {
+    auto str = [&](size_t i) { return i < strings.size() ? strings[i] : string(); };
+
+    string name = str(getVarint(buf, p));
+    string prefix = str(getVarint(buf, p));
+    xmlpp::Element* e = 0;
+    if (parent) e = parent->add_child(name, prefix);
+    else e = doc.create_root_node(name, "", prefix);
+
+    size_t Na = getVarint(buf, p);
+    for (size_t i=0; i<Na; i++) {
+        string aname = str(getVarint(buf, p));
+        e->set_attribute(aname, getStr(buf, p));
+    }
+
+    while (p < buf.size()) {
+        char type = get<char>(buf, p);
+        if (type == NODE_END) return;
+        if (type == NODE_ELEMENT) { decodeDOM(buf, p, strings, e, doc); continue; }
+        string content = getStr(buf, p);
+        if (type == NODE_TEXT) e->add_child_text(content);
+        if (type == NODE_CDATA) e->add_child_cdata(content);
+        if (type == NODE_COMMENT) e->add_child_comment(content);
+    }
+}
+
+void VRSceneBinary::write(string path, xmlpp::Document& doc) {
+    auto root = doc.get_root_node();
+    if (!root) return;
+
+    // the DOM and the string table go in front of the geometry chunks
+    map<string, int> strings;
+    string dom;
+    encodeDOM(root, dom, strings);
+
+    vector<string> table(strings.size());
+    for (auto s : strings) table[s.second] = s.first;
+    string strt;
+    putVarint(strt, table.size());
+    for (auto& s : table) putStr(strt, s);
+
+    vector<Chunk> geos = chunks;
+    chunks.clear();
+    geoChunks.clear();
+    addChunk("STRT", 0, strt);
+    addChunk("XDOM", 0, dom);
+    for (auto& c : geos) {
+        if (c.tag == "STRT" || c.tag == "XDOM") continue;
+        c.data = readStored(c); // pulls not yet loaded chunks into memory
+        c.offset = 0;
+        chunks.push_back(c);
+        if (c.tag == "GEOM") geoChunks[c.ID] = chunks.size()-1;
+    }
+
+    ofstream f(path, ios::binary);
+    f.write(magic, 4);
+    f.write((const char*)&version, sizeof(version));
+    for (auto& c : chunks) {
+        uint64_t rawSize = c.rawSize;
+        uint64_t size = c.size;
+        char compressed = c.compressed;
+        f.write(c.tag.c_str(), 4);
+        f.write((const char*)&c.ID, sizeof(int));
+        f.write(&compressed, 1);
+        f.write((const char*)&rawSize, sizeof(uint64_t));
+        f.write((const char*)&size, sizeof(uint64_t));
+        f.write(c.data.data(), c.data.size());
+    }
+    this->path = path;
+}
+
+bool VRSceneBinary::read(string path, xmlpp::Document& doc) {
+    this->path = path;
+    chunks.clear();
+    geoChunks.clear();
+
+    ifstream f(path, ios::binary);
+    char m[4];
+    unsigned int v = 0;
+    f.read(m, 4);
+    f.read((char*)&v, sizeof(v));
+    if (!f.good() || strncmp(m, magic, 4) != 0) { cout << "VRSceneBinary::read ERROR: " << path << " is no binary scene\n"; return false; }
+    if (v > version) { cout << "VRSceneBinary::read ERROR: unsupported version " << v << endl; return false; }
+
+    while (true) {
+        Chunk c;
+        char tag[4];
+        char compressed = 0;
+        uint64_t rawSize = 0, size = 0;
+        f.read(tag, 4);
+        f.read((char*)&c.ID, sizeof(int));
+        f.read(&compressed, 1);
+        f.read((char*)&rawSize, sizeof(uint64_t));
+        f.read((char*)&size, sizeof(uint64_t));
+        if (!f.good()) break;
+
+        c.tag = string(tag, 4);
+        c.compressed = compressed;
+        c.rawSize = rawSize;
+        c.size = size;
+        c.offset = f.tellg();
+        if (c.tag == "GEOM") f.seekg(size, ios::cur); // geometry is read on demand
+        else {
+            c.data.resize(size);
+            f.read(&c.data[0], size);
+        }
+
+        chunks.push_back(c);
+        if (c.tag == "GEOM") geoChunks[c.ID] = chunks.size()-1;
+    }
+
+    string strt = getChunkData(findChunk("STRT"));
+    string dom = getChunkData(findChunk("XDOM"));
+    if (dom.size() == 0) { cout << "VRSceneBinary::read ERROR: " << path << " has no scene data\n"; return false; }
+
+    size_t p = 0;
+    vector<string> table(getVarint(strt, p));
+    for (auto& s : table) s = getStr(strt, p);
+
+    p = 0;
+    if (get<char>(dom, p) != NODE_ELEMENT) return false;
+    decodeDOM(dom, p, table, 0, doc);
+    return true;
+}
+
+void VRSceneBinary::writeChunksTo(xmlpp::Element* e) {
+    for (uint i=0; i<chunks.size(); i++) {
+        auto& c = chunks[i];
+        if (c.tag != "GEOM") continue;
+        auto ce = e->add_child("Chunk");
+        ce->set_attribute("tag", c.tag);
+        ce->set_attribute("ID", toString(c.ID));
+        ce->add_child_text( toBase64(getChunkData(i)) );
+    }
+}
+
+void VRSceneBinary::readChunksFrom(xmlpp::Element* e) {
+    for (auto n : e->get_children()) {
+        auto ce = dynamic_cast<xmlpp::Element*>(n);
+        if (!ce || ce->get_name() != "Chunk") continue;
+        if (!ce->get_attribute("tag") || !ce->get_attribute("ID")) continue;
+        auto t = ce->get_child_text();
+        addChunk(ce->get_attribute_value("tag"), toInt(ce->get_attribute_value("ID")), t ? fromBase64(t->get_content()) : "");
+    }
+}
+
+void VRSceneBinary::convertToXML(string in, string out) {
+    auto bin = create();
+    xmlpp::Document doc;
+    if (!bin->read(in, doc)) return;
+    auto root = doc.get_root_node();
+    if (bin->getGeometryCount() > 0) bin->writeChunksTo( root->add_child("Chunks") );
+    doc.write_to_file_formatted(out);
+}
+
+void VRSceneBinary::convertToBinary(string in, string out, bool compress) {
+    xmlpp::DomParser parser;
+    parser.set_validate(false);
+    parser.parse_file(in.c_str());
+    auto& doc = *parser.get_document();
+    auto root = doc.get_root_node();
+
+    auto bin = create();
+    bin->setCompression(compress);
+    for (auto n : root->get_children("Chunks")) { // geometry chunks embedded in the XML
+        bin->readChunksFrom( dynamic_cast<xmlpp::Element*>(n) );
+        root->remove_child(n);
+    }
+    bin->write(out, doc);
+}
+
+OSG_END_NAMESPACE;
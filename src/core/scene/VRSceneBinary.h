@@ -0,0 +1,88 @@
+#ifndef VRSCENEBINARY_H_INCLUDED
+#define VRSCENEBINARY_H_INCLUDED
+
+#include <OpenSG/OSGConfig.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "core/scene/VRSceneFwd.h"
+#include "core/objects/VRObjectFwd.h"
+
+namespace xmlpp{ class Element; class Document; }
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+/**
+    Chunked binary scene container, alternative to the plain XML scene files.
+
+    A file starts with the magic 'PVRB' and a version, followed by a list of chunks:
+        char[4] tag | int32 ID | uint8 compressed | uint64 raw size | uint64 size | data
+
+    'XDOM' holds the VRStorage element tree (names through a string table),
+    'GEOM' chunks hold the raw geometry buffers of code generated geometries, each property with its index.
+    Geometry chunks are only read from disk when requested, optionally spread over several frames.
+*/
+
+class VRSceneBinary : public std::enable_shared_from_this<VRSceneBinary> {
+    public:
+        struct Chunk {
+            string tag;
+            int ID = 0;
+            bool compressed = false;
+            size_t rawSize = 0;
+            size_t size = 0;
+            size_t offset = 0; // file offset of the data, 0 if data is in memory
+            string data;
+        };
+
+    private:
+        string path;
+        bool compression = true;
+        bool lazy = false;
+        int geoBatch = 16;
+        vector<Chunk> chunks;
+        map<int, int> geoChunks; // geometry ID -> chunk index
+        map<int, VRGeometryWeakPtr> pending;
+
+        void addChunk(string tag, int ID, const string& data);
+        string readStored(Chunk& c);
+        string getChunkData(int i);
+        int findChunk(string tag);
+
+        void encodeDOM(xmlpp::Element* e, string& buf, map<string, int>& strings);
+        void decodeDOM(const string& buf, size_t& p, const vector<string>& strings, xmlpp::Element* parent, xmlpp::Document& doc);
+
+    public:
+        VRSceneBinary();
+        ~VRSceneBinary();
+
+        static VRSceneBinaryPtr create();
+        VRSceneBinaryPtr ptr();
+
+        static bool isBinary(string path);
+
+        void setCompression(bool b);
+        void setLazyLoading(bool b, int perFrame = 16);
+
+        int addGeometry(OSGGeometryPtr mesh);
+        OSGGeometryPtr getGeometry(int ID);
+        void requestGeometry(int ID, VRGeometryPtr geo);
+        void addGeometries(VRObjectPtr root, int p = 0); // before saving, stores the meshes of the code generated geometries
+        void requestGeometries(VRObjectPtr root); // after loading, the geometries with a mesh chunk
+        void loadPendingGeometries();
+        int getGeometryCount();
+
+        void write(string path, xmlpp::Document& doc);
+        bool read(string path, xmlpp::Document& doc);
+
+        void writeChunksTo(xmlpp::Element* e);
+        void readChunksFrom(xmlpp::Element* e);
+
+        static void convertToXML(string in, string out);
+        static void convertToBinary(string in, string out, bool compress = true);
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRSCENEBINARY_H_INCLUDED
@@ -17,6 +17,8 @@ ptrFwd(VRRenderStudio);
 ptrFwd(VRScene);
 ptrFwd(VRThread);
 ptrFwd(VRSpaceWarper);
+ptrFwd(VRSceneBinary);
+ptrFwd(VRImportCache);
 
 }
 
@@ -12,6 +12,7 @@
 //#include "addons/Engineering/CSG/CSGGeometry.h"
 
 #include "VRScene.h"
+#include "VRSceneBinary.h"
 #include "core/utils/VRTimer.h"
 #include "core/utils/VRStorage_template.h"
 #include "core/navigation/VRNavigator.h"
@@ -82,6 +83,10 @@ void VRSceneLoader::saveScene(string file, xmlpp::Element* guiN) {
     auto scene = VRScene::getCurrent();
     if (scene == 0) return;
 
+    bool binary = (boost::filesystem::path(file).extension() == ".pvrb");
+    VRSceneBinaryPtr bin;
+    if (binary) bin = VRSceneBinary::create();
+
     xmlpp::Document doc;
     xmlpp::Element* sceneN = doc.create_root_node("Scene", "", "VRF"); //name, ns_uri, ns_prefix
     xmlpp::Element* objectsN = sceneN->add_child("Objects");
@@ -90,9 +95,12 @@ void VRSceneLoader::saveScene(string file, xmlpp::Element* guiN) {
     // save scenegraph
     scene->setPath(file);
     VRObjectPtr root = scene->getRoot();
+    if (bin) bin->addGeometries(root); // geometries write their buffers into the binary chunks
     root->saveUnder(objectsN);
     scene->saveScene(sceneN);
-    doc.write_to_file_formatted(file);
+
+    if (bin) bin->write(file, doc);
+    else doc.write_to_file_formatted(file);
 }
 
 xmlpp::Element* VRSceneLoader_getElementChild_(xmlpp::Element* e, string name) {
@@ -129,10 +137,27 @@ xmlpp::Element* VRSceneLoader_getElementChild_(xmlpp::Element* e, int i) {
 
 void VRSceneLoader::loadScene(string path) {
     xmlpp::DomParser parser;
-    parser.set_validate(false);
-    parser.parse_file(path.c_str());
-    xmlpp::Node* n = parser.get_document()->get_root_node();
-    xmlpp::Element* sceneN = dynamic_cast<xmlpp::Element*>(n);
+    xmlpp::Document binDoc;
+    VRSceneBinaryPtr bin;
+    xmlpp::Element* sceneN = 0;
+
+    if (VRSceneBinary::isBinary(path)) {
+        bin = VRSceneBinary::create();
+        bin->setLazyLoading(true);
+        if (!bin->read(path, binDoc)) return;
+        sceneN = binDoc.get_root_node();
+    } else {
+        parser.set_validate(false);
+        parser.parse_file(path.c_str());
+        xmlpp::Node* n = parser.get_document()->get_root_node();
+        sceneN = dynamic_cast<xmlpp::Element*>(n);
+
+        xmlpp::Element* chunksN = VRSceneLoader_getElementChild_(sceneN, "Chunks"); // converted from binary
+        if (chunksN) {
+            bin = VRSceneBinary::create();
+            bin->readChunksFrom(chunksN);
+        }
+    }
 
     // load scenegraph
     xmlpp::Element* objectsN = VRSceneLoader_getElementChild_(sceneN, "Objects");
@@ -142,6 +167,11 @@ void VRSceneLoader::loadScene(string path) {
     VRSceneLoader_current_scene = scene;
 
     scene->getRoot()->load(root);
+    if (bin) {
+        bin->requestGeometries(scene->getRoot());
+        bin->loadPendingGeometries();
+    }
+
     VRSceneManager::get()->setScene(scene);
     scene->loadScene(sceneN);
 }
@@ -1,4 +1,5 @@
 #include "VRImport.h"
+#include "VRImportCache.h"
 #include "VRCOLLADA.h"
 #include "VRPLY.h"
 #include "VRVTK.h"
@@ -33,6 +34,7 @@ OSG_BEGIN_NAMESPACE;
 
 VRImport::VRImport() {
     progress = VRProgress::create();
+    diskCache = VRImportCache::create();
 }
 
 VRImport* VRImport::get() {
@@ -127,6 +129,95 @@ VRImport::LoadJob::LoadJob(string p, string pr, VRTransformPtr r, VRProgressPtr
     options = opt;
 }
 
+string repSpaces(string s);
+
+void collectNodes(Node* n, vector<Node*>& nodes, vector<int>& parents, int parent = -1) { // pre-order
+    int i = nodes.size();
+    nodes.push_back(n);
+    parents.push_back(parent);
+    for (uint j=0; j<n->getNChildren(); j++) collectNodes(n->getChild(j), nodes, parents, i);
+}
+
+vector<VRImportCache::ObjectType> getObjectTypes(VRObjectPtr root) { // the objects created by the loader and their nodes
+    vector<Node*> nodes;
+    vector<int> parents;
+    collectNodes(root->getNode()->node, nodes, parents);
+    map<Node*, int> index;
+    for (uint i=0; i<nodes.size(); i++) index[nodes[i]] = i;
+
+    vector<VRImportCache::ObjectType> types;
+    for (auto o : root->getChildren(true)) {
+        Node* n = o->getNode()->node;
+        if (!index.count(n)) continue;
+        VRImportCache::ObjectType t;
+        t.node = index[n];
+        t.type = o->getType();
+        t.name = o->getBaseName();
+        types.push_back(t);
+    }
+    return types;
+}
+
+VRObjectPtr constructObject(Node* n, const VRImportCache::ObjectType& t, string path) {
+    NodeCore* core = n->getCore();
+    Transform* trans = dynamic_cast<Transform*>(core);
+
+    if (t.type == "Geometry") {
+        auto geo = VRGeometry::create(t.name);
+        if (trans) geo->setMatrix(toMatrix4d(trans->getMatrix()));
+        for (uint i=0; i<n->getNChildren(); i++) { // the mesh node
+            auto g = dynamic_cast<Geometry*>(n->getChild(i)->getCore());
+            if (!g) continue;
+            VRGeometry::Reference ref;
+            ref.type = VRGeometry::FILE;
+            ref.parameter = repSpaces(path) + " " + repSpaces( geo->getBaseName() );
+            geo->setMesh( OSGGeometry::create(g), ref, true );
+            break;
+        }
+        return geo;
+    }
+
+    if (t.type == "Transform") {
+        auto tr = VRTransform::create(t.name);
+        if (trans) tr->setMatrix(toMatrix4d(trans->getMatrix()));
+        return tr;
+    }
+
+    if (t.type == "Material") {
+        auto m = VRMaterial::create(t.name);
+        m->setCore(OSGCore::create(core), "Material");
+        return m;
+    }
+
+    auto o = VRObject::create(t.name);
+    if (core && string(core->getTypeName()) != "Group") o->setCore(OSGCore::create(core), t.type);
+    return o;
+}
+
+void rebuildObjects(Node* root, const vector<VRImportCache::ObjectType>& types, VRObjectPtr res, string path) {
+    vector<Node*> nodes;
+    vector<int> parents;
+    collectNodes(root, nodes, parents);
+    map<int, const VRImportCache::ObjectType*> owners;
+    for (auto& t : types) owners[t.node] = &t;
+
+    map<int, VRObjectPtr> objects;
+    objects[0] = res;
+    for (uint i=1; i<nodes.size(); i++) {
+        if (!objects.count(parents[i])) continue; // below a node without object
+        auto parent = objects[parents[i]];
+        Node* n = nodes[i];
+        if (!owners.count(i)) {
+            if (parent->getType() == "Geometry" && dynamic_cast<Geometry*>(n->getCore())) continue; // mesh, already set
+            parent->getNode()->node->addChild(n); // a node the loader added without object
+            continue;
+        }
+        auto o = constructObject(n, *owners[i], path);
+        parent->addChild(o);
+        objects[i] = o;
+    }
+}
+
 void VRImport::LoadJob::load(VRThreadWeakPtr tw) {
     VRThreadPtr t = tw.lock();
 
@@ -151,7 +242,21 @@ void VRImport::LoadJob::load(VRThreadWeakPtr tw) {
         if (preset == "COLLADA") loadCollada(path, res);
     };
 
-    loadSwitch();
+    auto diskCache = VRImport::get()->getDiskCache();
+    string key;
+    if (diskCache->isCacheable(path)) key = diskCache->getKey(path, preset, options);
+    vector<VRImportCache::ObjectType> types;
+    NodeMTRecPtr cached = diskCache->lookup(key, types);
+    if (cached && types.size()) rebuildObjects(cached, types, res, path); // same object types as the loader
+    else if (cached) {
+        map<string, bool> m;
+        fixEmptyNames(cached,m);
+        for (uint i=0; i<cached->getNChildren(); i++) res->addChild( OSGConstruct(cached->getChild(i), res, path, path) );
+    } else {
+        loadSwitch();
+        diskCache->store(key, res->getNode()->node, getObjectTypes(res));
+    }
+
     VRImport::get()->fillCache(path, res);
     if (t) t->syncToMain();
 }
@@ -304,6 +409,7 @@ VRGeometryPtr VRImport::loadGeometry(string file, string object, string preset,
 }
 
 VRProgressPtr VRImport::getProgressObject() { return progress; }
+VRImportCachePtr VRImport::getDiskCache() { return diskCache; }
 
 void VRImport::ingoreHeavyRessources() { ihr_flag = true; }
 
@@ -40,6 +40,7 @@ class VRImport {
 
     private:
         map<string, Cache> cache;
+        VRImportCachePtr diskCache;
 
         VRProgressPtr progress;
         bool ihr_flag = false; // ignore heavy ressources
@@ -60,6 +61,7 @@ class VRImport {
         VRGeometryPtr loadGeometry(string path, string name, string preset = "OSG", bool thread = false);
 
         VRProgressPtr getProgressObject();
+        VRImportCachePtr getDiskCache();
         void ingoreHeavyRessources();
 };
 
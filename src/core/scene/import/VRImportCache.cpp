@@ -0,0 +1,219 @@
+#include "VRImportCache.h"
+
+#include <OpenSG/OSGSceneFileHandler.h>
+#include <boost/filesystem.hpp>
+#include <boost/thread/thread.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+namespace bfs = boost::filesystem;
+
+const string cacheVersion = "2";
+
+VRImportCache::VRImportCache() {
+    const char* home = getenv("HOME");
+    setFolder( string(home ? home : "/tmp") + "/.polyvr/importcache" );
+}
+
+VRImportCachePtr VRImportCache::create() { return VRImportCachePtr( new VRImportCache() ); }
+
+void VRImportCache::setFolder(string f) {
+    boost::mutex::scoped_lock lock(mutex);
+    folder = f;
+    stamps.clear();
+    boost::system::error_code ec;
+    bfs::create_directories(folder, ec);
+    if (ec) { cout << "VRImportCache WARNING: can not create cache folder " << folder << ", " << ec.message() << endl; enabled = false; return; }
+    loadIndex();
+}
+
+string VRImportCache::getFolder() { return folder; }
+void VRImportCache::setEnabled(bool b) { enabled = b; }
+void VRImportCache::setMaxSize(size_t b) { maxSize = b; }
+void VRImportCache::setMinFileSize(size_t b) { minFileSize = b; }
+int VRImportCache::getHits() { return hits; }
+int VRImportCache::getMisses() { return misses; }
+string VRImportCache::entryPath(string key) { return folder + "/" + key + ".osb"; }
+string VRImportCache::typesPath(string key) { return folder + "/" + key + ".types"; }
+
+// FNV-1a, 64 bit, pass the last result as h to continue
+uint64_t VRImportCache::hashData(const void* data, size_t size, uint64_t h) {
+    const unsigned char* d = (const unsigned char*)data;
+    for (size_t i=0; i<size; i++) { h ^= d[i]; h *= 1099511628211ULL; }
+    return h;
+}
+
+string VRImportCache::hashFile(string path) {
+    ifstream f(path, ios::binary);
+    if (!f.good()) return "";
+    uint64_t h = hashData(0, 0); // offset basis
+    vector<char> buf(1<<20);
+    while (f) {
+        f.read(&buf[0], buf.size());
+        h = hashData(&buf[0], f.gcount(), h);
+    }
+    stringstream ss;
+    ss << hex << h;
+    return ss.str();
+}
+
+static string threadTag() {
+    stringstream ss;
+    ss << boost::this_thread::get_id();
+    return ss.str();
+}
+
+void VRImportCache::loadIndex() {
+    ifstream f(folder + "/index");
+    string path;
+    FileStamp s;
+    while (f >> s.size >> s.mtime >> s.hash && getline(f >> ws, path)) stamps[path] = s;
+}
+
+void VRImportCache::saveIndex() {
+    string tmp = folder + "/index." + threadTag();
+    {
+        ofstream f(tmp);
+        for (auto s : stamps) f << s.second.size << " " << s.second.mtime << " " << s.second.hash << " " << s.first << endl;
+    }
+    boost::system::error_code ec;
+    bfs::rename(tmp, folder + "/index", ec);
+}
+
+bool VRImportCache::isCacheable(string path) {
+    if (!enabled) return false;
+    boost::system::error_code ec;
+    size_t size = bfs::file_size(path, ec);
+    return !ec && size >= minFileSize;
+}
+
+string VRImportCache::getKey(string path, string preset, string options) {
+    boost::system::error_code ec;
+    FileStamp s;
+    s.size = bfs::file_size(path, ec);
+    if (ec) return "";
+    s.mtime = bfs::last_write_time(path, ec);
+
+    {
+        boost::mutex::scoped_lock lock(mutex);
+        if (stamps.count(path)) {
+            auto& o = stamps[path];
+            if (o.size == s.size && o.mtime == s.mtime) s.hash = o.hash;
+        }
+    }
+
+    if (s.hash == "") { // new or changed file
+        s.hash = hashFile(path);
+        boost::mutex::scoped_lock lock(mutex);
+        stamps[path] = s;
+        saveIndex();
+    }
+
+    string params = preset + "|" + options + "|" + cacheVersion;
+    stringstream ss;
+    ss << hex << hashData(params.data(), params.size());
+    return s.hash + "_" + ss.str();
+}
+
+NodeTransitPtr VRImportCache::lookup(string key, vector<ObjectType>& types) {
+    types.clear();
+    if (!enabled || key == "") return NodeTransitPtr();
+    string path = entryPath(key);
+    auto count = [&](int& i) { boost::mutex::scoped_lock lock(mutex); i++; };
+    if (!bfs::exists(path)) { count(misses); return NodeTransitPtr(); }
+
+    NodeTransitPtr n = SceneFileHandler::the()->read(path.c_str());
+    if (!n) { // corrupt entry
+        cout << "VRImportCache WARNING: invalid entry " << path << ", removed" << endl;
+        remove(key);
+        count(misses);
+        return n;
+    }
+
+    ifstream f(typesPath(key));
+    ObjectType t;
+    while (f >> t.node >> t.type && getline(f >> ws, t.name)) types.push_back(t);
+
+    boost::system::error_code ec;
+    bfs::last_write_time(path, time(0), ec); // used for LRU eviction
+    count(hits);
+    return n;
+}
+
+void VRImportCache::store(string key, Node* node, const vector<ObjectType>& types) {
+    if (!enabled || key == "" || !node) return;
+    string path = entryPath(key);
+    boost::system::error_code ec;
+
+    // concurrent load jobs of the same file each write their own files, the renames are atomic
+    string tmpTypes = typesPath(key) + "." + threadTag();
+    {
+        ofstream f(tmpTypes);
+        for (auto& t : types) f << t.node << " " << t.type << " " << t.name << endl;
+    }
+    bfs::rename(tmpTypes, typesPath(key), ec); // before the scene, an entry is complete once it exists
+    if (ec) { bfs::remove(tmpTypes, ec); return; }
+
+    string tmp = folder + "/" + key + "." + threadTag() + ".part.osb"; // the writer is chosen by extension
+    if (!SceneFileHandler::the()->write(node, tmp.c_str())) {
+        cout << "VRImportCache WARNING: failed to write " << tmp << endl;
+        return;
+    }
+
+    bfs::rename(tmp, path, ec);
+    if (ec) { bfs::remove(tmp, ec); return; }
+    evict();
+}
+
+void VRImportCache::remove(string key) {
+    boost::system::error_code ec;
+    bfs::remove(entryPath(key), ec);
+    bfs::remove(typesPath(key), ec);
+}
+
+size_t VRImportCache::getSize() {
+    size_t size = 0;
+    boost::system::error_code ec;
+    for (bfs::directory_iterator i(folder, ec), end; i != end; i.increment(ec)) {
+        if (i->path().extension() != ".osb") continue;
+        size += bfs::file_size(i->path(), ec);
+    }
+    return size;
+}
+
+void VRImportCache::evict() {
+    boost::mutex::scoped_lock lock(mutex);
+    boost::system::error_code ec;
+    multimap<time_t, pair<bfs::path, size_t>> entries;
+    size_t size = 0;
+    for (bfs::directory_iterator i(folder, ec), end; i != end; i.increment(ec)) {
+        if (i->path().extension() != ".osb") continue;
+        size_t s = bfs::file_size(i->path(), ec);
+        entries.insert( make_pair(bfs::last_write_time(i->path(), ec), make_pair(i->path(), s)) );
+        size += s;
+    }
+
+    for (auto& e : entries) { // oldest first
+        if (size <= maxSize) break;
+        auto types = e.second.first;
+        bfs::remove(e.second.first, ec);
+        bfs::remove(types.replace_extension(".types"), ec);
+        size -= e.second.second;
+    }
+}
+
+void VRImportCache::clear() {
+    boost::mutex::scoped_lock lock(mutex);
+    boost::system::error_code ec;
+    vector<bfs::path> files;
+    for (bfs::directory_iterator i(folder, ec), end; i != end; i.increment(ec)) files.push_back(i->path());
+    for (auto& f : files) bfs::remove(f, ec);
+    stamps.clear();
+    hits = misses = 0;
+}
+
+OSG_END_NAMESPACE;
@@ -0,0 +1,81 @@
+#ifndef VRIMPORTCACHE_H_INCLUDED
+#define VRIMPORTCACHE_H_INCLUDED
+
+#include <OpenSG/OSGNode.h>
+#include <string>
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <boost/thread/mutex.hpp>
+#include "core/scene/VRSceneFwd.h"
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+/**
+    Persistent on disk cache for imported models.
+    Entries are keyed by a hash of the file content and the import preset and options,
+    the loaded scene graph is stored as OpenSG binary (.osb) in the cache folder,
+    next to it the types and names of the objects the loader created, by pre-order index of their nodes.
+    Content hashes are memorized by path, size and modification time to avoid rehashing unchanged files.
+*/
+
+class VRImportCache {
+    public:
+        struct FileStamp {
+            size_t size = 0;
+            time_t mtime = 0;
+            string hash;
+        };
+
+        struct ObjectType {
+            int node;
+            string type;
+            string name;
+        };
+
+    private:
+        string folder;
+        bool enabled = true;
+        size_t maxSize = size_t(4) << 30;
+        size_t minFileSize = size_t(1) << 20;
+        int hits = 0;
+        int misses = 0;
+        map<string, FileStamp> stamps;
+        boost::mutex mutex;
+
+        void loadIndex();
+        void saveIndex();
+        string entryPath(string key);
+        string typesPath(string key);
+
+    public:
+        VRImportCache();
+        static VRImportCachePtr create();
+
+        static uint64_t hashData(const void* data, size_t size, uint64_t h = 14695981039346656037ULL);
+        static string hashFile(string path);
+
+        void setFolder(string folder);
+        string getFolder();
+        void setEnabled(bool b);
+        void setMaxSize(size_t bytes);
+        void setMinFileSize(size_t bytes);
+
+        string getKey(string path, string preset, string options);
+        bool isCacheable(string path);
+
+        NodeTransitPtr lookup(string key, vector<ObjectType>& types);
+        void store(string key, Node* node, const vector<ObjectType>& types);
+        void remove(string key);
+        void evict();
+        void clear();
+
+        size_t getSize();
+        int getHits();
+        int getMisses();
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRIMPORTCACHE_H_INCLUDED
@@ -2,6 +2,7 @@
 #include "VRSoundUtils.h"
 #include "core/math/path.h"
 #include "VRSoundManager.h"
+#include "VRSoundMixer.h"
 
 
 extern "C" {
@@ -26,6 +27,7 @@ sudo apt-get install libfftw3-dev
 #include <fftw3.h>
 #include <map>
 #include <climits>
+#include <cmath>
 //#include <complex>
 
 using namespace OSG;
@@ -37,6 +39,26 @@ string avErrToStr(const int& e) {
     return string(buf);
 }
 
+vector<float> toMono(const uint8_t* data, int frames, int channels, AVSampleFormat fmt) { // interleaved samples to mono in the range of shorts
+    vector<float> res(frames, 0);
+    float k = 1.0/max(channels, 1);
+    for (int i=0; i<frames; i++) {
+        for (int c=0; c<channels; c++) {
+            int j = i*channels+c;
+            switch (av_get_packed_sample_fmt(fmt)) {
+                case AV_SAMPLE_FMT_U8: res[i] += (data[j] - 128)*256.f; break;
+                case AV_SAMPLE_FMT_S16: res[i] += ((const int16_t*)data)[j]; break;
+                case AV_SAMPLE_FMT_S32: res[i] += ((const int32_t*)data)[j]/65536.f; break;
+                case AV_SAMPLE_FMT_FLT: res[i] += ((const float*)data)[j]*32767.f; break;
+                case AV_SAMPLE_FMT_DBL: res[i] += ((const double*)data)[j]*32767.f; break;
+                default: break;
+            }
+        }
+        res[i] *= k;
+    }
+    return res;
+}
+
 struct VRSound::ALData {
     ALenum sample = 0;
     ALenum format = 0;
@@ -69,16 +91,23 @@ void VRSound::setPath( string p ) { path = p; }
 
 void VRSound::setLoop(bool loop) { this->loop = loop; doUpdate = true; }
 void VRSound::setPitch(float pitch) { this->pitch = pitch; doUpdate = true; }
-void VRSound::setGain(float gain) { this->gain = gain; doUpdate = true; }
-void VRSound::setUser(Vec3d p, Vec3d v) { pos = p; vel = v; doUpdate = true; }
+void VRSound::setGain(float gain) { this->gain = gain; doUpdate = true; if (voice >= 0) mixer->setGain(voice, gain); }
+void VRSound::setUser(Vec3d p, Vec3d v) { pos = p; vel = v; doUpdate = true; setMixed(false); }
+bool VRSound::isMixed() { return mixed; }
+
+void VRSound::setMixed(bool b) {
+    if (!b) closeVoice();
+    mixed = b;
+}
 bool VRSound::isRunning() {
     recycleBuffer();
     //cout << "isRunning " << bool(al->state == AL_PLAYING) << " " << bool(al->state == AL_INITIAL) << " " << getQueuedBuffer()<< endl;
     return al->state == AL_PLAYING || al->state == AL_INITIAL || getQueuedBuffer() != 0;
 }
-void VRSound::stop() { interrupt = true; loop = false; }
+void VRSound::stop() { interrupt = true; loop = false; closeVoice(); }
 
 void VRSound::close() {
+    closeVoice();
     ALCHECK( alDeleteSources(1u, &source));
     ALCHECK( alDeleteBuffers(Nbuffers, buffers));
     if(al->context) avformat_close_input(&al->context);
@@ -93,6 +122,7 @@ void VRSound::play() { al->state = AL_INITIAL; }
 
 void VRSound::updateSource() {
     cout << "update source" << endl;
+    if (voice >= 0) mixer->setGain(voice, gain);
     ALCHECK( alSourcef(source, AL_PITCH, pitch));
     ALCHECK( alSourcef(source, AL_GAIN, gain));
     ALCHECK( alSource3f(source, AL_POSITION, pos[0], pos[1], pos[2]));
@@ -230,6 +260,7 @@ void VRSound::playFrame() {
     int len;
     if (al->state == AL_PLAYING) {
         if (doUpdate) updateSource();
+        if (voice >= 0 && !flushMixer()) return; // mixer stream is full, decode the next packet later
         auto avrf = av_read_frame(al->context, &al->packet);
         //cout << "play frame " << interrupt << " " << avrf << endl;
         if (interrupt || avrf < 0) {
@@ -265,6 +296,14 @@ void VRSound::playFrame() {
                     avresample_convert( al->resampler, (uint8_t **)&frameData, linesize, al->frame->nb_samples, (uint8_t **)al->frame->data, al->frame->linesize[0], al->frame->nb_samples);
                 } else frameData = (ALbyte*)al->frame->data[0];
 
+                if (useMixer()) {
+                    mixBuffer(toMono((const uint8_t*)frameData, al->frame->nb_samples, al->codec->channels, al->codec->sample_fmt), frequency);
+                    if (al->resampler) av_free(frameData);
+                    al->packet.size -= len;
+                    al->packet.data += len;
+                    continue;
+                }
+
                 ALint val = -1;
                 ALuint bufid = getFreeBufferID();
 
@@ -346,6 +385,11 @@ void VRSound::playLocally() {
 }
 
 void VRSound::playBuffer(vector<short>& buffer, int sample_rate) {
+    if (useMixer()) {
+        mixBuffer(vector<float>(buffer.begin(), buffer.end()), sample_rate);
+        return;
+    }
+
     ALint val = -1;
     ALuint buf = getFreeBufferID();
     alBufferData(buf, AL_FORMAT_MONO16, &buffer[0], buffer.size()*sizeof(short), sample_rate);
@@ -354,6 +398,55 @@ void VRSound::playBuffer(vector<short>& buffer, int sample_rate) {
     if (val != AL_PLAYING) ALCHECK( alSourcePlay(source));
 }
 
+bool VRSound::useMixer() {
+    if (!mixed) return false;
+    if (!mixer) mixer = VRSoundManager::get()->getMixer();
+    if (voice < 0) {
+        voice = mixer->addStream();
+        if (voice >= 0) mixer->setGain(voice, gain);
+    }
+    return voice >= 0;
+}
+
+void VRSound::mixBuffer(const vector<float>& samples, int sample_rate) { // linear resampling to the mixer rate, the pitch scales the rate
+    int N = samples.size();
+    if (N == 0 || sample_rate <= 0) return;
+    double step = double(sample_rate)*pitch/mixer->getRate();
+    vector<short> out;
+    out.reserve(N/step + 2);
+    for (; resamplePos < N-1; resamplePos += step) { // positions from -1, the last sample of the previous buffer
+        int i = floor(resamplePos);
+        double t = resamplePos - i;
+        float a = i < 0 ? lastSample : samples[i];
+        out.push_back( short( a + t*(samples[i+1]-a) ) );
+    }
+    resamplePos -= N;
+    lastSample = samples[N-1];
+
+    pendingSamples.insert(pendingSamples.end(), out.begin(), out.end());
+    mixedBuffers.push_back(out.size());
+    mixedSamples += out.size();
+    flushMixer();
+}
+
+bool VRSound::flushMixer() {
+    if (pendingSamples.size() == 0) return true;
+    int n = mixer->pushSamples(voice, pendingSamples);
+    pendingSamples.erase(pendingSamples.begin(), pendingSamples.begin() + n);
+    return pendingSamples.size() == 0;
+}
+
+void VRSound::closeVoice() {
+    if (voice >= 0) mixer->remove(voice);
+    voice = -1;
+    pendingSamples.clear();
+    mixedBuffers.clear();
+    mixedSamples = 0;
+    resamplePos = 0;
+    lastSample = 0;
+    queuedBuffers = 0;
+}
+
 uint VRSound::getFreeBufferID() {
     recycleBuffer();
 
@@ -377,7 +470,7 @@ uint VRSound::getFreeBufferID() {
 
 // carrier amplitude, carrier frequency, carrier phase, modulation amplitude, modulation frequency, modulation phase, packet duration
 void VRSound::synthesize(float Ac, float wc, float pc, float Am, float wm, float pm, float duration) {
-    if (!initiated) initiate();
+    if (!mixed && !initiated) initiate(); // mixed sounds need no OpenAL source
 
     int sample_rate = 22050;
     size_t buf_size = duration * sample_rate;
@@ -393,7 +486,7 @@ void VRSound::synthesize(float Ac, float wc, float pc, float Am, float wm, float
 }
 
 vector<short> VRSound::synthSpectrum(vector<double> spectrum, uint sample_rate, float duration, float fade_factor, bool returnBuffer) {
-    if (!initiated) initiate();
+    if (!mixed && !initiated) initiate(); // mixed sounds need no OpenAL source
 
     /* --- fade in/out curve ---
     ::path c;
@@ -490,7 +583,7 @@ vector<short> VRSound::synthSpectrum(vector<double> spectrum, uint sample_rate,
 }
 
 vector<short> VRSound::synthBuffer(vector<Vec2d> freqs1, vector<Vec2d> freqs2, float duration) {
-    if (!initiated) initiate();
+    if (!mixed && !initiated) initiate(); // mixed sounds need no OpenAL source
     // play sound
     int sample_rate = 22050;
     size_t buf_size = duration * sample_rate;
@@ -518,6 +611,17 @@ vector<short> VRSound::synthBuffer(vector<Vec2d> freqs1, vector<Vec2d> freqs2, f
 int VRSound::getQueuedBuffer() { return queuedBuffers; }
 
 void VRSound::recycleBuffer() {
+    if (voice >= 0) { // buffers are played when the mixer has consumed their samples
+        flushMixer();
+        int Q = mixer->getQueuedSamples(voice) + pendingSamples.size();
+        while (mixedBuffers.size() && mixedSamples - mixedBuffers.front() >= Q) {
+            mixedSamples -= mixedBuffers.front();
+            mixedBuffers.pop_front();
+        }
+        queuedBuffers = mixedBuffers.size();
+        return;
+    }
+
     if (!initiated) return;
     ALint val = -1;
     ALuint bufid = 0; // TODO: not working properly!!
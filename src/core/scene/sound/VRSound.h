@@ -2,6 +2,7 @@
 #define VRSOUND_H_INCLUDED
 
 #include <list>
+#include <deque>
 #include <OpenSG/OSGVector.h>
 
 #include "VRSoundFwd.h"
@@ -32,7 +33,20 @@ class VRSound {
         float gain = 1;
         Vec3d pos, vel;
 
+        VRSoundMixerPtr mixer; // stream voice on the mixer thread of the sound manager
+        int voice = -1;
+        bool mixed = false;
+        vector<short> pendingSamples; // not yet accepted by the mixer stream
+        deque<int> mixedBuffers; // sizes of the buffers in the mixer stream
+        int mixedSamples = 0;
+        double resamplePos = 0;
+        float lastSample = 0;
+
         void playBuffer(vector<short>& buffer, int sample_rate);
+        bool useMixer();
+        void mixBuffer(const vector<float>& samples, int sample_rate);
+        bool flushMixer(); // false while the mixer stream is full
+        void closeVoice();
 
     public:
         VRSound();
@@ -43,7 +57,9 @@ class VRSound {
         void setLoop(bool loop);
         void setPitch(float pitch);
         void setGain(float gain);
-        void setUser(Vec3d p, Vec3d v);
+        void setUser(Vec3d p, Vec3d v); // positioned sounds play on their own OpenAL source, not through the mixer
+        void setMixed(bool b); // synthesized and decoded samples go through the mixer, mono at the mixer rate, off by default
+        bool isMixed();
 
         bool isRunning();
         int getState();
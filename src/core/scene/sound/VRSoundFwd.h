@@ -7,6 +7,7 @@ namespace OSG {
 
 ptrFwd(VRSoundManager);
 ptrFwd(VRSound);
+ptrFwd(VRSoundMixer);
 
 }
 
@@ -10,6 +10,7 @@ extern "C" {
 
 #include "VRSoundManager.h"
 #include "VRSound.h"
+#include "VRSoundMixer.h"
 #include "../VRSceneManager.h"
 #include "../VRScene.h"
 
@@ -127,6 +128,7 @@ VRSoundManager::VRSoundManager() {
 
 VRSoundManager::~VRSoundManager() {
     clearSoundMap();
+    mixer.reset();
     if (channel) delete channel;
 }
 
@@ -161,6 +163,17 @@ VRSoundPtr VRSoundManager::getSound(string path) {
     } return sounds[path];
 }
 
+VRSoundMixerPtr VRSoundManager::getMixer() {
+    if (!mixer) {
+        if (!channel) channel = new VRSoundChannel();
+        while (!channel->context) osgSleep(1); // the mixer output uses the OpenAL context of the channel
+        mixer = VRSoundMixer::create();
+        mixer->setOpenALOutput();
+        mixer->start();
+    }
+    return mixer;
+}
+
 void VRSoundManager::setVolume(float volume) {
     volume = max(volume, 0.f);
     volume = min(volume, 1.f);
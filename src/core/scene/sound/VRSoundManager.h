@@ -17,6 +17,7 @@ class VRSoundManager {
 public:
     map<string, VRSoundPtr> sounds;
     VRSoundChannel* channel = 0;
+    VRSoundMixerPtr mixer;
 
     VRSoundManager();
     VRSoundPtr getSound(string path);
@@ -32,6 +33,8 @@ public:
     void stopSound(string path);
     void stopAllSounds(void);
 
+    VRSoundMixerPtr getMixer(); // audio thread for synthesized and streamed voices, started on first use
+
     void setVolume(float volume);
     void updatePlayerPosition(Vec3d position, Vec3d forward);
 };
@@ -0,0 +1,412 @@
+#include "VRSoundMixer.h"
+#include "VRSoundUtils.h"
+
+#if _WIN32
+#include <al.h>
+#include <alc.h>
+#else
+#include <AL/al.h>
+#include <AL/alc.h>
+#endif
+
+#include <OpenSG/OSGBaseFunctions.h>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <iostream>
+#include <algorithm>
+#include <deque>
+#include <cmath>
+
+using namespace OSG;
+typedef chrono::steady_clock Clock;
+
+namespace {
+    const double twoPi = 6.283185307179586;
+
+    inline float fastSin(float x) { // odd polynomial on [-pi/2, pi/2] after range reduction, branch free for vectorization
+        float k = (x*0.15915494f + 12582912.f) - 12582912.f; // nearest period, rounded by the float addition
+        x -= 6.2831853f*k;
+        x = max(min(x, 3.1415927f - x), -3.1415927f - x); // reflect into [-pi/2, pi/2]
+        float x2 = x*x;
+        return x*(1.f + x2*(-1.6666667e-1f + x2*(8.3333333e-3f + x2*(-1.9841270e-4f + x2*(2.7557319e-6f - x2*2.5052108e-8f)))));
+    }
+
+    size_t nextPow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+}
+
+VRSoundMixer::Output::~Output() {}
+
+void VRSoundMixer::NullOutput::write(const vector<short>& samples, int rate) {
+    if (written == 0) begin = Clock::now();
+    written += samples.size();
+}
+
+int VRSoundMixer::NullOutput::getQueued(int rate) {
+    if (written == 0) return 0;
+    long long played = chrono::duration_cast<chrono::microseconds>(Clock::now() - begin).count()*rate/1000000;
+    if (played > written) written = played; // ran dry, silence was played
+    return written - played;
+}
+
+struct VRSoundMixer::ALOutput : Output {
+    ALCdevice* device = 0;
+    ALCcontext* context = 0;
+    ALuint source = 0;
+    vector<ALuint> free_buffers;
+    deque<pair<ALuint, int>> queued; // buffers on the source and their samples
+    int queuedSamples = 0;
+
+    ALOutput() {
+        if (!alcGetCurrentContext()) { // the sound manager may already have a context
+            device = alcOpenDevice(NULL);
+            if (!device) { cout << "VRSoundMixer::ALOutput, alcOpenDevice failed!\n"; return; }
+            context = alcCreateContext(device, NULL);
+            alcMakeContextCurrent(context);
+        }
+        ALCHECK( alGenSources(1u, &source) );
+    }
+
+    ~ALOutput() {
+        ALCHECK( alSourceStop(source) );
+        recycle();
+        ALCHECK( alDeleteSources(1u, &source) );
+        for (auto b : free_buffers) ALCHECK( alDeleteBuffers(1u, &b) );
+        if (context) {
+            alcMakeContextCurrent(NULL);
+            alcDestroyContext(context);
+            alcCloseDevice(device);
+        }
+    }
+
+    void recycle() {
+        ALint N = 0;
+        ALCHECK( alGetSourcei(source, AL_BUFFERS_PROCESSED, &N) );
+        for (; N > 0 && queued.size(); N--) {
+            ALuint buf = queued.front().first;
+            ALCHECK( alSourceUnqueueBuffers(source, 1, &buf) );
+            queuedSamples -= queued.front().second;
+            queued.pop_front();
+            free_buffers.push_back(buf);
+        }
+    }
+
+    void write(const vector<short>& samples, int rate) {
+        ALuint buf = 0;
+        if (free_buffers.size()) { buf = free_buffers.back(); free_buffers.pop_back(); }
+        else ALCHECK( alGenBuffers(1u, &buf) );
+        ALCHECK( alBufferData(buf, AL_FORMAT_MONO16, &samples[0], samples.size()*sizeof(short), rate) );
+        ALCHECK( alSourceQueueBuffers(source, 1, &buf) );
+        queued.push_back( make_pair(buf, int(samples.size())) );
+        queuedSamples += samples.size();
+
+        ALint state = 0;
+        ALCHECK( alGetSourcei(source, AL_SOURCE_STATE, &state) );
+        if (state != AL_PLAYING) ALCHECK( alSourcePlay(source) ); // also restarts after running dry
+    }
+
+    int getQueued(int rate) {
+        recycle();
+        ALint offset = 0;
+        ALCHECK( alGetSourcei(source, AL_SAMPLE_OFFSET, &offset) );
+        return max(0, queuedSamples - offset);
+    }
+};
+
+VRSoundMixer::Stream::Stream(size_t capacity) : ring(nextPow2(capacity)), head(0), tail(0), closed(false) {}
+
+VRSoundMixer::VRSoundMixer(int rate, int blockSize, int commandCapacity) : enqueuePos(0), rate(rate), blockSize(blockSize), nextID(0),
+    running(false), voiceCount(0), blocks(0), underruns(0), renderTime(0), commandDelay(0), appliedCommands(0), queueLatency(0) {
+    commands = vector<Slot>(nextPow2(commandCapacity));
+    mask = commands.size()-1;
+    for (size_t i=0; i<commands.size(); i++) commands[i].seq.store(i);
+    mixBuffer.resize(blockSize);
+    voiceBuffer.resize(blockSize);
+    outBuffer.resize(blockSize);
+}
+
+VRSoundMixer::~VRSoundMixer() { stop(); }
+
+VRSoundMixerPtr VRSoundMixer::create(int rate, int blockSize) { return VRSoundMixerPtr( new VRSoundMixer(rate, blockSize) ); }
+
+void VRSoundMixer::setOutput(shared_ptr<Output> o) {
+    if (running) { cout << "VRSoundMixer::setOutput, stop the mixer first" << endl; return; }
+    output = o;
+}
+
+void VRSoundMixer::setNullOutput() { setOutput( shared_ptr<Output>( new NullOutput() ) ); }
+void VRSoundMixer::setOpenALOutput() { setOutput( shared_ptr<Output>( new ALOutput() ) ); }
+void VRSoundMixer::setLatency(int samples) { latency = max(samples, blockSize); }
+
+void VRSoundMixer::start() {
+    if (running) return;
+    if (!output) setOpenALOutput();
+    running = true;
+    thread = new boost::thread(boost::bind(&VRSoundMixer::loop, this));
+}
+
+void VRSoundMixer::stop() {
+    if (!thread) return;
+    running = false;
+    thread->join();
+    delete thread;
+    thread = 0;
+}
+
+bool VRSoundMixer::isRunning() { return running; }
+
+bool VRSoundMixer::push(Command& c) {
+    c.sent = Clock::now();
+    size_t pos = enqueuePos.load(memory_order_relaxed);
+    Slot* s = 0;
+    while (true) {
+        s = &commands[pos & mask];
+        size_t seq = s->seq.load(memory_order_acquire);
+        long long diff = (long long)seq - (long long)pos;
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos+1, memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            cout << "VRSoundMixer, command queue full, command dropped" << endl;
+            return false;
+        } else pos = enqueuePos.load(memory_order_relaxed);
+    }
+    s->cmd = c;
+    s->seq.store(pos+1, memory_order_release);
+    return true;
+}
+
+bool VRSoundMixer::pop(Command& c) { // only the audio thread pops
+    Slot& s = commands[dequeuePos & mask];
+    if (s.seq.load(memory_order_acquire) != dequeuePos+1) return false;
+    c = s.cmd;
+    s.cmd.stream.reset();
+    s.seq.store(dequeuePos+mask+1, memory_order_release);
+    dequeuePos++;
+    return true;
+}
+
+void VRSoundMixer::apply(Command& c) {
+    commandDelay += chrono::duration_cast<chrono::microseconds>(Clock::now() - c.sent).count();
+    appliedCommands++;
+
+    auto voice = find_if(voices.begin(), voices.end(), [&](const Voice& v) { return v.ID == c.voice; });
+
+    if (c.type == ADD_TONE || c.type == ADD_STREAM) {
+        Voice v;
+        v.ID = c.voice;
+        v.Ac = c.p[0];
+        v.wc = twoPi*c.p[1]/rate;
+        v.pc = c.p[2];
+        v.Am = c.p[3];
+        v.wm = twoPi*c.p[4]/rate;
+        v.pm = c.p[5];
+        v.gain = v.targetGain = c.p[6];
+        v.stream = c.stream;
+        voices.push_back(v);
+    }
+
+    if (c.type == REMOVE && voice != voices.end()) { *voice = voices.back(); voices.pop_back(); }
+    if (c.type == SET_GAIN && voice != voices.end()) voice->targetGain = c.p[0];
+    if (c.type == SET_TONE && voice != voices.end()) {
+        voice->Ac = c.p[0];
+        voice->wc = twoPi*c.p[1]/rate;
+        voice->Am = c.p[2];
+        voice->wm = twoPi*c.p[3]/rate;
+    }
+    if (c.type == CLEAR) voices.clear();
+    voiceCount = voices.size();
+}
+
+void VRSoundMixer::renderVoice(Voice& v, float* out, int N) {
+    if (v.stream) { // copy what the producer has written, silence if it is late
+        auto& s = *v.stream;
+        size_t tail = s.tail.load(memory_order_relaxed);
+        size_t head = s.head.load(memory_order_acquire);
+        size_t M = s.ring.size()-1;
+        int n = min(size_t(N), head-tail);
+        for (int i=0; i<n; i++) out[i] = s.ring[(tail+i) & M];
+        for (int i=n; i<N; i++) out[i] = 0;
+        s.tail.store(tail+n, memory_order_release);
+        return;
+    }
+
+    const float Ac = v.Ac, wc = v.wc, Am = v.Am, wm = v.wm;
+    const float pc = v.pc, pm = v.pm;
+    #pragma omp simd
+    for (int i=0; i<N; i++) out[i] = Ac*fastSin(pc + wc*i + Am*fastSin(pm + wm*i));
+    v.pc = fmod(v.pc + double(wc)*N, twoPi);
+    v.pm = fmod(v.pm + double(wm)*N, twoPi);
+}
+
+void VRSoundMixer::mixBlock() {
+    auto t0 = Clock::now();
+    int N = blockSize;
+    float* mix = &mixBuffer[0];
+    float* buf = &voiceBuffer[0];
+    for (int i=0; i<N; i++) mix[i] = 0;
+
+    for (unsigned int k=0; k<voices.size(); k++) {
+        auto& v = voices[k];
+        renderVoice(v, buf, N);
+        float g = v.gain;
+        float dg = (v.targetGain - v.gain)/N; // ramp to avoid clicks
+        #pragma omp simd
+        for (int i=0; i<N; i++) mix[i] += (g + dg*i)*buf[i];
+        v.gain = v.targetGain;
+    }
+
+    for (int i=0; i<N; i++) {
+        float m = max(-32768.f, min(32767.f, mix[i]));
+        outBuffer[i] = short((m + 12582912.f) - 12582912.f);
+    }
+
+    // streams closed by the producer are removed once played
+    for (unsigned int k=0; k<voices.size();) {
+        auto& s = voices[k].stream;
+        if (s && s->closed && s->tail.load() == s->head.load()) { voices[k] = voices.back(); voices.pop_back(); }
+        else k++;
+    }
+    voiceCount = voices.size();
+
+    blocks++;
+    renderTime += chrono::duration_cast<chrono::microseconds>(Clock::now() - t0).count();
+}
+
+void VRSoundMixer::loop() {
+    Command c;
+    while (running) {
+        int q = output->getQueued(rate);
+        if (q == 0 && blocks > 0) underruns++;
+        while (q < latency) {
+            while (pop(c)) apply(c); // commands take effect at block boundaries
+            mixBlock();
+            output->write(outBuffer, rate);
+            q += blockSize;
+        }
+        queueLatency = q;
+        osgSleep(1);
+    }
+}
+
+void VRSoundMixer::mix(int frames, vector<short>& out) {
+    if (running) { cout << "VRSoundMixer::mix, mixer thread is running" << endl; return; }
+    Command c;
+    for (int n=0; n<frames; n+=blockSize) {
+        while (pop(c)) apply(c);
+        mixBlock();
+        out.insert(out.end(), outBuffer.begin(), outBuffer.begin() + min(blockSize, frames-n));
+    }
+}
+
+int VRSoundMixer::addTone(float Ac, float wc, float pc, float Am, float wm, float pm, float gain) {
+    Command c;
+    c.type = ADD_TONE;
+    c.voice = nextID++;
+    float p[7] = { Ac, wc, pc, Am, wm, pm, gain };
+    copy(p, p+7, c.p);
+    if (!push(c)) return -1;
+    return c.voice;
+}
+
+void VRSoundMixer::setTone(int voice, float Ac, float wc, float Am, float wm) {
+    Command c;
+    c.type = SET_TONE;
+    c.voice = voice;
+    c.p[0] = Ac; c.p[1] = wc; c.p[2] = Am; c.p[3] = wm;
+    push(c);
+}
+
+int VRSoundMixer::addStream(int capacity) {
+    Command c;
+    c.type = ADD_STREAM;
+    c.voice = nextID++;
+    c.p[6] = 1; // gain
+    c.stream = make_shared<Stream>(capacity);
+    {
+        boost::mutex::scoped_lock lock(streamMutex);
+        streams[c.voice] = c.stream;
+    }
+    if (!push(c)) return -1;
+    return c.voice;
+}
+
+int VRSoundMixer::pushSamples(int voice, const vector<short>& samples) {
+    shared_ptr<Stream> s;
+    {
+        boost::mutex::scoped_lock lock(streamMutex);
+        auto i = streams.find(voice);
+        if (i == streams.end()) { cout << "VRSoundMixer::pushSamples, voice " << voice << " is no open stream" << endl; return 0; }
+        s = i->second;
+    }
+
+    size_t head = s->head.load(memory_order_relaxed);
+    size_t tail = s->tail.load(memory_order_acquire);
+    size_t M = s->ring.size()-1;
+    int n = min(samples.size(), s->ring.size() - (head-tail));
+    for (int i=0; i<n; i++) s->ring[(head+i) & M] = samples[i];
+    s->head.store(head+n, memory_order_release);
+    return n;
+}
+
+int VRSoundMixer::getQueuedSamples(int voice) {
+    boost::mutex::scoped_lock lock(streamMutex);
+    auto i = streams.find(voice);
+    if (i == streams.end()) return 0;
+    return i->second->head.load() - i->second->tail.load();
+}
+
+void VRSoundMixer::closeStream(int voice) {
+    boost::mutex::scoped_lock lock(streamMutex);
+    auto i = streams.find(voice);
+    if (i == streams.end()) return;
+    i->second->closed = true;
+    streams.erase(i);
+}
+
+void VRSoundMixer::setGain(int voice, float gain) {
+    Command c;
+    c.type = SET_GAIN;
+    c.voice = voice;
+    c.p[0] = gain;
+    push(c);
+}
+
+void VRSoundMixer::remove(int voice) {
+    {
+        boost::mutex::scoped_lock lock(streamMutex);
+        streams.erase(voice);
+    }
+    Command c;
+    c.type = REMOVE;
+    c.voice = voice;
+    push(c);
+}
+
+void VRSoundMixer::clear() {
+    {
+        boost::mutex::scoped_lock lock(streamMutex);
+        streams.clear();
+    }
+    Command c;
+    c.type = CLEAR;
+    push(c);
+}
+
+int VRSoundMixer::getRate() { return rate; }
+int VRSoundMixer::getBlockSize() { return blockSize; }
+int VRSoundMixer::getVoiceCount() { return voiceCount; }
+long long VRSoundMixer::getBlockCount() { return blocks; }
+long long VRSoundMixer::getUnderruns() { return underruns; }
+
+double VRSoundMixer::getRenderLoad() {
+    double played = double(blocks)*blockSize/rate;
+    return played > 0 ? renderTime*1e-6/played : 0;
+}
+
+double VRSoundMixer::getCommandLatency() {
+    double delay = appliedCommands > 0 ? commandDelay*1e-3/appliedCommands : 0;
+    return delay + queueLatency*1000.0/rate;
+}
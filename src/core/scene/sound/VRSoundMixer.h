@@ -0,0 +1,161 @@
+#ifndef VRSOUNDMIXER_H_INCLUDED
+#define VRSOUNDMIXER_H_INCLUDED
+
+#include <OpenSG/OSGConfig.h>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <map>
+#include <boost/thread/mutex.hpp>
+
+#include "VRSoundFwd.h"
+
+namespace boost { class thread; }
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Audio engine thread mixing many voices into one mono stream.
+    Other threads only push commands into a lock free queue, the audio thread applies them
+    between blocks and renders blocks until the output holds the target latency.
+    Voices are FM tones, like VRSound::synthesize, or streams fed with chunks of decoded samples.
+    The block loops are written to be vectorized by the compiler.
+    The OpenAL output queues the blocks on a source, the null output consumes them in real time without a device.
+*/
+
+class VRSoundMixer {
+    public:
+        struct Output {
+            virtual ~Output();
+            virtual void write(const vector<short>& samples, int rate) = 0;
+            virtual int getQueued(int rate) = 0; // samples written but not played yet
+        };
+
+        struct NullOutput : Output {
+            long long written = 0;
+            chrono::steady_clock::time_point begin;
+            void write(const vector<short>& samples, int rate);
+            int getQueued(int rate);
+        };
+
+        struct ALOutput;
+
+    private:
+        enum COMMAND {
+            ADD_TONE,
+            ADD_STREAM,
+            REMOVE,
+            SET_GAIN,
+            SET_TONE,
+            CLEAR
+        };
+
+        struct Stream { // single producer single consumer ring of samples
+            vector<float> ring;
+            atomic<size_t> head; // written by the producer
+            atomic<size_t> tail; // written by the audio thread
+            atomic<bool> closed;
+            Stream(size_t capacity);
+        };
+
+        struct Command {
+            COMMAND type = CLEAR;
+            int voice = 0;
+            float p[7] = {0,0,0,0,0,0,0};
+            shared_ptr<Stream> stream;
+            chrono::steady_clock::time_point sent;
+        };
+
+        struct Slot {
+            atomic<size_t> seq;
+            Command cmd;
+        };
+
+        struct Voice {
+            int ID = 0;
+            float gain = 1;
+            float targetGain = 1;
+            float Ac = 0, wc = 0, Am = 0, wm = 0; // amplitude and angular frequency per sample of carrier and modulation
+            double pc = 0, pm = 0; // phases
+            shared_ptr<Stream> stream;
+        };
+
+        vector<Slot> commands; // bounded multi producer queue, each slot has a sequence number
+        size_t mask = 0;
+        atomic<size_t> enqueuePos;
+        size_t dequeuePos = 0;
+
+        map<int, shared_ptr<Stream>> streams; // producer side, the audio thread only sees its own voices
+        boost::mutex streamMutex;
+
+        vector<Voice> voices;
+        vector<float> mixBuffer;
+        vector<float> voiceBuffer;
+        vector<short> outBuffer;
+
+        int rate = 22050;
+        int blockSize = 256;
+        int latency = 1024; // samples
+        atomic<int> nextID;
+
+        shared_ptr<Output> output;
+        boost::thread* thread = 0;
+        atomic<bool> running;
+
+        atomic<int> voiceCount;
+        atomic<long long> blocks;
+        atomic<long long> underruns;
+        atomic<long long> renderTime; // microseconds
+        atomic<long long> commandDelay; // microseconds from sending to applying, summed
+        atomic<long long> appliedCommands;
+        atomic<int> queueLatency; // samples ahead in the output when the last block was written
+
+        bool push(Command& c);
+        bool pop(Command& c);
+        void apply(Command& c);
+        void renderVoice(Voice& v, float* out, int N);
+        void mixBlock();
+        void loop();
+
+    public:
+        VRSoundMixer(int rate = 22050, int blockSize = 256, int commandCapacity = 4096);
+        ~VRSoundMixer();
+
+        static VRSoundMixerPtr create(int rate = 22050, int blockSize = 256);
+
+        void setOutput(shared_ptr<Output> o);
+        void setNullOutput();
+        void setOpenALOutput();
+        void setLatency(int samples);
+
+        void start();
+        void stop();
+        bool isRunning();
+
+        // carrier amplitude, carrier frequency, carrier phase, modulation amplitude, modulation frequency, modulation phase, like VRSound::synthesize
+        int addTone(float Ac = 32760, float wc = 440, float pc = 0, float Am = 0, float wm = 0, float pm = 0, float gain = 1);
+        void setTone(int voice, float Ac, float wc, float Am = 0, float wm = 0);
+        int addStream(int capacity = 1<<16);
+        int pushSamples(int voice, const vector<short>& samples); // returns the samples accepted, call from one thread per stream
+        int getQueuedSamples(int voice); // samples of a stream not yet mixed
+        void closeStream(int voice); // voice is removed when the stream is played
+        void setGain(int voice, float gain);
+        void remove(int voice);
+        void clear();
+
+        void mix(int frames, vector<short>& out); // render without thread and output, applies pending commands
+
+        int getRate();
+        int getBlockSize();
+        int getVoiceCount();
+        long long getBlockCount();
+        long long getUnderruns();
+        double getRenderLoad(); // render time over played time
+        double getCommandLatency(); // ms until a command is audible, delay in the queue and samples ahead in the output
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRSOUNDMIXER_H_INCLUDED
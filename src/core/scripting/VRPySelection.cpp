@@ -56,6 +56,8 @@ PyMethodDef VRPySelection::methods[] = {
     {"getSubselection", (PyCFunction)VRPySelection::getSubselection, METH_VARARGS, "Return the objects selected vertices - [int] getSubselection(object)" },
     {"computePCA", (PyCFunction)VRPySelection::computePCA, METH_NOARGS, "Return the selection PCA - pose computePCA()" },
     {"selectPlane", (PyCFunction)VRPySelection::selectPlane, METH_VARARGS, "Select a plane - pose selectPlane( pose, threshold )" },
+    {"updateSubselection", (PyCFunction)VRPySelection::updateSubselection, METH_VARARGS, "Update the selected vertices, only the unselected vertices are tested again while the volume is unchanged - updateSubselection( | object )" },
+    {"setParallel", (PyCFunction)VRPySelection::setParallel, METH_VARARGS, "Test the vertices in parallel - setParallel( bool )" },
     {NULL}  /* Sentinel */
 };
 
@@ -72,6 +74,23 @@ PyObject* VRPySelection::selectPlane(VRPySelection* self, PyObject* args) {
     Py_RETURN_TRUE;
 }
 
+PyObject* VRPySelection::updateSubselection(VRPySelection* self, PyObject* args) {
+    if (!self->valid()) return NULL;
+    VRPyGeometry* geo = 0;
+    if (!PyArg_ParseTuple(args, "|O:updateSubselection", &geo)) return NULL;
+    if (geo) self->objPtr->updateSubselection(geo->objPtr);
+    else self->objPtr->updateSubselection();
+    Py_RETURN_TRUE;
+}
+
+PyObject* VRPySelection::setParallel(VRPySelection* self, PyObject* args) {
+    if (!self->valid()) return NULL;
+    int b = 1;
+    if (!PyArg_ParseTuple(args, "|i:setParallel", &b)) return NULL;
+    self->objPtr->setParallel(b);
+    Py_RETURN_TRUE;
+}
+
 PyObject* VRPySelection::add(VRPySelection* self, PyObject* args, PyObject* kwargs) {
     if (!self->valid()) return NULL;
     VRPyGeometry* geo = 0;
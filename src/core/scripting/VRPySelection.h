@@ -18,6 +18,8 @@ struct VRPySelection : VRPyBaseT<OSG::VRSelection> {
 
     static PyObject* computePCA(VRPySelection* self);
     static PyObject* selectPlane(VRPySelection* self, PyObject* args);
+    static PyObject* updateSubselection(VRPySelection* self, PyObject* args);
+    static PyObject* setParallel(VRPySelection* self, PyObject* args);
 };
 
 #endif // VRPYSELECTION_H_INCLUDED
@@ -2,6 +2,7 @@
 #include "VRPyBaseT.h"
 
 #include "core/setup/windows/VRView.h"
+#include "core/setup/windows/VRMultiWindow.h"
 #include "core/scripting/VRPyPose.h"
 #include "core/scripting/VRPyImage.h"
 #include "core/scripting/VRPyCamera.h"
@@ -96,6 +97,8 @@ PyObject* VRPyView::setCamera(VRPyView* self, PyObject* args) {
 
 PyMethodDef VRPyWindow::methods[] = {
     {"getSize", (PyCFunction)VRPyWindow::getSize, METH_NOARGS, "Get the size in pixel - [W,H] getSize()" },
+    {"getSyncBytes", (PyCFunction)VRPyWindow::getSyncBytes, METH_NOARGS, "Get the bytes sent to the cluster servers in the last frame, 0 if not a multi window - int getSyncBytes()" },
+    {"getSyncRawBytes", (PyCFunction)VRPyWindow::getSyncRawBytes, METH_NOARGS, "Get the bytes of the last frame before compression, only with the CompressedStreamSock connection - int getSyncRawBytes()" },
     {NULL}  /* Sentinel */
 };
 
@@ -104,4 +107,14 @@ PyObject* VRPyWindow::getSize(VRPyWindow* self) {
     return toPyTuple( self->objPtr->getSize() );
 }
 
+PyObject* VRPyWindow::getSyncBytes(VRPyWindow* self) {
+    if (!self->valid()) return NULL;
+    auto w = dynamic_pointer_cast<VRMultiWindow>(self->objPtr);
+    return PyInt_FromLong( w ? w->getSyncBytes() : 0 );
+}
 
+PyObject* VRPyWindow::getSyncRawBytes(VRPyWindow* self) {
+    if (!self->valid()) return NULL;
+    auto w = dynamic_pointer_cast<VRMultiWindow>(self->objPtr);
+    return PyInt_FromLong( w ? w->getSyncRawBytes() : 0 );
+}
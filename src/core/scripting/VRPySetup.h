@@ -26,6 +26,8 @@ struct VRPyView : VRPyBaseT<OSG::VRView> {
 
 struct VRPyWindow : VRPyBaseT<OSG::VRWindow> {
     static PyObject* getSize(VRPyWindow* self);
+    static PyObject* getSyncBytes(VRPyWindow* self);
+    static PyObject* getSyncRawBytes(VRPyWindow* self);
     static PyMethodDef methods[];
 };
 
@@ -7,9 +7,11 @@ using namespace OSG;
 
 template<> PyObject* VRPyTypeCaster::cast(const VRSoundPtr& e) { return VRPySound::fromSharedPtr(e); }
 template<> PyObject* VRPyTypeCaster::cast(const VRSoundManagerPtr& e) { return VRPySoundManager::fromSharedPtr(e); }
+template<> PyObject* VRPyTypeCaster::cast(const VRSoundMixerPtr& e) { return VRPySoundMixer::fromSharedPtr(e); }
 
 simpleVRPyType( SoundManager, 0 );
 simpleVRPyType( Sound, New_ptr );
+simpleVRPyType( SoundMixer, 0 );
 
 PyMethodDef VRPySound::methods[] = {
     {"play", PyWrap(Sound, play, "Play sound", void) },
@@ -20,6 +22,8 @@ PyMethodDef VRPySound::methods[] = {
     {"synthSpectrum", PyWrap(Sound, synthSpectrum, "synthSpectrum( [A], int S, float T, float F, bool retBuffer )\t\n A amplitude, S sample rate, T packet duration in seconds, F fade in/out duration in s , specify if you want to return the generated buffer", vector<short>, vector<double>, uint, float, float, bool) },
     {"getQueuedBuffer", PyWrap(Sound, getQueuedBuffer, "Get the buffer currently queued", int) },
     {"recycleBuffer", PyWrap(Sound, recycleBuffer, "Recycle unused buffers", void) },
+    {"setMixed", PyWrap(Sound, setMixed, "Play the synthesized and decoded samples through the sound mixer, downmixed to mono, default is False", void, bool) },
+    {"isMixed", PyWrap(Sound, isMixed, "Check if the sound plays through the sound mixer", bool) },
     {NULL}  /* Sentinel */
 };
 
@@ -27,6 +31,26 @@ PyMethodDef VRPySoundManager::methods[] = {
     {"setupSound", PyWrapOpt(SoundManager, setupSound, "Play sound, lopping and playing are optional", "0|0", VRSoundPtr, string, bool, bool) },
     {"stopAllSounds", PyWrap(SoundManager, stopAllSounds, "Stops all currently playing sounds.", void) },
     {"setVolume", PyWrap(SoundManager, setVolume, "Set sound volume from 0 to 1", void, float) },
+    {"getMixer", PyWrap(SoundManager, getMixer, "Get the sound mixer, started on first use", VRSoundMixerPtr) },
+    {NULL}  /* Sentinel */
+};
+
+PyMethodDef VRPySoundMixer::methods[] = {
+    {"addTone", PyWrapOpt(SoundMixer, addTone, "Add an FM tone voice, returns its ID - addTone( Ac, wc, pc, Am, wm, pm, gain )\t\n like Sound.synthesize", "32760|440|0|0|0|0|1", int, float, float, float, float, float, float, float) },
+    {"setTone", PyWrapOpt(SoundMixer, setTone, "Change a tone voice - setTone( voice, Ac, wc, Am, wm )", "0|0", void, int, float, float, float, float) },
+    {"addStream", PyWrapOpt(SoundMixer, addStream, "Add a stream voice fed with pushSamples, returns its ID - addStream( capacity )", "65536", int, int) },
+    {"pushSamples", PyWrap(SoundMixer, pushSamples, "Push samples to a stream voice, returns the number of accepted samples - pushSamples( voice, [samples] )", int, int, vector<short>) },
+    {"getQueuedSamples", PyWrap(SoundMixer, getQueuedSamples, "Get the number of samples of a stream voice not yet mixed", int, int) },
+    {"closeStream", PyWrap(SoundMixer, closeStream, "Close a stream voice, it is removed when its samples are played", void, int) },
+    {"setGain", PyWrap(SoundMixer, setGain, "Set the gain of a voice - setGain( voice, gain )", void, int, float) },
+    {"remove", PyWrap(SoundMixer, remove, "Remove a voice", void, int) },
+    {"clear", PyWrap(SoundMixer, clear, "Remove all voices", void) },
+    {"setLatency", PyWrap(SoundMixer, setLatency, "Set the target latency of the output in samples", void, int) },
+    {"getRate", PyWrap(SoundMixer, getRate, "Get the sample rate", int) },
+    {"getVoiceCount", PyWrap(SoundMixer, getVoiceCount, "Get the number of voices", int) },
+    {"getUnderruns", PyWrap(SoundMixer, getUnderruns, "Get the number of times the output ran dry", long long) },
+    {"getRenderLoad", PyWrap(SoundMixer, getRenderLoad, "Get the render time over the played time", double) },
+    {"getCommandLatency", PyWrap(SoundMixer, getCommandLatency, "Get the time in ms until a command is audible", double) },
     {NULL}  /* Sentinel */
 };
 
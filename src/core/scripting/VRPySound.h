@@ -4,6 +4,7 @@
 #include "VRPyObject.h"
 #include "core/scene/sound/VRSoundManager.h"
 #include "core/scene/sound/VRSound.h"
+#include "core/scene/sound/VRSoundMixer.h"
 
 struct VRPySoundManager : VRPyBaseT<OSG::VRSoundManager> {
     static PyMethodDef methods[];
@@ -13,4 +14,8 @@ struct VRPySound : VRPyBaseT<OSG::VRSound> {
     static PyMethodDef methods[];
 };
 
+struct VRPySoundMixer : VRPyBaseT<OSG::VRSoundMixer> {
+    static PyMethodDef methods[];
+};
+
 #endif // VRPYSOCKET_H_INCLUDED
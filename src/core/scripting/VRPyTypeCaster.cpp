@@ -81,6 +81,8 @@ template<> PyObject* VRPyTypeCaster::cast(const VREntityPtr& e) { return VRPyEnt
 template<> PyObject* VRPyTypeCaster::cast(const int& i) { return PyInt_FromLong(i); }
 template<> PyObject* VRPyTypeCaster::cast(const short& s) { return PyInt_FromLong(s); }
 template<> PyObject* VRPyTypeCaster::cast(const float& f) { return PyFloat_FromDouble(f); }
+template<> PyObject* VRPyTypeCaster::cast(const double& f) { return PyFloat_FromDouble(f); }
+template<> PyObject* VRPyTypeCaster::cast(const long long& i) { return PyLong_FromLongLong(i); }
 template<> PyObject* VRPyTypeCaster::cast(const string& s) { return PyString_FromString(s.c_str()); }
 template<> PyObject* VRPyTypeCaster::cast(const bool& b) { if (b) Py_RETURN_TRUE; else Py_RETURN_FALSE; }
 template<> PyObject* VRPyTypeCaster::cast(const Vec2d& b) { return toPyObject(b); }
@@ -111,6 +111,7 @@ void VRSceneModules::setup(VRScriptManager* sm, PyObject* pModVR) {
     sm->registerModule<VRPySprite>("Sprite", pModVR, VRPyGeometry::typeRef);
     sm->registerModule<VRPySound>("Sound", pModVR);
     sm->registerModule<VRPySoundManager>("SoundManager", pModVR);
+    sm->registerModule<VRPySoundMixer>("SoundMixer", pModVR);
     sm->registerModule<VRPySocket>("Socket", pModVR);
     sm->registerModule<VRPyStroke>("Stroke", pModVR, VRPyGeometry::typeRef);
     sm->registerModule<VRPyConstraint>("Constraint", pModVR);
@@ -191,6 +192,7 @@ void VRSceneModules::setup(VRScriptManager* sm, PyObject* pModVR) {
     sm->registerModule<VRPyConcept>("Concept", pModVR);
     sm->registerModule<VRPyEntity>("Entity", pModVR);
     sm->registerModule<VRPyReasoner>("Reasoner", pModVR);
+    sm->registerModule<VRPyRuleEngine>("RuleEngine", pModVR);
 
     sm->registerModule<VRPyHandGeo>("HandGeo", pModVR, VRPyGeometry::typeRef);
     sm->registerModule<VRPyLeap>("Leap", pModVR, VRPyDevice::typeRef);
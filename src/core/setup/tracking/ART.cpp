@@ -7,6 +7,8 @@
 #include "core/utils/toString.h"
 #include <libxml++/nodes/element.h>
 #include "DTrack.h"
+#include "ARTReplay.h"
+#include "VRPosePredictor.h"
 #include "core/setup/devices/VRFlystick.h"
 #include "core/utils/VRFunction.h"
 #include "core/objects/VRTransform.h"
@@ -56,7 +58,8 @@ void ART_device::init() {
 
 void ART_device::update() {
     if (ent) {
-        ent->setMatrix(m);
+        if (predictor && predictor->hasSamples()) ent->setMatrix( predictor->getPose() );
+        else ent->setMatrix(m);
         if (fingers.size() == 5 && fingerEnts.size() == 5)
             for (int i=0;i<5;i++) fingerEnts[i]->setMatrix( fingers[i] );
     }
@@ -80,10 +83,13 @@ ART::ART() {
     store("port", &port);
     store("offset", &offset);
     store("up", &up);
+    store("filter", &filter);
+    store("prediction", &prediction);
 }
 
 ART::~ART() {
     //VRSceneManager::get()->stopThread(fetchThread);
+    stopReplay();
 }
 
 template<typename dev>
@@ -105,6 +111,7 @@ void ART::getMatrix(dev t, ART_devicePtr d) {
     if (t.quality <= 0) return;
     getMatrix(t, d->m);
     d->m[3] += Vec4d(d->offset);
+    if (d->predictor) d->predictor->addSample(VRPosePredictor::now(), d->m);
 }
 
 void ART::scan(int type, int N) {
@@ -156,8 +163,13 @@ void ART::updateT( weak_ptr<VRThread>  t) {
     setARTPort(port);
     if (!active || dtrack == 0) return;
 
-    if (dtrack->receive()) scan();
-    else {
+    if (dtrack->receive()) {
+        {
+            boost::mutex::scoped_lock lock(mutex);
+            if (recording) recording->add(dtrack->get_datagram(), dtrack->get_datagram_length());
+        }
+        scan();
+    } else {
         if(dtrack->timeout())       cout << "--- ART: timeout while waiting for udp data" << endl;
         if(dtrack->udperror())      cout << "--- ART: error while receiving udp data" << endl;
         if(dtrack->parseerror())    cout << "--- ART: error while parsing udp data" << endl;
@@ -193,6 +205,7 @@ void ART::checkNewDevices(int type, int N) {
         if (devices.count(k) == 0) {
             cout << "ART - New device " << type << " " << k << endl;
             devices[k] = ART_device::create(i,type);
+            setupPredictor(devices[k]);
             on_new_device->triggerPtr<VRDevice>();
             update_setup();
         }
@@ -237,8 +250,54 @@ void ART::setARTPort(int port) {
 void ART::setARTOffset(Vec3d o) { offset = o; }
 Vec3d ART::getARTOffset() { return offset; }
 
+void ART::setupPredictor(ART_devicePtr d) {
+    if (!filter) { d->predictor = 0; return; }
+    if (!d->predictor) d->predictor = VRPosePredictor::create();
+    d->predictor->setHorizon(prediction);
+}
+
+void ART::setARTFilter(bool b) {
+    boost::mutex::scoped_lock lock(mutex);
+    filter = b;
+    for (auto d : devices) setupPredictor(d.second);
+}
+
+bool ART::getARTFilter() { return filter; }
+
+void ART::setARTPrediction(double t) {
+    boost::mutex::scoped_lock lock(mutex);
+    prediction = t;
+    for (auto d : devices) setupPredictor(d.second);
+}
+
+double ART::getARTPrediction() { return prediction; }
+
 void ART::startTestStream() {
-    // TODO: create test data
+    setARTActive(true);
+    startReplay( ARTRecording::createTestStream(600, 60, 2, 1, 1), 1, true );
+}
+
+void ART::startReplay(ARTRecordingPtr r, float speed, bool loop) {
+    stopReplay();
+    replay = ARTReplay::create(r, port, speed, loop);
+    replay->start();
+}
+
+void ART::stopReplay() {
+    if (replay) replay->stop();
+    replay = 0;
+}
+
+void ART::startRecording() {
+    boost::mutex::scoped_lock lock(mutex);
+    recording = ARTRecording::create();
+}
+
+ARTRecordingPtr ART::stopRecording() {
+    boost::mutex::scoped_lock lock(mutex);
+    auto r = recording;
+    recording = 0;
+    return r;
 }
 
 VRSignalPtr ART::getSignal_on_new_art_device() { return on_new_device; }
@@ -29,6 +29,7 @@ struct ART_device : public VRName {
     VRTransformPtr ent = 0;
     vector<VRTransformPtr> fingerEnts;
     VRFlystickPtr dev = 0;
+    VRPosePredictorPtr predictor; // optional, filters m and predicts the pose of ent
     Vec3d offset;
     float scale = 1;
     int ID = 0;
@@ -53,9 +54,13 @@ class ART : public VRStorage {
         int current_port = -1;
         Vec3d offset;
         string up;
+        bool filter = false;
+        double prediction = 0;
 
         DTrack* dtrack = 0;
         map<int, ART_devicePtr> devices;
+        ARTRecordingPtr recording;
+        ARTReplayPtr replay;
 
         VRUpdateCbPtr updatePtr;
         shared_ptr< VRFunction< weak_ptr<VRThread> > > threadFkt;
@@ -68,6 +73,7 @@ class ART : public VRStorage {
         void scan(int type = -1, int N = 0);
 
         void update_setup();
+        void setupPredictor(ART_devicePtr d);
 
         void updateT( weak_ptr<VRThread>  t); //update thread
         void updateL(); //update
@@ -91,7 +97,17 @@ class ART : public VRStorage {
         void setARTOffset(Vec3d o);
         Vec3d getARTOffset();
 
-        void startTestStream();
+        void setARTFilter(bool b); // smooth the tracked poses, see VRPosePredictor
+        bool getARTFilter();
+        void setARTPrediction(double t); // seconds to predict the tracked poses ahead, needs the filter
+        double getARTPrediction();
+
+        void startTestStream(); // replays a generated stream to the port, in a loop
+        void startReplay(ARTRecordingPtr r, float speed = 1, bool loop = false);
+        void stopReplay();
+
+        void startRecording(); // captures the raw datagrams received on the port
+        ARTRecordingPtr stopRecording();
 
         VRSignalPtr getSignal_on_new_art_device();
 };
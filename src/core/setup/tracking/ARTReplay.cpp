@@ -0,0 +1,190 @@
+#include "ARTReplay.h"
+
+#include <boost/asio.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <fstream>
+#include <thread>
+#include <iostream>
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+
+using namespace OSG;
+using boost::asio::ip::udp;
+
+namespace {
+    void append(string& s, const char* fmt, double a = 0, double b = 0, double c = 0) {
+        char buf[128];
+        int N = snprintf(buf, sizeof(buf), fmt, a, b, c);
+        s.append(buf, max(0, min(N, int(sizeof(buf))-1)));
+    }
+
+    void appendPose(string& s, double x, double y, double z, double a) { // location in mm and rotation by a around z, column wise
+        double c = cos(a), si = sin(a);
+        append(s, "[%.3f %.3f %.3f]", x, y, z);
+        append(s, "[%.6f %.6f %.6f ", c, si, 0);
+        append(s, "%.6f %.6f %.6f ", -si, c, 0);
+        append(s, "%.6f %.6f %.6f]", 0, 0, 1);
+    }
+}
+
+ARTRecording::ARTRecording() {}
+ARTRecording::~ARTRecording() {}
+
+ARTRecordingPtr ARTRecording::create() { return ARTRecordingPtr( new ARTRecording() ); }
+
+ARTRecordingPtr ARTRecording::createTestStream(int frames, float fps, int bodies, int flysticks, int hands, int markers) {
+    auto r = create();
+    for (int k=0; k<frames; k++) {
+        double t = k/fps;
+        string s;
+        append(s, "fr %.0f\n", k);
+        append(s, "ts %.6f\n", t);
+
+        append(s, "6dcal %.0f\n", bodies);
+        append(s, "6d %.0f ", bodies);
+        for (int i=0; i<bodies; i++) {
+            append(s, "[%.0f 1.000]", i);
+            appendPose(s, 100*(i+1)*cos(t), 100*(i+1)*sin(t), 1000+i, t);
+            if (i < bodies-1) s += " ";
+        }
+        s += "\n";
+
+        if (flysticks > 0) {
+            append(s, "6df2 %.0f %.0f ", flysticks, flysticks);
+            for (int i=0; i<flysticks; i++) {
+                append(s, "[%.0f 1.000 8 2]", i);
+                appendPose(s, -100*(i+1)*cos(t), 100*(i+1)*sin(t), 1200+i, -t);
+                append(s, "[%.0f %.3f %.3f]", (k/10)%256, sin(t), cos(t)); // buttons count up, joystick on a circle
+                if (i < flysticks-1) s += " ";
+            }
+            s += "\n";
+        }
+
+        if (hands > 0) {
+            append(s, "glcal %.0f\n", hands);
+            append(s, "gl %.0f ", hands);
+            for (int i=0; i<hands; i++) {
+                append(s, "[%.0f 1.000 %.0f 5]", i, i%2);
+                appendPose(s, 100*(i+1)*cos(t), -100*(i+1)*sin(t), 1400+i, t);
+                for (int j=0; j<5; j++) {
+                    appendPose(s, 20*j, 50, 0, 0.1*j);
+                    s += "[10.000 30.000 -20.000 25.000 -10.000 20.000]";
+                }
+                if (i < hands-1) s += " ";
+            }
+            s += "\n";
+        }
+
+        if (markers > 0) {
+            append(s, "3d %.0f ", markers);
+            for (int i=0; i<markers; i++) {
+                append(s, "[%.0f 1.000]", i+1);
+                append(s, "[%.3f %.3f %.3f]", 10*i + cos(t), 10*i + sin(t), 500);
+                if (i < markers-1) s += " ";
+            }
+            s += "\n";
+        }
+
+        r->add(t, s);
+    }
+    return r;
+}
+
+void ARTRecording::add(const char* data, int len) {
+    if (datagrams.size() == 0) begin = chrono::steady_clock::now();
+    double t = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    add(t, string(data, len));
+}
+
+void ARTRecording::add(double time, const string& data) {
+    Datagram d;
+    d.time = time;
+    d.data = data;
+    datagrams.push_back(d);
+}
+
+void ARTRecording::clear() { datagrams.clear(); }
+int ARTRecording::size() { return datagrams.size(); }
+const ARTRecording::Datagram& ARTRecording::get(int i) { return datagrams[i]; }
+double ARTRecording::getDuration() { return datagrams.size() ? datagrams.back().time : 0; }
+
+bool ARTRecording::save(string path) {
+    ofstream f(path, ios::binary);
+    if (!f) { cout << "ARTRecording::save, cannot open " << path << endl; return false; }
+    f.write("ARTREC1\n", 8);
+    for (auto& d : datagrams) {
+        uint32_t len = d.data.size();
+        f.write((const char*)&d.time, sizeof(double));
+        f.write((const char*)&len, sizeof(uint32_t));
+        f.write(d.data.data(), len);
+    }
+    return bool(f);
+}
+
+bool ARTRecording::load(string path) {
+    ifstream f(path, ios::binary);
+    if (!f) { cout << "ARTRecording::load, cannot open " << path << endl; return false; }
+    char header[8];
+    if (!f.read(header, 8) || string(header, 8) != "ARTREC1\n") { cout << "ARTRecording::load, " << path << " is no ART recording" << endl; return false; }
+
+    datagrams.clear();
+    while (true) {
+        Datagram d;
+        uint32_t len = 0;
+        if (!f.read((char*)&d.time, sizeof(double))) break;
+        if (!f.read((char*)&len, sizeof(uint32_t))) { cout << "ARTRecording::load, truncated file " << path << endl; return false; }
+        d.data.resize(len);
+        if (len && !f.read(&d.data[0], len)) { cout << "ARTRecording::load, truncated file " << path << endl; return false; }
+        datagrams.push_back(d);
+    }
+    return true;
+}
+
+
+ARTReplay::ARTReplay(ARTRecordingPtr recording, int port, float speed, bool loop) : recording(recording), port(port), speed(speed), loop(loop), running(false), sent(0) {}
+ARTReplay::~ARTReplay() { stop(); }
+
+ARTReplayPtr ARTReplay::create(ARTRecordingPtr recording, int port, float speed, bool loop) { return ARTReplayPtr( new ARTReplay(recording, port, speed, loop) ); }
+
+void ARTReplay::start() {
+    if (thread || !recording) return;
+    running = true;
+    thread = new boost::thread(boost::bind(&ARTReplay::send, this));
+}
+
+void ARTReplay::stop() {
+    if (!thread) return;
+    running = false;
+    thread->join();
+    delete thread;
+    thread = 0;
+}
+
+bool ARTReplay::isRunning() { return running; }
+int ARTReplay::getSentCount() { return sent; }
+
+void ARTReplay::send() {
+    try {
+        boost::asio::io_service io;
+        udp::socket socket(io, udp::endpoint(udp::v4(), 0));
+        udp::endpoint target(boost::asio::ip::address_v4::loopback(), port);
+
+        do {
+            auto begin = chrono::steady_clock::now();
+            for (int i=0; i<recording->size() && running; i++) {
+                auto& d = recording->get(i);
+                if (speed > 0) { // recorded timing
+                    auto due = begin + chrono::duration_cast<chrono::steady_clock::duration>( chrono::duration<double>(d.time/speed) );
+                    std::this_thread::sleep_until(due);
+                }
+                socket.send_to(boost::asio::buffer(d.data), target);
+                sent++;
+            }
+        } while (loop && running);
+    } catch (exception& e) {
+        cout << "ARTReplay::send, " << e.what() << endl;
+    }
+    running = false;
+}
@@ -0,0 +1,85 @@
+#ifndef ARTREPLAY_H_INCLUDED
+#define ARTREPLAY_H_INCLUDED
+
+#include "core/utils/VRDeviceFwd.h"
+#include <OpenSG/OSGConfig.h>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+
+namespace boost { class thread; }
+
+OSG_BEGIN_NAMESPACE;
+using namespace std;
+
+/**
+    Raw DTrack UDP datagrams with their arrival time in seconds, to reproduce tracking sessions without the hardware.
+    The file starts with the line ARTREC1, followed by each datagram as time (double), length (uint32) and data.
+    The test stream moves body i at frame k on a circle, (100*(i+1)*cos(t), 100*(i+1)*sin(t), 1000+i) mm with t = k/fps,
+    rotated by t around z, flysticks, hands and markers follow the same pattern.
+*/
+
+class ARTRecording {
+    public:
+        struct Datagram {
+            double time = 0;
+            string data;
+        };
+
+    private:
+        vector<Datagram> datagrams;
+        chrono::steady_clock::time_point begin;
+
+    public:
+        ARTRecording();
+        ~ARTRecording();
+
+        static ARTRecordingPtr create();
+        static ARTRecordingPtr createTestStream(int frames, float fps = 60, int bodies = 2, int flysticks = 1, int hands = 0, int markers = 0);
+
+        void add(const char* data, int len); // time since the first datagram
+        void add(double time, const string& data);
+        void clear();
+
+        int size();
+        const Datagram& get(int i);
+        double getDuration();
+
+        bool save(string path);
+        bool load(string path);
+};
+
+/**
+    Local stand-in for the DTrack server, sends a recording to a UDP port on this host.
+    The datagrams keep their recorded timing divided by speed, a speed of 0 sends them as fast as possible.
+*/
+
+class ARTReplay {
+    private:
+        ARTRecordingPtr recording;
+        int port = 5000;
+        float speed = 1;
+        bool loop = false;
+
+        boost::thread* thread = 0;
+        atomic<bool> running;
+        atomic<int> sent;
+
+        void send();
+
+    public:
+        ARTReplay(ARTRecordingPtr recording, int port, float speed = 1, bool loop = false);
+        ~ARTReplay();
+
+        static ARTReplayPtr create(ARTRecordingPtr recording, int port, float speed = 1, bool loop = false);
+
+        void start();
+        void stop();
+        bool isRunning();
+        int getSentCount();
+};
+
+OSG_END_NAMESPACE;
+
+#endif // ARTREPLAY_H_INCLUDED
@@ -92,8 +92,6 @@
 #define DTRACK_CMD_STOP_DATA            12
 #define DTRACK_CMD_SEND_N_DATA          13
 
-#include "core/utils/toString.h"
-
 // Local prototypes:
 
 static char* string_nextline(char* str, char* start, int len);
@@ -130,23 +128,29 @@ DTrack::DTrack(
 )
 {
 
+	d_udpsock = NULL;
 	d_udpbuf = NULL;
+	d_udplen = 0;
 	set_noerror();
 
-	// create UDP socket:
+	// reset actual DTrack data:
 
-	if(udpport <= 0 || udpport > 65535){
-		return;
-	}
+	act_framecounter = 0;
+	act_timestamp = -1;
 
-	d_udpsock = udp_init((unsigned short )udpport);
+	act_num_body = act_num_flystick = act_num_meatool = act_num_hand = 0;
+	act_num_marker = 0;
 
-	if(d_udpsock == NULL){
+	d_remote_ip = 0;
+	d_remote_port = 0;
+	d_remote_cameras = false;
+	d_remote_tracking = true;
+	d_remote_sending = true;
+
+	if(udpport < 0 || udpport > 65535){
 		return;
 	}
 
-	d_udptimeout_us = udptimeout_us;
-
 	// create UDP buffer:
 
 	d_udpbufsize = udpbufsize;
@@ -154,11 +158,23 @@ DTrack::DTrack(
 	d_udpbuf = (char *)malloc(udpbufsize);
 
 	if(d_udpbuf == NULL){
-		udp_exit(d_udpsock);
-		d_udpsock = NULL;
 		return;
 	}
 
+	if(udpport == 0){  // only processing packets from memory
+		return;
+	}
+
+	// create UDP socket:
+
+	d_udpsock = udp_init((unsigned short )udpport);
+
+	if(d_udpsock == NULL){
+		return;
+	}
+
+	d_udptimeout_us = udptimeout_us;
+
 	// DTrack remote control parameters:
 
 	if(remote_host != NULL && remote_port != 0){
@@ -173,28 +189,12 @@ DTrack::DTrack(
 			}
 		}
 
-		if(d_remote_ip == 0){  // resolving of hostname was not possible
-			free(d_udpbuf);
+		if(d_remote_ip == 0){  // resolving of hostname was not possible, the buffer is released by the destructor
 			udp_exit(d_udpsock);
 			d_udpsock = NULL;
 			return;
 		}
-	}else{
-		d_remote_ip = 0;
-		d_remote_port = 0;
 	}
-
-	d_remote_cameras = false;
-	d_remote_tracking = true;
-	d_remote_sending = true;
-
-	// reset actual DTrack data:
-
-	act_framecounter = 0;
-	act_timestamp = -1;
-
-	act_num_body = act_num_flystick = act_num_meatool = act_num_hand = 0;
-	act_num_marker = 0;
 }
 
 
@@ -277,26 +277,13 @@ void DTrack::set_parseerror(void)  // 'parse error'
 
 bool DTrack::receive(void)
 {
-	char* s;
-	int i, j, k, l, n, len, id;
-	char sfmt[20];
-	int iarr[3];
-	float f, farr[6];
-	int loc_num_bodycal, loc_num_handcal, loc_num_flystick1, loc_num_meatool;
+	int len;
 
 	if(!valid()){
 		set_udperror();
 		return false;
 	}
 
-	// defaults:
-
-	act_framecounter = 0;
-	act_timestamp = -1;   // i.e. not available
-
-	loc_num_bodycal = loc_num_handcal = -1;  // i.e. not available
-	loc_num_flystick1 = loc_num_meatool = 0;
-
 	// receive UDP packet:
 
 	len = udp_receive(d_udpsock, d_udpbuf, d_udpbufsize-1, d_udptimeout_us);
@@ -310,6 +297,56 @@ bool DTrack::receive(void)
 		return false;
 	}
 
+	return parse_buffer(len);
+}
+
+
+// Process one DTrack data packet from memory (ASCII protocol):
+//
+// data (i): packet data
+// len (i): packet length in bytes
+//
+// return value (o): processing was successfull
+
+bool DTrack::parse(const char* data, int len)
+{
+	if(d_udpbuf == NULL || len <= 0 || len >= d_udpbufsize){
+		set_parseerror();
+		return false;
+	}
+
+	memcpy(d_udpbuf, data, len);
+	return parse_buffer(len);
+}
+
+const char* DTrack::get_datagram(void)
+{
+	return d_udpbuf;
+}
+
+int DTrack::get_datagram_length(void)
+{
+	return d_udplen;
+}
+
+bool DTrack::parse_buffer(int len)
+{
+	char* s;
+	int i, j, k, l, n, id;
+	char sfmt[20];
+	int iarr[3];
+	float f, farr[6];
+	int loc_num_bodycal, loc_num_handcal, loc_num_flystick1, loc_num_meatool;
+
+	// defaults:
+
+	act_framecounter = 0;
+	act_timestamp = -1;   // i.e. not available
+
+	loc_num_bodycal = loc_num_handcal = -1;  // i.e. not available
+	loc_num_flystick1 = loc_num_meatool = 0;
+
+	d_udplen = len;
 	s = d_udpbuf;
 	s[len] = '\0';
 
@@ -710,7 +747,7 @@ bool DTrack::receive(void)
 
 		// ignore unknown line identifiers (could be valid in future DTracks)
 
-	}while((s = string_nextline(d_udpbuf, s, d_udpbufsize)) != NULL);
+	}while((s = string_nextline(d_udpbuf, s, len+1)) != NULL);  // only up to the end of this packet
 
 	// set number of calibrated standard bodies, if necessary:
 
@@ -1082,10 +1119,140 @@ static char* string_nextline(char* str, char* start, int len)
 	return NULL;                      // no new line found in buffer
 }
 
-static char* string_get_i(char* str, int* f) { if (!str) return 0; int N = 0; N = toValue(str, *f); if (N == 0) return 0; return str+N; }
-static char* string_get_ui(char* str, unsigned int* f) { if (!str) return 0; int N = 0; N = toValue(str, *f); if (N == 0) return 0; return str+N; }
-static char* string_get_d(char* str, double* f) { if (!str) return 0; int N = 0; N = toValue(str, *f); if (N == 0) return 0; return str+N; }
-static char* string_get_f(char* str, float* f) { if (!str) return 0; int N = 0; N = toValue(str, *f); if (N == 0) return 0; return str+N; }
+// Read numbers from string without allocations, independent of the C locale:
+// str (i): string
+// return value (o): pointer behind read value in str; NULL in case of error
+
+static char* string_skip_space(char* str)
+{
+	while(*str == ' ' || *str == '\t' || *str == '\r' || *str == '\n'){
+		str++;
+	}
+	return str;
+}
+
+static char* string_get_ull(char* str, unsigned long long* ull, bool* neg)
+{
+	char* s;
+
+	if(!str){
+		return NULL;
+	}
+
+	s = string_skip_space(str);
+	*neg = (*s == '-');
+	if(*s == '-' || *s == '+'){
+		s++;
+	}
+
+	if(*s < '0' || *s > '9'){
+		return NULL;
+	}
+
+	*ull = 0;
+	while(*s >= '0' && *s <= '9'){
+		*ull = *ull*10 + (*s++ - '0');
+	}
+
+	return s;
+}
+
+static char* string_get_i(char* str, int* i)
+{
+	unsigned long long ull;
+	bool neg;
+
+	if(!(str = string_get_ull(str, &ull, &neg))){
+		return NULL;
+	}
+
+	*i = neg ? -(int )ull : (int )ull;
+	return str;
+}
+
+static char* string_get_ui(char* str, unsigned int* ui)
+{
+	unsigned long long ull;
+	bool neg;
+
+	if(!(str = string_get_ull(str, &ull, &neg)) || neg){
+		return NULL;
+	}
+
+	*ui = (unsigned int )ull;
+	return str;
+}
+
+static char* string_get_d(char* str, double* d)
+{
+	static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	unsigned long long m = 0;
+	int digits = 0, exp10 = 0, e = 0;
+	bool neg, eneg = false, any = false;
+	char* s;
+
+	if(!str){
+		return NULL;
+	}
+
+	s = string_skip_space(str);
+	neg = (*s == '-');
+	if(*s == '-' || *s == '+'){
+		s++;
+	}
+
+	// mantissa, digits beyond the precision of a double only shift the exponent:
+
+	for(; *s >= '0' && *s <= '9'; s++, any = true){
+		if(digits < 19){ m = m*10 + (*s - '0'); if(m) digits++; }
+		else exp10++;
+	}
+	if(*s == '.'){
+		for(s++; *s >= '0' && *s <= '9'; s++, any = true){
+			if(digits < 19){ m = m*10 + (*s - '0'); if(m) digits++; exp10--; }
+		}
+	}
+	if(!any){
+		return NULL;
+	}
+
+	if(*s == 'e' || *s == 'E'){
+		char* se = s+1;
+		eneg = (*se == '-');
+		if(*se == '-' || *se == '+'){
+			se++;
+		}
+		if(*se >= '0' && *se <= '9'){
+			for(; *se >= '0' && *se <= '9'; se++){
+				if(e < 10000) e = e*10 + (*se - '0');
+			}
+			exp10 += eneg ? -e : e;
+			s = se;
+		}
+	}
+
+	*d = (double )m;
+	while(exp10 > 22){ *d *= 1e22; exp10 -= 22; }
+	while(exp10 < -22){ *d /= 1e22; exp10 += 22; }
+	*d = exp10 < 0 ? *d / pow10[-exp10] : *d * pow10[exp10];  // exact for up to 15 digits
+	if(neg){
+		*d = -*d;
+	}
+	return s;
+}
+
+static char* string_get_f(char* str, float* f)
+{
+	double d;
+
+	if(!(str = string_get_d(str, &d))){
+		return NULL;
+	}
+
+	*f = (float )d;
+	return str;
+}
 
 // Process next block '[...]' in string:
 // str (i): string
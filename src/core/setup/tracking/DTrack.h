@@ -138,7 +138,7 @@ class DTrack {
 
 // Constructor:
 //
-// udpport (i): UDP port number to receive data from DTrack
+// udpport (i): UDP port number to receive data from DTrack (0 to only parse packets from memory)
 //
 // remote_host (i): DTrack remote control: hostname || IP address of DTrack PC (NULL if not used)
 // remote_port (i): port number of DTrack remote control (0 if not used)
@@ -176,6 +176,21 @@ class DTrack {
 
 	bool receive(void);
 
+// Process one DTrack data packet from memory, e.g. a recorded one (ASCII protocol):
+//  - works without socket, the parser does not allocate memory once the data arrays fit
+//
+// data (i): packet data
+// len (i): packet length in bytes
+//
+// return value (o): processing was successfull
+
+	bool parse(const char* data, int len);
+
+// Raw data of the last received || processed packet (e.g. for recording):
+
+	const char* get_datagram(void);             // packet data
+	int get_datagram_length(void);              // packet length in bytes
+
 // Get data of last received DTrack data packet:
 //  - currently not tracked bodies are getting a quality of -1
 
@@ -219,6 +234,7 @@ private:
 
 	int d_udpbufsize;               // size of UDP buffer
 	char* d_udpbuf;                 // UDP buffer
+	int d_udplen;                   // length of the last packet in the buffer
 
 	unsigned int d_remote_ip;       // DTrack remote command access: IP address
 	unsigned short d_remote_port;   // DTrack remote command access: port number
@@ -253,6 +269,7 @@ private:
 	void set_parseerror(void);      // set last receive/send error to 'parse error'
 
 	bool cmd_send(int cmd, int val = 0);  // send remote control command
+	bool parse_buffer(int len);           // process the packet in the UDP buffer
 };
 
 
@@ -1,4 +1,5 @@
 #include "VRPN.h"
+#include "VRPosePredictor.h"
 #include "core/gui/VRGuiManager.h"
 #include "core/gui/VRGuiConsole.h"
 #include "core/scene/VRSceneManager.h"
@@ -47,6 +48,14 @@ void VRPN_CALLBACK handle_tracker(void* data, const vrpn_TRACKERCB tracker ) {
     for (int i=0; i<3; i++) m[3][i] = pos[i];
 
     if (dev->verbose) VRGuiManager::get()->getConsole("Tracking")->write( "vrpn tracker pos "+toString(pos)+" dir "+toString(-Vec3d(m[2]))+"\n");
+
+    if (auto p = dev->predictor) { // the beacon is set in loop, samples are timestamped by the sender
+        double t = tracker.msg_time.tv_sec + tracker.msg_time.tv_usec*1e-6;
+        double now = VRPosePredictor::now();
+        if (!p->hasSamples() || now - t < dev->clockOffset) dev->clockOffset = now - t; // the fastest sample so far
+        p->addSample(t + dev->clockOffset, m);
+        return;
+    }
     obj->setMatrix(m);
 }
 
@@ -118,6 +127,12 @@ void VRPN_device::setAddress(string addr) {
 void VRPN_device::setTranslationAxis(Vec3d v) { translate_axis = v; }
 void VRPN_device::setRotationAxis(Vec3d v) { rotation_axis = v; }
 
+void VRPN_device::setPrediction(bool filter, double horizon) {
+    if (!filter) { predictor = 0; return; }
+    if (!predictor) predictor = VRPosePredictor::create();
+    predictor->setHorizon(horizon);
+}
+
 void VRPN_device::loop(bool verbose) {
     this->verbose = verbose;
     if (!initialized) setAddress(address);
@@ -127,6 +142,10 @@ void VRPN_device::loop(bool verbose) {
     if (analog) analog->mainloop();
     if (dial) dial->mainloop();
     if (text) text->mainloop();
+
+    if (predictor && predictor->hasSamples()) {
+        if (auto obj = editBeacon()) obj->setMatrix( predictor->getPose() );
+    }
 }
 
 
@@ -140,6 +159,8 @@ VRPN::VRPN() {
     store("active", &active);
     store("port", &port);
     store("verbose", &verbose);
+    store("filter", &filter);
+    store("prediction", &prediction);
 }
 
 VRPN::~VRPN() {
@@ -150,11 +171,19 @@ void VRPN::update_t(VRThread* thread) {}
 void VRPN::update() {
     if (!active) return;
     if (verbose) VRGuiManager::get()->getConsole("Tracking")->write("vrpn devices: "+toString(devices.size())+"\n");
-    for (auto tr : devices) tr.second->loop(verbose);
+    for (auto tr : devices) {
+        tr.second->setPrediction(filter, prediction);
+        tr.second->loop(verbose);
+    }
 }
 
 void VRPN::setVRPNVerbose(bool b) { verbose = b; }
 
+void VRPN::setVRPNFilter(bool b) { filter = b; }
+bool VRPN::getVRPNFilter() { return filter; }
+void VRPN::setVRPNPrediction(double t) { prediction = t; }
+double VRPN::getVRPNPrediction() { return prediction; }
+
 void VRPN::addVRPNTracker(int ID, string addr, Vec3d offset, float scale) {
     while(devices.count(ID)) ID++;
 
@@ -8,6 +8,7 @@
 
 #include "core/setup/devices/VRDevice.h"
 #include "core/utils/VRFunctionFwd.h"
+#include "core/utils/VRDeviceFwd.h"
 
 class vrpn_Tracker_Remote;
 class vrpn_Button_Remote;
@@ -33,6 +34,8 @@ class VRPN_device : public VRDevice {
         vrpn_Text_Receiver*  text = 0;
 
         vrpn_Connection* vrpnc = 0;
+        VRPosePredictorPtr predictor; // optional, filters the tracker and predicts the pose of the beacon
+        double clockOffset = 0; // from the sender clock to the local clock
         int ID = 0;
         bool initialized = false;
         bool verbose = false;
@@ -46,6 +49,7 @@ class VRPN_device : public VRDevice {
         void setAddress(string t);
         void setTranslationAxis(Vec3d v);
         void setRotationAxis(Vec3d v);
+        void setPrediction(bool filter, double horizon);
         void loop(bool verbose = false);
 };
 
@@ -56,6 +60,8 @@ class VRPN : public VRStorage {
         bool active = true;
         int port = 3883;
         bool verbose = false;
+        bool filter = false;
+        double prediction = 0;
 
         VRUpdateCbPtr updatePtr;
         VRUpdateCbPtr testServer = 0;
@@ -85,6 +91,11 @@ class VRPN : public VRStorage {
 
         void setVRPNVerbose(bool b);
 
+        void setVRPNFilter(bool b); // smooth the tracked poses, see VRPosePredictor
+        bool getVRPNFilter();
+        void setVRPNPrediction(double t); // seconds to predict the tracked poses ahead, needs the filter
+        double getVRPNPrediction();
+
         void startVRPNTestServer();
         void stopVRPNTestServer();
 };
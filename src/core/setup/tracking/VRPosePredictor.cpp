@@ -0,0 +1,173 @@
+#include "VRPosePredictor.h"
+
+#include <chrono>
+#include <cmath>
+
+using namespace OSG;
+
+namespace {
+    void qmult(const double* a, const double* b, double* r) {
+        double x = a[3]*b[0] + a[0]*b[3] + a[1]*b[2] - a[2]*b[1];
+        double y = a[3]*b[1] - a[0]*b[2] + a[1]*b[3] + a[2]*b[0];
+        double z = a[3]*b[2] + a[0]*b[1] - a[1]*b[0] + a[2]*b[3];
+        double w = a[3]*b[3] - a[0]*b[0] - a[1]*b[1] - a[2]*b[2];
+        r[0] = x; r[1] = y; r[2] = z; r[3] = w;
+    }
+
+    void qnormalize(double* q) {
+        double l = sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2] + q[3]*q[3]);
+        if (l < 1e-12) { q[0] = q[1] = q[2] = 0; q[3] = 1; return; }
+        for (int i=0; i<4; i++) q[i] /= l;
+    }
+
+    Vec3d qlog(const double* q) { // rotation vector, angle times axis
+        double s = sqrt(q[0]*q[0] + q[1]*q[1] + q[2]*q[2]);
+        if (s < 1e-12) return Vec3d(2*q[0], 2*q[1], 2*q[2]);
+        double a = 2*atan2(s, q[3]);
+        return Vec3d(q[0], q[1], q[2]) * (a/s);
+    }
+
+    void qexp(const Vec3d& v, double* r) {
+        double a = v.length();
+        double s = a < 1e-12 ? 0.5 : sin(a*0.5)/a;
+        r[0] = v[0]*s; r[1] = v[1]*s; r[2] = v[2]*s; r[3] = cos(a*0.5);
+    }
+
+    void fromMatrix(const Matrix4d& m, Vec3d& scale, double* q) { // OSG matrices are column major, m[i] is the i-th column
+        Vec3d c[3];
+        for (int i=0; i<3; i++) {
+            c[i] = Vec3d(m[i][0], m[i][1], m[i][2]);
+            scale[i] = c[i].length();
+            if (scale[i] > 1e-12) c[i] /= scale[i];
+        }
+
+        double tr = c[0][0] + c[1][1] + c[2][2];
+        if (tr > 0) {
+            double s = 0.5/sqrt(tr+1);
+            q[3] = 0.25/s;
+            q[0] = (c[1][2] - c[2][1])*s;
+            q[1] = (c[2][0] - c[0][2])*s;
+            q[2] = (c[0][1] - c[1][0])*s;
+        } else if (c[0][0] > c[1][1] && c[0][0] > c[2][2]) {
+            double s = 2*sqrt(1 + c[0][0] - c[1][1] - c[2][2]);
+            q[3] = (c[1][2] - c[2][1])/s;
+            q[0] = 0.25*s;
+            q[1] = (c[1][0] + c[0][1])/s;
+            q[2] = (c[2][0] + c[0][2])/s;
+        } else if (c[1][1] > c[2][2]) {
+            double s = 2*sqrt(1 + c[1][1] - c[0][0] - c[2][2]);
+            q[3] = (c[2][0] - c[0][2])/s;
+            q[0] = (c[1][0] + c[0][1])/s;
+            q[1] = 0.25*s;
+            q[2] = (c[2][1] + c[1][2])/s;
+        } else {
+            double s = 2*sqrt(1 + c[2][2] - c[0][0] - c[1][1]);
+            q[3] = (c[0][1] - c[1][0])/s;
+            q[0] = (c[2][0] + c[0][2])/s;
+            q[1] = (c[2][1] + c[1][2])/s;
+            q[2] = 0.25*s;
+        }
+        qnormalize(q);
+    }
+
+    Matrix4d toMatrix(const Vec3d& p, const Vec3d& scale, const double* q) {
+        double x = q[0], y = q[1], z = q[2], w = q[3];
+        double c[3][3] = { // columns
+            { 1-2*(y*y+z*z), 2*(x*y+z*w), 2*(x*z-y*w) },
+            { 2*(x*y-z*w), 1-2*(x*x+z*z), 2*(y*z+x*w) },
+            { 2*(x*z+y*w), 2*(y*z-x*w), 1-2*(x*x+y*y) } };
+        Matrix4d m;
+        for (int i=0; i<3; i++) for (int j=0; j<3; j++) m[i][j] = c[i][j]*scale[i];
+        for (int i=0; i<3; i++) m[3][i] = p[i];
+        return m;
+    }
+}
+
+VRPosePredictor::VRPosePredictor() {}
+VRPosePredictor::~VRPosePredictor() {}
+
+VRPosePredictorPtr VRPosePredictor::create() { return VRPosePredictorPtr( new VRPosePredictor() ); }
+
+void VRPosePredictor::setFilter(double mc, double b) { minCutoff = mc; beta = b; }
+void VRPosePredictor::setRotationFilter(double mc, double b) { rotMinCutoff = mc; rotBeta = b; }
+void VRPosePredictor::setHorizon(double h) { horizon = h; }
+double VRPosePredictor::getHorizon() { return horizon; }
+void VRPosePredictor::setMaxExtrapolation(double t) { maxExtrapolation = t; }
+
+void VRPosePredictor::reset() { initialized = false; }
+bool VRPosePredictor::hasSamples() { return initialized; }
+Vec3d VRPosePredictor::getVelocity() { return vel; }
+Vec3d VRPosePredictor::getAngularVelocity() { return omega; }
+
+double VRPosePredictor::now() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double VRPosePredictor::alpha(double cutoff, double dt) { // smoothing factor of an exponential low pass
+    double tau = 1.0/(2*Pi*cutoff);
+    return 1.0/(1.0 + tau/dt);
+}
+
+void VRPosePredictor::addSample(double t, const Matrix4d& m) {
+    Vec3d p;
+    double q[4];
+    for (int i=0; i<3; i++) p[i] = m[3][i];
+    fromMatrix(m, scale, q);
+
+    if (!initialized) {
+        pos = p;
+        for (int i=0; i<4; i++) rot[i] = q[i];
+        vel = Vec3d();
+        omega = Vec3d();
+        lastTime = t;
+        initialized = true;
+        return;
+    }
+
+    double dt = t - lastTime;
+    if (dt <= 1e-6) return; // duplicate or out of order sample
+    if (dt > 1.0) { // tracking was lost, restart the filter
+        initialized = false;
+        addSample(t, m);
+        return;
+    }
+    lastTime = t;
+
+    // position, predict with constant velocity and correct with the residual, the speed sets the gains
+    double a = alpha(minCutoff + beta * vel.length(), dt);
+    double b = a*a/(2-a);
+    Vec3d r = p - (pos + vel * dt);
+    pos += vel * dt + r * a;
+    vel += r * (b/dt);
+
+    // orientation, same with rotation vectors in the local frame
+    double step[4], d[4];
+    qexp(omega * dt, step);
+    qmult(rot, step, rot);
+    double ri[4] = {-rot[0], -rot[1], -rot[2], rot[3]};
+    qmult(ri, q, d);
+    if (d[3] < 0) for (int i=0; i<4; i++) d[i] = -d[i]; // shortest way, q and -q are the same rotation
+    Vec3d rr = qlog(d);
+    a = alpha(rotMinCutoff + rotBeta * omega.length(), dt);
+    b = a*a/(2-a);
+    qexp(rr * a, step);
+    qmult(rot, step, rot);
+    qnormalize(rot);
+    omega += rr * (b/dt);
+}
+
+Matrix4d VRPosePredictor::predict(double t) {
+    if (!initialized) return toMatrix(pos, scale, rot);
+
+    double h = t - lastTime;
+    if (h > maxExtrapolation) h = maxExtrapolation;
+    if (h < 0) h = 0;
+
+    Vec3d p = pos + vel * h;
+    double step[4], r[4];
+    qexp(omega * h, step);
+    qmult(rot, step, r);
+    return toMatrix(p, scale, r);
+}
+
+Matrix4d VRPosePredictor::getPose() { return predict(now() + horizon); }
@@ -0,0 +1,69 @@
+#ifndef VRPOSEPREDICTOR_H_INCLUDED
+#define VRPOSEPREDICTOR_H_INCLUDED
+
+#include <OpenSG/OSGConfig.h>
+#include <OpenSG/OSGMatrix.h>
+#include <OpenSG/OSGVector.h>
+#include "core/utils/VRDeviceFwd.h"
+
+using namespace std;
+OSG_BEGIN_NAMESPACE;
+
+/**
+    Filtering and prediction of tracked poses to compensate network and frame latency.
+    Samples are timestamped when they arrive and run through an alpha beta filter, a steady state Kalman filter with constant velocity,
+    on the position and on the orientation as rotation vectors, it follows steady motion without lag.
+    Like the one euro filter the gains follow the speed, at rest the cutoff is low and the jitter is filtered strongly,
+    fast motion raises the cutoff by beta per unit per second, or per radian per second.
+    The pose is extrapolated with the filtered velocities to the requested time,
+    at most maxExtrapolation seconds beyond the last sample, a lost tracker does not drift away.
+    Times are in seconds, positions in the units of the samples.
+*/
+
+class VRPosePredictor {
+    private:
+        double minCutoff = 1;
+        double beta = 30;
+        double rotMinCutoff = 1;
+        double rotBeta = 10;
+        double horizon = 0;
+        double maxExtrapolation = 0.2;
+
+        bool initialized = false;
+        double lastTime = 0;
+        Vec3d pos;
+        Vec3d vel;
+        double rot[4] = {0,0,0,1}; // quaternion x y z w
+        Vec3d omega; // angular velocity in the local frame
+        Vec3d scale = Vec3d(1,1,1);
+
+        static double alpha(double cutoff, double dt);
+
+    public:
+        VRPosePredictor();
+        ~VRPosePredictor();
+
+        static VRPosePredictorPtr create();
+
+        void setFilter(double minCutoff, double beta); // position, cutoff in Hz at rest, increase of the cutoff per speed
+        void setRotationFilter(double minCutoff, double beta);
+        void setHorizon(double h); // time to predict ahead of now
+        double getHorizon();
+        void setMaxExtrapolation(double t);
+
+        void reset();
+        void addSample(double t, const Matrix4d& m);
+        bool hasSamples();
+
+        Matrix4d predict(double t);
+        Matrix4d getPose(); // predicted for now + horizon
+
+        Vec3d getVelocity();
+        Vec3d getAngularVelocity();
+
+        static double now(); // monotonic clock for sample times
+};
+
+OSG_END_NAMESPACE;
+
+#endif // VRPOSEPREDICTOR_H_INCLUDED
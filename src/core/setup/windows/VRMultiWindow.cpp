@@ -6,12 +6,14 @@
 #include <libxml++/nodes/element.h>
 #include "core/scene/VRSceneManager.h"
 #include "core/utils/VRFunction.h"
+#include "core/networking/VRSyncConnection.h"
 
 
 #include <OpenSG/OSGChangeList.h>
 #include <OpenSG/OSGThread.h>
 #include <OpenSG/OSGThreadManager.h>
 #include <OpenSG/OSGBarrier.h>
+#include <OpenSG/OSGClusterNetwork.h>
 
 OSG_BEGIN_NAMESPACE;
 using namespace std;
@@ -73,6 +75,7 @@ void VRMultiWindow::initialize() {
     win->setVServers(Ny);
 
     //win->setConnectionType(connection_type); // "Multicast", "SockPipeline" // not needed apparently!
+    if (connection_type == "CompressedStreamSock") win->setConnectionType(connection_type);
     for (auto s : servers) win->editMFServers()->push_back(s);
     for (auto wv : views) if (auto v = wv.lock()) v->setWindow(win);
 
@@ -85,14 +88,57 @@ void VRMultiWindow::initialize() {
     cout << " done " << getStateString() << endl;
 }
 
+/** The change list can hold several entries for the same container when changes were committed more than once in a frame,
+    the remote aspect sends the current values of the changed fields for each of them.
+    The field masks are merged into the last entry of the container, the others are left with an empty mask.
+*/
+int VRMultiWindow::coalesceChanges(ChangeList* cl) {
+    map<UInt32, ContainerChangeEntry*> last;
+    for (auto it = cl->begin(); it != cl->end(); ++it) {
+        if ((*it)->uiEntryDesc == ContainerChangeEntry::Change) last[(*it)->uiContainerId] = *it;
+    }
+
+    int N = 0;
+    for (auto it = cl->begin(); it != cl->end(); ++it) {
+        auto e = *it;
+        if (e->uiEntryDesc != ContainerChangeEntry::Change || e->whichField == 0) continue;
+        auto l = last[e->uiContainerId];
+        if (l == e) continue;
+        l->whichField |= e->whichField;
+        e->whichField = 0;
+        N++;
+    }
+    return N;
+}
+
 void VRMultiWindow::render(bool fromThread) {
     if (state == INITIALIZING) initialize();
     if (state == CONNECTED && active && content) {
+        coalesced = coalesceChanges(Thread::getCurrentChangeList());
+        auto codec = getSyncCodec();
+        long long raw = codec ? codec->getRawBytes() : 0;
+        long long sent = codec ? codec->getPacketBytes() : 0;
+
         try { _win->render(ract); }
-        catch(exception& e) { reset(); }
+        catch(exception& e) { reset(); return; }
+
+        if (codec) {
+            syncRawBytes = codec->getRawBytes() - raw;
+            syncBytes = codec->getPacketBytes() - sent;
+        }
     }
 }
 
+VRSyncCodec* VRMultiWindow::getSyncCodec() {
+    if (!win) return 0;
+    auto c = dynamic_cast<VRSyncGroupConnection*>(win->getNetwork()->getMainConnection());
+    return c ? &c->getCodec() : 0;
+}
+
+int VRMultiWindow::getSyncBytes() { return syncBytes; }
+int VRMultiWindow::getSyncRawBytes() { return syncRawBytes; }
+int VRMultiWindow::getCoalescedChanges() { return coalesced; }
+
 void VRMultiWindow::reset() { state = INITIALIZING; }
 int VRMultiWindow::getState() { return state; }
 void VRMultiWindow::setConnectionType(string ct) { connection_type = ct; }
@@ -8,6 +8,8 @@ OSG_BEGIN_NAMESPACE;
 using namespace std;
 
 class VRThread;
+class VRSyncCodec;
+class ChangeList;
 
 class VRMultiWindow : public VRWindow {
     private:
@@ -18,6 +20,9 @@ class VRMultiWindow : public VRWindow {
         int Ny = 1;
         int state = INITIALIZING;
         int tries = 0;
+        int syncBytes = 0;
+        int syncRawBytes = 0;
+        int coalesced = 0;
 
         void render(bool fromThread = false);
 
@@ -41,9 +46,16 @@ class VRMultiWindow : public VRWindow {
         void addServer(string server);
         void setServer(int x, int y, string);
         string getServer(int x, int y);
-        void setConnectionType(string ct);
+        void setConnectionType(string ct); // CompressedStreamSock compresses the sync stream, see VRSyncConnection
         string getConnectionType();
 
+        VRSyncCodec* getSyncCodec(); // only with CompressedStreamSock
+        int getSyncBytes(); // sent to the servers in the last frame
+        int getSyncRawBytes(); // before compression
+        int getCoalescedChanges(); // change entries merged in the last frame
+
+        static int coalesceChanges(ChangeList* cl);
+
         void setNTiles(int x, int y);
         int getNXTiles();
         int getNYTiles();
@@ -32,7 +32,21 @@ void VRPolygonSelection::close(VRObjectPtr world) {
     convex_hull = selection.getConvexHull();
     convex_hull.close();
     convex_decomposition = selection.getConvexDecomposition();
+
+    auto toVec4 = [](frustum& f) {
+        vector<Vec4f> res;
+        for (auto p : f.getPlanes()) {
+            Vec3f n = p.getNormal();
+            res.push_back( Vec4f(n[0], n[1], n[2], p.getDistanceFromOrigin()) );
+        }
+        return res;
+    };
+
+    hull_planes = toVec4(convex_hull);
+    decomposition_planes.clear();
+    for (auto& f : convex_decomposition) decomposition_planes.push_back( toVec4(f) );
     closed = true;
+    volumeChanged();
     apply(world);
     updateSubselection();
     updateShape(selection);
@@ -50,6 +64,8 @@ void VRPolygonSelection::clear() {
     selection.clear();
     convex_hull.clear();
     convex_decomposition.clear();
+    hull_planes.clear();
+    decomposition_planes.clear();
     closed = false;
 }
 
@@ -88,6 +104,65 @@ bool VRPolygonSelection::vertSelected(Vec3d p) {
     return false;
 }
 
+int VRPolygonSelection::boxSelected(const Boundingbox& box) {
+    if (!closed) return 0;
+    Vec3d b1 = box.min();
+    Vec3d b2 = box.max();
+    float eps = 1e-4 * box.radius(); // keep away from the vertex test precision
+    Vec3f corners[8];
+    for (int i=0; i<8; i++) corners[i] = Vec3f( i&1 ? b2[0] : b1[0], i&2 ? b2[1] : b1[1], i&4 ? b2[2] : b1[2] );
+
+    auto classify = [&](const vector<Vec4f>& planes) { // -1: outside, 0: intersecting, 1: inside
+        bool inside = true;
+        for (auto& P : planes) {
+            int nIn = 0, nOut = 0;
+            for (auto& c : corners) {
+                float d = P[0]*c[0] + P[1]*c[1] + P[2]*c[2] - P[3];
+                if (d > eps) nIn++;
+                if (d < -eps) nOut++;
+            }
+            if (nOut == 8) return -1;
+            if (nIn < 8) inside = false;
+        }
+        return inside ? 1 : 0;
+    };
+
+    int h = classify(hull_planes);
+    if (h < 0) return 0;
+    if (h == 0) return 1;
+    for (auto& planes : decomposition_planes) if (classify(planes) == 1) return 2;
+    return 1;
+}
+
+void VRPolygonSelection::vertsSelected(const double* x, const double* y, const double* z, char* res, int N) {
+    if (!closed) { for (int i=0; i<N; i++) res[i] = 0; return; }
+    const int B = 256;
+
+    // blocks of vertices, planes in the outer loop to keep the inner loop vectorizable
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (int b=0; b<N; b+=B) {
+        int n = min(B, N-b);
+        float X[B], Y[B], Z[B];
+        char inHull[B], inPart[B], hit[B];
+        for (int k=0; k<n; k++) { X[k] = x[b+k]; Y[k] = y[b+k]; Z[k] = z[b+k]; inHull[k] = 1; hit[k] = 0; }
+
+        auto test = [&](const vector<Vec4f>& planes, char* in) {
+            for (auto& P : planes) {
+                float nx = P[0], ny = P[1], nz = P[2], d = P[3];
+                for (int k=0; k<n; k++) in[k] &= (nx*X[k] + ny*Y[k] + nz*Z[k] - d >= 0);
+            }
+        };
+
+        test(hull_planes, inHull);
+        for (auto& planes : decomposition_planes) {
+            for (int k=0; k<n; k++) inPart[k] = inHull[k];
+            test(planes, inPart);
+            for (int k=0; k<n; k++) hit[k] |= inPart[k];
+        }
+        for (int k=0; k<n; k++) res[b+k] = hit[k];
+    }
+}
+
 void VRPolygonSelection::updateShape(frustum f) {
     int N = f.getEdges().size();
     if (N <= 1) return;
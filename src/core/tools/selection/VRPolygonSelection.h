@@ -19,9 +19,14 @@ class VRPolygonSelection : public VRSelection {
         bool closed = false;
         VRGeometryPtr shape;
 
+        vector<Vec4f> hull_planes; // normal and distance, cached for batch tests
+        vector< vector<Vec4f> > decomposition_planes;
+
         bool vertSelected(Vec3d p);
         bool objSelected(VRGeometryPtr geo);
         bool partialSelected(VRGeometryPtr geo);
+        int boxSelected(const Boundingbox& box);
+        void vertsSelected(const double* x, const double* y, const double* z, char* res, int N);
 
         void updateShape(frustum f);
 
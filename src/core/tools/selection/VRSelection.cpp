@@ -2,8 +2,13 @@
 #include "core/objects/geometry/VRGeometry.h"
 #include "core/objects/geometry/OSGGeometry.h"
 #include "core/math/boundingbox.h"
+#include "core/utils/VRGlobals.h"
 
 #include <OpenSG/OSGGeometry.h>
+#include <OpenSG/OSGBoxVolume.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 /* not compiling?
 install liblapacke-dev
@@ -22,12 +27,25 @@ VRSelectionPtr VRSelection::create() { return VRSelectionPtr( new VRSelection()
 bool VRSelection::vertSelected(Vec3d p) { return false; }
 bool VRSelection::objSelected(VRGeometryPtr geo) { return false; }
 bool VRSelection::partialSelected(VRGeometryPtr geo) { return false; }
+int VRSelection::boxSelected(const Boundingbox& box) { return 1; }
+void VRSelection::setParallel(bool b) { parallel = b; }
+
+void VRSelection::volumeChanged(bool grown) {
+    volumeVersion++;
+    if (!grown) volumeReset = volumeVersion;
+}
+
+void VRSelection::vertsSelected(const double* x, const double* y, const double* z, char* res, int N) {
+    #pragma omp parallel for schedule(static)
+    for (int i=0; i<N; i++) res[i] = vertSelected(Vec3d(x[i], y[i], z[i]));
+}
 
 void VRSelection::add(VRGeometryPtr geo, vector<int> subselection) {
     auto k = geo.get();
     if (selected.count(k) == 0) selected[k] = selection_atom();
     selected[k].geo = geo;
     selected[k].subselection = subselection;
+    selected[k].mask.clear();
 }
 
 void VRSelection::clear() {
@@ -60,6 +78,7 @@ void VRSelection::append(VRSelectionPtr sel) {
             auto& s1 = selected[s.first].subselection;
             auto& s2 = s.second.subselection;
             s1.insert( s1.end(), s2.begin(), s2.end() );
+            selected[s.first].mask.clear();
         }
     }
 }
@@ -84,6 +103,19 @@ void VRSelection::updateSubselection() {
     for (auto s : selected) updateSubselection(s.second.geo.lock());
 }
 
+void VRSelection::updateSubselectionSerial(VRGeometryPtr geo, selection_atom& sel, const Matrix4d& m, bool incremental) {
+    auto pos = geo->getMesh()->geo->getPositions();
+    for (uint i=0; i<pos->size(); i++) {
+        if (incremental && sel.mask[i]) continue;
+        Pnt3d p = Pnt3d(pos->getValue<Pnt3f>(i));
+        m.mult(p,p);
+        if (vertSelected(Vec3d(p))) {
+            if (bbox) bbox->update(Vec3d(p));
+            sel.mask[i] = 1;
+        }
+    }
+}
+
 void VRSelection::updateSubselection(VRGeometryPtr geo) {
     if (!geo) return;
     if ( !selected.count( geo.get() ) ) {
@@ -94,18 +126,78 @@ void VRSelection::updateSubselection(VRGeometryPtr geo) {
 
     auto& sel = selected[geo.get()];
     Matrix4d m = geo->getWorldMatrix();
-    sel.subselection.clear();
-    if (!geo->getMesh()) return;
+    if (!geo->getMesh()) { sel.subselection.clear(); sel.mask.clear(); return; }
     auto pos = geo->getMesh()->geo->getPositions();
-    if (!pos) return;
-    for (uint i=0; i<pos->size(); i++) {
+    if (!pos) { sel.subselection.clear(); sel.mask.clear(); return; }
+    int N = pos->size();
+
+    bool meshUnchanged = geo->getLastMeshChange() < sel.frame; // a change in the frame of the last update may have come after it
+    bool incremental = sel.version >= volumeReset && int(sel.mask.size()) == N && sel.matrix == m && meshUnchanged;
+    if (!incremental) sel.mask.assign(N, 0);
+    sel.matrix = m;
+    sel.version = volumeVersion;
+    sel.frame = VRGlobals::CURRENT_FRAME;
+
+    auto finish = [&]() {
+        sel.subselection.clear();
+        for (int i=0; i<N; i++) if (sel.mask[i]) sel.subselection.push_back(i);
+    };
+
+    if (!parallel) { updateSubselectionSerial(geo, sel, m, incremental); finish(); return; }
+
+    // cull with the world space bounding box of the mesh
+    BoxVolume vol;
+    geo->getMesh()->geo->adjustVolume(vol);
+    Pnt3f b1, b2;
+    vol.getBounds(b1, b2);
+    Boundingbox box;
+    for (int i=0; i<8; i++) {
+        Pnt3d c( i&1 ? b2[0] : b1[0], i&2 ? b2[1] : b1[1], i&4 ? b2[2] : b1[2] );
+        m.mult(c,c);
+        box.update(Vec3d(c));
+    }
+    int cull = boxSelected(box);
+    if (cull == 0) { finish(); return; }
+
+    vector<int> candidates; // vertices to test, all if empty and not incremental
+    if (incremental) {
+        for (int i=0; i<N; i++) if (!sel.mask[i]) candidates.push_back(i);
+        if (candidates.size() == 0) { finish(); return; }
+    }
+    int C = incremental ? candidates.size() : N;
+
+    // world space positions as structure of arrays
+    vector<double> X(C), Y(C), Z(C);
+    vector<char> res(C, 1);
+    #pragma omp parallel for schedule(static)
+    for (int k=0; k<C; k++) {
+        int i = incremental ? candidates[k] : k;
         Pnt3d p = Pnt3d(pos->getValue<Pnt3f>(i));
         m.mult(p,p);
-        if (vertSelected(Vec3d(p))) {
-            if (bbox) bbox->update(Vec3d(p));
-            sel.subselection.push_back(i);
-        }
+        X[k] = p[0]; Y[k] = p[1]; Z[k] = p[2];
     }
+
+    if (cull == 1) vertsSelected(&X[0], &Y[0], &Z[0], &res[0], C);
+
+    // merge results, bounding box per thread
+    int T = 1;
+#ifdef _OPENMP
+    T = omp_get_max_threads();
+#endif
+    vector<Boundingbox> boxes(T);
+    #pragma omp parallel for schedule(static)
+    for (int k=0; k<C; k++) {
+        if (!res[k]) continue;
+        int t = 0;
+#ifdef _OPENMP
+        t = omp_get_thread_num();
+#endif
+        boxes[t].update(Vec3d(X[k], Y[k], Z[k]));
+        sel.mask[incremental ? candidates[k] : k] = 1;
+    }
+
+    if (bbox) for (auto& b : boxes) if (!b.empty()) { bbox->update(b.min()); bbox->update(b.max()); }
+    finish();
 }
 
 vector<int> VRSelection::getSubselection(VRGeometryPtr geo) {
@@ -233,6 +325,7 @@ void VRSelection::selectPlane(Pose p, float threshold) {
         auto pos = geo->getMesh()->geo->getPositions();
         auto norms = geo->getMesh()->geo->getNormals();
         s.second.subselection.clear();
+        s.second.mask.clear();
         for (uint i=0; i<pos->size(); i++) {
             auto p = pos->getValue<Pnt3f>(i);
             auto n = Vec3d(norms->getValue<Vec3f>(i));
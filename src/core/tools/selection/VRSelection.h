@@ -20,18 +20,31 @@ class VRSelection {
             VRGeometryWeakPtr geo;
             bool partial = false;
             vector<int> subselection;
+            vector<char> mask; // per vertex selection state, base of incremental updates
+            Matrix4d matrix;
+            int version = -1; // volume version of the last update
+            int frame = -1; // frame of the last update, the mesh has to be unchanged since
         };
 
     protected:
         map<VRGeometry*, selection_atom> selected;
         BoundingboxPtr bbox = 0;
+        bool parallel = true;
+        int volumeVersion = 0;
+        int volumeReset = 0; // last version that did not only grow the volume
 
         virtual bool vertSelected(Vec3d p);
         virtual bool objSelected(VRGeometryPtr geo);
         virtual bool partialSelected(VRGeometryPtr geo);
 
-        void updateSubselection();
-        void updateSubselection(VRGeometryPtr geo);
+        /** Classify a world space box against the selection volume, 0: outside, 1: intersecting or unknown, 2: inside **/
+        virtual int boxSelected(const Boundingbox& box);
+        /** Test a batch of world space vertices, the default calls vertSelected in parallel, it has to be thread safe **/
+        virtual void vertsSelected(const double* x, const double* y, const double* z, char* res, int N);
+
+        /** Call when the selection volume changed, grown if it only grew, then the selected vertices stay selected **/
+        void volumeChanged(bool grown = false);
+        void updateSubselectionSerial(VRGeometryPtr geo, selection_atom& sel, const Matrix4d& m, bool incremental);
 
     public:
         VRSelection();
@@ -42,6 +55,11 @@ class VRSelection {
         void apply(VRObjectPtr tree, bool force = false, bool recursive = true);
         void append(VRSelectionPtr sel);
         void clear();
+        void setParallel(bool b);
+
+        /** While the volume is unchanged or only grew since the last update, only unselected vertices are tested again **/
+        void updateSubselection();
+        void updateSubselection(VRGeometryPtr geo);
 
         vector<VRGeometryWeakPtr> getPartials();
         vector<VRGeometryWeakPtr> getSelected();
@@ -20,6 +20,9 @@ ptrFwd(VRServer);
 ptrFwd(VRHaptic);
 ptrFwd(ART);
 ptrFwd(ART_device);
+ptrFwd(ARTRecording);
+ptrFwd(ARTReplay);
+ptrFwd(VRPosePredictor);
 ptrFwd(VRPN);
 ptrFwd(VRPN_device);
 ptrFwd(VRLeap);
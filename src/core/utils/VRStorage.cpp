@@ -87,6 +87,12 @@ VRStoragePtr VRStorage::createFromStore(xmlpp::Element* e, bool verbose) {
     return res;
 }
 
+vector<string> VRStorage::getStorageTypes() {
+    vector<string> res;
+    for (auto f : factory) res.push_back(f.first);
+    return res;
+}
+
 xmlpp::Element* VRStorage::getChild(xmlpp::Element* e, string c) {
     if (e == 0) return 0;
     for (auto n : e->get_children()) {
@@ -101,6 +101,7 @@ class VRStorage {
         static int getPersistency(xmlpp::Element* e);
         static VRStoragePtr createFromStore(xmlpp::Element* e, bool verbose = true);
         template<class T> static void regStorageType(string t);
+        static vector<string> getStorageTypes();
 
         void setPersistency(int p);
         int getPersistency();
@@ -62,10 +62,2410 @@ void vrpn_server() {
     if (setup) setup->startVRPNTestServer();
 }
 
+#include "core/scene/VRSceneLoader.h"
+#include "core/scene/VRSceneBinary.h"
+#include "core/objects/geometry/VRGeoData.h"
+#include "core/utils/VRStorage.h"
+#include <libxml++/libxml++.h>
+#include <OpenSG/OSGGeoProperties.h>
+#include <fstream>
+void sceneBinaryRoundtrip() {
+    VRSceneLoader::get(); // registers the object storage types
+    string path = "/tmp/polyvr_roundtrip.pvrb";
+
+    // one object of each registered type and a code generated mesh
+    auto bin = VRSceneBinary::create();
+    xmlpp::Document doc, tmp;
+    auto objectsN = doc.create_root_node("Scene", "", "VRF")->add_child("Objects");
+    auto tmpN = tmp.create_root_node("tmp");
+    for (auto type : VRStorage::getStorageTypes()) {
+        tmpN->set_attribute("type", type);
+        auto s = VRStorage::createFromStore(tmpN);
+        if (s) s->saveUnder(objectsN);
+        else cout << " sceneBinaryRoundtrip: could not create type " << type << endl;
+    }
+
+    VRGeoData data;
+    data.pushQuad(Vec3d(), Vec3d(0,1,0), Vec3d(0,0,1), Vec2d(1,1), true);
+    data.pushQuad(Vec3d(2,0,0), Vec3d(1,0,0), Vec3d(0,1,0), Vec2d(1,2), true);
+    auto geo = data.asGeometry("binaryGeo");
+    GeoUInt32PropertyRecPtr nIndex = GeoUInt32Property::create(); // the normals with their own index
+    for (uint i=0; i<geo->getMesh()->geo->getIndices()->size(); i++) nIndex->addValue(i%4);
+    geo->getMesh()->geo->setIndex(nIndex, Geometry::NormalsIndex);
+
+    auto hidden = data.asGeometry("hiddenGeo"); // not persistent, no mesh chunk
+    hidden->setPersistency(0);
+    geo->addChild(hidden);
+
+    bin->addGeometries(geo);
+    geo->saveUnder(objectsN);
+
+    bool passed = true;
+    auto check = [&](string what, bool b) {
+        cout << " sceneBinaryRoundtrip " << what << (b ? " passed" : " FAILED") << endl;
+        passed = passed && b;
+    };
+
+    auto sameMesh = [&](OSGGeometryPtr mesh) {
+        if (!mesh || !mesh->geo) return false;
+        auto g0 = geo->getMesh()->geo;
+        auto g = mesh->geo;
+        for (auto slot : { Geometry::PositionsIndex, Geometry::NormalsIndex, Geometry::TexCoordsIndex }) {
+            auto p0 = g0->getProperty(slot);
+            auto p = g->getProperty(slot);
+            auto i0 = g0->getIndex(slot);
+            auto i = g->getIndex(slot);
+            if (!p || p->size() != p0->size()) return false;
+            for (uint j=0; j<p->size(); j++) if (p->getValue<Vec4f>(j) != p0->getValue<Vec4f>(j)) return false;
+            if (!i || i->size() != i0->size()) return false;
+            for (uint j=0; j<i->size(); j++) if (i->getValue<UInt32>(j) != i0->getValue<UInt32>(j)) return false;
+            bool shared0 = (i0 == g0->getIndex(Geometry::PositionsIndex));
+            bool shared = (i == g->getIndex(Geometry::PositionsIndex));
+            if (shared != shared0) return false;
+        }
+        return true;
+    };
+
+    auto readFile = [](string path) {
+        ifstream f(path, ios::binary);
+        return string( istreambuf_iterator<char>(f), istreambuf_iterator<char>() );
+    };
+
+    // binary round trip
+    bin->write(path, doc);
+    check("persistency", bin->getGeometryCount() == 1 && hidden->getMeshChunk() < 0);
+    auto bin2 = VRSceneBinary::create();
+    xmlpp::Document doc2;
+    check("read", bin2->read(path, doc2));
+    check("DOM", doc.write_to_string() == doc2.write_to_string());
+    check("mesh", sameMesh(bin2->getGeometry(0)));
+
+    // restore the objects from the DOM and save them again
+    auto objectsN2 = doc2.get_root_node()->get_children("Objects").front();
+    vector<VRStoragePtr> restored;
+    VRGeometryPtr geo2;
+    for (auto e : VRStorage::getChildren( dynamic_cast<xmlpp::Element*>(objectsN2) )) {
+        auto s = VRStorage::createFromStore(e);
+        if (!s) { check("restore " + e->get_name(), false); continue; }
+        s->load(e);
+        restored.push_back(s);
+        if (auto o = dynamic_pointer_cast<VRObject>(s)) bin2->requestGeometries(o);
+        if (auto g = dynamic_pointer_cast<VRGeometry>(s)) if (g->getBaseName() == "binaryGeo") geo2 = g;
+    }
+    bin2->loadPendingGeometries();
+    check("restored mesh", geo2 && sameMesh(geo2->getMesh()));
+
+    auto bin3 = VRSceneBinary::create();
+    xmlpp::Document doc3;
+    auto objectsN3 = doc3.create_root_node("Scene", "", "VRF")->add_child("Objects");
+    for (auto s : restored) {
+        if (auto o = dynamic_pointer_cast<VRObject>(s)) bin3->addGeometries(o);
+        s->saveUnder(objectsN3);
+    }
+    bin3->write(path + ".3", doc3);
+    check("re-save DOM", doc.write_to_string() == doc3.write_to_string());
+    check("re-save file", readFile(path) == readFile(path + ".3"));
+
+    // XML conversion round trip
+    VRSceneBinary::convertToXML(path, path + ".xml");
+    VRSceneBinary::convertToBinary(path + ".xml", path + ".2");
+    auto bin4 = VRSceneBinary::create();
+    xmlpp::Document doc4;
+    check("XML conversion", bin4->read(path + ".2", doc4) && doc.write_to_string() == doc4.write_to_string());
+    check("XML conversion mesh", sameMesh(bin4->getGeometry(0)));
+
+    cout << "sceneBinaryRoundtrip " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "core/scene/import/VRImport.h"
+#include "core/scene/import/VRImportCache.h"
+#include "core/utils/toString.h"
+#include "core/objects/VRTransform.h"
+#include "core/objects/geometry/VRGeometry.h"
+#include "core/objects/geometry/VRGeoData.h"
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/filesystem.hpp>
+#include <OpenSG/OSGSceneFileHandler.h>
+#include <OpenSG/OSGGeometry.h>
+#include <OpenSG/OSGThread.h>
+#include <functional>
+#include <fstream>
+#include <unistd.h>
+void importCache() {
+    string path = "/tmp/polyvr_cache_test.obj";
+    auto writeObj = [&](int N) {
+        ofstream f(path);
+        for (int i=0; i<N; i++) f << "v " << i << " 0 0\nv " << i << " 1 0\nv " << i+1 << " 0 0\n";
+        for (int i=0; i<N; i++) f << "f " << 3*i+1 << " " << 3*i+2 << " " << 3*i+3 << "\n";
+    };
+
+    auto cache = VRImport::get()->getDiskCache();
+    string folder = cache->getFolder();
+    cache->setFolder("/tmp/polyvr_cache_test");
+    cache->setMinFileSize(0);
+    cache->clear();
+
+    bool passed = true;
+    auto check = [&](string what, bool b) {
+        cout << " importCache " << what << (b ? " passed" : " FAILED") << endl;
+        passed = passed && b;
+    };
+
+    auto load = [&]() {
+        auto res = VRTransform::create("proxy");
+        VRImport::LoadJob job(path, "OSG", res, VRImport::get()->getProgressObject(), "");
+        job.load(VRThreadWeakPtr());
+        return res;
+    };
+
+    auto describe = [](VRTransformPtr res) { // object types, names and vertices
+        vector<string> objects;
+        vector<Pnt3d> positions;
+        for (auto o : res->getChildren(true)) {
+            objects.push_back(o->getType() + " " + o->getBaseName());
+            auto geo = dynamic_pointer_cast<VRGeometry>(o);
+            if (!geo) continue;
+            VRGeoData data(geo);
+            for (int i=0; i<data.size(); i++) positions.push_back(data.getPosition(i));
+        }
+        return make_pair(objects, positions);
+    };
+
+    auto equal = [&](VRTransformPtr a, VRTransformPtr b) {
+        auto A = describe(a);
+        auto B = describe(b);
+        if (A.first != B.first || A.second.size() != B.second.size()) return false;
+        for (unsigned int i=0; i<A.second.size(); i++) if ((A.second[i] - B.second[i]).length() > 1e-6) return false;
+        return A.second.size() > 0;
+    };
+
+    writeObj(10);
+    auto r0 = load();
+    check("miss", cache->getMisses() == 1 && cache->getHits() == 0);
+    auto r1 = load();
+    check("hit", cache->getMisses() == 1 && cache->getHits() == 1);
+    check("same objects and geometry", equal(r0, r1));
+
+    sleep(1); // mtime resolution
+    writeObj(20);
+    auto r2 = load();
+    check("invalidation", cache->getMisses() == 2 && cache->getHits() == 1 && !equal(r0, r2));
+
+    // concurrent jobs, hashing, cache lookups, loading and cache writes run in parallel, only the commit of the OpenSG changes is serialized
+    auto positions = [](Node* n) {
+        vector<Pnt3f> res;
+        function<void(Node*)> collect = [&](Node* n) {
+            auto g = dynamic_cast<Geometry*>(n->getCore());
+            if (g && g->getPositions()) for (unsigned int i=0; i<g->getPositions()->size(); i++) res.push_back(g->getPositions()->getValue<Pnt3f>(i));
+            for (unsigned int i=0; i<n->getNChildren(); i++) collect(n->getChild(i));
+        };
+        if (n) collect(n);
+        return res;
+    };
+
+    auto sameTypes = [](const vector<VRImportCache::ObjectType>& a, const vector<VRImportCache::ObjectType>& b) {
+        if (a.size() != b.size()) return false;
+        for (unsigned int i=0; i<a.size(); i++) if (a[i].node != b[i].node || a[i].type != b[i].type || a[i].name != b[i].name) return false;
+        return true;
+    };
+
+    string key = cache->getKey(path, "OSG", "");
+    vector<VRImportCache::ObjectType> refTypes;
+    NodeMTRecPtr refNode = cache->lookup(key, refTypes); // entry of the last load
+    auto refPositions = positions(refNode);
+    check("reference entry", refNode && refTypes.size() > 0 && refPositions.size() > 0);
+
+    struct JobResult {
+        NodeMTRecPtr node;
+        vector<VRImportCache::ObjectType> types;
+        string key;
+    };
+
+    int Njobs = 8;
+    cache->clear();
+    boost::mutex commitMtx;
+    vector<JobResult> results(Njobs);
+    auto job = [&](int i) {
+        ExternalThreadRefPtr osgThread = ExternalThread::get(("importCacheJob" + toString(i)).c_str(), false);
+        osgThread->initialize(0);
+
+        JobResult& r = results[i];
+        r.key = cache->getKey(path, "OSG", "");
+        NodeMTRecPtr n = cache->lookup(r.key, r.types);
+        if (!n) { // miss, load and write the entry, other jobs may write the same entry at the same time
+            n = SceneFileHandler::the()->read(path.c_str());
+            r.types = refTypes;
+            cache->store(r.key, n, r.types);
+        }
+
+        boost::mutex::scoped_lock lock(commitMtx);
+        commitChanges();
+        r.node = n;
+    };
+    vector<boost::thread*> jobs;
+    for (int i=0; i<Njobs; i++) jobs.push_back( new boost::thread(job, i) );
+    for (auto j : jobs) { j->join(); delete j; }
+
+    bool same = true;
+    for (auto& r : results) same = same && r.key == key && sameTypes(r.types, refTypes) && positions(r.node) == refPositions;
+    check("concurrent jobs", cache->getMisses() >= 1 && cache->getMisses() + cache->getHits() == Njobs && same);
+
+    // one complete entry, no leftovers of the concurrent writes
+    vector<string> files;
+    boost::system::error_code ec;
+    for (boost::filesystem::directory_iterator i(cache->getFolder(), ec), end; i != end; i.increment(ec)) files.push_back(i->path().filename().string());
+    sort(files.begin(), files.end());
+    vector<string> expected = { "index", key + ".osb", key + ".types" };
+    sort(expected.begin(), expected.end());
+    check("concurrent writes leave one entry", files == expected);
+
+    vector<VRImportCache::ObjectType> types;
+    NodeMTRecPtr entry = cache->lookup(key, types);
+    check("concurrent entry not corrupt", entry && sameTypes(types, refTypes) && positions(entry) == refPositions && cache->getSize() > 0);
+
+    cache->setMaxSize(0);
+    cache->evict();
+    check("eviction", cache->getSize() == 0);
+
+    cache->setMaxSize(size_t(4) << 30);
+    cache->setMinFileSize(size_t(1) << 20);
+    cache->setFolder(folder);
+    cout << "importCache " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "core/math/VRVertexWelder.h"
+#include "core/utils/VRTimer.h"
+#include <random>
+void vertexWelder() {
+    mt19937 rng(42);
+    uniform_real_distribution<float> u(0,1);
+    bool passed = true;
+
+    for (int trial=0; trial<20; trial++) { // random meshes with jittered duplicates
+        float t = 0.005 + 0.02*u(rng);
+        vector<Vec3f> P;
+        for (int i=0; i<3000; i++) {
+            Vec3f p(u(rng), u(rng), u(rng));
+            P.push_back(p);
+            if (u(rng) < 0.3) P.push_back(p + Vec3f(u(rng), u(rng), u(rng))*t*0.5);
+        }
+
+        VRVertexWelder welder(t);
+        welder.weld(P);
+        bool same = (welder.getMapping() == VRVertexWelder::weldBruteForce(P, t));
+        if (!same) cout << " vertexWelder trial " << trial << " differs from brute force!" << endl;
+        passed = passed && same;
+    }
+
+    { // huge coordinates and a tiny tolerance, the cell coordinates leave the int range
+        float t = 1e-6;
+        vector<Vec3f> P;
+        for (int i=0; i<2000; i++) {
+            Vec3f p = Vec3f(u(rng), u(rng), u(rng))*2e5 - Vec3f(1e5, 1e5, 1e5);
+            P.push_back(p);
+            if (u(rng) < 0.3) P.push_back(p);
+        }
+
+        VRVertexWelder welder(t);
+        welder.weld(P);
+        bool same = (welder.getMapping() == VRVertexWelder::weldBruteForce(P, t));
+        if (!same) cout << " vertexWelder with huge coordinates differs from brute force!" << endl;
+        passed = passed && same;
+    }
+
+    vector<Vec3f> P;
+    for (int i=0; i<2000000; i++) P.push_back(Vec3f(u(rng), u(rng), u(rng)));
+    VRTimer timer;
+    timer.start();
+    VRVertexWelder welder(1e-4);
+    welder.weld(P);
+    cout << " vertexWelder welded " << P.size() << " vertices to " << welder.size() << " in " << timer.stop() << " ms" << endl;
+    cout << "vertexWelder " << (passed ? "passed" : "FAILED") << endl;
+}
+
+void geoDataBulk() {
+    int N = 1000; // N x N grid of quads
+    VRTimer timer;
+
+    timer.start();
+    VRGeoData single;
+    for (int i=0; i<N; i++) {
+        for (int j=0; j<N; j++) single.pushVert(Pnt3d(i,0,j), Vec3d(0,1,0));
+    }
+    for (int i=0; i<N-1; i++) {
+        for (int j=0; j<N-1; j++) single.pushQuad(i*N+j, i*N+j+1, (i+1)*N+j+1, (i+1)*N+j);
+    }
+    int t1 = timer.stop();
+
+    timer.start();
+    VRGeoData bulk;
+    vector<Pnt3f> pos(N*N);
+    vector<Vec3f> norms(N*N, Vec3f(0,1,0));
+    vector<int> inds;
+    inds.reserve((N-1)*(N-1)*4);
+    for (int i=0; i<N; i++) {
+        for (int j=0; j<N; j++) pos[i*N+j] = Pnt3f(i,0,j);
+    }
+    for (int i=0; i<N-1; i++) {
+        for (int j=0; j<N-1; j++) {
+            inds.push_back(i*N+j); inds.push_back(i*N+j+1);
+            inds.push_back((i+1)*N+j+1); inds.push_back((i+1)*N+j);
+        }
+    }
+    bulk.reserve(N*N, inds.size());
+    int o = bulk.pushVerts(pos, norms);
+    bulk.pushPrims(GL_QUADS, inds, o);
+    int t2 = timer.stop();
+
+    timer.start();
+    VRGeoData merged;
+    for (int k=0; k<4; k++) merged.append(bulk);
+    int t3 = timer.stop();
+
+    bool same = single.size() == bulk.size() && single.getNIndices() == bulk.getNIndices();
+    same = same && merged.size() == 4*bulk.size() && merged.getNIndices() == 4*bulk.getNIndices();
+
+    // the attributes have to stay aligned with the positions
+    bool aligned = bulk.getDataSize(4) == bulk.size() && merged.getDataSize(4) == merged.size();
+    VRGeoData mixed;
+    for (int i=0; i<3; i++) mixed.pushVert(Pnt3d(i,0,0), Vec3d(0,0,1));
+    aligned = aligned && mixed.pushVerts(vector<Pnt3f>(5)) == 3 && mixed.getDataSize(4) == 8; // no normals passed, padded
+    aligned = aligned && mixed.pushVerts(vector<Pnt3f>(3), vector<Vec3f>(2)) == -1 && mixed.size() == 8; // wrong size, rejected
+    VRGeoData plain;
+    plain.pushVerts(vector<Pnt3d>(5));
+    aligned = aligned && plain.getDataSize(4) == 0;
+    aligned = aligned && plain.pushVerts(vector<Pnt3d>(2), vector<Vec3d>(2, Vec3d(1,0,0))) == 5 && plain.getDataSize(4) == 7;
+    aligned = aligned && plain.getNormal(6) == Vec3d(1,0,0);
+    if (!aligned) cout << " geoDataBulk attributes not aligned with the positions" << endl;
+    same = same && aligned;
+    cout << " geoDataBulk per vertex: " << t1 << " ms, bulk: " << t2 << " ms, append 4x: " << t3 << " ms" << endl;
+    cout << "geoDataBulk " << (same ? "passed" : "FAILED") << endl;
+}
+
+#include "core/tools/selection/VRPolygonSelection.h"
+#include "core/math/boundingbox.h"
+#include "core/utils/VRGlobals.h"
+#include <atomic>
+namespace OSG {
+class VRTestSphereSelection : public VRSelection { // growing volume for the incremental update
+    public:
+        Vec3d center;
+        double radius = 0;
+        atomic<int> tests;
+
+        VRTestSphereSelection() : tests(0) {}
+
+        bool vertSelected(Vec3d p) { tests++; return (p-center).length() <= radius; }
+
+        int boxSelected(const Boundingbox& box) {
+            Vec3d c = box.center() - center;
+            if (c.length() > radius + box.radius()) return 0;
+            return 1;
+        }
+
+        void update(bool grown) { volumeChanged(grown); updateSubselection(); }
+};
+}
+
+void selectionParallel() {
+    mt19937 rng(23);
+    uniform_real_distribution<float> u(0,1);
+    bool passed = true;
+
+    VRGeoData data;
+    for (int i=0; i<500000; i++) {
+        data.pushVert(Pnt3d(u(rng)*2-1, u(rng)*2-1, u(rng)*2-1));
+        data.pushPoint();
+    }
+    auto geo = data.asGeometry("selectionParallel");
+    geo->setFrom(Vec3d(0.2,0.1,0));
+    VRGlobals::CURRENT_FRAME++; // the mesh is older than the updates, they may be incremental
+
+    VRTimer timer;
+    int tSerial = 0, tParallel = 0;
+    for (int trial=0; trial<20; trial++) { // random concave polygon volumes
+        Pose origin(Vec3d(u(rng)-0.5, u(rng)-0.5, 4), Vec3d(0,0,-1));
+        int N = 3 + trial%6;
+        vector<float> angles, radii;
+        for (int i=0; i<N; i++) angles.push_back(u(rng)*2*M_PI);
+        for (int i=0; i<N; i++) radii.push_back(0.05 + 0.2*u(rng));
+        sort(angles.begin(), angles.end());
+
+        vector<VRPolygonSelectionPtr> sels;
+        for (int k=0; k<2; k++) {
+            auto sel = VRPolygonSelection::create();
+            sel->setParallel(k == 1);
+            sel->setOrigin(origin);
+            for (int i=0; i<N; i++) sel->addEdge(Vec3d(cos(angles[i])*radii[i], sin(angles[i])*radii[i], -1));
+            sels.push_back(sel);
+        }
+        timer.start();
+        sels[0]->close(geo);
+        auto r1 = sels[0]->getSubselection(geo);
+        tSerial += timer.stop();
+        timer.start();
+        sels[1]->close(geo);
+        auto r2 = sels[1]->getSubselection(geo);
+        tParallel += timer.stop();
+        if (r1 != r2) { cout << " selectionParallel polygon trial " << trial << " differs, " << r1.size() << " vs " << r2.size() << endl; passed = false; }
+        sels[1]->updateSubselection(); // unchanged volume, incremental by default
+        if (sels[1]->getSubselection(geo) != r2) { cout << " selectionParallel polygon trial " << trial << " differs after a second update" << endl; passed = false; }
+    }
+    cout << " selectionParallel polygon serial: " << tSerial << " ms, parallel: " << tParallel << " ms" << endl;
+
+    VRTestSphereSelection grow, full;
+    grow.add(geo);
+    full.add(geo);
+    full.setParallel(false);
+    for (int i=1; i<=10; i++) { // growing volume, incremental against full update
+        grow.radius = full.radius = 0.1*i;
+        grow.update(true);
+        full.update(false);
+        if (grow.getSubselection(geo) != full.getSubselection(geo)) { cout << " selectionParallel incremental step " << i << " differs" << endl; passed = false; }
+    }
+
+    int unselected = data.size() - grow.getSubselection(geo).size();
+    grow.tests = 0;
+    grow.updateSubselection(); // volume unchanged, only the unselected vertices are tested
+    if (grow.tests != unselected) { cout << " selectionParallel unchanged volume tested " << grow.tests << " vertices, expected " << unselected << endl; passed = false; }
+
+    grow.radius = full.radius = 0.5; // shrinking, everything is tested again
+    grow.update(false);
+    full.update(false);
+    if (grow.getSubselection(geo) != full.getSubselection(geo)) { cout << " selectionParallel shrinking differs" << endl; passed = false; }
+
+    VRGeoData deformed(geo); // same vertex count, moved vertices, the selection has to follow
+    for (int i=0; i<deformed.size(); i++) deformed.setPos(i, deformed.getPosition(i)*0.7);
+    deformed.apply(geo);
+    grow.updateSubselection(); // volume unchanged, but the mesh changed in this frame
+    full.update(false);
+    if (grow.getSubselection(geo) != full.getSubselection(geo)) { cout << " selectionParallel deformed mesh differs" << endl; passed = false; }
+    VRGlobals::CURRENT_FRAME++;
+    grow.updateSubselection();
+    if (grow.getSubselection(geo) != full.getSubselection(geo)) { cout << " selectionParallel deformed mesh differs in the next frame" << endl; passed = false; }
+
+    cout << "selectionParallel " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "core/objects/geometry/VRInstancedGeometry.h"
+#include "core/objects/material/VRMaterial.h"
+#include "core/scene/VRObjectManager.h"
+#include "core/objects/VRLod.h"
+#include "core/math/pose.h"
+void instancing() {
+    bool passed = true;
+    int N = 10000;
+
+    auto shelf = VRTransform::create("shelf"); // template with two materials
+    auto frame = VRGeometry::create("frame", "Box", "0.1 2 0.1 1 1 1");
+    auto board = VRGeometry::create("board", "Box", "1 0.05 0.5 1 1 1");
+    frame->setMaterial( VRMaterial::create("frameMat") );
+    board->setMaterial( VRMaterial::create("boardMat") );
+    board->setFrom(Vec3d(0,1,0));
+    shelf->addChild(frame);
+    shelf->addChild(board);
+
+    vector<PosePtr> poses;
+    for (int i=0; i<N; i++) poses.push_back( Pose::create(Vec3d((i%100)*2, 0, (i/100)*2)) );
+
+    auto traverse = [](VRObjectPtr root) {
+        VRTimer timer;
+        timer.start();
+        for (int k=0; k<10; k++) {
+            root->getChildren(true);
+            root->getNode()->node->invalidateVolume();
+            root->getBoundingbox();
+        }
+        return timer.stop();
+    };
+
+    auto copies = VRObjectManager::create("copies");
+    copies->addTemplate(shelf, "shelf");
+    VRTimer timer;
+    timer.start();
+    for (auto p : poses) copies->copy("shelf", p);
+    int tCopy = timer.stop();
+    int nCopy = copies->getChildren(true).size();
+    int tTravCopy = traverse(copies);
+
+    auto instanced = VRObjectManager::create("instanced");
+    instanced->addTemplate(shelf, "shelf");
+    timer.start();
+    for (auto p : poses) instanced->addInstance("shelf", p);
+    auto inst = instanced->getInstancer();
+    inst->update();
+    int tInst = timer.stop();
+    int nInst = instanced->getChildren(true).size();
+    int tTravInst = traverse(instanced);
+
+    cout << " instancing nodes, copies: " << nCopy << ", instanced: " << nInst << endl;
+    cout << " instancing build, copies: " << tCopy << " ms, instanced: " << tInst << " ms" << endl;
+    cout << " instancing 10x traversal, copies: " << tTravCopy << " ms, instanced: " << tTravInst << " ms" << endl;
+    if (nInst*10 > nCopy) { cout << " instancing node count not reduced" << endl; passed = false; }
+    if (inst->getInstanceCount() != N) { cout << " instancing wrong instance count " << inst->getInstanceCount() << endl; passed = false; }
+
+    Boundingbox box; // spatial query against brute force
+    box.update(Vec3d(15,-1,15));
+    box.update(Vec3d(61,1,33));
+    int expected = 0;
+    for (auto p : poses) if (box.isInside(p->pos())) expected++;
+    if (int(inst->getInstances(box).size()) != expected) { cout << " instancing box query failed" << endl; passed = false; }
+
+    if (inst->getMeshCount() != 2) { cout << " instancing meshes not shared, " << inst->getMeshCount() << " meshes" << endl; passed = false; }
+    if (inst->getBatchCount() != 200) { cout << " instancing expected one batch per cell and material, got " << inst->getBatchCount() << endl; passed = false; }
+
+    auto cellsBefore = inst->getChildren(true); // pose and attribute changes only write the instance buffers
+    inst->setInstancePose(5, Pose::create(Vec3d(11,0,1)));
+    inst->setInstanceAttribute(5, 3);
+    inst->update();
+    if (inst->getChildren(true) != cellsBefore) { cout << " instancing pose change rebuilt the cell" << endl; passed = false; }
+    if ((inst->getInstancePose(5)->pos() - Vec3d(11,0,1)).length() > 1e-6 || inst->getInstanceAttribute(5) != 3) { cout << " instancing pose change lost" << endl; passed = false; }
+
+    int hit = inst->getInstance( Line(Pnt3f(42.2,10,86.1), Vec3f(0,-1,0)) ); // board of the shelf at 42,0,86
+    if (hit < 0 || (inst->getInstancePose(hit)->pos() - Vec3d(42,0,86)).length() > 1e-6) { cout << " instancing picking failed" << endl; passed = false; }
+    if (inst->getInstance( Line(Pnt3f(43,10,87), Vec3f(0,-1,0)) ) != -1) { cout << " instancing picked between the shelves" << endl; passed = false; }
+
+    auto far = VRInstancedGeometry::create("far"); // cells 2^21 apart got the same key with 21 bits per axis
+    int fp = far->addPrototype(shelf);
+    far->addInstance(fp, Pose::create(Vec3d(1,0,1)));
+    far->addInstance(fp, Pose::create(Vec3d(1+20.0*(1<<21),0,1)));
+    far->update();
+    Boundingbox origin;
+    origin.update(Vec3d(-5,-5,-5));
+    origin.update(Vec3d(5,5,5));
+    if (far->getChildren().size() != 2 || far->getInstances(origin).size() != 1) { cout << " instancing distant cells collide" << endl; passed = false; }
+
+    auto lodShelf = VRTransform::create("lodShelf"); // the detail levels of the template switch per cell
+    auto lod = VRLod::create("lod");
+    lodShelf->addChild(lod);
+    lod->addChild(shelf->duplicate());
+    lod->addChild(frame->duplicate());
+    lod->addDistance(30);
+    auto lodded = VRInstancedGeometry::create("lodded");
+    int lp = lodded->addPrototype(lodShelf);
+    for (auto p : poses) lodded->addInstance(lp, p);
+    lodded->update();
+    auto cell = lodded->getChild(0);
+    if (lodded->getMeshCount() != 3 || !cell || cell->getType() != "Lod" || static_pointer_cast<VRLod>(cell)->getDistances() != vector<float>({30})) {
+        cout << " instancing lost the detail levels" << endl; passed = false;
+    }
+
+    cout << "instancing " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "core/math/path.h"
+#include "core/math/VRSegmentBVH.h"
+void pathBVH() {
+    mt19937 rng(7);
+    uniform_real_distribution<double> u(-1,1);
+    bool passed = true;
+
+    auto p = path::create(); // long road like path
+    Vec3d x;
+    for (int i=0; i<200; i++) {
+        x += Vec3d(10+5*u(rng), u(rng), 10*u(rng));
+        p->addPoint( Pose(x, Vec3d(1,0,0.3*u(rng))) );
+    }
+    p->compute(80);
+    auto positions = p->getPositions();
+
+    vector<Vec3d> queries;
+    for (int i=0; i<20000; i++) queries.push_back( Vec3d(1000+1000*u(rng), 5*u(rng), 100*u(rng)) );
+
+    VRTimer timer;
+    timer.start();
+    vector<float> linear;
+    for (auto& q : queries) {
+        auto r = VRSegmentBVH::closestLinear(positions, q);
+        linear.push_back( (float(r.segment)+r.t)/(positions.size()-1) );
+    }
+    int tLinear = timer.stop();
+
+    timer.start();
+    vector<float> single;
+    for (auto& q : queries) single.push_back( p->getClosestPoint(q) );
+    int tSingle = timer.stop();
+
+    timer.start();
+    auto batched = p->getClosestPoints(queries);
+    int tBatched = timer.stop();
+
+    if (single != linear) { cout << " pathBVH closest points differ from linear scan" << endl; passed = false; }
+    if (batched != linear) { cout << " pathBVH batched closest points differ from linear scan" << endl; passed = false; }
+    auto dists = p->getDistances(queries);
+    for (unsigned int i=0; i<queries.size(); i++) {
+        float d = sqrt(VRSegmentBVH::closestLinear(positions, queries[i]).dist2);
+        if (d != dists[i] || d != p->getDistance(queries[i])) { cout << " pathBVH distance differs from linear scan" << endl; passed = false; break; }
+    }
+
+    cout << " pathBVH " << queries.size() << " queries on " << positions.size() << " samples, linear: " << tLinear << " ms, bvh: " << tSingle << " ms, batched: " << tBatched << " ms" << endl;
+    cout << "pathBVH " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "addons/WorldGenerator/terrain/VRTerrain.h"
+#include "core/objects/material/VRTexture.h"
+#include "core/objects/material/VRTextureGenerator.h"
+void terrainHeights() {
+    mt19937 rng(11);
+    uniform_real_distribution<double> u(-1,1);
+    bool passed = true;
+
+    int R = 512;
+    VRTextureGenerator tg;
+    tg.setSize(Vec3i(R,R,1), true);
+    auto tex = tg.compose(0);
+    for (int i=0; i<R; i++) {
+        for (int j=0; j<R; j++) {
+            float h = 20*sin(i*0.03)*cos(j*0.02) + u(rng);
+            tex->setPixel(Vec3i(i,j,0), Color4f(1,1,1,h));
+        }
+    }
+
+    auto terrain = VRTerrain::create("testTerrain");
+    terrain->setParameters(Vec2d(1000,1000), 2, 1);
+    terrain->setMap(tex);
+
+    auto road = [&](double z, double d) { // embankment between two road borders
+        auto p = path::create();
+        p->addPoint( Pose(Vec3d(-200*d,30,z), Vec3d(d,0,0)) );
+        p->addPoint( Pose(Vec3d(200*d,30,z), Vec3d(d,0,0)) );
+        p->compute(32);
+        return p;
+    };
+    terrain->addEmbankment("e1", road(-10,1), road(10,-1), road(-20,1), road(20,-1));
+
+    vector<Vec2d> pnts;
+    for (int i=0; i<200000; i++) pnts.push_back( Vec2d(550*u(rng), 550*u(rng)) );
+
+    for (bool useEmbankments : {false, true}) {
+        VRTimer timer;
+        timer.start();
+        vector<double> single;
+        for (auto& p : pnts) single.push_back( terrain->getHeight(p, useEmbankments) );
+        int tSingle = timer.stop();
+
+        timer.start();
+        auto batched = terrain->getHeights(pnts, useEmbankments);
+        int tBatched = timer.stop();
+
+        if (batched != single) { cout << " terrainHeights batched heights differ from getHeight" << endl; passed = false; }
+        cout << " terrainHeights " << pnts.size() << " points, embankments: " << useEmbankments << ", getHeight: " << tSingle << " ms, getHeights: " << tBatched << " ms" << endl;
+    }
+
+    vector<Vec3d> pnts3;
+    for (auto& p : pnts) pnts3.push_back( Vec3d(p[0], 0, p[1]) );
+    terrain->elevatePoints(pnts3, 1.5);
+    for (unsigned int i=0; i<pnts.size(); i++) {
+        if (pnts3[i][1] != terrain->getHeight(pnts[i]) + 1.5f) { cout << " terrainHeights elevatePoints differs from elevatePoint" << endl; passed = false; break; }
+    }
+
+    cout << "terrainHeights " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "addons/Algorithms/VRGraphLayout.h"
+#include "addons/Algorithms/VRBarnesHut.h"
+#include "core/math/graph.h"
+void graphLayout() {
+    mt19937 rng(5);
+    uniform_real_distribution<double> u(-1,1);
+    bool passed = true;
+
+    auto randomGraph = [&](int N, double extent) { // random tree plus shortcuts
+        auto g = Graph::create();
+        for (int i=0; i<N; i++) {
+            int n = g->addNode();
+            g->setPosition(n, Pose::create( Vec3d(u(rng), u(rng), u(rng))*extent ));
+        }
+        for (int i=1; i<N; i++) g->connect(int((u(rng)*0.5+0.5)*(i-1)), i);
+        for (int i=0; i<N/2; i++) {
+            int a = (u(rng)*0.5+0.5)*(N-1);
+            int b = (u(rng)*0.5+0.5)*(N-1);
+            if (a != b) g->connect(a, b);
+        }
+        return g;
+    };
+
+    // energy of the approximation against the exact sum
+    auto small = randomGraph(80, 5);
+    vector<Vec3d> start;
+    for (int i=0; i<small->size(); i++) start.push_back( small->getPosition(i)->pos() );
+
+    auto layout = VRGraphLayout::create();
+    layout->setAlgorithm(VRGraphLayout::FORCES);
+    layout->setGraph(small);
+    double E0 = layout->getEnergy();
+    double E0bh = layout->getEnergy(0.8);
+    if (abs(E0bh-E0) > 0.01*abs(E0)) { cout << " graphLayout Barnes-Hut energy " << E0bh << " differs from exact energy " << E0 << endl; passed = false; }
+
+    double energies[2];
+    float thetas[2] = {0, 0.8};
+    for (int k=0; k<2; k++) {
+        for (int i=0; i<small->size(); i++) {
+            small->getNode(i).box.clear();
+            small->setPosition(i, Pose::create(start[i]));
+        }
+        layout->setGraph(small);
+        layout->setTheta(thetas[k]);
+        int steps = layout->compute(1000, 1e-3);
+        energies[k] = layout->getEnergy();
+        cout << " graphLayout theta " << thetas[k] << ", energy " << E0 << " -> " << energies[k] << " after " << steps << " steps" << endl;
+        if (steps >= 1000) { cout << " graphLayout did not converge" << endl; passed = false; }
+        if (energies[k] >= E0) { cout << " graphLayout energy did not decrease" << endl; passed = false; }
+    }
+    if (abs(energies[1]-energies[0]) > 0.1*energies[0]) { cout << " graphLayout Barnes-Hut layout energy differs from exact layout" << endl; passed = false; }
+
+    // large random graph
+    auto big = randomGraph(50000, 100);
+    layout->setGraph(big);
+    layout->setTheta(0.8);
+    VRTimer timer;
+    timer.start();
+    int steps = layout->compute(10, 1e-3);
+    int tBH = timer.stop();
+
+    vector<Vec3d> P;
+    vector<float> M(2000, 1);
+    for (int i=0; i<2000; i++) P.push_back( big->getPosition(i)->pos() );
+    timer.start();
+    for (int i=0; i<2000; i++) VRBarnesHut::fieldExact(P, M, P[i], i);
+    int tExact = timer.stop();
+
+    cout << " graphLayout " << big->size() << " nodes, " << big->getNEdges() << " edges, " << steps << " steps in " << tBH << " ms";
+    cout << ", exact repulsion on 2000 nodes: " << tExact << " ms per step" << endl;
+    cout << "graphLayout " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "addons/Bullet/Fluids/VRSPHSolver.h"
+void sphDamBreak() {
+    bool passed = true;
+
+    // water column of 0.4 x 0.6 x 0.3 m in a 1.6 m long tank
+    auto solver = VRSPHSolver::create();
+    float spacing = 0.04;
+    solver->setKernelRadius(2*spacing);
+    solver->setTimeStep(0.001);
+    solver->setDomain(Vec3d(0,0,0), Vec3d(1.6,1,0.3));
+    int N = solver->spawnCuboid(Vec3d(0,0,0), Vec3d(0.4,0.6,0.3), spacing);
+
+    VRTimer timer;
+    timer.start();
+    int steps = 0;
+    float vmax = 0;
+    for (int k=0; k<6; k++) {
+        for (int i=0; i<250; i++) solver->step();
+        steps += 250;
+        vmax = max(vmax, solver->getMaxSpeed());
+        cout << " sphDamBreak t " << steps*solver->getTimeStep() << " s, max speed " << solver->getMaxSpeed() << ", average density " << solver->getAverageDensity() << endl;
+    }
+    int t = timer.stop();
+
+    // the front can not be faster than 2 sqrt(g H) by much, everything stays in the tank
+    float front = 0;
+    for (int i=0; i<N; i++) {
+        Vec3d p = solver->getPosition(i);
+        if (p[0] != p[0] || p[1] != p[1] || p[2] != p[2]) { cout << " sphDamBreak particle " << i << " is NaN" << endl; passed = false; break; }
+        if (p[0] < 0 || p[0] > 1.6 || p[1] < 0 || p[1] > 1 || p[2] < 0 || p[2] > 0.3) { cout << " sphDamBreak particle " << i << " left the tank" << endl; passed = false; break; }
+        front = max(front, float(p[0]));
+    }
+    float rho = solver->getAverageDensity();
+    if (vmax > 10) { cout << " sphDamBreak unstable, max speed " << vmax << endl; passed = false; }
+    if (rho < 800 || rho > 1100) { cout << " sphDamBreak average density " << rho << " is off" << endl; passed = false; }
+    if (front < 1.0) { cout << " sphDamBreak front only reached " << front << endl; passed = false; }
+
+    cout << " sphDamBreak " << N << " particles, " << steps << " steps in " << t << " ms, " << N*double(steps)/max(t,1)*1000 << " particle updates per second" << endl;
+    cout << "sphDamBreak " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "addons/Engineering/Milling/VRMillingDexels.h"
+void millingDexels() {
+    bool passed = true;
+    float R = 0.005, D = 0.01, L = 0.04, top = 0.04;
+
+    // 10 x 4 x 10 cm stock with 0.25 mm dexels
+    auto dexels = VRMillingDexels::create();
+    dexels->init(Vec3d(0,0,0), Vec3d(0.1,top,0.1), 0.00025);
+    double V0 = dexels->getVolume();
+    vector<VRMillingDexels::Mesh> meshes;
+    VRTimer timer;
+    timer.start();
+    dexels->remesh(meshes);
+    int tFull = timer.stop();
+
+    auto check = [&](string name, double removed, double expected) {
+        double err = abs(removed-expected)/expected;
+        cout << " millingDexels " << name << " removed " << removed*1e6 << " cm3, expected " << expected*1e6 << " cm3, error " << err*100 << " %" << endl;
+        if (err > 0.02) { cout << " millingDexels " << name << " volume is off" << endl; passed = false; }
+    };
+
+    // flat end mill, plunge and straight slot, the pocket is a stadium
+    vector<Vec2d> flat = { Vec2d(0,R), Vec2d(0.03,R) };
+    dexels->setTool(flat);
+    timer.start();
+    dexels->cutPath({ Vec3d(0.03,top+0.01,0.03), Vec3d(0.03,top-D,0.03), Vec3d(0.03+L,top-D,0.03) });
+    int tCut = timer.stop();
+    double V1 = dexels->getVolume();
+    check("slot", V0-V1, D*(2*R*L + M_PI*R*R));
+
+    int dirty = dexels->getDirtyTiles().size();
+    timer.start();
+    dexels->remesh(meshes);
+    int tDirty = timer.stop();
+    cout << " millingDexels remeshed " << dirty << " of " << dexels->getTileCount() << " tiles in " << tDirty << " ms, full mesh " << tFull << " ms" << endl;
+    if (dirty == 0 || dirty >= dexels->getTileCount()) { cout << " millingDexels wrong dirty tiles" << endl; passed = false; }
+
+    // ball end mill, plunge
+    vector<Vec2d> ball;
+    float Rb = 0.004;
+    for (int i=0; i<=64; i++) {
+        float a = M_PI*0.5*i/64;
+        ball.push_back( Vec2d(Rb*(1-cos(a)), Rb*sin(a)) );
+    }
+    ball.push_back( Vec2d(0.03,Rb) );
+    dexels->setTool(ball);
+    dexels->cutSegment(Vec3d(0.05,top+0.01,0.07), Vec3d(0.05,top-D,0.07));
+    double V2 = dexels->getVolume();
+    check("ball plunge", V1-V2, M_PI*Rb*Rb*(D-Rb) + 2.0/3*M_PI*Rb*Rb*Rb);
+
+    // zig zag facing of the whole top, 0.5 mm deep, the slot and the hole are already open there
+    dexels->setTool(flat);
+    vector<Vec3d> path;
+    for (int k=0; k<=12; k++) {
+        float z = -0.005 + k*0.009;
+        path.push_back(Vec3d(k%2 ? 0.11 : -0.01, top-0.0005, z));
+        path.push_back(Vec3d(k%2 ? -0.01 : 0.11, top-0.0005, z));
+    }
+    timer.start();
+    int rays = dexels->cutPath(path);
+    int tFace = timer.stop();
+    check("facing", V2-dexels->getVolume(), (0.1*0.1 - 2*R*L - M_PI*R*R - M_PI*Rb*Rb)*0.0005);
+
+    timer.start();
+    dexels->remesh(meshes);
+    int tMesh = timer.stop();
+    size_t quads = 0;
+    for (auto& m : meshes) quads += m.positions.size()/4;
+    cout << " millingDexels slot cut in " << tCut << " ms, facing " << path.size()-1 << " moves updated " << rays << " rays in " << tFace << " ms, remesh " << quads << " quads in " << tMesh << " ms" << endl;
+    cout << "millingDexels " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "addons/CaveKeeper/CKVoxelWorld.h"
+void voxelMeshing() {
+    bool passed = true;
+
+    // rolling terrain of two block types with some caves
+    auto world = CKVoxelWorld::create();
+    int W = 96;
+    for (int x=0; x<W; x++) {
+        for (int z=0; z<W; z++) {
+            int h = 24 + 8*sin(x*0.1)*cos(z*0.13);
+            for (int y=0; y<h; y++) world->setBlock(Vec3i(x,y,z), y < 12 ? 2 : 1);
+        }
+    }
+    mt19937 rng(7);
+    uniform_int_distribution<int> rx(0, W-1), ry(4, 28);
+    for (int i=0; i<20; i++) world->dig(Vec3i(rx(rng), ry(rng), rx(rng)), 4);
+
+    // closed surfaces enclose exactly the blocks, the divergence theorem gives the volume
+    auto volume = [](const CKVoxelWorld::Mesh& m) {
+        double V = 0;
+        for (unsigned int i=0; i+2<m.indices.size(); i+=3) {
+            Vec3d a(m.positions[m.indices[i]]), b(m.positions[m.indices[i+1]]), c(m.positions[m.indices[i+2]]);
+            V += a.dot(b.cross(c))/6;
+        }
+        return V;
+    };
+
+    auto area = [](const CKVoxelWorld::Mesh& m) {
+        double A = 0;
+        for (unsigned int i=0; i+2<m.indices.size(); i+=3) {
+            Vec3d a(m.positions[m.indices[i]]), b(m.positions[m.indices[i+1]]), c(m.positions[m.indices[i+2]]);
+            A += (b-a).cross(c-a).length()*0.5;
+        }
+        return A;
+    };
+
+    size_t faces = 0; // brute force count of visible faces
+    Vec3i dirs[6] = { Vec3i(1,0,0), Vec3i(-1,0,0), Vec3i(0,1,0), Vec3i(0,-1,0), Vec3i(0,0,1), Vec3i(0,0,-1) };
+    for (int x=-1; x<=W; x++) for (int y=-1; y<=40; y++) for (int z=-1; z<=W; z++) {
+        Vec3i p(x,y,z);
+        if (!world->getBlock(p)) continue;
+        for (auto d : dirs) if (!world->getBlock(p+d)) faces++;
+    }
+
+    map<long long, CKVoxelWorld::Mesh> chunks;
+    vector<CKVoxelWorld::Mesh> meshes;
+    VRTimer timer;
+    timer.start();
+    auto keys = world->remesh(meshes);
+    int tGreedy = timer.stop();
+    for (unsigned int i=0; i<keys.size(); i++) chunks[keys[i]] = meshes[i];
+
+    size_t triGreedy = 0, triNaive = 0;
+    double Vg = 0, Ag = 0, Vn = 0;
+    timer.start();
+    for (auto& c : chunks) {
+        CKVoxelWorld::Mesh naive;
+        world->meshChunk(c.first, naive, false);
+        triNaive += naive.indices.size()/3;
+        Vn += volume(naive);
+    }
+    int tNaive = timer.stop();
+    for (auto& c : chunks) {
+        triGreedy += c.second.indices.size()/3;
+        Vg += volume(c.second);
+        Ag += area(c.second);
+    }
+
+    double blocks = world->getBlockCount();
+    cout << " voxelMeshing " << blocks << " blocks in " << world->getChunkCount() << " chunks, " << faces << " visible faces" << endl;
+    cout << " voxelMeshing naive " << triNaive << " triangles in " << tNaive << " ms, greedy " << triGreedy << " triangles in " << tGreedy << " ms" << endl;
+    if (triNaive != 2*faces) { cout << " voxelMeshing naive mesh has " << triNaive << " triangles, expected " << 2*faces << endl; passed = false; }
+    if (abs(Ag - faces) > 1e-3*faces) { cout << " voxelMeshing greedy area " << Ag << " differs from face count" << endl; passed = false; }
+    if (abs(Vg - blocks) > 1e-3*blocks || abs(Vn - blocks) > 1e-3*blocks) { cout << " voxelMeshing mesh not closed, volumes " << Vg << " " << Vn << endl; passed = false; }
+    if (triGreedy >= triNaive) { cout << " voxelMeshing greedy meshing did not reduce triangles" << endl; passed = false; }
+
+    // random digging, only the touched chunks are meshed again
+    int digs = 200;
+    size_t remeshed = 0;
+    timer.start();
+    for (int i=0; i<digs; i++) {
+        world->dig(Vec3i(rx(rng), ry(rng), rx(rng)), 3);
+        keys = world->remesh(meshes);
+        remeshed += keys.size();
+        for (unsigned int j=0; j<keys.size(); j++) chunks[keys[j]] = meshes[j];
+    }
+    int tDig = timer.stop();
+
+    Vg = 0;
+    for (auto& c : chunks) Vg += volume(c.second);
+    blocks = world->getBlockCount();
+    if (abs(Vg - blocks) > 1e-3*blocks) { cout << " voxelMeshing incremental meshes volume " << Vg << " differs from " << blocks << " blocks" << endl; passed = false; }
+    cout << " voxelMeshing " << digs << " digs with remeshing in " << tDig << " ms, " << float(remeshed)/digs << " chunks per dig" << endl;
+
+    // lanterns in caves, only faces of the same light are merged, greedy and naive meshes carry the same light
+    auto lightSum = [](const CKVoxelWorld::Mesh& m) {
+        double L = 0;
+        for (unsigned int i=0; i+3<m.positions.size(); i+=4) {
+            Vec3d a(m.positions[i]), b(m.positions[i+1]), d(m.positions[i+3]);
+            double c = 0;
+            for (int q=0; q<4; q++) c += m.colors[i+q][0]*0.25;
+            L += (b-a).cross(d-a).length()*c;
+        }
+        return L;
+    };
+
+    Vec3i lanterns[2] = { Vec3i(W/2, 18, W/2), Vec3i(20, 10, 30) };
+    for (auto l : lanterns) {
+        world->dig(l, 5);
+        world->addLight(Vec3f(l));
+    }
+    keys = world->remesh(meshes);
+    for (unsigned int j=0; j<keys.size(); j++) chunks[keys[j]] = meshes[j];
+    double Lg = 0, Ln = 0;
+    float Lmax = 0;
+    triGreedy = triNaive = 0;
+    for (auto& c : chunks) {
+        CKVoxelWorld::Mesh naive;
+        world->meshChunk(c.first, naive, false);
+        if (c.second.colors.size() != c.second.positions.size()) { cout << " voxelMeshing mesh without a light per vertex" << endl; passed = false; }
+        for (auto& l : c.second.colors) Lmax = max(Lmax, l[0]);
+        Lg += lightSum(c.second);
+        Ln += lightSum(naive);
+        triGreedy += c.second.indices.size()/3;
+        triNaive += naive.indices.size()/3;
+    }
+    cout << " voxelMeshing lit greedy " << triGreedy << " triangles, naive " << triNaive << ", brightest vertex " << Lmax << endl;
+    if (Lmax <= 0.2) { cout << " voxelMeshing lanterns do not light the cave" << endl; passed = false; }
+    if (abs(Lg - Ln) > 1e-3*Ln) { cout << " voxelMeshing greedy light " << Lg << " differs from naive light " << Ln << endl; passed = false; }
+
+    // BlockWorld meshes a snapshot of the dirty chunks in a worker thread, it has to give the meshes of the world
+    for (int i=0; i<10; i++) world->dig(Vec3i(rx(rng), ry(rng), rx(rng)), 3);
+    auto dirty = world->getDirtyChunks();
+    map<long long, CKVoxelWorld::Mesh> direct;
+    for (auto k : dirty) world->meshChunk(k, direct[k]);
+    auto snapshot = world->extractDirty();
+    vector<long long> snapKeys;
+    boost::thread worker([&]() { snapKeys = snapshot->remesh(meshes); });
+    worker.join();
+    if (world->hasDirtyChunks()) { cout << " voxelMeshing chunks still dirty after the snapshot" << endl; passed = false; }
+    if (snapKeys != dirty) { cout << " voxelMeshing snapshot meshed " << snapKeys.size() << " chunks, expected " << dirty.size() << endl; passed = false; }
+    else for (unsigned int i=0; i<snapKeys.size(); i++) {
+        auto& a = meshes[i];
+        auto& b = direct[snapKeys[i]];
+        if (a.positions != b.positions || a.colors != b.colors || a.indices != b.indices) { cout << " voxelMeshing snapshot mesh of chunk " << CKVoxelWorld::getChunkCoords(snapKeys[i]) << " differs" << endl; passed = false; }
+    }
+    cout << "voxelMeshing " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "addons/Engineering/Mechanics/VRMechanism.h"
+#include "core/utils/VRGlobals.h"
+void mechanismBroadphase() {
+    bool passed = true;
+
+    // square grid of equal gears, each gear meshes with its four direct neighbours
+    int W = 100;
+    float r = 0.5*0.05*8/M_PI;
+    float a = 0.3;
+
+    auto frame = [](vector<VRGeometryPtr>& gears) { // what the scene does between two frames
+        VRGlobals::CURRENT_FRAME++;
+        for (auto g : gears) g->updateChange();
+    };
+
+    auto run = [&](bool broadphase, vector<Vec3d>& ups, int& tGraph, int& tDrive) {
+        auto m = VRMechanism::create();
+        m->setBroadphase(broadphase);
+        vector<VRGeometryPtr> gears;
+        for (int i=0; i<W; i++) {
+            for (int j=0; j<W; j++) {
+                auto g = VRGeometry::create("gear", "Gear", "0.1 0.02 0.05 8 0.02 0");
+                g->setFrom(Vec3d(2*r*i, 2*r*j, 0));
+                gears.push_back(g);
+                m->add(g);
+            }
+        }
+
+        VRTimer timer;
+        frame(gears); // every part changed, builds the whole engagement graph
+        for (auto g : gears) g->rotate(0, Vec3d(0,0,1));
+        timer.start();
+        m->update();
+        tGraph = timer.stop();
+
+        frame(gears); // drive the corner gear, the rotation spreads over the whole gearbox
+        gears[0]->rotate(a, Vec3d(0,0,1));
+        timer.start();
+        m->update();
+        tDrive = timer.stop();
+
+        for (auto g : gears) ups.push_back(g->getUp());
+    };
+
+    vector<Vec3d> upsBP, upsBF;
+    int tGraphBP, tDriveBP, tGraphBF, tDriveBF;
+    run(true, upsBP, tGraphBP, tDriveBP);
+    run(false, upsBF, tGraphBF, tDriveBF);
+
+    int wrong = 0, differ = 0;
+    for (int i=0; i<W; i++) {
+        for (int j=0; j<W; j++) {
+            int k = i*W+j;
+            float s = (i+j)%2 ? -a : a; // neighbouring gears turn in opposite directions
+            Vec3d e(-sin(s), cos(s), 0);
+            if ((upsBP[k]-e).length() > 1e-4) wrong++;
+            if ((upsBP[k]-upsBF[k]).length() > 1e-6) differ++;
+        }
+    }
+
+    cout << " mechanismBroadphase " << W*W << " gears, engagement graph in " << tGraphBP << " ms (brute force " << tGraphBF << " ms)" << endl;
+    cout << " mechanismBroadphase propagation in " << tDriveBP << " ms (brute force " << tDriveBF << " ms)" << endl;
+    if (wrong) { cout << " mechanismBroadphase " << wrong << " gears with wrong rotation" << endl; passed = false; }
+    if (differ) { cout << " mechanismBroadphase " << differ << " gears differ from the brute force mechanism" << endl; passed = false; }
+    cout << "mechanismBroadphase " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "addons/Engineering/Chemistry/VRMolecule.h"
+#include <OpenSG/OSGGeometry.h>
+void moleculeUpdates() {
+    bool passed = true;
+
+    // parallel zigzag carbon chains, written as PDB without CONECT records
+    int chains = 100, L = 300;
+    string path = "/tmp/polyvr_test_molecule.pdb";
+    {
+        ofstream f(path.c_str());
+        char line[100];
+        int serial = 1;
+        for (int c=0; c<chains; c++) {
+            for (int i=0; i<L; i++) {
+                double x = i*1.26, y = (i%2)*0.89 + (c%10)*4.0, z = (c/10)*4.0;
+                snprintf(line, sizeof(line), "ATOM  %5d  C   PEP A   1    %8.3f%8.3f%8.3f  1.00  0.00           C  \n", serial++, x, y, z);
+                f << line;
+            }
+        }
+    }
+
+    auto mol = VRMolecule::create("protein");
+    VRTimer timer;
+    timer.start();
+    mol->loadPDB(path);
+    int tLoad = timer.stop();
+
+    // neighbouring atoms of a chain are 1.54 apart, all others at least 2.5
+    int N = mol->getAtomCount(), bonds = 0, wrong = 0;
+    for (int i=0; i<N; i++) {
+        for (auto& b : mol->getAtom(i)->getBonds()) {
+            if (b.second.atom2 == 0) continue;
+            bonds++;
+            int j = b.second.atom2->getID();
+            if (abs(i-j) != 1 || i/L != j/L) wrong++;
+        }
+    }
+    bonds /= 2;
+    if (N != chains*L) { cout << " moleculeUpdates loaded " << N << " atoms, expected " << chains*L << endl; passed = false; }
+    if (bonds != chains*(L-1) || wrong) { cout << " moleculeUpdates " << bonds << " bonds, expected " << chains*(L-1) << ", " << wrong << " wrong" << endl; passed = false; }
+
+    auto snapshot = [](VRGeometryPtr g) -> vector<Pnt3f> {
+        vector<Pnt3f> res;
+        auto pos = g->getMesh()->geo->getPositions();
+        for (uint i=0; i<pos->size(); i++) res.push_back(pos->getValue<Pnt3f>(i));
+        return res;
+    };
+
+    auto differs = [](const vector<Pnt3f>& a, const vector<Pnt3f>& b) {
+        if (a.size() != b.size()) return true;
+        for (uint i=0; i<a.size(); i++) if (a[i].dist(b[i]) > 1e-4) return true;
+        return false;
+    };
+
+    // in place updates have to give the same buffers as rebuilding the geometry
+    auto check = [&](string what) {
+        auto atoms = snapshot(mol);
+        auto bnds = snapshot(mol->getBondsGeometry());
+        mol->updateGeo();
+        if (differs(atoms, snapshot(mol)) || differs(bnds, snapshot(mol->getBondsGeometry()))) {
+            cout << " moleculeUpdates " << what << " differs from rebuilt geometry" << endl;
+            passed = false;
+        }
+    };
+
+    timer.start();
+    mol->updateGeo();
+    int tRebuild = timer.stop();
+
+    timer.start();
+    for (int k=0; k<100; k++) mol->rotateBond(L/2-1, L/2, 0.01);
+    float tRotate = timer.stop()/100.0;
+    check("rotateBond");
+
+    mt19937 rng(3);
+    uniform_real_distribution<double> jitter(-0.05, 0.05);
+    vector<int> IDs;
+    vector<Vec3d> positions;
+    for (int i=0; i<N; i+=10) {
+        IDs.push_back(i);
+        positions.push_back( Vec3d(mol->getAtom(i)->getTransformation()[3]) + Vec3d(jitter(rng), jitter(rng), jitter(rng)) );
+    }
+    timer.start();
+    mol->setAtomPositions(IDs, positions);
+    int tAnimate = timer.stop();
+    check("setAtomPositions");
+
+    cout << " moleculeUpdates " << N << " atoms and " << bonds << " bonds loaded in " << tLoad << " ms, full geometry update " << tRebuild << " ms" << endl;
+    cout << " moleculeUpdates rotateBond " << tRotate << " ms, moving " << IDs.size() << " atoms " << tAnimate << " ms" << endl;
+    cout << "moleculeUpdates " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "addons/Engineering/CSG/CSGEvaluator.h"
+#include <functional>
+void csgBackends() {
+    bool passed = true;
+
+    auto prism = [](vector<Vec2d> poly, double z0, double z1) -> CSGNodePtr { // poly is ccw
+        vector<Vec3d> pos;
+        vector<int> inds;
+        int n = poly.size();
+        for (auto p : poly) pos.push_back(Vec3d(p[0], p[1], z0));
+        for (auto p : poly) pos.push_back(Vec3d(p[0], p[1], z1));
+        for (int k=1; k+1<n; k++) {
+            inds.push_back(0); inds.push_back(k+1); inds.push_back(k);
+            inds.push_back(n); inds.push_back(n+k); inds.push_back(n+k+1);
+        }
+        for (int i=0; i<n; i++) {
+            int j = (i+1)%n;
+            inds.push_back(i); inds.push_back(j); inds.push_back(n+j);
+            inds.push_back(i); inds.push_back(n+j); inds.push_back(n+i);
+        }
+        return CSGNode::create(pos, inds);
+    };
+
+    int segments = 24;
+    auto cylinder = [&](Vec2d c, double r, double z0, double z1) {
+        vector<Vec2d> poly;
+        for (int i=0; i<segments; i++) poly.push_back(c + Vec2d(cos(2*Pi*i/segments), sin(2*Pi*i/segments))*r);
+        return prism(poly, z0, z1);
+    };
+
+    function<CSGNodePtr(vector<CSGNodePtr>, int, int)> unite = [&](vector<CSGNodePtr> v, int a, int b) -> CSGNodePtr {
+        if (b-a == 1) return v[a];
+        int m = (a+b)/2;
+        return CSGNode::create("unite", unite(v, a, m), unite(v, m, b));
+    };
+
+    // plate with 3x3 through holes and 4 bosses between them
+    double rh = 0.8, rb = 0.5;
+    CSGNodePtr plate = prism({Vec2d(0,0), Vec2d(10,0), Vec2d(10,10), Vec2d(0,10)}, 0, 1);
+    vector<CSGNodePtr> holes, bosses;
+    for (int i=0; i<3; i++) for (int j=0; j<3; j++) holes.push_back( cylinder(Vec2d(2+3*i, 2+3*j), rh, -0.5, 1.5) );
+    for (int i=0; i<2; i++) for (int j=0; j<2; j++) bosses.push_back( cylinder(Vec2d(3.5+3*i, 3.5+3*j), rb, 0.5, 2) );
+    CSGNodePtr root = CSGNode::create("unite", CSGNode::create("subtract", plate, unite(holes, 0, holes.size())), unite(bosses, 0, bosses.size()));
+
+    auto area = [&](double r) { return 0.5*segments*r*r*sin(2*Pi/segments); };
+    double V = 100 - 9*area(rh) + 4*area(rb);
+
+    function<int(CSGNodePtr, CSGNodePtr)> depth = [&](CSGNodePtr n, CSGNodePtr leaf) -> int { // number of ancestors of leaf
+        if (n == leaf) return 0;
+        for (auto c : n->children) {
+            int d = depth(c, leaf);
+            if (d >= 0) return d+1;
+        }
+        return -1;
+    };
+
+    VRTimer timer;
+    vector<CSGResultPtr> results;
+    vector<string> names = { "nef", "corefine" };
+    vector<CSGEvaluator::BACKEND> backends = { CSGEvaluator::NEF, CSGEvaluator::COREFINE };
+    for (int b=0; b<2; b++) {
+        auto evaluator = CSGEvaluator::create(backends[b]);
+        timer.start();
+        auto r = evaluator->evaluate(root);
+        int t = timer.stop();
+        if (r == 0) { cout << " csgBackends " << names[b] << " evaluation failed" << endl; passed = false; continue; }
+        results.push_back(r);
+        cout << " csgBackends " << names[b] << " " << evaluator->getOperations() << " operations in " << t << " ms, volume " << r->getVolume();
+        cout << ", euler characteristic " << r->getEulerCharacteristic() << ", components " << r->getComponents() << endl;
+        if (!r->isClosed()) { cout << " csgBackends " << names[b] << " result is not closed" << endl; passed = false; }
+        if (abs(r->getVolume()-V) > 1e-6*V) { cout << " csgBackends " << names[b] << " volume differs from " << V << endl; passed = false; }
+        if (r->getEulerCharacteristic() != 2-2*9 || r->getComponents() != 1) { cout << " csgBackends " << names[b] << " wrong topology" << endl; passed = false; }
+
+        // move one hole, only the operations above it are computed again
+        auto moved = cylinder(Vec2d(2.2, 2), rh, -0.5, 1.5);
+        auto parent = root->children[0]->children[1];
+        while (parent->children[0] != holes[0]) parent = parent->children[0];
+        parent->children[0] = moved;
+        timer.start();
+        r = evaluator->evaluate(root);
+        t = timer.stop();
+        int expected = depth(root, moved);
+        parent->children[0] = holes[0];
+        cout << " csgBackends " << names[b] << " moved hole: " << evaluator->getOperations() << " operations, " << evaluator->getCacheHits() << " cached subtrees, " << t << " ms" << endl;
+        if (r == 0 || abs(r->getVolume()-V) > 1e-6*V) { cout << " csgBackends " << names[b] << " wrong result after moving a hole" << endl; passed = false; }
+        if (evaluator->getOperations() != expected || evaluator->getCacheHits() == 0) { cout << " csgBackends " << names[b] << " expected " << expected << " operations" << endl; passed = false; }
+    }
+
+    if (results.size() == 2) {
+        double V0 = results[0]->getVolume(), V1 = results[1]->getVolume();
+        if (abs(V0-V1) > 1e-6*V) { cout << " csgBackends volumes differ" << endl; passed = false; }
+        if (results[0]->getEulerCharacteristic() != results[1]->getEulerCharacteristic()) { cout << " csgBackends topologies differ" << endl; passed = false; }
+    }
+
+    cout << "csgBackends " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "addons/Semantics/Reasoning/VROntology.h"
+#include <set>
+void ontologyIndex() {
+    bool passed = true;
+    mt19937 rng(7);
+    auto onto = VROntology::create("indexTest");
+
+    // random taxonomy, some concepts with a second parent
+    int Nc = 500;
+    vector<VRConceptPtr> concepts;
+    vector<string> names;
+    auto addConcept = [&]() {
+        int i = concepts.size();
+        string name = "IndexTestConcept" + toString(i);
+        string parents;
+        if (i > 0 && rng()%10) {
+            parents = names[rng()%i];
+            string p2 = names[rng()%i];
+            if (rng()%5 == 0 && p2 != parents) parents += " " + p2;
+        }
+        concepts.push_back( onto->addConcept(name, parents) );
+        names.push_back(name);
+    };
+    for (int i=0; i<Nc; i++) addConcept();
+
+    int Ne = 20000;
+    vector<VREntityPtr> ents;
+    auto addEntity = [&]() {
+        auto e = onto->addEntity("indexTestEntity", names[rng()%names.size()]);
+        if (rng()%5 == 0) e->addConcept( concepts[rng()%concepts.size()] );
+        ents.push_back(e);
+    };
+    for (int i=0; i<Ne; i++) addEntity();
+
+    auto scan = [&](string concept) { // traversal of all entities, as done before the index
+        vector<VREntityPtr> res;
+        for (auto i : onto->entities) {
+            for (auto c : i.second->getConcepts()) {
+                if (c && c->is_a(concept)) { res.push_back(i.second); break; }
+            }
+        }
+        return res;
+    };
+
+    set<string> removed;
+    VRTimer timer;
+    auto compare = [&](string what) {
+        vector<string> queries(1, "Thing");
+        for (unsigned int i=0; i<names.size(); i+=5) if (!removed.count(names[i])) queries.push_back(names[i]);
+
+        timer.start();
+        vector<vector<VREntityPtr>> reference;
+        for (auto q : queries) reference.push_back( scan(q) );
+        int tScan = timer.stop();
+
+        timer.start();
+        vector<vector<VREntityPtr>> indexed;
+        for (auto q : queries) indexed.push_back( onto->getEntities(q) );
+        int tIndex = timer.stop();
+
+        int wrong = 0, wrongIsA = 0;
+        for (unsigned int i=0; i<queries.size(); i++) if (indexed[i] != reference[i]) wrong++;
+        for (int k=0; k<20000; k++) {
+            auto a = concepts[rng()%concepts.size()];
+            auto b = concepts[rng()%concepts.size()];
+            if (onto->isA(a, b) != a->is_a(b)) wrongIsA++;
+        }
+
+        cout << " ontologyIndex " << what << ": " << queries.size() << " queries, scan " << tScan << " ms, index " << tIndex << " ms" << endl;
+        if (wrong) { cout << " ontologyIndex " << what << ": " << wrong << " entity lists differ from the scan" << endl; passed = false; }
+        if (wrongIsA) { cout << " ontologyIndex " << what << ": " << wrongIsA << " wrong subsumption checks" << endl; passed = false; }
+    };
+
+    compare("initial");
+
+    // entity changes update the index
+    for (int i=0; i<2000; i++) addEntity();
+    for (int i=0; i<2000; i++) {
+        int j = rng()%ents.size();
+        onto->remEntity(ents[j]);
+        ents[j] = ents.back();
+        ents.pop_back();
+    }
+    for (int i=0; i<1000; i++) ents[rng()%ents.size()]->addConcept( concepts[rng()%concepts.size()] );
+    compare("entity changes");
+
+    // taxonomy changes update it in place
+    for (int i=0; i<50; i++) addConcept();
+    for (int i=0; i<20; i++) {
+        int a = rng()%concepts.size(), b = rng()%concepts.size();
+        if (a != b) concepts[min(a,b)]->append( concepts[max(a,b)] ); // older concepts stay ancestors, no cycles
+    }
+    for (int i=0; i<5; i++) {
+        int j = 1 + rng()%(concepts.size()-1);
+        if (removed.count(names[j])) continue;
+        onto->remConcept(concepts[j]);
+        removed.insert(names[j]);
+    }
+    for (int i=0; i<2000; i++) addEntity();
+    compare("taxonomy changes");
+    if (onto->indexDirty) { cout << " ontologyIndex: taxonomy changes rebuilt the index" << endl; passed = false; }
+    onto->indexDirty = true;
+    compare("rebuilt");
+
+    cout << "ontologyIndex " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "addons/Semantics/Reasoning/VRRuleEngine.h"
+#include "addons/Semantics/Reasoning/VRReasoner.h"
+void ruleEngineStream() {
+    bool passed = true;
+    mt19937 rng(11);
+
+    // synthetic plant, machines on lines with sensors
+    auto onto = VROntology::create("ruleEngineTest");
+    auto Machine = onto->addConcept("RETMachine");
+    auto Press = onto->addConcept("RETPress", "RETMachine");
+    auto Sensor = onto->addConcept("RETSensor");
+    for (string p : {"state", "load", "line", "sensors", "maintenance"}) Machine->addProperty(p, "string");
+    Sensor->addProperty("value", "string");
+
+    onto->addRule("overloaded(m):RETMachine(m);is(m.state,running);is(m.load,high)", "RETMachine");
+    onto->addRule("idle(m):RETMachine(m);is_not(m.state,running)", "RETMachine");
+    onto->addRule("alarm(m,s):RETMachine(m);RETSensor(s);has(m.sensors,s);is(s.value,critical)", "RETMachine");
+    onto->addRule("jam(m,n):RETPress(m);RETMachine(n);is(m.line,n.line);is(m.state,broken);is(n.state,running)", "RETPress");
+    onto->addRule("is(m.maintenance,1):RETMachine(m);is(m.state,broken)", "RETMachine");
+
+    vector<string> states = { "running", "idle", "broken" };
+    vector<string> loads = { "low", "high" };
+    vector<string> readings = { "ok", "ok", "ok", "critical" };
+    vector<VREntityPtr> machines, sensors;
+    for (int i=0; i<2000; i++) {
+        auto m = onto->addEntity("machine", i%4 ? "RETMachine" : "RETPress");
+        m->set("state", states[rng()%3]);
+        m->set("load", loads[rng()%2]);
+        m->set("line", toString(i%40));
+        for (int j=0; j<2; j++) {
+            auto s = onto->addEntity("sensor", "RETSensor");
+            s->set("value", readings[rng()%4]);
+            m->add("sensors", s->getName());
+            sensors.push_back(s);
+        }
+        machines.push_back(m);
+    }
+
+    VRTimer timer;
+    timer.start();
+    auto engine = VRRuleEngine::create(onto);
+    int tCompile = timer.stop();
+    if (engine->getRuleCount() != 5) { cout << " ruleEngineStream compiled " << engine->getRuleCount() << " of 5 rules" << endl; passed = false; }
+
+    auto matches = [](VRRuleEnginePtr e) {
+        map<string, set<VRRuleEngine::Token>> res;
+        for (string h : {"overloaded", "idle", "alarm", "jam", "is"}) {
+            auto M = e->getMatches(h);
+            res[h] = set<VRRuleEngine::Token>(M.begin(), M.end());
+        }
+        return res;
+    };
+
+    string query = "q(m):RETMachine(m);is(m.load,high);is(m.state,running)";
+    auto check = [&](string what) {
+        timer.start();
+        auto fresh = VRRuleEngine::create(onto);
+        int tFresh = timer.stop();
+        if (matches(fresh) != matches(engine)) { cout << " ruleEngineStream " << what << ": matches differ from a fresh evaluation" << endl; passed = false; }
+
+        vector<VREntityPtr> expected;
+        for (auto m : machines) if (m->get("load")->value == "high" && m->get("state")->value == "running") expected.push_back(m);
+        auto res = engine->process(query);
+        sort(expected.begin(), expected.end(), [](VREntityPtr a, VREntityPtr b) { return a->ID < b->ID; });
+        if (res != expected) { cout << " ruleEngineStream " << what << ": query returned " << res.size() << " entities, expected " << expected.size() << endl; passed = false; }
+        return tFresh;
+    };
+    int tFresh = check("initial");
+
+    // stream of fact updates, rules with actions are applied every 1000 updates
+    int N = 20000, fired = 0;
+    timer.start();
+    for (int i=0; i<N; i++) {
+        if (rng()%3) {
+            auto m = machines[rng()%machines.size()];
+            if (rng()%2) engine->setValue(m, "state", states[rng()%3]);
+            else engine->setValue(m, "load", loads[rng()%2]);
+        } else engine->setValue(sensors[rng()%sensors.size()], "value", readings[rng()%4]);
+        if (i%1000 == 999) {
+            fired += engine->fire();
+            engine->process(query);
+        }
+    }
+    int tStream = timer.stop();
+    check("after updates");
+
+    for (auto m : machines) {
+        if (m->get("state")->value != "broken") continue;
+        auto p = m->get("maintenance");
+        if (!p || p->value != "1") { cout << " ruleEngineStream broken machine " << m->getName() << " not in maintenance" << endl; passed = false; break; }
+    }
+
+    // the engine of the ontology follows plain entity changes and answers the reasoner
+    auto hooked = onto->getRuleEngine();
+    for (int i=0; i<2000; i++) machines[rng()%machines.size()]->set("state", states[rng()%3]);
+    auto m = onto->addEntity("machine", "RETMachine");
+    m->set("state", "running");
+    m->set("load", "high");
+    machines.push_back(m);
+    onto->remEntity(machines[0]);
+    machines.erase(machines.begin());
+    if (matches(hooked) != matches(VRRuleEngine::create(onto))) { cout << " ruleEngineStream ontology engine missed entity changes" << endl; passed = false; }
+
+    // joins on entity names, a renamed sensor leaves the alarms of its machine until the machine refers to the new name
+    auto alarmed = hooked->getMatches("alarm");
+    if (alarmed.size()) {
+        auto am = onto->getEntity(alarmed[0][0]);
+        auto as = onto->getEntity(alarmed[0][1]);
+        onto->renameEntity(as, "renamedSensor");
+        if (matches(hooked) != matches(VRRuleEngine::create(onto))) { cout << " ruleEngineStream ontology engine kept matches of a renamed entity" << endl; passed = false; }
+        am->add("sensors", as->getName());
+        if (matches(hooked) != matches(VRRuleEngine::create(onto))) { cout << " ruleEngineStream ontology engine missed the join on a renamed entity" << endl; passed = false; }
+    } else { cout << " ruleEngineStream no alarm to test the rename" << endl; passed = false; }
+    if (!hooked->covers(query)) { cout << " ruleEngineStream ontology engine does not cover the query" << endl; passed = false; }
+    auto reasoner = VRReasoner::create();
+    reasoner->setVerbose(false, false);
+    auto reasoned = reasoner->process(query, onto);
+    if (reasoned != hooked->process(query)) { cout << " ruleEngineStream reasoner results differ from the ontology engine" << endl; passed = false; }
+    engine = hooked;
+    check("ontology engine");
+
+    // cached query results
+    timer.start();
+    for (int i=0; i<1000; i++) engine->process(query);
+    float tQuery = timer.stop()/1000.0;
+
+    cout << " ruleEngineStream " << machines.size() << " machines, " << sensors.size() << " sensors, compiled and matched in " << tCompile << " ms, fresh evaluation " << tFresh << " ms" << endl;
+    cout << " ruleEngineStream " << N << " updates in " << tStream << " ms (" << int(N*1000.0/max(tStream,1)) << " updates/s), " << fired << " actions fired, " << engine->getActivations() << " activations" << endl;
+    cout << " ruleEngineStream cached query " << tQuery << " ms" << endl;
+    cout << "ruleEngineStream " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "core/math/Expression.h"
+#include <cmath>
+void expressionCompiler() {
+    bool passed = true;
+    mt19937 rng(5);
+
+    // random expressions over four variables and small numbers
+    vector<string> vars = {"x", "y", "z", "w"};
+    std::function<string(int)> randExpr = [&](int depth) -> string {
+        if (depth == 0 || rng()%5 == 0) {
+            if (rng()%3 == 0) return toString(int(1+rng()%4));
+            return vars[rng()%vars.size()];
+        }
+        string ops = "+-*/";
+        string a = randExpr(depth-1);
+        string b = randExpr(depth-1);
+        string s = a + ops[rng()%4] + b;
+        if (rng()%2) s = "(" + s + ")";
+        return s;
+    };
+
+    // known values, non commutative operators
+    auto checkValue = [&](string s, vector<string> names, vector<double> values, double expected) {
+        Expression e(s);
+        e.computeTree();
+        for (auto l : e.getLeafs()) {
+            auto it = find(names.begin(), names.end(), l->param);
+            if (it != names.end()) l->setValue(float(values[it-names.begin()]));
+            else l->setValue(l->param);
+        }
+        double t = toFloat(e.compute());
+        double c = e.compile(names).evaluate(values);
+        if (abs(t - expected) > 1e-5 || abs(c - expected) > 1e-9) {
+            cout << " expressionCompiler " << s << " gives " << t << " (tree) and " << c << " (compiled), expected " << expected << endl;
+            passed = false;
+        }
+    };
+    checkValue("7-2", {}, {}, 5);
+    checkValue("8/2", {}, {}, 4);
+    checkValue("x-y", {"x", "y"}, {7, 2}, 5);
+    checkValue("x/y", {"x", "y"}, {7, 2}, 3.5);
+    checkValue("x-y*2", {"x", "y"}, {7, 2}, 3);
+    checkValue("(x-y)/(y-x)", {"x", "y"}, {7, 2}, -1);
+
+    int E = 200, N = 2000;
+    int tTree = 0, tSingle = 0, tCompiled = 0, tCompile = 0;
+    int wrong = 0, tested = 0, instructions = 0, operators = 0;
+    for (int k=0; k<E; k++) {
+        Expression e(randExpr(6));
+        e.computeTree();
+        for (auto n : e.nodes) if (n->left) operators++;
+
+        VRTimer timer;
+        auto program = e.compile(vars);
+        tCompile += timer.stop();
+        if (!program.valid()) { cout << " expressionCompiler could not compile " << e.toString() << endl; passed = false; continue; }
+        instructions += program.code.size();
+
+        vector<double> bindings(vars.size()*N); // all values of a variable in a row
+        for (auto& v : bindings) v = 1.0 + (rng()%10000)*0.0001;
+
+        // tree evaluator, leafs are set to the bindings
+        vector<float> treeResults(N);
+        auto leafs = e.getLeafs();
+        vector<int> leafVars;
+        for (auto l : leafs) leafVars.push_back(program.getVariable(l->param));
+        timer.start();
+        for (int i=0; i<N; i++) {
+            for (unsigned int j=0; j<leafs.size(); j++) {
+                if (leafVars[j] >= 0) leafs[j]->setValue(float(bindings[leafVars[j]*N+i]));
+                else leafs[j]->setValue(leafs[j]->param);
+            }
+            treeResults[i] = toFloat(e.compute());
+        }
+        tTree += timer.stop();
+
+        // compiled program, one binding at a time
+        vector<double> singleResults(N);
+        vector<double> values(vars.size());
+        timer.start();
+        for (int i=0; i<N; i++) {
+            for (unsigned int v=0; v<vars.size(); v++) values[v] = bindings[v*N+i];
+            singleResults[i] = program.evaluate(values);
+        }
+        tSingle += timer.stop();
+
+        // compiled program, all bindings at once
+        vector<double> results(N);
+        timer.start();
+        program.evaluate(bindings, results);
+        tCompiled += timer.stop();
+
+        for (int i=0; i<N; i++) {
+            if (singleResults[i] != results[i]) { wrong++; continue; }
+            if (!std::isfinite(results[i]) || abs(results[i]) > 1e3) continue; // near zero divisors, float and double differ
+            tested++;
+            if (abs(treeResults[i] - results[i]) > 1e-3*max(1.0, abs(results[i]))) wrong++;
+        }
+    }
+
+    if (wrong) { cout << " expressionCompiler " << wrong << " results differ from the tree evaluator" << endl; passed = false; }
+    cout << " expressionCompiler " << E << " expressions, " << operators << " operators compiled to " << instructions << " instructions in " << tCompile << " ms" << endl;
+    cout << " expressionCompiler " << E*N << " evaluations (" << tested << " compared), tree " << tTree << " ms, compiled single " << tSingle << " ms, compiled batch " << tCompiled << " ms" << endl;
+    cout << " expressionCompiler speedup single " << float(tTree)/max(tSingle,1) << ", batch " << float(tTree)/max(tCompiled,1) << endl;
+    cout << "expressionCompiler " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "addons/Semantics/Processes/VRProcess.h"
+#include "addons/Semantics/Processes/VRProcessEngine.h"
+void processSimulation() {
+    bool passed = true;
+
+    // customers order at shops and wait for the delivery, shops pack and ship
+    auto process = VRProcess::create("simulationTest");
+    int customer = process->addSubject("Customer")->ID;
+    int shop = process->addSubject("Shop")->ID;
+    int order = process->addMessage("order", customer, shop)->ID;
+    int delivery = process->addMessage("delivery", shop, customer)->ID;
+
+    auto cDiag = process->getBehaviorDiagram(customer);
+    int browse = process->addAction("browse", customer)->ID;
+    int request = process->addAction("order", customer)->ID;
+    int wait = process->addAction("wait", customer)->ID;
+    process->addMessage("", browse, browse, cDiag);
+    process->addMessage("", browse, request, cDiag);
+    process->addMessage("", request, wait, cDiag);
+    int received = process->addMessage("", wait, browse, cDiag)->ID;
+
+    auto sDiag = process->getBehaviorDiagram(shop);
+    int idle = process->addAction("idle", shop)->ID;
+    int pack = process->addAction("pack", shop)->ID;
+    int ship = process->addAction("ship", shop)->ID;
+    int ordered = process->addMessage("", idle, pack, sDiag)->ID;
+    process->addMessage("", pack, ship, sDiag);
+    process->addMessage("", ship, idle, sDiag);
+
+    int Nc = 5000, Ns = 100;
+    double T = 200;
+    auto setup = [&](unsigned int seed) {
+        auto engine = VRProcessEngine::create();
+        engine->setSeed(seed);
+        engine->setProcess(process);
+        engine->setInstances(customer, Nc);
+        engine->setInstances(shop, Ns);
+        engine->setDuration(customer, browse, 2.0);
+        engine->setDuration(customer, request, 0.5);
+        engine->setDuration(customer, wait, 0);
+        engine->setDuration(shop, idle, 0);
+        engine->setDuration(shop, pack, 0.1);
+        engine->setDuration(shop, ship, 0.05);
+        engine->setSendMessage(customer, request, order);
+        engine->setSendMessage(shop, ship, delivery);
+        engine->setReceiveMessage(customer, received, delivery);
+        engine->setReceiveMessage(shop, ordered, order);
+        engine->setMessageDelay(delivery, 1.0);
+        engine->reset();
+        return engine;
+    };
+
+    auto engine = setup(1);
+    if (engine->getActorCount() != Nc+Ns) { cout << " processSimulation " << engine->getActorCount() << " actors, expected " << Nc+Ns << endl; passed = false; }
+
+    VRTimer timer;
+    engine->simulate(T);
+    int t1 = timer.stop();
+    size_t events = engine->getEventCount();
+    size_t hash = engine->getTraceHash();
+
+    int waiting = 0, shipping = 0;
+    for (int i=0; i<engine->getActorCount(); i++) {
+        if (engine->getActorSubject(i) == customer && engine->getActorState(i) == wait) waiting++;
+        if (engine->getActorSubject(i) == shop && engine->getActorState(i) != idle) shipping++;
+    }
+    if (events < size_t(Nc)*T/4) { cout << " processSimulation only " << events << " events" << endl; passed = false; }
+
+    // the same seed replays the same events, after a reset and in a new engine
+    engine->reset();
+    timer.start();
+    for (int k=1; k<=10; k++) engine->simulate(T*k/10); // in steps as paced by frames
+    int t2 = timer.stop();
+    if (engine->getEventCount() != events || engine->getTraceHash() != hash) { cout << " processSimulation replay after reset differs" << endl; passed = false; }
+
+    auto engine2 = setup(1);
+    engine2->simulate(T);
+    if (engine2->getEventCount() != events || engine2->getTraceHash() != hash) { cout << " processSimulation replay in new engine differs" << endl; passed = false; }
+
+    auto engine3 = setup(2);
+    engine3->simulate(T);
+    if (engine3->getTraceHash() == hash) { cout << " processSimulation other seed gives the same trace" << endl; passed = false; }
+
+    cout << " processSimulation " << Nc << " customers, " << Ns << " shops, " << T << " s simulated, " << events << " events in " << t1 << " ms (" << int(events*1000.0/max(t1,1)) << " events/s)" << endl;
+    cout << " processSimulation replay in steps " << t2 << " ms, " << waiting << " customers waiting, " << shipping << " shops busy at the end" << endl;
+    cout << "processSimulation " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "addons/Engineering/Factory/VRLogistics.h"
+void logisticsFlow() {
+    bool passed = true;
+    mt19937 rng(9);
+
+    // grid of conveyors in both directions, items travel between random nodes
+    int G = 50, Nitems = 10000;
+    float spacing = 2;
+    auto sim = FSimulation::create();
+    for (int j=0; j<G; j++) for (int i=0; i<G; i++) sim->addNode(Vec3d(i*spacing, 0, j*spacing));
+    for (int j=0; j<G; j++) {
+        for (int i=0; i<G; i++) {
+            int n = i+j*G;
+            if (i+1 < G) { sim->addLane(n, n+1, 1.5); sim->addLane(n+1, n, 1.5); }
+            if (j+1 < G) { sim->addLane(n, n+G, 1.5); sim->addLane(n+G, n, 1.5); }
+        }
+    }
+    vector<int> stations; // items travel between stations
+    for (int k=0; k<100; k++) stations.push_back(rng()%(G*G));
+    for (int k=0; k<Nitems; k++) sim->addItem(rng()%(G*G), stations[rng()%stations.size()]);
+
+    int steps = 1500;
+    int total = 0;
+    VRTimer timer;
+    for (int k=0; k<steps; k++) {
+        sim->step(0.02);
+        for (int i : sim->getDelivered()) {
+            sim->send(i, stations[rng()%stations.size()]);
+            total++;
+        }
+    }
+    int t = timer.stop();
+
+    // no item is lost, items on a lane keep their gap
+    int onLanes = 0, atNodes = 0, tooClose = 0;
+    map<int, vector<float>> lanes;
+    for (int i=0; i<Nitems; i++) {
+        auto item = sim->getItem(i);
+        if (item.lane >= 0) { onLanes++; lanes[item.lane].push_back(item.s); }
+        else if (item.node >= 0) atNodes++;
+    }
+    for (auto& l : lanes) {
+        sort(l.second.begin(), l.second.end());
+        for (unsigned int k=1; k<l.second.size(); k++) if (l.second[k] - l.second[k-1] < 0.5 - 1e-4) tooClose++;
+    }
+    if (onLanes + atNodes != Nitems || onLanes != sim->getMovingCount()) { cout << " logisticsFlow " << onLanes << " items on lanes and " << atNodes << " at nodes, expected " << Nitems << endl; passed = false; }
+    if (tooClose) { cout << " logisticsFlow " << tooClose << " items closer than the gap" << endl; passed = false; }
+    if (total == 0) { cout << " logisticsFlow no item delivered" << endl; passed = false; }
+
+    // fixed steps for the frame time
+    int N = sim->advance(0.1);
+    if (N != 5) { cout << " logisticsFlow advance took " << N << " steps, expected 5" << endl; passed = false; }
+
+    cout << " logisticsFlow " << sim->getNodeCount() << " nodes, " << sim->getLaneCount() << " lanes, " << Nitems << " items, " << steps << " steps in " << t << " ms (" << int(steps*1000.0/max(t,1)) << " steps/s, " << int(double(steps)*Nitems/max(t,1)) << "k item updates/s)" << endl;
+    cout << " logisticsFlow " << total << " deliveries, " << onLanes << " items moving at the end" << endl;
+    cout << "logisticsFlow " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "core/math/polygon.h"
+#include <OpenSG/OSGImage.h>
+void textureSynthesis() {
+    bool passed = true;
+    int W = 2048, H = 2048;
+    int seed = 4;
+    Color3f c1(0.3,0.3,0.35), c2(0.6,0.6,0.6);
+    vector<float> amounts = { 0.5, 0.25, 0.125, 0.0625 };
+    Color4f pc(0.9, 0.8, 0.1, 0.7);
+
+    vector<VRPolygonPtr> polygons;
+    auto star = VRPolygon::create(); // self intersecting, filled by the nonzero winding rule
+    for (int i=0; i<5; i++) { double a = i*4*Pi/5; star->addPoint(Vec2d(0.5+0.3*cos(a), 0.5+0.3*sin(a))); }
+    polygons.push_back(star);
+    auto quad = VRPolygon::create();
+    for (Vec2d p : { Vec2d(0.7,0.05), Vec2d(0.95,0.2), Vec2d(0.9,0.45), Vec2d(0.65,0.3) }) quad->addPoint(p);
+    polygons.push_back(quad);
+
+    auto gen = VRTextureGenerator::create();
+    gen->setSize(Vec3i(W,H,1), false);
+    for (float a : amounts) gen->add(PERLIN, a, c1, c2);
+    for (auto p : polygons) gen->drawPolygon(p, pc);
+
+    VRTimer timer;
+    auto tex = gen->compose(seed);
+    int tNew = timer.stop();
+    const float* res = (const float*)tex->getImage()->getData();
+
+    // reference, the previous generator with a gradient per lattice point and a point in polygon test per pixel
+    timer.start();
+    vector<Color3f> ref(W*H, Color3f(1,1,1));
+    srand(seed);
+    for (float amount : amounts) {
+        float a = 0.5*amount;
+        Vec3i dim(max(1,int(W*a)), max(1,int(H*a)), 1);
+        vector<Vec3d> grid(dim[0]*dim[1]);
+        for (int j=0; j<dim[1]; j++) {
+            for (int i=0; i<dim[0]; i++) {
+                Vec3d r = Vec3d(rand(), rand(), rand())*2.0/RAND_MAX - Vec3d(1,1,1);
+                r.normalize();
+                grid[i+j*dim[0]] = r;
+            }
+        }
+
+        auto dotGrad = [&](Vec3i vi, Vec3d v) -> float {
+            Vec3d d = v-Vec3d(vi);
+            for (int k=0; k<3; k++) if (vi[k] >= dim[k]) vi[k] = 0;
+            return d.dot( grid[vi[0]+vi[1]*dim[0]] );
+        };
+        auto lerp = [](float a0, float a1, float w) -> float { return (1.0 - w)*a0 + w*a1; };
+        auto hermite5 = [](float w) -> float { return 6*pow(w,5) - 15*pow(w,4) + 10*pow(w,3); };
+
+        for (int y=0; y<H; y++) {
+            for (int x=0; x<W; x++) {
+                Vec3d v = Vec3d(x,y,0)*a;
+                Vec3i v0 = Vec3i(v);
+                Vec3d s = v-Vec3d(v0);
+                float fu = hermite5(s[0]);
+                float fv = hermite5(s[1]);
+                float i0 = lerp(dotGrad(v0, v), dotGrad(v0+Vec3i(1,0,0), v), fu);
+                float i1 = lerp(dotGrad(v0+Vec3i(0,1,0), v), dotGrad(v0+Vec3i(1,1,0), v), fu);
+                float p = lerp(i0, i1, fv);
+                Color3f c = c1*p + c2*(1-p);
+                Color3f& d = ref[x+y*W];
+                d = Color3f(d[0]*c[0], d[1]*c[1], d[2]*c[2]);
+            }
+        }
+    }
+    double perimeter = 0;
+    for (auto p : polygons) {
+        auto bb = p->getBoundingBox();
+        auto& pnts = p->get();
+        for (unsigned int i=0; i<pnts.size(); i++) perimeter += (pnts[(i+1)%pnts.size()]-pnts[i]).length()*W; // only pixels on the outline may differ
+        int i0 = bb.min()[0]*W-1, i1 = bb.max()[0]*W+1;
+        int j0 = bb.min()[2]*H-1, j1 = bb.max()[2]*H+1;
+        for (int j=j0; j<j1; j++) {
+            for (int i=i0; i<i1; i++) {
+                double dist;
+                if (!p->isInside(Vec2d(float(i)/W, float(j)/H), dist)) continue;
+                Color3f& d = ref[i+j*W]; // both polygons lie inside the texture
+                d = Color3f(pc[0], pc[1], pc[2])*pc[3] + d*(1.0-pc[3]);
+            }
+        }
+    }
+    int tRef = timer.stop();
+
+    double maxNoise = 0;
+    int mismatch = 0;
+    for (int i=0; i<W*H; i++) {
+        double d = 0;
+        for (int c=0; c<3; c++) d = max(d, (double)abs(res[3*i+c] - ref[i][c]));
+        if (d > 1e-3) mismatch++;
+        else maxNoise = max(maxNoise, d);
+    }
+    if (maxNoise > 1e-4) { cout << " textureSynthesis noise differs by " << maxNoise << endl; passed = false; }
+    if (mismatch > perimeter) { cout << " textureSynthesis " << mismatch << " polygon pixels differ, more than on the outline" << endl; passed = false; }
+
+    float MP = W*H*1e-6;
+    cout << " textureSynthesis " << W << "x" << H << ", " << amounts.size() << " noise layers, " << polygons.size() << " polygons" << endl;
+    cout << " textureSynthesis composed in " << tNew << " ms (" << MP*1000/max(tNew,1) << " MP/s), reference " << tRef << " ms (" << MP*1000/max(tRef,1) << " MP/s)" << endl;
+    cout << " textureSynthesis max noise difference " << maxNoise << ", " << mismatch << " outline pixels differ" << endl;
+    cout << "textureSynthesis " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "core/scene/sound/VRSoundMixer.h"
+#include <OpenSG/OSGBaseFunctions.h>
+void soundMixer() {
+    bool passed = true;
+    int rate = 22050;
+
+    // synthesis against the formula of VRSound::synthesize
+    auto mixer = VRSoundMixer::create(rate, 256);
+    mixer->addTone(8000, 440, 0.3, 2, 110, 0.1);
+    mixer->addTone(4000, 1234.5, 1.0);
+    vector<short> out;
+    mixer->mix(rate, out);
+    double maxErr = 0;
+    for (int i=0; i<rate; i++) {
+        double t = i*2*Pi/rate;
+        double s = 8000*sin(440*t + 0.3 + 2*sin(110*t + 0.1)) + 4000*sin(1234.5*t + 1.0);
+        maxErr = max(maxErr, abs(s - out[i]));
+    }
+    if (out.size() != size_t(rate) || maxErr > 4) { cout << " soundMixer synthesis error " << maxErr << endl; passed = false; }
+
+    // streamed chunks are played unchanged and the voice is removed when the stream ends
+    mixer->clear();
+    int stream = mixer->addStream();
+    vector<short> chunk(1000);
+    for (int i=0; i<1000; i++) chunk[i] = (i*37)%2000 - 1000;
+    for (int k=0; k<3; k++) mixer->pushSamples(stream, chunk);
+    mixer->closeStream(stream);
+    out.clear();
+    mixer->mix(4096, out);
+    int wrong = 0;
+    for (int i=0; i<4096; i++) if (out[i] != (i < 3000 ? chunk[i%1000] : 0)) wrong++;
+    if (wrong || mixer->getVoiceCount() != 0) { cout << " soundMixer stream, " << wrong << " wrong samples, " << mixer->getVoiceCount() << " voices left" << endl; passed = false; }
+
+    // audio thread with the null output, many voices in real time
+    int Nvoices = 512;
+    auto rt = VRSoundMixer::create(rate, 256);
+    rt->setNullOutput();
+    rt->setLatency(1024);
+    rt->start();
+    vector<int> IDs;
+    for (int i=0; i<Nvoices; i++) IDs.push_back( rt->addTone(30000.0/Nvoices, 100+i*7.3, 0, 1, 3+i*0.1) );
+    for (int k=0; k<50; k++) { // commands from the main loop while the thread is playing
+        for (int i=0; i<Nvoices; i+=8) rt->setTone(IDs[i], 30000.0/Nvoices, 100+i*7.3+k, 1, 3);
+        osgSleep(20);
+    }
+    int voices = rt->getVoiceCount();
+    rt->stop();
+    double load = rt->getRenderLoad();
+    if (voices != Nvoices) { cout << " soundMixer " << voices << " voices instead of " << Nvoices << endl; passed = false; }
+    if (load >= 1) { cout << " soundMixer slower than real time" << endl; passed = false; }
+
+    cout << " soundMixer synthesis error " << maxErr << ", stream samples wrong " << wrong << endl;
+    cout << " soundMixer " << voices << " voices, " << rt->getBlockCount() << " blocks, " << rt->getUnderruns() << " underruns, render load " << load*100 << "% (about " << int(Nvoices/max(load, 1e-6)) << " voices in real time)" << endl;
+    cout << " soundMixer command latency " << rt->getCommandLatency() << " ms" << endl;
+    cout << "soundMixer " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "core/setup/tracking/DTrack.h"
+#include "core/setup/tracking/ARTReplay.h"
+void trackingReplay() {
+    bool passed = true;
+    int frames = 600;
+    float fps = 60;
+    int bodies = 10, flysticks = 2, hands = 2, markers = 20;
+    auto rec = ARTRecording::createTestStream(frames, fps, bodies, flysticks, hands, markers);
+
+    // capture file round trip
+    string path = "/tmp/polyvr_art_test.rec";
+    auto rec2 = ARTRecording::create();
+    bool fileOk = rec->save(path) && rec2->load(path) && rec2->size() == rec->size();
+    for (int i=0; fileOk && i<rec->size(); i++) {
+        if (rec->get(i).data != rec2->get(i).data || rec->get(i).time != rec2->get(i).time) fileOk = false;
+    }
+    if (!fileOk) { cout << " trackingReplay recording file differs after loading" << endl; passed = false; }
+
+    // parser on the recorded datagrams
+    auto checkFrame = [&](DTrack& dt, int k) {
+        double t = k/fps;
+        if (int(dt.get_framecounter()) != k || abs(dt.get_timestamp() - t) > 1e-5) return false;
+        if (dt.get_num_body() != bodies || dt.get_num_flystick() != flysticks || dt.get_num_hand() != hands || dt.get_num_marker() != markers) return false;
+        for (int i=0; i<bodies; i++) {
+            auto b = dt.get_body(i);
+            float loc[3] = { float(100*(i+1)*cos(t)), float(100*(i+1)*sin(t)), float(1000+i) };
+            for (int j=0; j<3; j++) if (abs(b.loc[j] - loc[j]) > 1e-3) return false;
+            if (abs(b.rot[0] - cos(t)) > 1e-5 || abs(b.rot[1] - sin(t)) > 1e-5 || b.rot[8] != 1) return false;
+        }
+        auto f = dt.get_flystick(flysticks-1);
+        if (f.num_button != 8 || f.num_joystick != 2 || abs(f.joystick[0] - sin(t)) > 1e-3) return false;
+        for (int j=0; j<8; j++) if (f.button[j] != (((k/10)%256) >> j & 1)) return false;
+        auto h = dt.get_hand(hands-1);
+        if (h.nfinger != 5 || h.lr != (hands-1)%2 || h.finger[4].loc[0] != 80 || h.finger[4].radiustip != 10) return false;
+        auto m = dt.get_marker(markers-1);
+        if (m.id != markers || abs(m.loc[2] - 500) > 1e-3) return false;
+        return true;
+    };
+
+    DTrack parser(0);
+    int wrong = 0;
+    int bytes = 0;
+    for (int i=0; i<rec->size(); i++) if (!parser.parse(rec->get(i).data.c_str(), rec->get(i).data.size()) || !checkFrame(parser, i)) wrong++;
+    VRTimer timer;
+    int R = 20;
+    for (int r=0; r<R; r++) {
+        for (int i=0; i<rec->size(); i++) {
+            parser.parse(rec->get(i).data.c_str(), rec->get(i).data.size());
+            bytes += rec->get(i).data.size();
+        }
+    }
+    double tParse = max(timer.stop(), 1);
+    if (wrong) { cout << " trackingReplay " << wrong << " frames parsed wrong" << endl; passed = false; }
+
+    // full receive path, the replay server sends to a local port at the recorded timing
+    int port = 5099;
+    DTrack receiver(port, 0, 0, 20000, 200000);
+    int received = 0, outOfOrder = 0, last = -1, wrongReceived = 0;
+    if (!receiver.valid()) { cout << " trackingReplay cannot open port " << port << endl; passed = false; }
+    else {
+        auto replay = ARTReplay::create(rec, port, 10); // ten times faster than recorded
+        timer.start();
+        replay->start();
+        while (replay->isRunning() || received == 0) {
+            if (!receiver.receive()) { if (receiver.timeout() && !replay->isRunning()) break; continue; }
+            int k = receiver.get_framecounter();
+            if (k <= last) outOfOrder++;
+            if (!checkFrame(receiver, k)) wrongReceived++;
+            last = k;
+            received++;
+        }
+        while (receiver.receive()) { int k = receiver.get_framecounter(); if (k <= last) outOfOrder++; last = k; received++; } // remaining datagrams
+        replay->stop();
+        int tReplay = timer.stop();
+        if (outOfOrder || wrongReceived || last != frames-1 || received < frames/2) {
+            cout << " trackingReplay received " << received << " frames, last " << last << ", " << outOfOrder << " out of order, " << wrongReceived << " wrong" << endl;
+            passed = false;
+        }
+        cout << " trackingReplay replayed " << replay->getSentCount() << " datagrams in " << tReplay << " ms, received " << received << " frames" << endl;
+    }
+
+    cout << " trackingReplay " << frames << " frames, " << bodies << " bodies, " << flysticks << " flysticks, " << hands << " hands, " << markers << " markers, " << bytes/(R*frames) << " bytes per frame" << endl;
+    cout << " trackingReplay parse latency " << tParse*1000/(R*frames) << " us per frame (" << bytes/tParse/1000 << " MB/s)" << endl;
+    cout << "trackingReplay " << (passed ? "passed" : "FAILED") << endl;
+}
+
+#include "core/setup/tracking/VRPosePredictor.h"
+
+void posePrediction() {
+    // head like motion tracked at 60 Hz, samples arrive 40 ms late with 1 mm and 0.3 degree noise, frames at 90 Hz
+    double rate = 60, latency = 0.04, frameRate = 90, duration = 20;
+    double posNoise = 0.001, rotNoise = 0.3*Pi/180;
+
+    auto pose = [](Vec3d p, double yaw, double pitch, double roll) { // yaw around y, pitch around x, roll around z
+        double cy = cos(yaw), sy = sin(yaw), cp = cos(pitch), sp = sin(pitch), cr = cos(roll), sr = sin(roll);
+        Vec3d x(cy*cr + sy*sp*sr, cp*sr, -sy*cr + cy*sp*sr);
+        Vec3d y(-cy*sr + sy*sp*cr, cp*cr, sy*sr + cy*sp*cr);
+        Vec3d z(sy*cp, -sp, cy*cp);
+        Matrix4d m;
+        for (int i=0; i<3; i++) { m[0][i] = x[i]; m[1][i] = y[i]; m[2][i] = z[i]; m[3][i] = p[i]; }
+        return m;
+    };
+
+    auto motion = [](double t, double k, Vec3d& p, Vec3d& a) { // k scales the motion, 0 for a still tracker
+        p = Vec3d(0.3*sin(1.3*t)*k, 1.7 + 0.05*sin(2.1*t)*k, 0.2*cos(0.9*t)*k);
+        a = Vec3d(0.8*sin(1.1*t)*k, 0.3*sin(1.7*t+1)*k, 0.1*sin(0.7*t)*k);
+    };
+
+    auto error = [](const Matrix4d& a, const Matrix4d& b, double& dp, double& da) {
+        Vec3d d(a[3][0]-b[3][0], a[3][1]-b[3][1], a[3][2]-b[3][2]);
+        dp = d.length();
+        double tr = 0;
+        for (int i=0; i<3; i++) for (int j=0; j<3; j++) tr += a[i][j]*b[i][j];
+        da = acos(max(-1.0, min(1.0, (tr-1)*0.5)));
+    };
+
+    bool ok = true;
+    for (int still = 0; still < 2; still++) {
+        mt19937 rng(42);
+        normal_distribution<double> noise(0, 1);
+        auto predictor = VRPosePredictor::create();
+        predictor->setHorizon(latency);
+
+        Matrix4d raw;
+        double rawP = 0, rawA = 0, predP = 0, predA = 0;
+        int frames = 0, nextSample = 0;
+        for (int f=0; f<duration*frameRate; f++) {
+            double T = f/frameRate;
+            while (nextSample/rate + latency <= T) { // deliver the samples that arrived until this frame
+                double ts = nextSample/rate;
+                Vec3d p, a;
+                motion(ts, 1-still, p, a);
+                p = p + Vec3d(noise(rng), noise(rng), noise(rng))*posNoise;
+                a = a + Vec3d(noise(rng), noise(rng), noise(rng))*rotNoise;
+                raw = pose(p, a[0], a[1], a[2]);
+                predictor->addSample(ts + latency, raw);
+                nextSample++;
+            }
+            if (T < 1) continue; // filter settling
+            Vec3d p, a;
+            motion(T, 1-still, p, a);
+            Matrix4d t = pose(p, a[0], a[1], a[2]);
+            double dp, da;
+            error(raw, t, dp, da); rawP += dp*dp; rawA += da*da;
+            error(predictor->predict(T + predictor->getHorizon()), t, dp, da); predP += dp*dp; predA += da*da;
+            frames++;
+        }
+
+        rawP = sqrt(rawP/frames)*1000; rawA = sqrt(rawA/frames)*180/Pi;
+        predP = sqrt(predP/frames)*1000; predA = sqrt(predA/frames)*180/Pi;
+        cout << " posePrediction " << (still ? "still" : "moving") << ", position error raw " << rawP << " mm, predicted " << predP << " mm";
+        cout << ", orientation error raw " << rawA << " deg, predicted " << predA << " deg" << endl;
+        if (predP > 0.5*rawP || predA > 0.5*rawA) ok = false;
+    }
+
+    cout << (ok ? "posePrediction passed" : "posePrediction FAILED") << endl;
+}
+
+#include "core/networking/VRSyncCodec.h"
+#include <zlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+void clusterSync() {
+    // a slave process decodes the sync stream from a pipe and rebuilds the scene state,
+    // the stream mimics serialized change lists, moving transforms and a deforming mesh, cut into connection buffers
+    int Ntransforms = 500, Nvertices = 5000, Nframes = 120;
+    size_t bufferSize = 32768;
+
+    auto putU32 = [](string& s, uint32_t v) { s.append((const char*)&v, 4); };
+    auto putF = [](string& s, float v) { s.append((const char*)&v, 4); };
+
+    auto serialize = [&](int frame) { // entries: container ID | field mask | size | field data
+        string s;
+        putU32(s, Ntransforms + 1);
+        for (int i=0; i<Ntransforms; i++) {
+            double a = frame*0.01 + i*0.1;
+            string m;
+            float M[16] = { float(cos(a)), float(sin(a)), 0, 0, float(-sin(a)), float(cos(a)), 0, 0, 0, 0, 1, 0, float(i%20), float(i/20), float(0.1*sin(a)), 1 };
+            for (int j=0; j<16; j++) putF(m, M[j]);
+            putU32(s, 1000+i); putU32(s, 0x4); putU32(s, m.size()); s += m;
+        }
+        string p;
+        for (int i=0; i<Nvertices; i++) {
+            float x = i%100*0.01, y = i/100*0.01;
+            putF(p, x); putF(p, y); putF(p, 0.05*sin(10*x + frame*0.05)*cos(10*y));
+        }
+        putU32(s, 5000); putU32(s, 0x10); putU32(s, p.size()); s += p;
+        return s;
+    };
+
+    auto apply = [](const string& frame, map<uint32_t, string>& state) {
+        size_t k = 0;
+        auto getU32 = [&]() { uint32_t v = 0; if (k+4 <= frame.size()) memcpy(&v, &frame[k], 4); k += 4; return v; };
+        uint32_t N = getU32();
+        for (uint32_t i=0; i<N && k < frame.size(); i++) {
+            uint32_t ID = getU32(); getU32(); uint32_t L = getU32();
+            if (k+L > frame.size()) return false;
+            state[ID] = frame.substr(k, L);
+            k += L;
+        }
+        return k == frame.size();
+    };
+
+    auto hashState = [](map<uint32_t, string>& state) {
+        uint64_t h = 1469598103934665603ull;
+        for (auto& s : state) {
+            h = (h ^ s.first) * 1099511628211ull;
+            for (unsigned char c : s.second) h = (h ^ c) * 1099511628211ull;
+        }
+        return h;
+    };
+
+    auto writeAll = [](int fd, const char* data, size_t N) {
+        while (N > 0) { ssize_t n = write(fd, data, N); if (n <= 0) return false; data += n; N -= n; }
+        return true;
+    };
+
+    auto readAll = [](int fd, char* data, size_t N) {
+        while (N > 0) { ssize_t n = read(fd, data, N); if (n <= 0) return false; data += n; N -= n; }
+        return true;
+    };
+
+    int down[2], up[2];
+    if (pipe(down) || pipe(up)) { cout << "clusterSync FAILED, no pipe" << endl; return; }
+
+    pid_t pid = fork();
+    if (pid == 0) { // slave, packets framed by their length, an empty packet ends a frame
+        close(down[1]); close(up[0]);
+        VRSyncCodec decoder;
+        map<uint32_t, string> state;
+        string frame, packet, data;
+        bool ok = true;
+        uint32_t L = 0;
+        while (readAll(down[0], (char*)&L, 4)) {
+            if (L == 0) {
+                ok = ok && apply(frame, state);
+                frame.clear();
+                continue;
+            }
+            packet.resize(L);
+            if (!readAll(down[0], &packet[0], L)) break;
+            ok = ok && decoder.decode(packet.data(), L, data);
+            frame += data;
+        }
+        uint64_t h = ok ? hashState(state) : 0;
+        writeAll(up[1], (const char*)&h, 8);
+        _exit(0);
+    }
+
+    close(down[0]); close(up[1]);
+    VRSyncCodec encoder;
+    map<uint32_t, string> state;
+    vector<string> frames;
+    long long zlibBytes = 0;
+    for (int f=0; f<Nframes; f++) {
+        frames.push_back(serialize(f));
+        apply(frames.back(), state);
+        for (size_t k=0; k<frames.back().size(); k += bufferSize) { // zlib alone for comparison
+            size_t N = min(bufferSize, frames.back().size()-k);
+            uLongf Z = compressBound(N);
+            string z(Z, 0);
+            compress2((Bytef*)&z[0], &Z, (const Bytef*)frames.back().data()+k, N, 1);
+            zlibBytes += Z;
+        }
+    }
+
+    vector<vector<string>> packets(Nframes);
+    VRTimer timer; timer.start();
+    for (int f=0; f<Nframes; f++) {
+        auto& frame = frames[f];
+        for (size_t k=0; k<frame.size(); k += bufferSize) {
+            packets[f].push_back(string());
+            encoder.encode(frame.data()+k, min(bufferSize, frame.size()-k), packets[f].back());
+        }
+    }
+    double encodeTime = timer.stop();
+
+    bool ok = true;
+    for (auto& frame : packets) {
+        for (auto& packet : frame) {
+            uint32_t L = packet.size();
+            ok = ok && writeAll(down[1], (const char*)&L, 4) && writeAll(down[1], packet.data(), L);
+        }
+        uint32_t end = 0;
+        ok = ok && writeAll(down[1], (const char*)&end, 4);
+    }
+    close(down[1]);
+
+    uint64_t slaveHash = 0;
+    ok = readAll(up[0], (char*)&slaveHash, 8) && ok;
+    close(up[0]);
+    waitpid(pid, 0, 0);
+
+    bool equal = slaveHash == hashState(state);
+    double raw = encoder.getRawBytes()/double(Nframes);
+    double sent = encoder.getPacketBytes()/double(Nframes);
+    cout << " clusterSync " << Nframes << " frames, raw " << raw/1024 << " KB/frame, zlib only " << zlibBytes/double(Nframes)/1024;
+    cout << " KB/frame, delta codec " << sent/1024 << " KB/frame, ratio " << encoder.getRatio() << ", encode " << encodeTime/Nframes << " ms/frame" << endl;
+    cout << " clusterSync slave state " << (equal ? "equal" : "DIFFERENT") << endl;
+
+    ok = ok && equal && encoder.getRatio() > 3;
+    cout << (ok ? "clusterSync passed" : "clusterSync FAILED") << endl;
+}
+
+#include "core/networking/VRSyncConnection.h"
+#include "core/setup/windows/VRMultiWindow.h"
+#include <OpenSG/OSGRemoteAspect.h>
+#include <OpenSG/OSGTransform.h>
+#include <OpenSG/OSGChangeList.h>
+#include <OpenSG/OSGThread.h>
+
+void clusterSyncLoopback() {
+    // the real path, a remote aspect sends the change lists through a CompressedStreamSock group connection,
+    // a forked server receives them with the point connection and its own remote aspect and reports the state it rebuilt
+    int Ntransforms = 200, Nvertices = 5000, Nframes = 60;
+
+    auto matrix = [](int frame, int i, int pass) {
+        double a = frame*0.01 + i*0.1 + pass*0.005;
+        Matrix m;
+        m.setRotate(Quaternion(Vec3f(0,0,1), a));
+        m.setTranslate(Vec3f(i%20, i/20, 0.1*sin(a)));
+        return m;
+    };
+
+    auto hashBytes = [](const void* data, size_t N) {
+        uint64_t h = 1469598103934665603ull;
+        for (size_t i=0; i<N; i++) h = (h ^ ((const unsigned char*)data)[i]) * 1099511628211ull;
+        return h;
+    };
+
+    auto hashTransform = [&](Transform* t) {
+        float M[16];
+        for (int i=0; i<16; i++) M[i] = t->getMatrix()[i/4][i%4];
+        return hashBytes(M, sizeof(M));
+    };
+
+    auto hashPoints = [&](GeoPnt3fProperty* p) {
+        vector<Pnt3f> P;
+        for (UInt32 i=0; i<p->size(); i++) P.push_back(p->getValue<Pnt3f>(i));
+        return hashBytes(P.data(), P.size()*sizeof(Pnt3f));
+    };
+
+    ChangeList* cl = Thread::getCurrentChangeList();
+    cl->commitChanges();
+    cl->clear(); // only the containers of this test go over the connection
+
+    auto group = new VRSyncGroupConnection();
+    string address = group->bind("");
+
+    pid_t pid = fork();
+    if (pid == 0) { // server, the containers are found through the changed callbacks of the remote aspect, sums of hashes ignore their order
+        UInt64 h = 0;
+        try {
+            auto point = new VRSyncPointConnection();
+            if (point->connectGroup(address, 10) < 0) _exit(1);
+            RemoteAspect aspect;
+            set<Transform*> transforms;
+            set<GeoPnt3fProperty*> points;
+            aspect.registerChanged(Transform::getClassType(), [&](FieldContainer* const fc, RemoteAspect*) { transforms.insert(dynamic_cast<Transform*>(fc)); return true; });
+            aspect.registerChanged(GeoPnt3fProperty::getClassType(), [&](FieldContainer* const fc, RemoteAspect*) { points.insert(dynamic_cast<GeoPnt3fProperty*>(fc)); return true; });
+
+            UInt32 frames = 0;
+            point->getValue(frames);
+            for (UInt32 f=0; f<frames; f++) {
+                aspect.receiveSync(*point, true);
+                Thread::getCurrentChangeList()->commitChanges();
+                Thread::getCurrentChangeList()->clear();
+            }
+            for (auto t : transforms) h += hashTransform(t);
+            for (auto p : points) h += hashPoints(p);
+
+            point->putValue(h);
+            point->flush();
+        } catch(exception& e) { cout << " clusterSyncLoopback server failed: " << e.what() << endl; }
+        _exit(0);
+    }
+
+    bool ok = true;
+    UInt64 serverHash = 0, localHash = 0;
+    int coalesced = 0;
+    if (group->acceptPoint(10) < 0) { cout << " clusterSyncLoopback server did not connect" << endl; ok = false; }
+    else {
+        vector<TransformRecPtr> transforms;
+        for (int i=0; i<Ntransforms; i++) transforms.push_back( Transform::create() );
+        GeoPnt3fPropertyRecPtr points = GeoPnt3fProperty::create();
+        points->editField().resize(Nvertices);
+
+        RemoteAspect aspect;
+        VRTimer timer; timer.start();
+        try {
+            group->putValue(UInt32(Nframes));
+            group->flush();
+            for (int f=0; f<Nframes; f++) {
+                // two commits in one frame, like scripts and the scene update, leave two entries of the same containers
+                for (int i=0; i<Ntransforms; i++) transforms[i]->setMatrix(matrix(f, i, 0));
+                cl->commitChanges();
+                for (int i=0; i<Ntransforms; i+=2) transforms[i]->setMatrix(matrix(f, i, 1));
+                for (int i=0; i<Nvertices; i++) {
+                    float x = i%100*0.01, y = i/100*0.01;
+                    points->editField()[i] = Pnt3f(x, y, 0.05*sin(10*x + f*0.05)*cos(10*y));
+                }
+                cl->commitChanges();
+
+                coalesced += VRMultiWindow::coalesceChanges(cl);
+                aspect.sendSync(*group, cl);
+                cl->clear();
+            }
+            group->selectChannel(10);
+            group->getValue(serverHash);
+        } catch(exception& e) { cout << " clusterSyncLoopback connection failed: " << e.what() << endl; ok = false; }
+        double syncTime = timer.stop();
+
+        for (auto t : transforms) localHash += hashTransform(t);
+        localHash += hashPoints(points);
+
+        auto& codec = group->getCodec();
+        cout << " clusterSyncLoopback " << Nframes << " frames, raw " << codec.getRawBytes()/Nframes/1024 << " KB/frame, sent " << codec.getPacketBytes()/Nframes/1024;
+        cout << " KB/frame, ratio " << codec.getRatio() << ", " << coalesced/Nframes << " change entries merged per frame, " << syncTime/Nframes << " ms/frame" << endl;
+        if (serverHash != localHash) { cout << " clusterSyncLoopback server state differs" << endl; ok = false; }
+        if (coalesced == 0) { cout << " clusterSyncLoopback no change entries merged" << endl; ok = false; }
+        if (codec.getFrameCount() < Nframes || codec.getRatio() <= 1) { cout << " clusterSyncLoopback stream not compressed" << endl; ok = false; }
+    }
+
+    waitpid(pid, 0, 0);
+    delete group;
+    cout << (ok ? "clusterSyncLoopback passed" : "clusterSyncLoopback FAILED") << endl;
+}
+
 void VRRunTest(string test) {
     cout << "run test " << test << endl;
 
     if (test == "listActiveMaterials") listActiveMaterials();
     if (test == "vrpn_client") vrpn_client();
     if (test == "vrpn_server") vrpn_server();
+    if (test == "sceneBinaryRoundtrip") sceneBinaryRoundtrip();
+    if (test == "importCache") importCache();
+    if (test == "vertexWelder") vertexWelder();
+    if (test == "geoDataBulk") geoDataBulk();
+    if (test == "selectionParallel") selectionParallel();
+    if (test == "instancing") instancing();
+    if (test == "pathBVH") pathBVH();
+    if (test == "terrainHeights") terrainHeights();
+    if (test == "graphLayout") graphLayout();
+    if (test == "sphDamBreak") sphDamBreak();
+    if (test == "millingDexels") millingDexels();
+    if (test == "voxelMeshing") voxelMeshing();
+    if (test == "mechanismBroadphase") mechanismBroadphase();
+    if (test == "moleculeUpdates") moleculeUpdates();
+    if (test == "csgBackends") csgBackends();
+    if (test == "ontologyIndex") ontologyIndex();
+    if (test == "ruleEngineStream") ruleEngineStream();
+    if (test == "expressionCompiler") expressionCompiler();
+    if (test == "processSimulation") processSimulation();
+    if (test == "logisticsFlow") logisticsFlow();
+    if (test == "textureSynthesis") textureSynthesis();
+    if (test == "soundMixer") soundMixer();
+    if (test == "trackingReplay") trackingReplay();
+    if (test == "posePrediction") posePrediction();
+    if (test == "clusterSync") clusterSync();
+    if (test == "clusterSyncLoopback") clusterSyncLoopback();
 }